@@ -0,0 +1,196 @@
+// Host check of the bootstrap mode.
+// 1) estimator bias: many independent links receive a steady RSSI plus uniform noise from their reset on; the mean output at each sample number,
+//    relative to the steady state mean, shows how early (and how biased) the estimates are with and without the bootstrap mode.
+// 2) multistatic_interference_radar_multiprocess() must give exactly the same results and transmitters data with the batch engine as with the scalar one,
+//    bootstrap and autoregressive smoother included.
+// 3) churn on the mock radar: an access point in use switches off, and the replacement link is blind until its first valid output.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o bootstrap_check bootstrap_check.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./bootstrap_check [trials=4000] [noise amplitude dB=3]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+
+#define SAMPLES_PER_TRIAL 160
+#define STEADY_FROM 96 // samples, the steady state reference is averaged from here to the end
+#define BATCH_LINKS 32
+
+
+// library internals, not in the public header
+int multistatic_interference_radar_multiprocess(radarContext * radar);
+
+
+uint32_t randomState = 12345;
+
+int noisySample(int amplitude) { // xorshift32, uniform in [-60 - amplitude, -60 + amplitude]
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return -60 + (int) (randomState % (uint32_t) (2 * amplitude + 1)) - amplitude;
+}
+
+
+void estimatorBias(radarContext * radar, int bootstrap, bool autoRegressive, int trials, int amplitude) {
+  multistatic_interference_radar_enable_bootstrap(radar, bootstrap);
+  std::vector<double> sums(SAMPLES_PER_TRIAL, 0.0);
+  std::vector<int> valid(SAMPLES_PER_TRIAL, 0);
+  transmitterData * link = new transmitterData;
+
+  for (int trial = 0; trial < trials; trial++) {
+    *link = transmitterData();
+    link->enableAutoRegressive = autoRegressive;
+    for (int sampleIndex = 0; sampleIndex < SAMPLES_PER_TRIAL; sampleIndex++) {
+      int level = multistatic_interference_radar_process(radar, noisySample(amplitude), link);
+      if (level >= 0) {
+        sums[sampleIndex] = sums[sampleIndex] + level;
+        valid[sampleIndex]++;
+      }
+    }
+  }
+  delete link;
+
+  double steady = 0;
+  int steadyValid = 0;
+  int firstValid = -1;
+  for (int sampleIndex = 0; sampleIndex < SAMPLES_PER_TRIAL; sampleIndex++) {
+    if ((firstValid < 0) && (valid[sampleIndex] == trials)) {
+      firstValid = sampleIndex + 1;
+    }
+    if (sampleIndex >= STEADY_FROM) {
+      steady = steady + sums[sampleIndex];
+      steadyValid = steadyValid + valid[sampleIndex];
+    }
+  }
+  steady = steady / steadyValid;
+
+  printf("bootstrap=%d autoregressive=%d first_valid_sample=%d steady_mean=%.2f mean/steady at sample", bootstrap, autoRegressive ? 1 : 0, firstValid, steady);
+  const int reported[] = {4, 5, 6, 8, 12, 16, 24, 31, 32, 33, 40, 64};
+  for (unsigned int reportIndex = 0; reportIndex < sizeof(reported) / sizeof(reported[0]); reportIndex++) {
+    int sampleIndex = reported[reportIndex] - 1;
+    if (valid[sampleIndex] == 0) {
+      printf(" %d:-", reported[reportIndex]);
+    } else {
+      printf(" %d:%.2f", reported[reportIndex], sums[sampleIndex] / valid[sampleIndex] / steady);
+    }
+  }
+  printf("\n");
+}
+
+
+radarContext * equivalenceRadar(int batch, bool autoRegressive) { // BATCH_LINKS tracked slots fed straight from the scan results, no scan involved
+  radarContext * radar = new radarContext;
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(radar, BATCH_LINKS);
+  multistatic_interference_radar_enable_batch_processing(radar, batch);
+  multistatic_interference_radar_enable_bootstrap(radar, 1);
+  for (int linkIndex = 0; linkIndex < BATCH_LINKS; linkIndex++) {
+    radar->accessPoints.transmittersData[linkIndex].enableAutoRegressive = autoRegressive;
+    radar->accessPoints.transmittersData[linkIndex].enableThreshold = linkIndex % 2; // half of the links also report their detection level
+    radar->accessPoints.netItemNumbers[linkIndex] = linkIndex;
+  }
+  radar->accessPoints.scanResults->entriesNumber = BATCH_LINKS;
+  return radar;
+}
+
+
+int batchMismatches(bool autoRegressive, int amplitude) { // the same samples through both engines of multistatic_interference_radar_multiprocess(), links reset at different times
+  radarContext * scalarRadar = equivalenceRadar(0, autoRegressive);
+  radarContext * batchRadar = equivalenceRadar(1, autoRegressive);
+
+  int mismatches = 0;
+  for (int step = 0; step < 400; step++) {
+    for (int linkIndex = 0; linkIndex < BATCH_LINKS; linkIndex++) {
+      if ((step > 0) && ((step + linkIndex * 13) % 97 == 0)) { // churn
+        scalarRadar->accessPoints.transmittersData[linkIndex].resetRequest = 1;
+        batchRadar->accessPoints.transmittersData[linkIndex].resetRequest = 1;
+      }
+      int sample = noisySample(amplitude + linkIndex % 4);
+      scalarRadar->accessPoints.scanResults->entries[linkIndex].RSSI = sample;
+      batchRadar->accessPoints.scanResults->entries[linkIndex].RSSI = sample;
+    }
+    multistatic_interference_radar_multiprocess(scalarRadar);
+    multistatic_interference_radar_multiprocess(batchRadar);
+    for (int linkIndex = 0; linkIndex < BATCH_LINKS; linkIndex++) {
+      int scalarResult = scalarRadar->accessPoints.latestVariances[linkIndex];
+      int batchResult = batchRadar->accessPoints.latestVariances[linkIndex];
+      const transmitterData * scalarLink = &scalarRadar->accessPoints.transmittersData[linkIndex];
+      const transmitterData * batchLink = &batchRadar->accessPoints.transmittersData[linkIndex];
+      if ((scalarResult != batchResult) && ((scalarResult >= 0) || (batchResult >= 0))) { // the booting codes may differ, < 0 both ways
+        mismatches++;
+      } else if ((scalarResult >= 0) && ((scalarLink->varianceSample != batchLink->varianceSample) || (scalarLink->detectionLevel != batchLink->detectionLevel) ||
+                                         (scalarLink->varianceAR != batchLink->varianceAR) || (scalarLink->alarmStatus != batchLink->alarmStatus))) { // the fields written back to the transmitters data
+        mismatches++;
+      }
+    }
+  }
+  delete scalarRadar;
+  delete batchRadar;
+  printf("batch_vs_scalar autoregressive=%d steps=400 links=%d mismatching_results=%d\n", autoRegressive ? 1 : 0, BATCH_LINKS, mismatches);
+  return mismatches;
+}
+
+
+int churnBlindCycles(int bootstrap, int batch) { // cycles from the loss of a transmitter to the first valid output of its replacement
+  mockScanEnvironment * env = new mockScanEnvironment;
+  radarContext * radar = new radarContext;
+  mock_scan_backend_reset(env, 99);
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = 10;
+  row.SSIDprefix = NULL;
+  row.strongestRSSI = -45;
+  row.noise = 2;
+  mock_scan_backend_add_synthetic_aps(env, &row);
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_set_scan_backend(radar, mock_scan_backend(env));
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_enable_batch_processing(radar, batch);
+  multistatic_interference_radar_enable_bootstrap(radar, bootstrap);
+  for (int cycle = 0; cycle < 100; cycle++) {
+    multistatic_interference_radar(radar);
+    mock_scan_backend_advance(env, 1000);
+  }
+
+  mock_scan_backend_ap(env, 0)->present = 0; // the strongest one, in use
+  int blindCycles = 0;
+  do {
+    multistatic_interference_radar(radar);
+    mock_scan_backend_advance(env, 1000);
+    blindCycles++;
+  } while ((radar->accessPoints.latestVariances[0] < 0) && (blindCycles < 1000));
+
+  delete radar;
+  delete env;
+  return blindCycles;
+}
+
+
+int main(int argc, char ** argv) {
+
+  int trials = (argc > 1) ? atoi(argv[1]) : 4000;
+  int amplitude = (argc > 2) ? atoi(argv[2]) : 3;
+
+  radarContext * radar = new radarContext;
+  multistatic_interference_radar_set_debug_level(radar, 0);
+
+  estimatorBias(radar, 0, false, trials, amplitude);
+  estimatorBias(radar, 1, false, trials, amplitude);
+  estimatorBias(radar, 0, true, trials, amplitude);
+  estimatorBias(radar, 1, true, trials, amplitude);
+
+  int mismatches = batchMismatches(false, amplitude) + batchMismatches(true, amplitude);
+
+  for (int batch = 0; batch <= 1; batch++) {
+    printf("churn engine=%s blind_cycles bootstrap=0: %d bootstrap=1: %d\n", batch ? "batch" : "scalar", churnBlindCycles(0, batch), churnBlindCycles(1, batch));
+  }
+
+  delete radar;
+  return (mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,454 @@
+// Host microbenchmarks of the radar core and of the housekeeping stages, one JSON object per line so that the results of two releases can be diffed or fed to a script:
+// - process:     multistatic_interference_radar_process(), per sample, across window sizes and filter options (booting cases restart the link every 32 samples)
+// - process_template: the same samples through the transmitterDataT overload (multistatic_interference_radar_template.h), sizes and options fixed at compile time
+// - multiprocess: multistatic_interference_radar_multiprocess(), per cycle, across transmitter counts, scalar and batch engines
+// - sort, scan_lookup, slot_lookup, scan_index: sortScanResultsByRSSI(), the BSSID searches and the per scan index rebuild, across scan sizes
+// - cycle:       the whole multistatic_interference_radar() against the mock scan backend (host time only, the simulated radio time is not waited for)
+// Every case is calibrated to about a fifth of the minimum time, then run 5 times: ns_per_op is the median, ns_min the best run. allocs_per_op counts the
+// operator new calls during the runs, the processing path is expected to never allocate.
+// With a baseline (the output of a previous run) each line also reports the relative change of the best runs, less sensitive to a busy machine than the medians,
+// and the exit code is 1 when a case got slower than BENCH_REGRESSION_THRESHOLD.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o core_bench core_bench.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./core_bench [minimum ms per case=300] [baseline.jsonl] > results.jsonl
+
+#include "../../multistatic_interference_radar.h"
+#include "../../multistatic_interference_radar_template.h"
+#include "mock_scan_backend.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+
+#define BENCH_REPETITIONS 5
+#define BENCH_SAMPLES_NUMBER 4096 // pre-drawn samples, MUST be a power of two
+#define BENCH_REGRESSION_THRESHOLD 0.15 // relative slowdown against the baseline flagged as a regression
+#define BENCH_WARMUP_CYCLES 48 // radar cycles before measuring, so that the windows are full
+
+
+// library internals, not in the public header
+int multistatic_interference_radar_multiprocess(radarContext * radar);
+void sortScanResultsByRSSI(radarContext * radar);
+int searchSlotByBSSID(radarContext * radar, uint8_t * searchBSSID);
+int searchScanResultsByBSSID(radarContext * radar, uint8_t * BSSIDtoSearch);
+void rebuildScanResultsIndex(radarContext * radar);
+
+
+// allocation counter: every operator new of the program goes through here
+std::atomic<unsigned long> allocationsCount(0);
+
+void * operator new(size_t size) {
+  allocationsCount.fetch_add(1, std::memory_order_relaxed);
+  void * memory = malloc((size > 0) ? size : 1);
+  if (memory == NULL) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void * operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void * memory) noexcept {
+  free(memory);
+}
+
+void operator delete[](void * memory) noexcept {
+  free(memory);
+}
+
+
+volatile int benchSink = 0; // results are written here, so that the compiler cannot drop the measured calls
+
+int minimumMs = 300;
+
+std::vector<std::string> baselineKeys;
+std::vector<double> baselineNs;
+
+int regressions = 0;
+
+
+typedef void (*benchBody)(void * state, long iterations);
+
+
+double runOnce(benchBody body, void * state, long iterations) { // returns the elapsed ns
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  body(state, iterations);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+void loadBaseline(const char * fileName) {
+  FILE * baselineFile = fopen(fileName, "r");
+  if (baselineFile == NULL) {
+    fprintf(stderr, "cannot read the baseline %s\n", fileName);
+    exit(1);
+  }
+  char line[1024];
+  while (fgets(line, sizeof(line), baselineFile) != NULL) {
+    const char * keyEnd = strstr(line, ",\"op\":");
+    const char * nsField = strstr(line, "\"ns_min\":");
+    if ((line[0] != '{') || (keyEnd == NULL) || (nsField == NULL)) {
+      continue;
+    }
+    baselineKeys.push_back(std::string(line + 1, keyEnd - line - 1));
+    baselineNs.push_back(atof(nsField + strlen("\"ns_min\":")));
+  }
+  fclose(baselineFile);
+}
+
+
+// key: the JSON members identifying the case, e.g. "\"bench\":\"sort\",\"scan_results\":64"; op: what one operation is; opsPerIteration: operations done by one iteration of the body
+void runBench(const std::string & key, const char * op, benchBody body, void * state, double opsPerIteration) {
+
+  // calibration: double the iterations until a run takes a fifth of the minimum time
+  long iterations = 1;
+  double targetNs = (double) minimumMs * 1e6 / BENCH_REPETITIONS;
+  while ((runOnce(body, state, iterations) < targetNs) && (iterations < (1L << 40))) {
+    iterations = iterations * 2;
+  }
+
+  double runsNs[BENCH_REPETITIONS];
+  unsigned long allocationsBefore = allocationsCount.load();
+  for (int repetition = 0; repetition < BENCH_REPETITIONS; repetition++) {
+    runsNs[repetition] = runOnce(body, state, iterations) / (iterations * opsPerIteration);
+  }
+  unsigned long allocations = allocationsCount.load() - allocationsBefore;
+  std::sort(runsNs, runsNs + BENCH_REPETITIONS);
+  double medianNs = runsNs[BENCH_REPETITIONS / 2];
+
+  printf("{%s,\"op\":\"%s\",\"iterations\":%ld,\"ns_per_op\":%.2f,\"ns_min\":%.2f,\"ops_per_s\":%.0f,\"allocs_per_op\":%.4f", key.c_str(), op, iterations, medianNs, runsNs[0],
+         1e9 / medianNs, (double) allocations / (BENCH_REPETITIONS * iterations * opsPerIteration));
+  for (unsigned int baselineIndex = 0; baselineIndex < baselineKeys.size(); baselineIndex++) {
+    if (baselineKeys[baselineIndex] == key) {
+      double change = runsNs[0] / baselineNs[baselineIndex] - 1.0;
+      printf(",\"baseline_ns_min\":%.2f,\"change\":%.3f", baselineNs[baselineIndex], change);
+      if (change > BENCH_REGRESSION_THRESHOLD) {
+        printf(",\"regression\":1");
+        regressions++;
+      }
+      break;
+    }
+  }
+  printf("}\n");
+  fflush(stdout);
+}
+
+
+std::string keyPrintf(const char * format, ...) __attribute__((format(printf, 1, 2)));
+
+std::string keyPrintf(const char * format, ...) {
+  char key[256];
+  va_list arguments;
+  va_start(arguments, format);
+  vsnprintf(key, sizeof(key), format, arguments);
+  va_end(arguments);
+  return std::string(key);
+}
+
+
+// process()
+
+void fillBenchSamples(int * samples) { // the same BENCH_SAMPLES_NUMBER samples for the runtime and the template links
+  uint32_t randomState = 12345;
+  for (int sampleIndex = 0; sampleIndex < BENCH_SAMPLES_NUMBER; sampleIndex++) { // xorshift32, -60 dBm plus or minus 3 dB, a person walking by now and then
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    samples[sampleIndex] = -60 + (int) (randomState % 7) - 3 - (((sampleIndex / 256) % 4 == 0) ? 8 : 0);
+  }
+}
+
+
+typedef struct  processBenchStruct {
+
+radarContext * radar;
+
+transmitterData * link;
+
+int samples[BENCH_SAMPLES_NUMBER];
+
+int resetEvery; // 0 = steady state, otherwise the link restarts every that many samples (the booting path)
+
+} processBench;
+
+
+void processBody(void * state, long iterations) {
+  processBench * bench = (processBench *) state;
+  int sink = 0;
+  for (long iteration = 0; iteration < iterations; iteration++) {
+    if ((bench->resetEvery > 0) && (iteration % bench->resetEvery == 0)) {
+      bench->link->resetRequest = 1;
+    }
+    sink = sink + multistatic_interference_radar_process(bench->radar, bench->samples[iteration & (BENCH_SAMPLES_NUMBER - 1)], bench->link);
+  }
+  benchSink = sink;
+}
+
+
+void benchProcess(int window, int integrator, int autoRegressive, int secondOrder, int bootstrap, int resetEvery) {
+  processBench * bench = new processBench;
+  bench->radar = new radarContext;
+  bench->link = new transmitterData;
+  bench->resetEvery = resetEvery;
+  multistatic_interference_radar_set_debug_level(bench->radar, 0);
+  multistatic_interference_radar_enable_second_order_variance_filtering(bench->radar, secondOrder);
+  multistatic_interference_radar_enable_bootstrap(bench->radar, bootstrap);
+  bench->link->sampleBufferSize = window;
+  bench->link->mobileAverageFilterSize = window;
+  bench->link->varianceIntegratorLimit = integrator;
+  bench->link->enableAutoRegressive = (autoRegressive >= 1);
+  fillBenchSamples(bench->samples);
+
+  runBench(keyPrintf("\"bench\":\"process\",\"window\":%d,\"integrator\":%d,\"autoregressive\":%d,\"second_order\":%d,\"bootstrap\":%d,\"reset_every\":%d",
+                     window, integrator, autoRegressive, secondOrder, bootstrap, resetEvery), "sample", processBody, bench, 1.0);
+
+  delete bench->link;
+  delete bench->radar;
+  delete bench;
+}
+
+
+// process() on transmitterDataT, steady state only: the template has no bootstrap mode
+
+template <typename templateLink>
+struct processTemplateBench {
+
+templateLink link;
+
+int samples[BENCH_SAMPLES_NUMBER];
+
+};
+
+
+template <typename templateLink>
+void processTemplateBody(void * state, long iterations) {
+  processTemplateBench<templateLink> * bench = (processTemplateBench<templateLink> *) state;
+  int sink = 0;
+  for (long iteration = 0; iteration < iterations; iteration++) {
+    sink = sink + multistatic_interference_radar_process(bench->samples[iteration & (BENCH_SAMPLES_NUMBER - 1)], &bench->link);
+  }
+  benchSink = sink;
+}
+
+
+template <int Window, bool AutoRegressive, bool SecondOrder>
+void benchProcessTemplate() { // same key members as benchProcess(), so that the two lines of a case can be compared
+  typedef transmitterDataT<Window, Window, MAX_VARIANCEBUFFERSIZE_MULTI, VARIANCE_INTEGRATOR_LIMIT, SecondOrder, 16, AutoRegressive, false> templateLink;
+  processTemplateBench<templateLink> * bench = new processTemplateBench<templateLink>;
+  fillBenchSamples(bench->samples);
+
+  runBench(keyPrintf("\"bench\":\"process_template\",\"window\":%d,\"integrator\":%d,\"autoregressive\":%d,\"second_order\":%d,\"bootstrap\":0,\"reset_every\":0",
+                     Window, VARIANCE_INTEGRATOR_LIMIT, AutoRegressive ? 1 : 0, SecondOrder ? 1 : 0), "sample", processTemplateBody<templateLink>, bench, 1.0);
+
+  delete bench;
+}
+
+
+template <int Window>
+void benchProcessTemplates() { // the options are template parameters, the four combinations are spelled out
+  benchProcessTemplate<Window, false, false>();
+  benchProcessTemplate<Window, false, true>();
+  benchProcessTemplate<Window, true, false>();
+  benchProcessTemplate<Window, true, true>();
+}
+
+
+// whole radars on the mock backend
+
+typedef struct  radarBenchStruct {
+
+mockScanEnvironment * env;
+
+radarContext * radar;
+
+uint8_t BSSIDs[2 * ABSOLUTE_MAX_SCAN_RESULTS][6]; // the lookups: every scanned BSSID, then as many absent ones
+
+int BSSIDsNumber;
+
+} radarBench;
+
+
+radarBench * setupRadarBench(int accessPoints, int transmitters, int batch, int shadows) {
+  radarBench * bench = new radarBench;
+  bench->env = new mockScanEnvironment;
+  bench->radar = new radarContext;
+  mock_scan_backend_reset(bench->env, 777);
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = accessPoints;
+  row.SSIDprefix = "bench";
+  row.RSSIstep = 7;
+  row.RSSIspread = 45;
+  mock_scan_backend_add_synthetic_aps(bench->env, &row);
+  for (int apIndex = 0; apIndex < accessPoints; apIndex++) {
+    memcpy(bench->BSSIDs[2 * apIndex], mock_scan_backend_ap(bench->env, apIndex)->BSSID, 6);
+    memcpy(bench->BSSIDs[2 * apIndex + 1], mock_scan_backend_ap(bench->env, apIndex)->BSSID, 6);
+    bench->BSSIDs[2 * apIndex + 1][3] = 0x55; // never scanned
+  }
+  bench->BSSIDsNumber = 2 * accessPoints;
+  multistatic_interference_radar_set_debug_level(bench->radar, 0);
+  multistatic_interference_radar_set_scan_backend(bench->radar, mock_scan_backend(bench->env));
+  multistatic_interference_radar_init(bench->radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(bench->radar, transmitters);
+  multistatic_interference_radar_enable_batch_processing(bench->radar, batch);
+  multistatic_interference_radar_set_shadow_trackers(bench->radar, shadows);
+  for (int cycle = 0; cycle < BENCH_WARMUP_CYCLES; cycle++) {
+    multistatic_interference_radar(bench->radar);
+  }
+  return bench;
+}
+
+
+void deleteRadarBench(radarBench * bench) {
+  delete bench->radar;
+  delete bench->env;
+  delete bench;
+}
+
+
+void multiprocessBody(void * state, long iterations) {
+  radarBench * bench = (radarBench *) state;
+  int sink = 0;
+  for (long iteration = 0; iteration < iterations; iteration++) {
+    sink = sink + multistatic_interference_radar_multiprocess(bench->radar);
+  }
+  benchSink = sink;
+}
+
+
+void sortBody(void * state, long iterations) {
+  radarBench * bench = (radarBench *) state;
+  for (long iteration = 0; iteration < iterations; iteration++) {
+    sortScanResultsByRSSI(bench->radar);
+  }
+  benchSink = bench->radar->accessPoints.scanIndexByPower[0];
+}
+
+
+void scanLookupBody(void * state, long iterations) { // one iteration looks every BSSID up
+  radarBench * bench = (radarBench *) state;
+  int sink = 0;
+  for (long iteration = 0; iteration < iterations; iteration++) {
+    for (int lookup = 0; lookup < bench->BSSIDsNumber; lookup++) {
+      sink = sink + searchScanResultsByBSSID(bench->radar, bench->BSSIDs[lookup]);
+    }
+  }
+  benchSink = sink;
+}
+
+
+void slotLookupBody(void * state, long iterations) {
+  radarBench * bench = (radarBench *) state;
+  int sink = 0;
+  for (long iteration = 0; iteration < iterations; iteration++) {
+    for (int lookup = 0; lookup < bench->BSSIDsNumber; lookup++) {
+      sink = sink + searchSlotByBSSID(bench->radar, bench->BSSIDs[lookup]);
+    }
+  }
+  benchSink = sink;
+}
+
+
+void scanIndexBody(void * state, long iterations) {
+  radarBench * bench = (radarBench *) state;
+  for (long iteration = 0; iteration < iterations; iteration++) {
+    rebuildScanResultsIndex(bench->radar);
+  }
+  benchSink = bench->radar->accessPoints.discoveredNetworks;
+}
+
+
+void cycleBody(void * state, long iterations) {
+  radarBench * bench = (radarBench *) state;
+  int sink = 0;
+  for (long iteration = 0; iteration < iterations; iteration++) {
+    sink = sink + multistatic_interference_radar(bench->radar);
+  }
+  benchSink = sink;
+}
+
+
+void benchMultiprocess(int transmitters, int batch) {
+  radarBench * bench = setupRadarBench(ABSOLUTE_MAX_SCAN_RESULTS, transmitters, batch, 0);
+  runBench(keyPrintf("\"bench\":\"multiprocess\",\"transmitters\":%d,\"engine\":\"%s\"", transmitters, batch ? "batch" : "scalar"), "cycle", multiprocessBody, bench, 1.0);
+  deleteRadarBench(bench);
+}
+
+
+void benchHousekeeping(int scanResults, int transmitters) {
+  radarBench * bench = setupRadarBench(scanResults, transmitters, 0, 0);
+  runBench(keyPrintf("\"bench\":\"sort\",\"scan_results\":%d,\"transmitters\":%d", scanResults, transmitters), "sort", sortBody, bench, 1.0);
+  runBench(keyPrintf("\"bench\":\"scan_lookup\",\"scan_results\":%d", scanResults), "lookup", scanLookupBody, bench, bench->BSSIDsNumber);
+  runBench(keyPrintf("\"bench\":\"slot_lookup\",\"scan_results\":%d,\"transmitters\":%d", scanResults, transmitters), "lookup", slotLookupBody, bench, bench->BSSIDsNumber);
+  runBench(keyPrintf("\"bench\":\"scan_index\",\"scan_results\":%d", scanResults), "rebuild", scanIndexBody, bench, 1.0);
+  deleteRadarBench(bench);
+}
+
+
+void benchCycle(int scanResults, int transmitters, int batch, int shadows) {
+  radarBench * bench = setupRadarBench(scanResults, transmitters, batch, shadows);
+  runBench(keyPrintf("\"bench\":\"cycle\",\"scan_results\":%d,\"transmitters\":%d,\"engine\":\"%s\",\"shadows\":%d", scanResults, transmitters, batch ? "batch" : "scalar", shadows),
+           "cycle", cycleBody, bench, 1.0);
+  deleteRadarBench(bench);
+}
+
+
+int main(int argc, char ** argv) {
+
+  minimumMs = (argc > 1) ? atoi(argv[1]) : 300;
+  if (minimumMs < 5) {
+    minimumMs = 5;
+  }
+  if (argc > 2) {
+    loadBaseline(argv[2]);
+  }
+
+  const int windows[] = {8, 16, 32};
+  for (unsigned int windowIndex = 0; windowIndex < sizeof(windows) / sizeof(windows[0]); windowIndex++) {
+    for (int autoRegressive = 0; autoRegressive <= 1; autoRegressive++) {
+      for (int secondOrder = 0; secondOrder <= 1; secondOrder++) {
+        benchProcess(windows[windowIndex], VARIANCE_INTEGRATOR_LIMIT, autoRegressive, secondOrder, 0, 0);
+      }
+    }
+  }
+  benchProcess(MAX_SAMPLEBUFFERSIZE_MULTI, MAX_VARIANCEBUFFERSIZE_MULTI, 0, 1, 0, 0); // the longest integrator
+  benchProcess(MAX_SAMPLEBUFFERSIZE_MULTI, VARIANCE_INTEGRATOR_LIMIT, 0, 1, 0, MAX_SAMPLEBUFFERSIZE_MULTI); // always booting
+  benchProcess(MAX_SAMPLEBUFFERSIZE_MULTI, VARIANCE_INTEGRATOR_LIMIT, 0, 1, 1, MAX_SAMPLEBUFFERSIZE_MULTI);
+  benchProcessTemplates<8>();
+  benchProcessTemplates<16>();
+  benchProcessTemplates<32>();
+
+  const int transmittersTested[] = {1, 4, 8, 16, 32, 64};
+  for (unsigned int transmittersIndex = 0; transmittersIndex < sizeof(transmittersTested) / sizeof(transmittersTested[0]); transmittersIndex++) {
+    benchMultiprocess(transmittersTested[transmittersIndex], 0);
+    benchMultiprocess(transmittersTested[transmittersIndex], 1);
+  }
+
+  const int scanSizes[] = {8, 16, 32, 64};
+  for (unsigned int scanIndex = 0; scanIndex < sizeof(scanSizes) / sizeof(scanSizes[0]); scanIndex++) {
+    benchHousekeeping(scanSizes[scanIndex], (scanSizes[scanIndex] < 16) ? scanSizes[scanIndex] / 2 : 4);
+  }
+  benchHousekeeping(64, 32);
+
+  benchCycle(16, 4, 0, 0);
+  benchCycle(64, 4, 0, 0);
+  benchCycle(64, 4, 0, 4);
+  benchCycle(64, 16, 0, 0);
+  benchCycle(64, 16, 1, 0);
+
+  if (baselineKeys.size() > 0) {
+    printf("{\"regressions\":%d,\"threshold\":%.2f}\n", regressions, BENCH_REGRESSION_THRESHOLD);
+  }
+  return (regressions == 0) ? 0 : 1;
+}
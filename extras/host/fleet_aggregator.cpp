@@ -0,0 +1,524 @@
+// Building-wide aggregation daemon: receives the link frames of many nodes over UDP (see fleet_protocol.h), runs the
+// multistatic_interference_radar_process() filters of every link on a work-stealing thread pool, and fuses the links of all the nodes
+// into building-wide detections.
+//
+// - the links (node id + BSSID) are spread by hash on SHARDS_NUMBER shards; the receiver thread appends each sample to its shard mailbox
+//   (single producer / single consumer ring) and schedules the shard on its home worker, a shard is processed by one worker at a time,
+//   so the samples of a link are always filtered in order and the link data needs no lock,
+// - each worker pops its own shards newest first and, when it has none, steals the oldest shard of another worker,
+// - every FUSION_PERIOD_MS the main thread reads the latest variance of every fresh link: a node is alarmed when at least NODE_ALARM_LINKS
+//   of its links are above the link threshold, the building detection needs at least quorum alarmed nodes.
+// Frames of kind FLEET_FRAME_VARIANCE skip the filters: the node results are fused as they are.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o fleet_aggregator fleet_aggregator.cpp fleet_protocol.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./fleet_aggregator [port=41200] [workers=all cores] [seconds=0, forever] [link threshold=20] [quorum nodes=1]
+// then feed it, e.g. with fleet_load_generator
+
+#include "../../multistatic_interference_radar.h"
+#include "fleet_protocol.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+#define SHARDS_NUMBER 1024 // MUST be a power of two
+#define SHARD_MAILBOX_SIZE 1024 // samples, MUST be a power of two; a full mailbox drops the samples (counted)
+#define SHARD_BUDGET 256 // samples processed per shard turn, then the worker moves on
+#define LINK_BLOCK_SIZE 64 // links storage grows by blocks that never move, so the fusion reads them while the workers add new ones
+#define MAX_LINK_BLOCKS 256 // per shard
+#define FUSION_PERIOD_MS 200
+#define STATS_PERIOD_MS 1000
+#define LINK_STALE_MS 2000 // links silent for longer are left out of the fusion
+#define NODE_ALARM_LINKS 2 // alarmed links for a node to be alarmed
+#define MAX_NODES 65536
+#define LATENCY_BUCKETS 32 // log2 histogram of the receive to filtered time, in microseconds
+
+
+typedef struct  fleetSampleStruct {
+
+uint64_t linkKey = 0; // node id << 48 | packed BSSID
+
+int value = 0;
+
+int kind = FLEET_FRAME_RSSI;
+
+uint64_t receivedUs = 0;
+
+} fleetSample;
+
+
+typedef struct  fleetLinkStruct {
+
+uint64_t linkKey = 0;
+
+transmitterData data; // the link filters, exactly one slot of a node
+
+std::atomic<int> latestVariance {RADAR_BOOTING};
+
+std::atomic<uint32_t> updatedMs {0}; // aggregator time of the latest sample
+
+} fleetLink;
+
+
+typedef struct  fleetShardStruct {
+
+std::atomic<uint32_t> head {0}; // mailbox, written by the receiver
+
+std::atomic<uint32_t> tail {0}; // mailbox, read by the worker holding the shard
+
+fleetSample mailbox[SHARD_MAILBOX_SIZE];
+
+std::atomic<int> scheduled {0}; // 1 while the shard is queued or being processed: one worker at a time
+
+fleetLink * linkBlocks[MAX_LINK_BLOCKS] = {NULL};
+
+std::atomic<int> linksNumber {0}; // links readable by the fusion
+
+std::unordered_map<uint64_t, int> linkIndex; // link key -> link number, only touched by the worker holding the shard
+
+} fleetShard;
+
+
+typedef struct  fleetWorkerStruct {
+
+std::mutex lock; // guards shards: the owner pushes and pops at the back, thieves pop at the front
+
+std::deque<int> shards;
+
+std::thread thread;
+
+std::atomic<uint64_t> processedSamples {0};
+
+std::atomic<uint64_t> steals {0};
+
+std::atomic<uint32_t> latency[LATENCY_BUCKETS];
+
+} fleetWorker;
+
+
+fleetShard * shards = NULL;
+fleetWorker * workers = NULL;
+int workersNumber = 1;
+
+radarContext * filtersRadar = NULL; // settings of the link filters (second order filter), only read by the workers
+
+std::atomic<int> stopRequest {0};
+
+std::atomic<uint64_t> datagramsReceived {0};
+std::atomic<uint64_t> samplesReceived {0};
+std::atomic<uint64_t> samplesDropped {0};
+std::atomic<uint64_t> framesMalformed {0};
+std::atomic<uint64_t> framesLost {0};
+
+std::chrono::steady_clock::time_point startTime;
+
+
+
+uint64_t nowUs() {
+  return (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+
+uint32_t linkHash(uint64_t linkKey) { // 64 bit mix, the top bits are the best spread
+  linkKey = linkKey * 0x9e3779b97f4a7c15ULL;
+  return (uint32_t) (linkKey >> 40);
+}
+
+
+fleetLink * shardLink(fleetShard * shard, int linkNumber) {
+  return &shard->linkBlocks[linkNumber / LINK_BLOCK_SIZE][linkNumber % LINK_BLOCK_SIZE];
+}
+
+
+
+// work-stealing pool
+
+void submitShard(int workerIndex, int shardIndex) {
+  fleetWorker * worker = &workers[workerIndex];
+  std::lock_guard<std::mutex> guard(worker->lock);
+  worker->shards.push_back(shardIndex);
+}
+
+
+int takeShard(int workerIndex, int * shardIndex) { // own shards first (newest, still in cache), then steal the oldest of the others; returns 1 if one was found
+  fleetWorker * worker = &workers[workerIndex];
+  {
+    std::lock_guard<std::mutex> guard(worker->lock);
+    if (!worker->shards.empty()) {
+      *shardIndex = worker->shards.back();
+      worker->shards.pop_back();
+      return 1;
+    }
+  }
+  for (int offset = 1; offset < workersNumber; offset++) {
+    fleetWorker * victim = &workers[(workerIndex + offset) % workersNumber];
+    std::lock_guard<std::mutex> guard(victim->lock);
+    if (!victim->shards.empty()) {
+      *shardIndex = victim->shards.front();
+      victim->shards.pop_front();
+      worker->steals.fetch_add(1, std::memory_order_relaxed);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+
+fleetLink * findOrAddLink(fleetShard * shard, uint64_t linkKey) { // worker holding the shard only
+  std::unordered_map<uint64_t, int>::iterator found = shard->linkIndex.find(linkKey);
+  if (found != shard->linkIndex.end()) {
+    return shardLink(shard, found->second);
+  }
+  int linkNumber = shard->linksNumber.load(std::memory_order_relaxed);
+  if (linkNumber >= MAX_LINK_BLOCKS * LINK_BLOCK_SIZE) {
+    return NULL;
+  }
+  if (linkNumber % LINK_BLOCK_SIZE == 0) {
+    shard->linkBlocks[linkNumber / LINK_BLOCK_SIZE] = new fleetLink[LINK_BLOCK_SIZE];
+  }
+  fleetLink * link = shardLink(shard, linkNumber);
+  link->linkKey = linkKey;
+  shard->linkIndex[linkKey] = linkNumber;
+  shard->linksNumber.store(linkNumber + 1, std::memory_order_release); // the fusion may read it from now on
+  return link;
+}
+
+
+void runShard(int workerIndex, int shardIndex) {
+  fleetWorker * worker = &workers[workerIndex];
+  fleetShard * shard = &shards[shardIndex];
+  uint32_t nowMs = (uint32_t) (nowUs() / 1000);
+  int processed = 0;
+
+  uint32_t tail = shard->tail.load(std::memory_order_relaxed);
+  uint32_t head = shard->head.load(std::memory_order_acquire);
+  while ((tail != head) && (processed < SHARD_BUDGET)) {
+    const fleetSample * sample = &shard->mailbox[tail & (SHARD_MAILBOX_SIZE - 1)];
+    fleetLink * link = findOrAddLink(shard, sample->linkKey);
+    if (link != NULL) {
+      int variance = sample->value;
+      if (sample->kind == FLEET_FRAME_RSSI) {
+        variance = multistatic_interference_radar_process(filtersRadar, sample->value, &link->data);
+      }
+      if (variance >= 0) {
+        link->latestVariance.store(variance, std::memory_order_relaxed);
+      }
+      link->updatedMs.store(nowMs, std::memory_order_relaxed);
+    }
+    uint64_t latencyUs = nowUs() - sample->receivedUs;
+    int bucket = 0;
+    while ((latencyUs > 1) && (bucket < LATENCY_BUCKETS - 1)) {
+      latencyUs = latencyUs >> 1;
+      bucket++;
+    }
+    worker->latency[bucket].fetch_add(1, std::memory_order_relaxed);
+    tail++;
+    processed++;
+    if (tail == head) {
+      head = shard->head.load(std::memory_order_acquire);
+    }
+  }
+  shard->tail.store(tail, std::memory_order_release);
+  worker->processedSamples.fetch_add(processed, std::memory_order_relaxed);
+
+  // hand the shard back; samples pushed meanwhile either see it unscheduled (and schedule it) or are seen here
+  shard->scheduled.store(0, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if ((shard->head.load(std::memory_order_acquire) != tail) && (shard->scheduled.exchange(1) == 0)) {
+    submitShard(workerIndex, shardIndex);
+  }
+}
+
+
+void workerLoop(int workerIndex) {
+  int shardIndex = 0;
+  while (stopRequest.load(std::memory_order_relaxed) == 0) {
+    if (takeShard(workerIndex, &shardIndex) == 1) {
+      runShard(workerIndex, shardIndex);
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+}
+
+
+
+// receiver
+
+void receiverLoop(int socketFd) {
+  static uint8_t datagram[FLEET_MAX_FRAME_LEN + 1];
+  static fleetFrame frame;
+  static uint32_t lastSequence[MAX_NODES];
+  static uint8_t nodeSeen[MAX_NODES];
+  std::vector<uint32_t> shardTouched(SHARDS_NUMBER, 0); // datagram number of the latest touch, to schedule each shard once per datagram
+  std::vector<int> touchedShards;
+  uint32_t datagramNumber = 0;
+
+  while (stopRequest.load(std::memory_order_relaxed) == 0) {
+    ssize_t length = recv(socketFd, datagram, sizeof(datagram), 0);
+    if (length <= 0) {
+      continue; // timeout: look at the stop request
+    }
+    datagramsReceived.fetch_add(1, std::memory_order_relaxed);
+    if (fleet_frame_decode(datagram, (int) length, &frame) != 0) {
+      framesMalformed.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    if (nodeSeen[frame.nodeId] && (frame.sequence > lastSequence[frame.nodeId] + 1)) {
+      framesLost.fetch_add(frame.sequence - lastSequence[frame.nodeId] - 1, std::memory_order_relaxed);
+    }
+    nodeSeen[frame.nodeId] = 1;
+    lastSequence[frame.nodeId] = frame.sequence;
+
+    uint64_t receivedUs = nowUs();
+    datagramNumber++;
+    touchedShards.clear();
+    for (int recordIndex = 0; recordIndex < frame.recordsNumber; recordIndex++) {
+      const fleetRecord * record = &frame.records[recordIndex];
+      uint64_t linkKey = (uint64_t) frame.nodeId << 48;
+      for (int bssidIndex = 0; bssidIndex < 6; bssidIndex++) {
+        linkKey = linkKey | ((uint64_t) record->BSSID[bssidIndex] << (8 * (5 - bssidIndex)));
+      }
+      int shardIndex = (int) (linkHash(linkKey) & (SHARDS_NUMBER - 1));
+      fleetShard * shard = &shards[shardIndex];
+
+      uint32_t head = shard->head.load(std::memory_order_relaxed);
+      if (head - shard->tail.load(std::memory_order_acquire) >= SHARD_MAILBOX_SIZE) {
+        samplesDropped.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      fleetSample * sample = &shard->mailbox[head & (SHARD_MAILBOX_SIZE - 1)];
+      sample->linkKey = linkKey;
+      sample->value = record->value;
+      sample->kind = frame.kind;
+      sample->receivedUs = receivedUs;
+      shard->head.store(head + 1, std::memory_order_release);
+
+      if (shardTouched[shardIndex] != datagramNumber) {
+        shardTouched[shardIndex] = datagramNumber;
+        touchedShards.push_back(shardIndex);
+      }
+    }
+    samplesReceived.fetch_add(frame.recordsNumber, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence of runShard()
+    for (size_t touchedIndex = 0; touchedIndex < touchedShards.size(); touchedIndex++) {
+      int shardIndex = touchedShards[touchedIndex];
+      if (shards[shardIndex].scheduled.exchange(1) == 0) {
+        submitShard(shardIndex % workersNumber, shardIndex); // the home worker of the shard
+      }
+    }
+  }
+}
+
+
+
+// fusion
+
+typedef struct  fusionResultStruct {
+
+int freshLinks = 0;
+
+int alarmedLinks = 0;
+
+int alarmedNodes = 0;
+
+long level = 0; // sum of the positive variances of the fresh links
+
+std::vector<int> nodes; // the alarmed ones
+
+} fusionResult;
+
+
+void fuseLinks(uint32_t nowMs, int linkThreshold, fusionResult * result) {
+  static int nodeAlarmedLinks[MAX_NODES];
+  std::vector<int> touchedNodes;
+
+  *result = fusionResult();
+  for (int shardIndex = 0; shardIndex < SHARDS_NUMBER; shardIndex++) {
+    fleetShard * shard = &shards[shardIndex];
+    int linksNumber = shard->linksNumber.load(std::memory_order_acquire);
+    for (int linkNumber = 0; linkNumber < linksNumber; linkNumber++) {
+      fleetLink * link = shardLink(shard, linkNumber);
+      if (nowMs - link->updatedMs.load(std::memory_order_relaxed) > LINK_STALE_MS) {
+        continue;
+      }
+      int variance = link->latestVariance.load(std::memory_order_relaxed);
+      result->freshLinks++;
+      if (variance > 0) {
+        result->level = result->level + variance;
+      }
+      if (variance > linkThreshold) {
+        int node = (int) (link->linkKey >> 48);
+        result->alarmedLinks++;
+        if (nodeAlarmedLinks[node] == 0) {
+          touchedNodes.push_back(node);
+        }
+        nodeAlarmedLinks[node]++;
+      }
+    }
+  }
+  for (size_t nodeIndex = 0; nodeIndex < touchedNodes.size(); nodeIndex++) {
+    int node = touchedNodes[nodeIndex];
+    if (nodeAlarmedLinks[node] >= NODE_ALARM_LINKS) {
+      result->alarmedNodes++;
+      result->nodes.push_back(node);
+    }
+    nodeAlarmedLinks[node] = 0;
+  }
+}
+
+
+int openSocket(int port) {
+  int socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (socketFd < 0) {
+    return -1;
+  }
+  int receiveBuffer = 8 * 1024 * 1024; // bursts of the whole fleet, the kernel may cap it (net.core.rmem_max)
+  setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+  struct timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = 100000;
+  setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons((uint16_t) port);
+  if (bind(socketFd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+    close(socketFd);
+    return -1;
+  }
+  return socketFd;
+}
+
+
+uint64_t latencyPercentile(const uint64_t * histogram, uint64_t total, double fraction) { // upper bound of the bucket, in microseconds
+  uint64_t count = 0;
+  for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    count = count + histogram[bucket];
+    if ((total > 0) && (count >= total * fraction)) {
+      return 1ULL << (bucket + 1);
+    }
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv) {
+
+  int port = (argc > 1) ? atoi(argv[1]) : FLEET_UDP_PORT;
+  workersNumber = (argc > 2) ? atoi(argv[2]) : (int) std::thread::hardware_concurrency();
+  int seconds = (argc > 3) ? atoi(argv[3]) : 0;
+  int linkThreshold = (argc > 4) ? atoi(argv[4]) : 20;
+  int quorumNodes = (argc > 5) ? atoi(argv[5]) : 1;
+  if (workersNumber < 1) {
+    workersNumber = 1;
+  }
+
+  int socketFd = openSocket(port);
+  if (socketFd < 0) {
+    printf("cannot bind UDP port %d\n", port);
+    return 1;
+  }
+
+  startTime = std::chrono::steady_clock::now();
+  filtersRadar = new radarContext;
+  multistatic_interference_radar_set_debug_level(filtersRadar, 0);
+  shards = new fleetShard[SHARDS_NUMBER];
+  workers = new fleetWorker[workersNumber];
+  for (int workerIndex = 0; workerIndex < workersNumber; workerIndex++) {
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+      workers[workerIndex].latency[bucket].store(0);
+    }
+    workers[workerIndex].thread = std::thread(workerLoop, workerIndex);
+  }
+  std::thread receiver(receiverLoop, socketFd);
+  printf("listening on UDP port %d, workers=%d shards=%d link_threshold=%d quorum_nodes=%d\n", port, workersNumber, SHARDS_NUMBER, linkThreshold, quorumNodes);
+  fflush(stdout);
+
+  // fusion and statistics
+  int detection = 0;
+  uint64_t previousSamples = 0;
+  uint64_t previousProcessed = 0;
+  uint64_t previousDatagrams = 0;
+  uint64_t previousHistogram[LATENCY_BUCKETS] = {0};
+  uint32_t nextStatsMs = STATS_PERIOD_MS;
+  fusionResult fused;
+  while ((seconds == 0) || (nowUs() < (uint64_t) seconds * 1000000ULL)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(FUSION_PERIOD_MS));
+    uint32_t nowMs = (uint32_t) (nowUs() / 1000);
+
+    fuseLinks(nowMs, linkThreshold, &fused);
+    int fusedDetection = (fused.alarmedNodes >= quorumNodes) ? 1 : 0;
+    if (fusedDetection != detection) {
+      detection = fusedDetection;
+      printf("t_s=%.1f detection=%d alarmed_nodes=%d alarmed_links=%d fresh_links=%d level=%ld nodes=", nowMs / 1000.0, detection, fused.alarmedNodes, fused.alarmedLinks,
+             fused.freshLinks, fused.level);
+      for (size_t nodeIndex = 0; nodeIndex < fused.nodes.size(); nodeIndex++) {
+        printf("%s%d", (nodeIndex > 0) ? "," : "", fused.nodes[nodeIndex]);
+      }
+      printf("\n");
+      fflush(stdout);
+    }
+
+    if (nowMs >= nextStatsMs) {
+      nextStatsMs = nextStatsMs + STATS_PERIOD_MS;
+      uint64_t processed = 0;
+      uint64_t steals = 0;
+      uint64_t histogram[LATENCY_BUCKETS] = {0};
+      for (int workerIndex = 0; workerIndex < workersNumber; workerIndex++) {
+        processed = processed + workers[workerIndex].processedSamples.load(std::memory_order_relaxed);
+        steals = steals + workers[workerIndex].steals.load(std::memory_order_relaxed);
+        for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+          histogram[bucket] = histogram[bucket] + workers[workerIndex].latency[bucket].load(std::memory_order_relaxed);
+        }
+      }
+      uint64_t intervalHistogram[LATENCY_BUCKETS];
+      uint64_t intervalTotal = 0;
+      for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        intervalHistogram[bucket] = histogram[bucket] - previousHistogram[bucket];
+        intervalTotal = intervalTotal + intervalHistogram[bucket];
+        previousHistogram[bucket] = histogram[bucket];
+      }
+      uint64_t samples = samplesReceived.load();
+      uint64_t datagrams = datagramsReceived.load();
+      int links = 0;
+      for (int shardIndex = 0; shardIndex < SHARDS_NUMBER; shardIndex++) {
+        links = links + shards[shardIndex].linksNumber.load(std::memory_order_relaxed);
+      }
+      printf("t_s=%.1f datagrams_per_s=%lu samples_per_s=%lu processed_per_s=%lu links=%d fresh_links=%d dropped=%lu lost_frames=%lu malformed=%lu steals=%lu latency_p50_us=%lu latency_p99_us=%lu\n",
+             nowMs / 1000.0, (unsigned long) (datagrams - previousDatagrams), (unsigned long) (samples - previousSamples), (unsigned long) (processed - previousProcessed),
+             links, fused.freshLinks, (unsigned long) samplesDropped.load(), (unsigned long) framesLost.load(), (unsigned long) framesMalformed.load(), (unsigned long) steals,
+             (unsigned long) latencyPercentile(intervalHistogram, intervalTotal, 0.5), (unsigned long) latencyPercentile(intervalHistogram, intervalTotal, 0.99));
+      fflush(stdout);
+      previousSamples = samples;
+      previousProcessed = processed;
+      previousDatagrams = datagrams;
+    }
+  }
+
+  stopRequest.store(1);
+  receiver.join();
+  for (int workerIndex = 0; workerIndex < workersNumber; workerIndex++) {
+    workers[workerIndex].thread.join();
+  }
+  close(socketFd);
+  return 0;
+}
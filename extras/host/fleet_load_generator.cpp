@@ -0,0 +1,204 @@
+// Load generator for fleet_aggregator: simulates a building full of nodes, each one sending the beacons RSSI of its links
+// (or, with kind=1, the variances computed on the node by multistatic_interference_radar_process()) at beacon rate, over UDP.
+// Every EVENT_PERIOD_MS someone walks for EVENT_DURATION_MS near EVENT_NODES consecutive nodes, whose links get a much noisier RSSI:
+// the generator prints each walk, the aggregator should print a detection with the same nodes.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o fleet_load_generator fleet_load_generator.cpp fleet_protocol.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./fleet_load_generator [nodes=200] [links per node=20] [beacons per s=10] [seconds=30] [kind=0] [port=41200] [host=127.0.0.1]
+
+#include "../../multistatic_interference_radar.h"
+#include "fleet_protocol.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+#define TICK_MS 100 // each node sends what it heard every TICK_MS
+#define EVENT_PERIOD_MS 20000
+#define EVENT_DURATION_MS 6000
+#define EVENT_FIRST_MS 10000 // the filters need a few seconds of quiet first
+#define EVENT_NODES 3
+#define QUIET_NOISE 1
+#define WALK_NOISE 10
+
+
+typedef struct  simulatedNodeStruct {
+
+uint16_t nodeId = 0;
+
+uint32_t sequence = 0;
+
+uint32_t randomState = 1;
+
+std::vector<transmitterData> links; // kind=1 only: the node side filters
+
+} simulatedNode;
+
+
+uint32_t nodeRandom(simulatedNode * node) { // xorshift32
+  node->randomState ^= node->randomState << 13;
+  node->randomState ^= node->randomState >> 17;
+  node->randomState ^= node->randomState << 5;
+  return node->randomState;
+}
+
+
+int walkedNode(int nodeIndex, int nodesNumber, uint32_t nowMs) { // 1 while someone walks near the node
+  if (nowMs < EVENT_FIRST_MS) {
+    return 0;
+  }
+  uint32_t eventMs = nowMs - EVENT_FIRST_MS;
+  if (eventMs % EVENT_PERIOD_MS >= EVENT_DURATION_MS) {
+    return 0;
+  }
+  int firstNode = (int) ((eventMs / EVENT_PERIOD_MS) * 7 % nodesNumber);
+  return ((nodeIndex - firstNode + nodesNumber) % nodesNumber) < EVENT_NODES;
+}
+
+
+int main(int argc, char ** argv) {
+
+  int nodesNumber = (argc > 1) ? atoi(argv[1]) : 200;
+  int linksNumber = (argc > 2) ? atoi(argv[2]) : 20;
+  double beaconsPerSecond = (argc > 3) ? atof(argv[3]) : 10.0;
+  int seconds = (argc > 4) ? atoi(argv[4]) : 30;
+  int kind = (argc > 5) ? atoi(argv[5]) : FLEET_FRAME_RSSI;
+  int port = (argc > 6) ? atoi(argv[6]) : FLEET_UDP_PORT;
+  const char * host = (argc > 7) ? argv[7] : "127.0.0.1";
+  if ((nodesNumber < 1) || (nodesNumber > 65535) || (linksNumber < 1) || (linksNumber > 256)) {
+    printf("nodes: 1 to 65535, links per node: 1 to 256\n");
+    return 1;
+  }
+
+  int socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons((uint16_t) port);
+  if ((socketFd < 0) || (inet_pton(AF_INET, host, &address.sin_addr) != 1)) {
+    printf("cannot send to %s:%d\n", host, port);
+    return 1;
+  }
+
+  radarContext * radar = new radarContext; // kind=1: the settings of the node filters
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  std::vector<simulatedNode> nodes(nodesNumber);
+  for (int nodeIndex = 0; nodeIndex < nodesNumber; nodeIndex++) {
+    nodes[nodeIndex].nodeId = (uint16_t) (nodeIndex + 1);
+    nodes[nodeIndex].randomState = 12345 + nodeIndex;
+    if (kind == FLEET_FRAME_VARIANCE) {
+      nodes[nodeIndex].links.resize(linksNumber);
+    }
+  }
+
+  printf("nodes=%d links=%d beacons_per_s=%.1f kind=%d: %.0f samples/s to %s:%d for %d s\n", nodesNumber, nodesNumber * linksNumber, beaconsPerSecond, kind,
+         nodesNumber * linksNumber * beaconsPerSecond, host, port, seconds);
+  fflush(stdout);
+
+  static fleetFrame frame;
+  uint8_t datagram[FLEET_MAX_FRAME_LEN];
+  double beaconsDue = 0; // per link, fractional beacons carried over to the next tick
+  unsigned long datagrams = 0;
+  unsigned long samples = 0;
+  unsigned long sendFailures = 0;
+  unsigned long lateTicks = 0;
+  int walking = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point nextTick = start;
+
+  for (uint32_t nowMs = 0; nowMs < (uint32_t) seconds * 1000; nowMs = nowMs + TICK_MS) {
+
+    int walkingNow = walkedNode(0, 1, nowMs); // is any walk going on
+    if (walkingNow != walking) {
+      walking = walkingNow;
+      if (walking) {
+        printf("t_s=%.1f walk nodes=", nowMs / 1000.0);
+        const char * separator = "";
+        for (int nodeIndex = 0; nodeIndex < nodesNumber; nodeIndex++) {
+          if (walkedNode(nodeIndex, nodesNumber, nowMs)) {
+            printf("%s%d", separator, nodes[nodeIndex].nodeId);
+            separator = ",";
+          }
+        }
+        printf("\n");
+      } else {
+        printf("t_s=%.1f walk over\n", nowMs / 1000.0);
+      }
+      fflush(stdout);
+    }
+
+    beaconsDue = beaconsDue + beaconsPerSecond * TICK_MS / 1000.0;
+    int beacons = (int) beaconsDue;
+    beaconsDue = beaconsDue - beacons;
+
+    for (int nodeIndex = 0; nodeIndex < nodesNumber; nodeIndex++) {
+      simulatedNode * node = &nodes[nodeIndex];
+      int noise = walkedNode(nodeIndex, nodesNumber, nowMs) ? WALK_NOISE : QUIET_NOISE;
+      frame.kind = kind;
+      frame.nodeId = node->nodeId;
+      frame.timestampMs = nowMs;
+      frame.recordsNumber = 0;
+
+      for (int beacon = 0; beacon < beacons; beacon++) {
+        for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+          int rssi = -45 - (linkIndex * 3 + nodeIndex) % 40 + (int) (nodeRandom(node) % (uint32_t) (2 * noise + 1)) - noise;
+          fleetRecord * record = &frame.records[frame.recordsNumber];
+          record->BSSID[0] = 0x02;
+          record->BSSID[4] = (uint8_t) (nodeIndex / 16); // neighbouring nodes hear some of the same access points
+          record->BSSID[5] = (uint8_t) linkIndex;
+          record->timestampMs = nowMs - (uint32_t) ((beacons - 1 - beacon) * TICK_MS / beacons);
+          record->value = rssi;
+          if (kind == FLEET_FRAME_VARIANCE) {
+            record->value = multistatic_interference_radar_process(radar, rssi, &node->links[linkIndex]);
+            if (record->value < 0) {
+              continue; // still booting: nothing to report
+            }
+          }
+          frame.recordsNumber++;
+
+          if (frame.recordsNumber == FLEET_MAX_RECORDS) { // full datagram
+            frame.sequence = node->sequence++;
+            int length = fleet_frame_encode(&frame, datagram, sizeof(datagram));
+            if (sendto(socketFd, datagram, length, 0, (struct sockaddr *) &address, sizeof(address)) != length) {
+              sendFailures++;
+            }
+            datagrams++;
+            samples = samples + frame.recordsNumber;
+            frame.recordsNumber = 0;
+          }
+        }
+      }
+      if (frame.recordsNumber > 0) {
+        frame.sequence = node->sequence++;
+        int length = fleet_frame_encode(&frame, datagram, sizeof(datagram));
+        if (sendto(socketFd, datagram, length, 0, (struct sockaddr *) &address, sizeof(address)) != length) {
+          sendFailures++;
+        }
+        datagrams++;
+        samples = samples + frame.recordsNumber;
+      }
+    }
+
+    nextTick = nextTick + std::chrono::milliseconds(TICK_MS);
+    if (std::chrono::steady_clock::now() > nextTick) {
+      lateTicks++; // the generator itself cannot keep the pace
+    }
+    std::this_thread::sleep_until(nextTick);
+  }
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("sent datagrams=%lu samples=%lu samples_per_s=%.0f send_failures=%lu late_ticks=%lu\n", datagrams, samples, samples / elapsed, sendFailures, lateTicks);
+  close(socketFd);
+  return 0;
+}
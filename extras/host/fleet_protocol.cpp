@@ -0,0 +1,97 @@
+// Fleet link frames, see fleet_protocol.h
+
+#include "fleet_protocol.h"
+
+#include <string.h>
+
+
+
+void fleetPut16(uint8_t * bytes, uint32_t value) {
+  bytes[0] = value & 0xff;
+  bytes[1] = (value >> 8) & 0xff;
+}
+
+
+void fleetPut32(uint8_t * bytes, uint32_t value) {
+  bytes[0] = value & 0xff;
+  bytes[1] = (value >> 8) & 0xff;
+  bytes[2] = (value >> 16) & 0xff;
+  bytes[3] = (value >> 24) & 0xff;
+}
+
+
+uint32_t fleetGet16(const uint8_t * bytes) {
+  return bytes[0] | (bytes[1] << 8);
+}
+
+
+uint32_t fleetGet32(const uint8_t * bytes) {
+  return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+
+
+int fleet_frame_encode(const fleetFrame * frame, uint8_t * buffer, int bufferLength) {
+  if ((frame->recordsNumber < 0) || (frame->recordsNumber > FLEET_MAX_RECORDS) || ((frame->kind != FLEET_FRAME_RSSI) && (frame->kind != FLEET_FRAME_VARIANCE))) {
+    return -1;
+  }
+  int length = FLEET_HEADER_LEN + frame->recordsNumber * FLEET_RECORD_LEN;
+  if (length > bufferLength) {
+    return -1;
+  }
+
+  fleetPut16(&buffer[0], FLEET_MAGIC);
+  buffer[2] = FLEET_VERSION;
+  buffer[3] = (uint8_t) frame->kind;
+  fleetPut16(&buffer[4], frame->nodeId);
+  fleetPut16(&buffer[6], frame->recordsNumber);
+  fleetPut32(&buffer[8], frame->sequence);
+  fleetPut32(&buffer[12], frame->timestampMs);
+
+  uint8_t * record = &buffer[FLEET_HEADER_LEN];
+  for (int recordIndex = 0; recordIndex < frame->recordsNumber; recordIndex++) {
+    const fleetRecord * item = &frame->records[recordIndex];
+    int value = item->value;
+    if (value > 32767) {
+      value = 32767;
+    }
+    if (value < -32768) {
+      value = -32768;
+    }
+    uint32_t offsetMs = frame->timestampMs - item->timestampMs; // records are never newer than their frame
+    if (offsetMs > 65535) {
+      offsetMs = 65535;
+    }
+    memcpy(record, item->BSSID, 6);
+    fleetPut16(&record[6], (uint16_t) (int16_t) value);
+    fleetPut16(&record[8], offsetMs);
+    record = record + FLEET_RECORD_LEN;
+  }
+  return length;
+}
+
+
+int fleet_frame_decode(const uint8_t * buffer, int length, fleetFrame * frame) {
+  if ((length < FLEET_HEADER_LEN) || (fleetGet16(&buffer[0]) != FLEET_MAGIC) || (buffer[2] != FLEET_VERSION)) {
+    return -1;
+  }
+  frame->kind = buffer[3];
+  frame->nodeId = (uint16_t) fleetGet16(&buffer[4]);
+  frame->recordsNumber = (int) fleetGet16(&buffer[6]);
+  frame->sequence = fleetGet32(&buffer[8]);
+  frame->timestampMs = fleetGet32(&buffer[12]);
+  if (((frame->kind != FLEET_FRAME_RSSI) && (frame->kind != FLEET_FRAME_VARIANCE)) || (frame->recordsNumber > FLEET_MAX_RECORDS)
+      || (length != FLEET_HEADER_LEN + frame->recordsNumber * FLEET_RECORD_LEN)) {
+    return -1;
+  }
+
+  const uint8_t * record = &buffer[FLEET_HEADER_LEN];
+  for (int recordIndex = 0; recordIndex < frame->recordsNumber; recordIndex++) {
+    fleetRecord * item = &frame->records[recordIndex];
+    memcpy(item->BSSID, record, 6);
+    item->value = (int16_t) fleetGet16(&record[6]);
+    item->timestampMs = frame->timestampMs - fleetGet16(&record[8]);
+    record = record + FLEET_RECORD_LEN;
+  }
+  return 0;
+}
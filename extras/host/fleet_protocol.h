@@ -0,0 +1,66 @@
+// Fleet link frames: how the nodes of a building send their links to the aggregator (fleet_aggregator.cpp), one UDP datagram per frame.
+
+// A frame carries the samples of one node: either raw RSSI samples, processed by the aggregator with multistatic_interference_radar_process(),
+// or the node's own results (latestVariances[]), fused as they are. A link is the pair node id / transmitter BSSID.
+// Everything is little endian, the encoder and decoder only need stdint and string.h, so a node can use them as well.
+//
+// frame header (FLEET_HEADER_LEN bytes):
+//   magic (2) version (1) kind (1) node id (2) records number (2) sequence (4) timestamp ms (4)
+// then recordsNumber records (FLEET_RECORD_LEN bytes each):
+//   BSSID (6) value (2, signed: RSSI dBm or variance) time offset from the frame timestamp, ms (2)
+
+#ifndef FLEET_PROTOCOL_H
+#define FLEET_PROTOCOL_H
+
+#include <stdint.h>
+
+
+#define FLEET_UDP_PORT 41200
+
+#define FLEET_MAGIC 0x464d // "MF"
+#define FLEET_VERSION 1
+
+#define FLEET_FRAME_RSSI 0 // raw RSSI samples
+#define FLEET_FRAME_VARIANCE 1 // node side results
+
+#define FLEET_HEADER_LEN 16
+#define FLEET_RECORD_LEN 10
+#define FLEET_MAX_RECORDS 128 // 1296 bytes datagrams at most, below the usual 1500 bytes MTU
+#define FLEET_MAX_FRAME_LEN (FLEET_HEADER_LEN + FLEET_MAX_RECORDS * FLEET_RECORD_LEN)
+
+
+typedef struct  fleetRecordStruct {
+
+uint8_t BSSID[6] = {0};
+
+int value = 0; // RSSI in dBm (FLEET_FRAME_RSSI) or variance (FLEET_FRAME_VARIANCE, clamped to 32767)
+
+uint32_t timestampMs = 0; // node time of the sample
+
+} fleetRecord;
+
+
+typedef struct  fleetFrameStruct {
+
+int kind = FLEET_FRAME_RSSI;
+
+uint16_t nodeId = 0;
+
+uint32_t sequence = 0; // per node, lets the aggregator count the lost frames
+
+uint32_t timestampMs = 0; // node time of the frame, the records are at most 65535 ms older
+
+int recordsNumber = 0;
+
+fleetRecord records[FLEET_MAX_RECORDS];
+
+} fleetFrame;
+
+
+// current status: IMPLEMENTED
+int fleet_frame_encode(const fleetFrame *, uint8_t * buffer, int bufferLength); // returns the frame length in bytes, -1 if the buffer is too small or the frame is invalid
+
+// current status: IMPLEMENTED
+int fleet_frame_decode(const uint8_t * buffer, int length, fleetFrame *); // returns 0 and fills the frame, -1 if the datagram is not a valid frame
+
+#endif
@@ -0,0 +1,203 @@
+// Size report of the radar data structures: what one link costs, in bytes and in cache lines, and how many links fit in a given RAM budget.
+// - sizeof and offsetof of every transmitterData field, the bytes per link of the batch structure-of-arrays, the size of the context,
+// - the cache lines a sample touches: the fields multistatic_interference_radar_process() reads or writes in the steady state, the two ring entries it writes and
+//   the two it evicts, over every position of the rings and every element of the 64 transmitters pool (the pool is packed, links do not start on a line boundary),
+// - the same figures for the all-int layout the library used before, kept below for the comparison.
+// The budgets are also checked at build time by the static_asserts of multistatic_interference_radar.h: this tool only reports.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -o layout_report layout_report.cpp
+// run:
+//   ./layout_report [cache line bytes=64] [RAM budget in bytes for the links=16384]
+
+#include "../../multistatic_interference_radar.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <set>
+
+
+typedef struct  legacyTransmitterDataStruct { // the all-int transmitterData, same field order
+
+int sampleBuffer[MAX_SAMPLEBUFFERSIZE_MULTI];
+int sampleBufferSize;
+int sampleBufferIndex;
+int sampleBufferValid;
+int latestReceivedSample;
+int mobileAverageBufferSize;
+int mobileAverageBuffer[MAX_AVERAGEBUFFERSIZE_MULTI];
+int mobileAverageTemp;
+int mobileAverageFilterSize;
+int mobileAverage;
+int mobileAverageBufferIndex;
+int mobileAverageBufferValid;
+int varianceBufferSize;
+int varianceBuffer[MAX_VARIANCEBUFFERSIZE_MULTI];
+int variance;
+int variancePrev;
+int varianceSample;
+int varianceBufferIndex;
+int varianceBufferValid;
+int varianceIntegral;
+int varianceIntegratorLimitMax;
+int varianceIntegratorLimit;
+int varianceAR;
+int mobileAverageSum;
+int mobileAverageSumSize;
+int sampleBufferSumSize;
+int varianceBufferSum;
+int varianceIntegralSize;
+int varianceBufferSumSize;
+int bufferIndex;
+int enableThreshold;
+int varianceThreshold;
+int FIRvarianceAvg;
+int detectionLevel;
+bool enableAutoRegressive;
+int minimum_RSSI;
+int currentRSSI;
+int initComplete;
+int resetRequest;
+int alarmStatus;
+
+} legacyTransmitterData;
+
+
+typedef struct  fieldSpanStruct {
+const char * name;
+size_t offset;
+size_t size;
+} fieldSpan;
+
+
+#define FIELD(type, field) { #field, offsetof(type, field), sizeof(((type *) 0)->field) }
+
+// the flags are bitfields in transmitterData, offsetof cannot take them: the bytes holding one are the bytes that change when it is cleared in an object full of ones
+#define FLAG(type, field) flagSpan<type>(#field, [](type * data) { data->field = 0; })
+
+
+template <typename T>
+fieldSpan flagSpan(const char * name, void (*clearFlag)(T *)) {
+  T * data = new T;
+  unsigned char * bytes = (unsigned char *) data;
+  memset(bytes, 0xff, sizeof(T));
+  clearFlag(data);
+  size_t first = sizeof(T);
+  size_t last = 0;
+  for (size_t byteIndex = 0; byteIndex < sizeof(T); byteIndex++) {
+    if (bytes[byteIndex] != 0xff) {
+      first = (byteIndex < first) ? byteIndex : first;
+      last = byteIndex;
+    }
+  }
+  delete data;
+  fieldSpan span = { name, first, last - first + 1 };
+  return span;
+}
+
+// the scalars a steady state sample reads or writes (the rings are counted apart, one entry at a time)
+#define SAMPLE_FIELDS(type) { \
+  FLAG(type, resetRequest), FIELD(type, mobileAverageSumSize), FIELD(type, mobileAverageFilterSize), FIELD(type, varianceIntegralSize), \
+  FIELD(type, sampleBufferSumSize), FIELD(type, varianceBufferSumSize), \
+  FIELD(type, varianceIntegratorLimit), FIELD(type, latestReceivedSample), FIELD(type, minimum_RSSI), FIELD(type, currentRSSI), \
+  FIELD(type, sampleBufferSize), FIELD(type, sampleBufferIndex), FLAG(type, sampleBufferValid), FIELD(type, mobileAverageSum), \
+  FIELD(type, mobileAverage), FIELD(type, varianceSample), FIELD(type, FIRvarianceAvg), FIELD(type, varianceBufferSize), \
+  FIELD(type, varianceBufferIndex), FLAG(type, varianceBufferValid), FIELD(type, varianceBufferSum), FIELD(type, varianceIntegral), \
+  FIELD(type, varianceAR), FIELD(type, variance), FLAG(type, enableAutoRegressive), FLAG(type, enableThreshold), \
+  FIELD(type, varianceThreshold), FIELD(type, detectionLevel) }
+
+
+void addSpan(std::set<size_t> * lines, size_t start, size_t size, size_t lineBytes) {
+  for (size_t line = start / lineBytes; line <= (start + size - 1) / lineBytes; line++) {
+    lines->insert(line);
+  }
+}
+
+
+template <typename T>
+void sampleLines(const char * layout, const fieldSpan * fields, int fieldsNumber, int lineBytes, int ramBudget) {
+  size_t sampleEntry = sizeof(((T *) 0)->sampleBuffer[0]);
+  size_t varianceEntry = sizeof(((T *) 0)->varianceBuffer[0]);
+  size_t sampleBufferOffset = offsetof(T, sampleBuffer);
+  size_t varianceBufferOffset = offsetof(T, varianceBuffer);
+
+  size_t scalarsEnd = 0;
+  for (int fieldIndex = 0; fieldIndex < fieldsNumber; fieldIndex++) {
+    if (fields[fieldIndex].offset + fields[fieldIndex].size > scalarsEnd) {
+      scalarsEnd = fields[fieldIndex].offset + fields[fieldIndex].size;
+    }
+  }
+
+  // every pool element (the arena is line aligned at best), every ring position, full windows
+  long totalLines = 0;
+  long cases = 0;
+  int minLines = 1 << 30;
+  int maxLines = 0;
+  for (int element = 0; element < TRANSMITTERS_POOL_SIZE; element++) {
+    size_t base = element * sizeof(T);
+    for (int position = 0; position < MAX_SAMPLEBUFFERSIZE_MULTI; position++) {
+      std::set<size_t> lines;
+      for (int fieldIndex = 0; fieldIndex < fieldsNumber; fieldIndex++) {
+        addSpan(&lines, base + fields[fieldIndex].offset, fields[fieldIndex].size, lineBytes);
+      }
+      int varianceIndex = position % MAX_VARIANCEBUFFERSIZE_MULTI;
+      int evictedVariance = (varianceIndex - VARIANCE_INTEGRATOR_LIMIT + MAX_VARIANCEBUFFERSIZE_MULTI) % MAX_VARIANCEBUFFERSIZE_MULTI;
+      addSpan(&lines, base + sampleBufferOffset + position * sampleEntry, sampleEntry, lineBytes); // with a full size filter the evicted sample is this same entry
+      addSpan(&lines, base + varianceBufferOffset + varianceIndex * varianceEntry, varianceEntry, lineBytes);
+      addSpan(&lines, base + varianceBufferOffset + evictedVariance * varianceEntry, varianceEntry, lineBytes);
+      int linesNumber = (int) lines.size();
+      totalLines = totalLines + linesNumber;
+      cases++;
+      minLines = (linesNumber < minLines) ? linesNumber : minLines;
+      maxLines = (linesNumber > maxLines) ? linesNumber : maxLines;
+    }
+  }
+
+  printf("layout=%s bytes_per_link=%u per_sample_scalars_span=%u sample_ring=%u@%u variance_ring=%u@%u lines_per_sample mean=%.2f min=%d max=%d links_in_%d_bytes=%d\n",
+         layout, (unsigned) sizeof(T), (unsigned) scalarsEnd, (unsigned) (MAX_SAMPLEBUFFERSIZE_MULTI * sampleEntry), (unsigned) sampleBufferOffset,
+         (unsigned) (MAX_VARIANCEBUFFERSIZE_MULTI * varianceEntry), (unsigned) varianceBufferOffset, (double) totalLines / cases, minLines, maxLines, ramBudget,
+         (int) (ramBudget / sizeof(T)));
+}
+
+
+int main(int argc, char ** argv) {
+
+  int lineBytes = (argc > 1) ? atoi(argv[1]) : 64;
+  int ramBudget = (argc > 2) ? atoi(argv[2]) : 16384;
+  if ((lineBytes < 4) || (ramBudget < 1)) {
+    printf("usage: %s [cache line bytes=64] [RAM budget in bytes=16384]\n", argv[0]);
+    return 1;
+  }
+
+  // transmitterData, field by field
+  const fieldSpan compactFields[] = SAMPLE_FIELDS(transmitterData);
+  const fieldSpan otherFields[] = { FLAG(transmitterData, initComplete), FIELD(transmitterData, sampleBuffer), FIELD(transmitterData, varianceBuffer),
+                                    FIELD(transmitterData, alarmStatus) };
+  printf("transmitterData sizeof=%u budget=%d\n", (unsigned) sizeof(transmitterData), TRANSMITTER_DATA_BUDGET);
+  for (size_t fieldIndex = 0; fieldIndex < sizeof(compactFields) / sizeof(compactFields[0]); fieldIndex++) {
+    printf("  field=%s offset=%u size=%u per_sample=1\n", compactFields[fieldIndex].name, (unsigned) compactFields[fieldIndex].offset, (unsigned) compactFields[fieldIndex].size);
+  }
+  for (size_t fieldIndex = 0; fieldIndex < sizeof(otherFields) / sizeof(otherFields[0]); fieldIndex++) {
+    printf("  field=%s offset=%u size=%u per_sample=0\n", otherFields[fieldIndex].name, (unsigned) otherFields[fieldIndex].offset, (unsigned) otherFields[fieldIndex].size);
+  }
+
+  const fieldSpan legacyFields[] = SAMPLE_FIELDS(legacyTransmitterData);
+  sampleLines<legacyTransmitterData>("all_int", legacyFields, (int) (sizeof(legacyFields) / sizeof(legacyFields[0])), lineBytes, ramBudget);
+  sampleLines<transmitterData>("compact", compactFields, (int) (sizeof(compactFields) / sizeof(compactFields[0])), lineBytes, ramBudget);
+  printf("compact_vs_all_int bytes_ratio=%.2f\n", (double) sizeof(legacyTransmitterData) / sizeof(transmitterData));
+
+  // the batch structure-of-arrays: everything but the shared header scales with MAX_ALLOWED_TRANSMITTERS_NUMBER
+  size_t batchShared = offsetof(transmittersBatchData, sampleRing);
+  printf("transmittersBatchData sizeof=%u shared=%u bytes_per_link=%.1f rings_per_link=%u\n", (unsigned) sizeof(transmittersBatchData), (unsigned) batchShared,
+         (double) (sizeof(transmittersBatchData) - batchShared) / MAX_ALLOWED_TRANSMITTERS_NUMBER,
+         (unsigned) ((sizeof(((transmittersBatchData *) 0)->sampleRing) + sizeof(((transmittersBatchData *) 0)->varianceRing)) / MAX_ALLOWED_TRANSMITTERS_NUMBER));
+
+  // the whole radar
+  printf("radarShadows sizeof=%u\n", (unsigned) sizeof(radarShadows));
+  printf("multistaticData sizeof=%u cold_slot_metadata_offset=%u cold_slot_metadata_bytes=%u\n", (unsigned) sizeof(multistaticData), (unsigned) offsetof(multistaticData, BSSIDs),
+         (unsigned) (sizeof(((multistaticData *) 0)->BSSIDs) + sizeof(((multistaticData *) 0)->SSIDs)));
+  printf("radarContext sizeof=%u transmitters_arena=%u pool=%d\n", (unsigned) sizeof(radarContext), (unsigned) sizeof(((radarContext *) 0)->transmittersArena), TRANSMITTERS_POOL_SIZE);
+  return 0;
+}
@@ -0,0 +1,191 @@
+// Host decoder of the binary log frames written by the radar in RADAR_LOG_MODE_RING_BINARY (see the logging section of multistatic_interference_radar.h),
+// e.g. a serial capture of a live node: the frames are found by their sync bytes and checked with their checksum, anything else (boot messages,
+// line noise, a frame cut by the capture start) is skipped, and every event is printed with the text the node would have printed itself.
+// Two helper modes run the unmodified radar on the mock scan backend:
+// - capture: the binary log of a few hundred cycles on stdout, drained by the drain task, to try the decoder on,
+// - timing: the host time of a cycle with the messages off, printed right away (RADAR_LOG_MODE_SERIAL) and queued to the ring, stdout going to /dev/null.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o log_decode log_decode.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./log_decode <capture file, - for stdin> [csv=0]
+//   ./log_decode capture [cycles=200] [debug level=4] > capture.bin
+//   ./log_decode timing [cycles=2000] [debug level=4]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+#define CAPTURE_PAUSE_US 1000 // between two cycles of the capture mode, so that the drain task keeps up (a real cycle takes hundreds of ms)
+
+
+int decodeFrame(const uint8_t * bytes, size_t available, radarLogRecord * record) { // returns the frame length, 0 if there is no valid frame at bytes
+  if ((available < RADAR_LOG_FRAME_HEADER_LEN + 1) || (bytes[0] != RADAR_LOG_FRAME_SYNC0) || (bytes[1] != RADAR_LOG_FRAME_SYNC1)) {
+    return 0;
+  }
+  int argsNumber = bytes[5];
+  size_t length = RADAR_LOG_FRAME_HEADER_LEN + 4 * argsNumber + 1;
+  if ((argsNumber > RADAR_LOG_MAX_ARGS) || (length > available)) {
+    return 0;
+  }
+  uint8_t checksum = 0;
+  for (size_t byteIndex = 2; byteIndex < length - 1; byteIndex++) {
+    checksum = (uint8_t) (checksum + bytes[byteIndex]);
+  }
+  if (checksum != bytes[length - 1]) {
+    return 0;
+  }
+  record->eventId = (uint16_t) (bytes[2] | (bytes[3] << 8));
+  record->level = bytes[4];
+  record->argsNumber = (uint8_t) argsNumber;
+  record->timestampUs = (uint32_t) bytes[6] | ((uint32_t) bytes[7] << 8) | ((uint32_t) bytes[8] << 16) | ((uint32_t) bytes[9] << 24);
+  for (int argIndex = 0; argIndex < RADAR_LOG_MAX_ARGS; argIndex++) {
+    record->args[argIndex] = 0;
+  }
+  for (int argIndex = 0; argIndex < argsNumber; argIndex++) {
+    const uint8_t * arg = &bytes[RADAR_LOG_FRAME_HEADER_LEN + 4 * argIndex];
+    record->args[argIndex] = (int32_t) ((uint32_t) arg[0] | ((uint32_t) arg[1] << 8) | ((uint32_t) arg[2] << 16) | ((uint32_t) arg[3] << 24));
+  }
+  return (int) length;
+}
+
+
+int decode(const char * fileName, int csv) {
+  FILE * captureFile = (strcmp(fileName, "-") == 0) ? stdin : fopen(fileName, "rb");
+  if (captureFile == NULL) {
+    fprintf(stderr, "cannot read %s\n", fileName);
+    return 1;
+  }
+  std::vector<uint8_t> bytes;
+  uint8_t chunk[4096];
+  size_t chunkLength;
+  while ((chunkLength = fread(chunk, 1, sizeof(chunk), captureFile)) > 0) {
+    bytes.insert(bytes.end(), chunk, chunk + chunkLength);
+  }
+  if (captureFile != stdin) {
+    fclose(captureFile);
+  }
+
+  if (csv == 1) {
+    printf("timestamp_us,level,event,arg0,arg1,arg2,arg3,arg4,arg5\n");
+  }
+  long frames = 0;
+  long skippedBytes = 0;
+  long dropped = 0;
+  char text[256];
+  radarLogRecord record;
+  size_t position = 0;
+  while (position < bytes.size()) {
+    int length = decodeFrame(&bytes[position], bytes.size() - position, &record);
+    if (length == 0) {
+      position++;
+      skippedBytes++;
+      continue;
+    }
+    position = position + length;
+    frames++;
+    if (record.eventId == RADAR_EVENT_LOG_DROPPED) {
+      dropped = dropped + record.args[0];
+    }
+    if (csv == 1) {
+      printf("%u,%u,%u", record.timestampUs, (unsigned) record.level, (unsigned) record.eventId);
+      for (int argIndex = 0; argIndex < RADAR_LOG_MAX_ARGS; argIndex++) {
+        printf(",%d", record.args[argIndex]);
+      }
+      printf("\n");
+    } else {
+      multistatic_interference_radar_log_format(&record, text, sizeof(text));
+      printf("%10u %2u %s\n", record.timestampUs, (unsigned) record.level, text);
+    }
+  }
+  fprintf(stderr, "bytes=%lu frames=%ld skipped_bytes=%ld dropped_events=%ld\n", (unsigned long) bytes.size(), frames, skippedBytes, dropped);
+  return 0;
+}
+
+
+void setupRadar(radarContext * radar, mockScanEnvironment * env, int debugLevel) {
+  mock_scan_backend_reset(env, 7);
+  mockSyntheticAccessPoints row;
+  mock_scan_backend_add_synthetic_aps(env, &row);
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_set_scan_backend(radar, mock_scan_backend(env));
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(radar, 8);
+  multistatic_interference_radar_enable_targeted_scan(radar, 1);
+  multistatic_interference_radar_set_debug_level(radar, debugLevel);
+}
+
+
+double runCycles(radarContext * radar, mockScanEnvironment * env, int cycles, int pauseUs) { // host microseconds per cycle, pauses excluded
+  double pausedUs = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int cycle = 0; cycle < cycles; cycle++) {
+    multistatic_interference_radar(radar);
+    mock_scan_backend_advance(env, 100);
+    if (pauseUs > 0) {
+      std::chrono::steady_clock::time_point pauseStart = std::chrono::steady_clock::now();
+      std::this_thread::sleep_for(std::chrono::microseconds(pauseUs));
+      pausedUs = pausedUs + std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - pauseStart).count();
+    }
+  }
+  return (std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() - pausedUs) / cycles;
+}
+
+
+int main(int argc, char ** argv) {
+
+  if (argc < 2) {
+    printf("usage: %s <capture file, - for stdin> [csv=0] | capture [cycles=200] [debug level=4] | timing [cycles=2000] [debug level=4]\n", argv[0]);
+    return 1;
+  }
+
+  if ((strcmp(argv[1], "capture") != 0) && (strcmp(argv[1], "timing") != 0)) {
+    return decode(argv[1], (argc > 2) ? atoi(argv[2]) : 0);
+  }
+
+  int timing = (strcmp(argv[1], "timing") == 0) ? 1 : 0;
+  int cycles = (argc > 2) ? atoi(argv[2]) : (timing ? 2000 : 200);
+  int debugLevel = (argc > 3) ? atoi(argv[3]) : 4;
+  radarContext * radar = new radarContext;
+  mockScanEnvironment * env = new mockScanEnvironment;
+
+  if (timing == 0) {
+    setupRadar(radar, env, debugLevel);
+    multistatic_interference_radar_set_log_mode(radar, RADAR_LOG_MODE_RING_BINARY);
+    multistatic_interference_radar_start_log_task(radar, 5);
+    double cycleUs = runCycles(radar, env, cycles, CAPTURE_PAUSE_US);
+    multistatic_interference_radar_stop_log_task(radar);
+    fflush(stdout);
+    fprintf(stderr, "cycles=%d debug_level=%d us_per_cycle=%.1f dropped_events=%u\n", cycles, debugLevel, cycleUs, radar->debugLog.dropped.load());
+  } else {
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+      fprintf(stderr, "cannot redirect stdout\n");
+      return 1;
+    }
+    const char * modes[] = { "off", "serial", "ring_text", "ring_binary" };
+    for (int mode = 0; mode < 4; mode++) {
+      setupRadar(radar, env, (mode == 0) ? 0 : debugLevel);
+      multistatic_interference_radar_set_log_mode(radar, (mode == 0) ? RADAR_LOG_MODE_SERIAL : mode - 1);
+      if (mode >= 2) {
+        multistatic_interference_radar_start_log_task(radar, 5);
+      }
+      runCycles(radar, env, cycles / 4, 0); // fills the windows
+      uint32_t droppedBefore = radar->debugLog.dropped.load();
+      double cycleUs = runCycles(radar, env, cycles, 0); // flat out: the ring modes drop what the drain task cannot keep up with
+      multistatic_interference_radar_stop_log_task(radar);
+      fprintf(stderr, "log=%s debug_level=%d cycles=%d us_per_cycle=%.2f dropped_events=%u\n", modes[mode], (mode == 0) ? 0 : debugLevel, cycles, cycleUs,
+              radar->debugLog.dropped.load() - droppedBefore);
+    }
+  }
+
+  delete env;
+  delete radar;
+  return 0;
+}
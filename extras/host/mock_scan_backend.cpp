@@ -0,0 +1,245 @@
+// Mock scan backend, see mock_scan_backend.h
+
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+mockScanEnvironment mockDefaultEnvironment; // the environment of the functions without an environment parameter
+
+
+
+uint32_t mockRandom(mockScanEnvironment * env) { // xorshift32, deterministic for a given seed
+  env->randomState ^= env->randomState << 13;
+  env->randomState ^= env->randomState >> 17;
+  env->randomState ^= env->randomState << 5;
+  return env->randomState;
+}
+
+
+double mockRandomUnit(mockScanEnvironment * env) { // [0, 1)
+  return (mockRandom(env) >> 8) * (1.0 / 16777216.0);
+}
+
+
+unsigned long mockScanDuration(mockScanEnvironment * env, int channel, int dwellMs) { // timing model
+  if (channel == 0) {
+    return env->timing.scanOverheadMs + env->timing.channelsNumber * (env->timing.channelSwitchMs + dwellMs) + env->timing.resultsLatencyMs;
+  }
+  return env->timing.scanOverheadMs + env->timing.channelSwitchMs + dwellMs + env->timing.resultsLatencyMs;
+}
+
+
+int mockDrawResults(mockScanEnvironment * env, int channel) { // the access points heard by a scan of the channel, as they are right now
+  if (env->beforeScan != NULL) {
+    env->beforeScan(env, env->beforeScanData);
+  }
+  env->resultsNumber = 0;
+  for (int apIndex = 0; apIndex < env->accessPointsNumber; apIndex++) {
+    mockAccessPoint * ap = &env->accessPointsList[apIndex];
+    if ((ap->present == 0) || ((channel != 0) && (ap->channel != channel)) || ((channel == 0) && (ap->channel > env->timing.channelsNumber))) {
+      continue;
+    }
+    if (mockRandomUnit(env) < env->timing.missProbability) {
+      continue;
+    }
+    int noise = 0;
+    if (ap->noise > 0) {
+      noise = (int)(mockRandom(env) % (uint32_t)(2 * ap->noise + 1)) - ap->noise;
+    }
+    env->results[env->resultsNumber] = apIndex;
+    env->resultsRSSI[env->resultsNumber] = ap->RSSI + noise;
+    env->resultsNumber++;
+  }
+
+  return env->resultsNumber;
+}
+
+
+int mockStartScan(void * backendData, int channel, int dwellMs) {
+  mockScanEnvironment * env = (mockScanEnvironment *) backendData;
+  if (env->asyncRunning == 1) {
+    return RADAR_SCAN_FAILED; // the radio is busy
+  }
+  mockDrawResults(env, channel);
+  env->clockMs = env->clockMs + mockScanDuration(env, channel, dwellMs);
+  return env->resultsNumber;
+}
+
+
+int mockStartScanAsync(void * backendData, int channel, int dwellMs) {
+  mockScanEnvironment * env = (mockScanEnvironment *) backendData;
+  if (env->asyncRunning == 1) {
+    return RADAR_SCAN_FAILED;
+  }
+  mockDrawResults(env, channel); // RSSI sampled when the scan starts, like the blocking scan does
+  env->asyncCompleteMs = env->clockMs + mockScanDuration(env, channel, dwellMs);
+  env->asyncRunning = 1;
+  return 0;
+}
+
+
+int mockScanStatus(void * backendData) {
+  mockScanEnvironment * env = (mockScanEnvironment *) backendData;
+  if (env->asyncRunning == 0) {
+    return RADAR_SCAN_FAILED; // nothing started
+  }
+  if (env->clockMs < env->asyncCompleteMs) {
+    return RADAR_SCAN_RUNNING;
+  }
+  env->asyncRunning = 0;
+  return env->resultsNumber;
+}
+
+
+int mockReadResult(void * backendData, int index, scanSnapshotEntry * entry, char * SSID) {
+  mockScanEnvironment * env = (mockScanEnvironment *) backendData;
+  if ((index < 0) || (index >= env->resultsNumber)) {
+    return -1;
+  }
+  mockAccessPoint * ap = &env->accessPointsList[env->results[index]];
+  memcpy(entry->BSSID, ap->BSSID, 6);
+  entry->RSSI = (int8_t) env->resultsRSSI[index];
+  entry->channel = (uint8_t) ap->channel;
+  strncpy(SSID, ap->SSID, SSID_STORAGE_LEN - 1);
+  SSID[SSID_STORAGE_LEN - 1] = 0;
+  return 0;
+}
+
+
+void mockReleaseResults(void * backendData) {
+  ((mockScanEnvironment *) backendData)->resultsNumber = 0;
+}
+
+
+unsigned long mockMillis(void * backendData) {
+  return ((mockScanEnvironment *) backendData)->clockMs;
+}
+
+
+
+const radarScanBackend * mock_scan_backend(mockScanEnvironment * env) {
+  env->backend = { mockStartScan, mockReadResult, mockReleaseResults, mockMillis, mockStartScanAsync, mockScanStatus, env };
+  return &env->backend;
+}
+
+
+int mock_scan_backend_add_ap(mockScanEnvironment * env, const mockAccessPoint * ap) {
+  if (env->accessPointsNumber >= MOCK_MAX_ACCESS_POINTS) {
+    return -1;
+  }
+  env->accessPointsList[env->accessPointsNumber] = *ap;
+  env->accessPointsNumber++;
+  return env->accessPointsNumber - 1;
+}
+
+
+int mock_scan_backend_add_synthetic_aps(mockScanEnvironment * env, const mockSyntheticAccessPoints * row) {
+  int added = 0;
+  for (int apIndex = 0; apIndex < row->accessPointsNumber; apIndex++) {
+    mockAccessPoint ap;
+    ap.BSSID[0] = 0x02; // locally administered
+    ap.BSSID[4] = (uint8_t) (row->BSSIDtag + (apIndex >> 8));
+    ap.BSSID[5] = (uint8_t) (apIndex & 0xff);
+    if (row->SSIDprefix != NULL) {
+      snprintf(ap.SSID, sizeof(ap.SSID), "%s%d", row->SSIDprefix, (row->SSIDvariety > 0) ? apIndex % row->SSIDvariety : apIndex);
+    }
+    ap.channel = 1 + (apIndex * 5 + row->channelOffset) % 13;
+    ap.RSSI = row->strongestRSSI - (apIndex * row->RSSIstep + row->RSSIoffset) % row->RSSIspread;
+    ap.noise = row->noise;
+    if (mock_scan_backend_add_ap(env, &ap) < 0) {
+      break;
+    }
+    added++;
+  }
+  return added;
+}
+
+
+mockAccessPoint * mock_scan_backend_ap(mockScanEnvironment * env, int apIndex) {
+  if ((apIndex < 0) || (apIndex >= env->accessPointsNumber)) {
+    return NULL;
+  }
+  return &env->accessPointsList[apIndex];
+}
+
+
+int mock_scan_backend_ap_number(mockScanEnvironment * env) {
+  return env->accessPointsNumber;
+}
+
+
+mockScanTiming * mock_scan_backend_timing(mockScanEnvironment * env) {
+  return &env->timing;
+}
+
+
+void mock_scan_backend_reset(mockScanEnvironment * env, unsigned int seed) {
+  env->accessPointsNumber = 0;
+  env->resultsNumber = 0;
+  env->asyncRunning = 0;
+  env->clockMs = 0;
+  env->randomState = (seed == 0) ? 1 : seed;
+  env->timing = mockScanTiming();
+  env->beforeScan = NULL;
+  env->beforeScanData = NULL;
+}
+
+
+unsigned long mock_scan_backend_clock(mockScanEnvironment * env) {
+  return env->clockMs;
+}
+
+
+void mock_scan_backend_advance(mockScanEnvironment * env, unsigned long elapsedMs) {
+  env->clockMs = env->clockMs + elapsedMs;
+}
+
+
+
+// the default environment
+
+const radarScanBackend * mock_scan_backend() {
+  return mock_scan_backend(&mockDefaultEnvironment);
+}
+
+
+int mock_scan_backend_add_ap(const mockAccessPoint * ap) {
+  return mock_scan_backend_add_ap(&mockDefaultEnvironment, ap);
+}
+
+
+int mock_scan_backend_add_synthetic_aps(const mockSyntheticAccessPoints * row) {
+  return mock_scan_backend_add_synthetic_aps(&mockDefaultEnvironment, row);
+}
+
+
+mockAccessPoint * mock_scan_backend_ap(int apIndex) {
+  return mock_scan_backend_ap(&mockDefaultEnvironment, apIndex);
+}
+
+
+int mock_scan_backend_ap_number() {
+  return mock_scan_backend_ap_number(&mockDefaultEnvironment);
+}
+
+
+mockScanTiming * mock_scan_backend_timing() {
+  return mock_scan_backend_timing(&mockDefaultEnvironment);
+}
+
+
+void mock_scan_backend_reset(unsigned int seed) {
+  mock_scan_backend_reset(&mockDefaultEnvironment, seed);
+}
+
+
+unsigned long mock_scan_backend_clock() {
+  return mock_scan_backend_clock(&mockDefaultEnvironment);
+}
+
+
+void mock_scan_backend_advance(unsigned long elapsedMs) {
+  mock_scan_backend_advance(&mockDefaultEnvironment, elapsedMs);
+}
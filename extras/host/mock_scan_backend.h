@@ -0,0 +1,175 @@
+// Mock scan backend for host (Linux) builds of the multistatic interference radar library.
+
+// It simulates a set of access points and the radio time a scan takes, on a simulated clock:
+// - a full sweep costs scanOverheadMs + channelsNumber * (channelSwitchMs + dwell),
+// - a single channel scan costs scanOverheadMs + channelSwitchMs + dwell,
+// - each access point on a scanned channel is reported with probability (1 - missProbability), with its RSSI plus a uniform noise,
+// - the results are delivered resultsLatencyMs after the radio work is over (driver and event delivery delays).
+// The library reads the time through the backend, so a whole day of radar cycles runs in a fraction of a second.
+// The asynchronous hooks do not move the clock: the scan completes once the application has let enough simulated time pass (mock_scan_backend_advance()).
+
+#ifndef MOCK_SCAN_BACKEND_H
+#define MOCK_SCAN_BACKEND_H
+
+#include "../../multistatic_interference_radar.h"
+
+
+#define MOCK_MAX_ACCESS_POINTS ABSOLUTE_MAX_SCAN_RESULTS
+
+
+typedef struct  mockAccessPointStruct {
+
+uint8_t BSSID[6] = {0};
+
+char SSID[SSID_STORAGE_LEN] = {0};
+
+int channel = 1;
+
+int RSSI = -60; // mean RSSI, in dBm
+
+int noise = 2; // uniform noise amplitude, in dB
+
+int present = 1; // 0 = switched off, not reported by any scan
+
+} mockAccessPoint;
+
+
+typedef struct  mockScanTimingStruct {
+
+int channelsNumber = 13; // channels swept by a full scan
+
+unsigned long scanOverheadMs = 30; // fixed cost of every scan request
+
+unsigned long channelSwitchMs = 5; // per channel retuning cost
+
+double missProbability = 0.0; // probability for an access point to be missed by a scan of its channel
+
+unsigned long resultsLatencyMs = 0; // extra delay before the results are available, added to every scan
+
+} mockScanTiming;
+
+
+// a row of synthetic access points, the fixture of most host tools: access point i gets
+// - BSSID 02:00:00:00:(BSSIDtag + i / 256):(i % 256), locally administered,
+// - SSID SSIDprefix followed by i (by i % SSIDvariety if SSIDvariety > 0), empty if SSIDprefix is NULL,
+// - channel 1 + (5 * i + channelOffset) % 13: crowded 1 / 6 / 11 plus the others,
+// - RSSI strongestRSSI - (RSSIstep * i + RSSIoffset) % RSSIspread, the lower the index, the stronger.
+
+typedef struct  mockSyntheticAccessPointsStruct {
+
+int accessPointsNumber = 24;
+
+uint8_t BSSIDtag = 0; // e.g. a node or room number, to give every environment its own BSSIDs
+
+const char * SSIDprefix = "ap";
+
+int SSIDvariety = 0; // > 0: only that many different SSIDs, like a building sharing a few network names
+
+int channelOffset = 0;
+
+int strongestRSSI = -40;
+
+int RSSIstep = 3;
+
+int RSSIoffset = 0;
+
+int RSSIspread = 40;
+
+int noise = 3;
+
+} mockSyntheticAccessPoints;
+
+
+// one simulated environment: access points, timing model, clock and the radio state. Environments share nothing, one per radar context
+// lets many simulated nodes run in parallel threads. The functions without an environment parameter work on a default one.
+
+typedef struct  mockScanEnvironmentStruct {
+
+mockAccessPoint accessPointsList[MOCK_MAX_ACCESS_POINTS];
+
+int accessPointsNumber = 0;
+
+mockScanTiming timing;
+
+unsigned long clockMs = 0;
+
+uint32_t randomState = 1;
+
+// latest scan results, as indexes into accessPointsList plus the RSSI drawn for this scan
+int results[MOCK_MAX_ACCESS_POINTS];
+
+int resultsRSSI[MOCK_MAX_ACCESS_POINTS];
+
+int resultsNumber = 0;
+
+int asyncRunning = 0; // 1 while an asynchronous scan is in progress
+
+unsigned long asyncCompleteMs = 0; // simulated time the asynchronous scan results become available
+
+radarScanBackend backend; // the mock hooks, bound to this environment by mock_scan_backend()
+
+void (*beforeScan)(struct mockScanEnvironmentStruct * env, void * hookData) = NULL; // optional, called by every scan right before it draws its results, at the simulated time of the scan: lets a script move the access points at the exact scan times (see mock_scenario.h), cleared by mock_scan_backend_reset()
+
+void * beforeScanData = NULL;
+
+} mockScanEnvironment;
+
+
+// current status: IMPLEMENTED
+const radarScanBackend * mock_scan_backend(); // the backend to hand to multistatic_interference_radar_set_scan_backend()
+
+// current status: IMPLEMENTED
+int mock_scan_backend_add_ap(const mockAccessPoint *); // returns the access point index, -1 if full
+
+// current status: IMPLEMENTED
+int mock_scan_backend_add_synthetic_aps(const mockSyntheticAccessPoints *); // adds the row, returns how many were added (fewer if full)
+
+// current status: IMPLEMENTED
+mockAccessPoint * mock_scan_backend_ap(int); // direct access to the simulated access points, to script changes between cycles
+
+// current status: IMPLEMENTED
+int mock_scan_backend_ap_number();
+
+// current status: IMPLEMENTED
+mockScanTiming * mock_scan_backend_timing(); // the timing model, change it before scanning
+
+// current status: IMPLEMENTED
+void mock_scan_backend_reset(unsigned int seed); // removes every access point, zeroes the clock and reseeds the noise generator
+
+// current status: IMPLEMENTED
+unsigned long mock_scan_backend_clock(); // simulated time, in milliseconds
+
+// current status: IMPLEMENTED
+void mock_scan_backend_advance(unsigned long); // lets simulated time pass, e.g. the delay() between two cycles
+
+
+// the same functions on an explicit environment
+
+// current status: IMPLEMENTED
+const radarScanBackend * mock_scan_backend(mockScanEnvironment *);
+
+// current status: IMPLEMENTED
+int mock_scan_backend_add_ap(mockScanEnvironment *, const mockAccessPoint *);
+
+// current status: IMPLEMENTED
+int mock_scan_backend_add_synthetic_aps(mockScanEnvironment *, const mockSyntheticAccessPoints *);
+
+// current status: IMPLEMENTED
+mockAccessPoint * mock_scan_backend_ap(mockScanEnvironment *, int);
+
+// current status: IMPLEMENTED
+int mock_scan_backend_ap_number(mockScanEnvironment *);
+
+// current status: IMPLEMENTED
+mockScanTiming * mock_scan_backend_timing(mockScanEnvironment *);
+
+// current status: IMPLEMENTED
+void mock_scan_backend_reset(mockScanEnvironment *, unsigned int seed);
+
+// current status: IMPLEMENTED
+unsigned long mock_scan_backend_clock(mockScanEnvironment *);
+
+// current status: IMPLEMENTED
+void mock_scan_backend_advance(mockScanEnvironment *, unsigned long);
+
+#endif
@@ -0,0 +1,567 @@
+// Scenario files for the mock scan backend, see mock_scenario.h
+
+#include "mock_scenario.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+
+#define SCENARIO_MAX_TOKENS 32
+
+const char * timingKeys[] = {"channels", "overhead_ms", "switch_ms", "miss", "latency_ms"}; // the bit order of mockScenarioEvent.timingMask
+
+#define TIMING_KEYS_NUMBER 5
+
+
+typedef struct  scenarioEveryStruct { // an every statement, expanded once the duration is known
+
+mockScenarioEvent event;
+
+unsigned long periodMs = 0;
+
+unsigned long fromMs = 0;
+
+unsigned long untilMs = 0;
+
+int untilSet = 0;
+
+} scenarioEvery;
+
+
+int splitTokens(char * line, char ** tokens) { // in place, returns the number of tokens; a '#' starts a comment
+  char * comment = strchr(line, '#');
+  if (comment != NULL) {
+    *comment = 0;
+  }
+  int tokensNumber = 0;
+  char * cursor = line;
+  while ((*cursor != 0) && (tokensNumber < SCENARIO_MAX_TOKENS)) {
+    while ((*cursor == ' ') || (*cursor == '\t') || (*cursor == '\r') || (*cursor == '\n')) {
+      cursor++;
+    }
+    if (*cursor == 0) {
+      break;
+    }
+    tokens[tokensNumber] = cursor;
+    tokensNumber++;
+    while ((*cursor != 0) && (*cursor != ' ') && (*cursor != '\t') && (*cursor != '\r') && (*cursor != '\n')) {
+      cursor++;
+    }
+    if (*cursor != 0) {
+      *cursor = 0;
+      cursor++;
+    }
+  }
+  return tokensNumber;
+}
+
+
+int parseTime(const char * text, unsigned long * timeMs) { // "<number>[ms|s|m|h|d]..." (e.g. 90, 1h30m, 250ms), seconds by default; returns 0, -1 if malformed
+  double totalMs = 0;
+  const char * cursor = text;
+  do {
+    char * unit = NULL;
+    double value = strtod(cursor, &unit);
+    if ((unit == cursor) || (value < 0)) {
+      return -1;
+    }
+    double scale = 1000.0;
+    cursor = unit;
+    if (strncmp(unit, "ms", 2) == 0) {
+      scale = 1.0;
+      cursor = unit + 2;
+    } else if ((*unit == 's') || (*unit == 'm') || (*unit == 'h') || (*unit == 'd')) {
+      scale = (*unit == 's') ? 1000.0 : ((*unit == 'm') ? 60000.0 : ((*unit == 'h') ? 3600000.0 : 86400000.0));
+      cursor = unit + 1;
+    } else if (*unit != 0) {
+      return -1;
+    }
+    totalMs = totalMs + value * scale;
+  } while (*cursor != 0);
+  *timeMs = (unsigned long) (totalMs + 0.5);
+  return 0;
+}
+
+
+int parseInt(const char * text, int * value) {
+  char * end = NULL;
+  long parsed = strtol(text, &end, 10);
+  if ((end == text) || (*end != 0)) {
+    return -1;
+  }
+  *value = (int) parsed;
+  return 0;
+}
+
+
+int parseTiming(char ** tokens, int tokensNumber, mockScanTiming * timing, int * mask) { // key=value tokens; returns 0, -1 if malformed
+  for (int tokenIndex = 0; tokenIndex < tokensNumber; tokenIndex++) {
+    char * equal = strchr(tokens[tokenIndex], '=');
+    if (equal == NULL) {
+      return -1;
+    }
+    *equal = 0;
+    const char * value = equal + 1;
+    int keyIndex = 0;
+    while ((keyIndex < TIMING_KEYS_NUMBER) && (strcmp(tokens[tokenIndex], timingKeys[keyIndex]) != 0)) {
+      keyIndex++;
+    }
+    switch (keyIndex) {
+      case 0:
+        timing->channelsNumber = atoi(value);
+        break;
+      case 1:
+        timing->scanOverheadMs = strtoul(value, NULL, 10);
+        break;
+      case 2:
+        timing->channelSwitchMs = strtoul(value, NULL, 10);
+        break;
+      case 3:
+        timing->missProbability = atof(value);
+        break;
+      case 4:
+        timing->resultsLatencyMs = strtoul(value, NULL, 10);
+        break;
+      default:
+        return -1;
+    }
+    *mask = *mask | (1 << keyIndex);
+  }
+  return 0;
+}
+
+
+void applyTiming(mockScanTiming * target, const mockScanTiming * source, int mask) {
+  if (mask & 1) {
+    target->channelsNumber = source->channelsNumber;
+  }
+  if (mask & 2) {
+    target->scanOverheadMs = source->scanOverheadMs;
+  }
+  if (mask & 4) {
+    target->channelSwitchMs = source->channelSwitchMs;
+  }
+  if (mask & 8) {
+    target->missProbability = source->missProbability;
+  }
+  if (mask & 16) {
+    target->resultsLatencyMs = source->resultsLatencyMs;
+  }
+}
+
+
+int mock_scenario_find_ap(const mockScenario * scenario, const char * name) {
+  for (int apIndex = 0; apIndex < MOCK_MAX_ACCESS_POINTS; apIndex++) {
+    if ((scenario->apNames[apIndex][0] != 0) && (strcmp(scenario->apNames[apIndex], name) == 0)) {
+      return apIndex;
+    }
+  }
+  return -1;
+}
+
+
+int parseApName(mockScenario * scenario, const char * name, int * apIndex) { // '*' = every access point
+  if (strcmp(name, "*") == 0) {
+    *apIndex = -1;
+    return 0;
+  }
+  *apIndex = mock_scenario_find_ap(scenario, name);
+  return (*apIndex >= 0) ? 0 : -1;
+}
+
+
+const char * parseAction(mockScenario * scenario, char ** tokens, int tokensNumber, mockScenarioEvent * event) { // returns NULL, or what is wrong
+  if (tokensNumber < 1) {
+    return "missing action";
+  }
+  const char * action = tokens[0];
+  if (strcmp(action, "mark") == 0) {
+    if (tokensNumber != 2) {
+      return "mark <label>";
+    }
+    event->type = MOCK_EVENT_MARK;
+    strncpy(event->label, tokens[1], MOCK_SCENARIO_NAME_LEN - 1);
+    return NULL;
+  }
+  if (strcmp(action, "timing") == 0) {
+    event->type = MOCK_EVENT_TIMING;
+    if ((tokensNumber < 2) || (parseTiming(&tokens[1], tokensNumber - 1, &event->timing, &event->timingMask) != 0)) {
+      return "timing <key>=<value> ...";
+    }
+    return NULL;
+  }
+  if (tokensNumber < 2) {
+    return "missing access point name";
+  }
+  if (parseApName(scenario, tokens[1], &event->apIndex) != 0) {
+    return "unknown access point";
+  }
+  if ((strcmp(action, "off") == 0) || (strcmp(action, "on") == 0)) {
+    event->type = (strcmp(action, "off") == 0) ? MOCK_EVENT_OFF : MOCK_EVENT_ON;
+    return (tokensNumber == 2) ? NULL : "off|on <name>";
+  }
+  if ((strcmp(action, "rssi") == 0) || (strcmp(action, "channel") == 0)) {
+    event->type = (strcmp(action, "rssi") == 0) ? MOCK_EVENT_RSSI : MOCK_EVENT_CHANNEL;
+    if ((tokensNumber != 3) || (parseInt(tokens[2], &event->value) != 0)) {
+      return "rssi|channel <name> <value>";
+    }
+    if ((event->type == MOCK_EVENT_CHANNEL) && ((event->value < 1) || (event->value > WIFI_CHANNELS_NUMBER))) {
+      return "channel out of range";
+    }
+    return NULL;
+  }
+  if (strcmp(action, "ramp") == 0) {
+    event->type = MOCK_EVENT_RAMP;
+    if ((tokensNumber != 4) || (parseInt(tokens[2], &event->value) != 0) || (parseTime(tokens[3], &event->durationMs) != 0)) {
+      return "ramp <name> <dBm> <time>";
+    }
+    return NULL;
+  }
+  if (strcmp(action, "noise") == 0) {
+    event->type = MOCK_EVENT_NOISE;
+    if ((tokensNumber < 3) || (tokensNumber > 4) || (parseInt(tokens[2], &event->value) != 0) || (event->value < 0)
+        || ((tokensNumber == 4) && (parseTime(tokens[3], &event->durationMs) != 0))) {
+      return "noise <name> <dB> [<time>]";
+    }
+    return NULL;
+  }
+  return "unknown action";
+}
+
+
+void addEvent(mockScenario * scenario, const mockScenarioEvent * event) { // a temporary noise also schedules its own end
+  scenario->events.push_back(*event);
+  if ((event->type == MOCK_EVENT_NOISE) && (event->durationMs > 0)) {
+    mockScenarioEvent noiseEnd = *event;
+    noiseEnd.type = MOCK_EVENT_NOISE_END;
+    noiseEnd.timeMs = event->timeMs + event->durationMs;
+    scenario->events.push_back(noiseEnd);
+  }
+}
+
+
+const char * loadTrace(mockScenario * scenario, int apIndex, const char * fileName, int * traceLine) { // returns NULL, or what is wrong
+  FILE * traceFile = fopen(fileName, "r");
+  if (traceFile == NULL) {
+    return "cannot open the trace file";
+  }
+  char line[MOCK_SCENARIO_LINE_LEN];
+  char * tokens[SCENARIO_MAX_TOKENS];
+  *traceLine = 0;
+  while (fgets(line, sizeof(line), traceFile) != NULL) {
+    (*traceLine)++;
+    int tokensNumber = splitTokens(line, tokens);
+    if (tokensNumber == 0) {
+      continue;
+    }
+    mockScenarioEvent event;
+    event.type = MOCK_EVENT_RSSI;
+    event.apIndex = apIndex;
+    if ((tokensNumber != 2) || (parseTime(tokens[0], &event.timeMs) != 0) || (parseInt(tokens[1], &event.value) != 0)) {
+      fclose(traceFile);
+      return "trace lines are <time> <dBm>";
+    }
+    addEvent(scenario, &event);
+  }
+  fclose(traceFile);
+  *traceLine = 0;
+  return NULL;
+}
+
+
+const char * parseAccessPoint(char ** tokens, int tokensNumber, mockAccessPoint * ap) { // the key=value tokens of an ap statement; returns NULL, or what is wrong
+  for (int tokenIndex = 0; tokenIndex < tokensNumber; tokenIndex++) {
+    char * equal = strchr(tokens[tokenIndex], '=');
+    if (equal == NULL) {
+      return "ap <name> <key>=<value> ...";
+    }
+    *equal = 0;
+    const char * value = equal + 1;
+    if (strcmp(tokens[tokenIndex], "bssid") == 0) {
+      unsigned int bytes[6];
+      if (sscanf(value, "%x:%x:%x:%x:%x:%x", &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5]) != 6) {
+        return "bssid=xx:xx:xx:xx:xx:xx";
+      }
+      for (int byteIndex = 0; byteIndex < 6; byteIndex++) {
+        ap->BSSID[byteIndex] = (uint8_t) bytes[byteIndex];
+      }
+    } else if (strcmp(tokens[tokenIndex], "ssid") == 0) {
+      strncpy(ap->SSID, value, 32);
+      ap->SSID[32] = 0;
+    } else if ((strcmp(tokens[tokenIndex], "channel") == 0) && (parseInt(value, &ap->channel) == 0)) {
+      if ((ap->channel < 1) || (ap->channel > WIFI_CHANNELS_NUMBER)) {
+        return "channel out of range";
+      }
+    } else if ((strcmp(tokens[tokenIndex], "rssi") == 0) && (parseInt(value, &ap->RSSI) == 0)) {
+    } else if ((strcmp(tokens[tokenIndex], "noise") == 0) && (parseInt(value, &ap->noise) == 0)) {
+    } else if ((strcmp(tokens[tokenIndex], "present") == 0) && (parseInt(value, &ap->present) == 0)) {
+    } else {
+      return "unknown or malformed access point key";
+    }
+  }
+  return NULL;
+}
+
+
+void scenarioBeforeScan(mockScanEnvironment * /* env */, void * hookData) {
+  mock_scenario_update((mockScenario *) hookData);
+}
+
+
+int mock_scenario_parse(mockScenario * scenario, mockScanEnvironment * env, const char * text, const char * directory) {
+
+  *scenario = mockScenario();
+  scenario->env = env;
+
+  std::vector<mockAccessPoint> accessPoints;
+  std::vector<scenarioEvery> everyStatements;
+  mockScanTiming timing;
+  int timingMask = 0;
+
+  char line[MOCK_SCENARIO_LINE_LEN];
+  char * tokens[SCENARIO_MAX_TOKENS];
+  int lineNumber = 0;
+  const char * cursor = text;
+  const char * problem = NULL;
+
+  while ((*cursor != 0) && (problem == NULL)) {
+    const char * lineEnd = strchr(cursor, '\n');
+    size_t lineLength = (lineEnd == NULL) ? strlen(cursor) : (size_t) (lineEnd - cursor);
+    lineNumber++;
+    if (lineLength >= sizeof(line)) {
+      problem = "line too long";
+      break;
+    }
+    memcpy(line, cursor, lineLength);
+    line[lineLength] = 0;
+    cursor = (lineEnd == NULL) ? cursor + lineLength : lineEnd + 1;
+
+    int tokensNumber = splitTokens(line, tokens);
+    if (tokensNumber == 0) {
+      continue;
+    }
+    const char * statement = tokens[0];
+
+    if (strcmp(statement, "duration") == 0) {
+      if ((tokensNumber != 2) || (parseTime(tokens[1], &scenario->durationMs) != 0)) {
+        problem = "duration <time>";
+      }
+    } else if (strcmp(statement, "seed") == 0) {
+      int seed = 0;
+      if ((tokensNumber != 2) || (parseInt(tokens[1], &seed) != 0)) {
+        problem = "seed <n>";
+      }
+      scenario->seed = (unsigned int) seed;
+    } else if (strcmp(statement, "loop_delay") == 0) {
+      if ((tokensNumber != 2) || (parseTime(tokens[1], &scenario->loopDelayMs) != 0)) {
+        problem = "loop_delay <time>";
+      }
+    } else if (strcmp(statement, "timing") == 0) {
+      if ((tokensNumber < 2) || (parseTiming(&tokens[1], tokensNumber - 1, &timing, &timingMask) != 0)) {
+        problem = "timing <key>=<value> ...";
+      }
+    } else if (strcmp(statement, "ap") == 0) {
+      int apIndex = (int) accessPoints.size();
+      if (tokensNumber < 2) {
+        problem = "ap <name> <key>=<value> ...";
+      } else if (apIndex >= MOCK_MAX_ACCESS_POINTS) {
+        problem = "too many access points";
+      } else if ((mock_scenario_find_ap(scenario, tokens[1]) >= 0) || (strcmp(tokens[1], "*") == 0) || (strlen(tokens[1]) >= MOCK_SCENARIO_NAME_LEN)) {
+        problem = "access point name already used or invalid";
+      } else {
+        mockAccessPoint ap;
+        ap.BSSID[0] = 0x02; // locally administered
+        ap.BSSID[5] = (uint8_t) (apIndex + 1);
+        strncpy(ap.SSID, tokens[1], 32);
+        problem = parseAccessPoint(&tokens[2], tokensNumber - 2, &ap);
+        strcpy(scenario->apNames[apIndex], tokens[1]);
+        scenario->baseNoise[apIndex] = ap.noise;
+        accessPoints.push_back(ap);
+      }
+    } else if (strcmp(statement, "at") == 0) {
+      mockScenarioEvent event;
+      if ((tokensNumber < 3) || (parseTime(tokens[1], &event.timeMs) != 0)) {
+        problem = "at <time> <action>";
+      } else {
+        problem = parseAction(scenario, &tokens[2], tokensNumber - 2, &event);
+        if (problem == NULL) {
+          addEvent(scenario, &event);
+        }
+      }
+    } else if (strcmp(statement, "every") == 0) {
+      scenarioEvery every;
+      int tokenIndex = 2;
+      if ((tokensNumber < 3) || (parseTime(tokens[1], &every.periodMs) != 0) || (every.periodMs == 0)) {
+        problem = "every <period> [from <time>] [until <time>] <action>";
+      } else {
+        every.fromMs = every.periodMs;
+        while ((problem == NULL) && (tokenIndex + 1 < tokensNumber) && ((strcmp(tokens[tokenIndex], "from") == 0) || (strcmp(tokens[tokenIndex], "until") == 0))) {
+          if (strcmp(tokens[tokenIndex], "from") == 0) {
+            problem = (parseTime(tokens[tokenIndex + 1], &every.fromMs) == 0) ? NULL : "every: malformed from time";
+          } else {
+            problem = (parseTime(tokens[tokenIndex + 1], &every.untilMs) == 0) ? NULL : "every: malformed until time";
+            every.untilSet = 1;
+          }
+          tokenIndex = tokenIndex + 2;
+        }
+        if (problem == NULL) {
+          problem = parseAction(scenario, &tokens[tokenIndex], tokensNumber - tokenIndex, &every.event);
+        }
+        if (problem == NULL) {
+          everyStatements.push_back(every);
+        }
+      }
+    } else if (strcmp(statement, "trace") == 0) {
+      int apIndex = -1;
+      if ((tokensNumber != 3) || (parseApName(scenario, tokens[1], &apIndex) != 0) || (apIndex < 0)) {
+        problem = "trace <name> <file>";
+      } else {
+        std::string traceName = tokens[2];
+        if ((directory != NULL) && (directory[0] != 0) && (tokens[2][0] != '/')) {
+          traceName = std::string(directory) + "/" + traceName;
+        }
+        int traceLine = 0;
+        problem = loadTrace(scenario, apIndex, traceName.c_str(), &traceLine);
+        if ((problem != NULL) && (traceLine > 0)) {
+          snprintf(scenario->error, sizeof(scenario->error), "line %d: %s line %d: %s", lineNumber, traceName.c_str(), traceLine, problem);
+          return -1;
+        }
+      }
+    } else {
+      problem = "unknown statement";
+    }
+  }
+
+  if (problem != NULL) {
+    snprintf(scenario->error, sizeof(scenario->error), "line %d: %s", lineNumber, problem);
+    return -1;
+  }
+
+  // the periodic events, now that the duration is known
+  for (unsigned int everyIndex = 0; everyIndex < everyStatements.size(); everyIndex++) {
+    scenarioEvery * every = &everyStatements[everyIndex];
+    unsigned long untilMs = (every->untilSet == 1) ? every->untilMs : scenario->durationMs;
+    for (unsigned long timeMs = every->fromMs; timeMs <= untilMs; timeMs = timeMs + every->periodMs) {
+      every->event.timeMs = timeMs;
+      addEvent(scenario, &every->event);
+    }
+  }
+  std::stable_sort(scenario->events.begin(), scenario->events.end(), [](const mockScenarioEvent & first, const mockScenarioEvent & second) {
+    return first.timeMs < second.timeMs;
+  });
+
+  // everything is fine: build the environment
+  mock_scan_backend_reset(env, scenario->seed);
+  applyTiming(&env->timing, &timing, timingMask);
+  for (unsigned int apIndex = 0; apIndex < accessPoints.size(); apIndex++) {
+    mock_scan_backend_add_ap(env, &accessPoints[apIndex]);
+  }
+  env->beforeScan = scenarioBeforeScan;
+  env->beforeScanData = scenario;
+  mock_scenario_update(scenario); // the events at time 0
+  return 0;
+}
+
+
+int mock_scenario_load(mockScenario * scenario, mockScanEnvironment * env, const char * fileName) {
+  FILE * scenarioFile = fopen(fileName, "r");
+  if (scenarioFile == NULL) {
+    *scenario = mockScenario();
+    snprintf(scenario->error, sizeof(scenario->error), "cannot open %s", fileName);
+    return -1;
+  }
+  std::string text;
+  char buffer[4096];
+  size_t readBytes = 0;
+  while ((readBytes = fread(buffer, 1, sizeof(buffer), scenarioFile)) > 0) {
+    text.append(buffer, readBytes);
+  }
+  fclose(scenarioFile);
+
+  std::string directory = fileName;
+  size_t slash = directory.find_last_of('/');
+  directory = (slash == std::string::npos) ? std::string("") : directory.substr(0, slash);
+  return mock_scenario_parse(scenario, env, text.c_str(), directory.c_str());
+}
+
+
+void playEvent(mockScenario * scenario, const mockScenarioEvent * event, int apIndex) {
+  mockAccessPoint * ap = mock_scan_backend_ap(scenario->env, apIndex);
+  switch (event->type) {
+    case MOCK_EVENT_OFF:
+      ap->present = 0;
+      break;
+    case MOCK_EVENT_ON:
+      ap->present = 1;
+      break;
+    case MOCK_EVENT_RSSI:
+      ap->RSSI = event->value;
+      scenario->rampActive[apIndex] = 0;
+      break;
+    case MOCK_EVENT_RAMP:
+      scenario->rampActive[apIndex] = 1;
+      scenario->rampFrom[apIndex] = ap->RSSI;
+      scenario->rampTo[apIndex] = event->value;
+      scenario->rampStartMs[apIndex] = event->timeMs;
+      scenario->rampEndMs[apIndex] = event->timeMs + event->durationMs;
+      break;
+    case MOCK_EVENT_CHANNEL:
+      ap->channel = event->value;
+      break;
+    case MOCK_EVENT_NOISE:
+      ap->noise = event->value;
+      if (event->durationMs == 0) {
+        scenario->baseNoise[apIndex] = event->value;
+      }
+      break;
+    case MOCK_EVENT_NOISE_END:
+      ap->noise = scenario->baseNoise[apIndex];
+      break;
+  }
+}
+
+
+void mock_scenario_update(mockScenario * scenario) {
+  mockScanEnvironment * env = scenario->env;
+  if (env == NULL) {
+    return;
+  }
+  unsigned long nowMs = mock_scan_backend_clock(env);
+
+  while ((scenario->nextEvent < scenario->events.size()) && (scenario->events[scenario->nextEvent].timeMs <= nowMs)) {
+    const mockScenarioEvent * event = &scenario->events[scenario->nextEvent];
+    scenario->nextEvent++;
+    if (event->type == MOCK_EVENT_MARK) {
+      mockScenarioMark mark;
+      mark.timeMs = event->timeMs;
+      strcpy(mark.label, event->label);
+      scenario->marks.push_back(mark);
+    } else if (event->type == MOCK_EVENT_TIMING) {
+      applyTiming(&env->timing, &event->timing, event->timingMask);
+    } else if (event->apIndex < 0) {
+      for (int apIndex = 0; apIndex < mock_scan_backend_ap_number(env); apIndex++) {
+        playEvent(scenario, event, apIndex);
+      }
+    } else {
+      playEvent(scenario, event, event->apIndex);
+    }
+  }
+
+  for (int apIndex = 0; apIndex < mock_scan_backend_ap_number(env); apIndex++) {
+    if (scenario->rampActive[apIndex] == 0) {
+      continue;
+    }
+    mockAccessPoint * ap = mock_scan_backend_ap(env, apIndex);
+    if (nowMs >= scenario->rampEndMs[apIndex]) {
+      ap->RSSI = scenario->rampTo[apIndex];
+      scenario->rampActive[apIndex] = 0;
+    } else {
+      double progress = (double) (nowMs - scenario->rampStartMs[apIndex]) / (double) (scenario->rampEndMs[apIndex] - scenario->rampStartMs[apIndex]);
+      double rssi = scenario->rampFrom[apIndex] + (scenario->rampTo[apIndex] - scenario->rampFrom[apIndex]) * progress;
+      ap->RSSI = (int) ((rssi < 0) ? rssi - 0.5 : rssi + 0.5);
+    }
+  }
+}
@@ -0,0 +1,127 @@
+// Scenario files for the mock scan backend: a text script of the access points, the scan timing and what happens to them over (simulated) time,
+// played on a mockScanEnvironment at the exact simulated time of every scan. See scenario_run.cpp for a runner and scenarios/ for examples.
+
+// One statement per line, '#' starts a comment. Times are numbers with an optional unit: ms, s (default), m, h or d, possibly chained (1h30m).
+//
+//   duration <time>                         how long scenario_run runs (default 1h)
+//   seed <n>                                noise generator seed of the environment (default 1)
+//   loop_delay <time>                       the delay() the application does between two cycles (default 0)
+//   timing <key>=<value> ...                channels, overhead_ms, switch_ms, miss (probability), latency_ms: see mockScanTiming
+//   ap <name> <key>=<value> ...             declares an access point: bssid=02:00:00:00:00:01 ssid=<text> channel=<n> rssi=<dBm> noise=<dB> present=<0|1>
+//                                           (bssid defaults to 02:00:00:00:00:<index + 1>, ssid to the name)
+//   at <time> <action>                      schedules an action
+//   every <period> [from <time>] [until <time>] <action>   schedules an action periodically (from defaults to one period, until to the duration)
+//   trace <name> <file>                     RSSI trace of an access point: "<time> <dBm>" lines, each one a step at that time (path relative to the scenario file)
+//
+// actions (<name> may be * for every access point):
+//   off <name> | on <name>                  the access point disappears / comes back
+//   rssi <name> <dBm>                       steps the mean RSSI
+//   ramp <name> <dBm> <time>                moves the mean RSSI linearly to <dBm> over <time>
+//   channel <name> <n>                      moves the access point to another channel
+//   noise <name> <dB> [<time>]              sets the noise amplitude, for <time> only if given (e.g. somebody walking through the links)
+//   timing <key>=<value> ...                changes the scan timing model
+//   mark <label>                            a ground truth marker: the runner reports the detection latency after each one
+
+#ifndef MOCK_SCENARIO_H
+#define MOCK_SCENARIO_H
+
+#include "mock_scan_backend.h"
+
+#include <vector>
+
+
+#define MOCK_SCENARIO_NAME_LEN 24
+
+#define MOCK_SCENARIO_LINE_LEN 512
+
+
+#define MOCK_EVENT_OFF 0
+#define MOCK_EVENT_ON 1
+#define MOCK_EVENT_RSSI 2
+#define MOCK_EVENT_RAMP 3
+#define MOCK_EVENT_CHANNEL 4
+#define MOCK_EVENT_NOISE 5
+#define MOCK_EVENT_NOISE_END 6 // end of a temporary noise, generated by the player
+#define MOCK_EVENT_TIMING 7
+#define MOCK_EVENT_MARK 8
+
+
+typedef struct  mockScenarioEventStruct {
+
+unsigned long timeMs = 0;
+
+int type = MOCK_EVENT_MARK;
+
+int apIndex = -1; // -1 = every access point
+
+int value = 0; // dBm, channel or dB
+
+unsigned long durationMs = 0; // ramps and temporary noises
+
+mockScanTiming timing; // MOCK_EVENT_TIMING: the fields set by the event, the others are ignored
+
+int timingMask = 0; // which fields of timing are set, one bit per key in the order of the timing statement keys
+
+char label[MOCK_SCENARIO_NAME_LEN] = {0}; // MOCK_EVENT_MARK
+
+} mockScenarioEvent;
+
+
+typedef struct  mockScenarioMarkStruct {
+
+unsigned long timeMs = 0; // simulated time the mark has been played
+
+char label[MOCK_SCENARIO_NAME_LEN] = {0};
+
+} mockScenarioMark;
+
+
+typedef struct  mockScenarioStruct {
+
+mockScanEnvironment * env = NULL;
+
+char apNames[MOCK_MAX_ACCESS_POINTS][MOCK_SCENARIO_NAME_LEN] = {{0}};
+
+std::vector<mockScenarioEvent> events; // sorted by time, same time events in file order
+
+size_t nextEvent = 0; // the first event not played yet
+
+unsigned long durationMs = 3600000;
+
+unsigned long loopDelayMs = 0;
+
+unsigned int seed = 1;
+
+// ramps in progress, per access point
+int rampActive[MOCK_MAX_ACCESS_POINTS] = {0};
+
+int rampFrom[MOCK_MAX_ACCESS_POINTS] = {0};
+
+int rampTo[MOCK_MAX_ACCESS_POINTS] = {0};
+
+unsigned long rampStartMs[MOCK_MAX_ACCESS_POINTS] = {0};
+
+unsigned long rampEndMs[MOCK_MAX_ACCESS_POINTS] = {0};
+
+int baseNoise[MOCK_MAX_ACCESS_POINTS] = {0}; // restored when a temporary noise ends
+
+std::vector<mockScenarioMark> marks; // played so far
+
+char error[160] = {0}; // why the last load failed, with the line number
+
+} mockScenario;
+
+
+// current status: IMPLEMENTED
+int mock_scenario_load(mockScenario *, mockScanEnvironment *, const char * fileName); // resets the environment and loads the scenario into it, returns 0 or -1 (see error)
+
+// current status: IMPLEMENTED
+int mock_scenario_parse(mockScenario *, mockScanEnvironment *, const char * text, const char * directory); // same, from memory; directory is where the trace files are, NULL = current
+
+// current status: IMPLEMENTED
+void mock_scenario_update(mockScenario *); // plays everything due at the environment clock; every scan calls it, call it yourself to see the changes between scans
+
+// current status: IMPLEMENTED
+int mock_scenario_find_ap(const mockScenario *, const char * name); // returns the access point index, -1 if not declared
+
+#endif
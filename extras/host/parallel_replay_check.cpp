@@ -0,0 +1,144 @@
+// Host check of the radar contexts: many independent nodes (one radar context plus one simulated environment each) are replayed
+// by a pool of threads, then the same nodes are replayed again by a single thread. The contexts share nothing, so every node must
+// produce exactly the same sequence of detection levels in both runs, and the replay time must scale with the threads.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o parallel_replay_check parallel_replay_check.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./parallel_replay_check [nodes=64] [threads=all cores] [simulated seconds=900]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+#define ACCESS_POINTS_NUMBER 12
+#define LOOP_DELAY_MS 100
+#define EVENT_PERIOD_MS 60000UL
+#define EVENT_DURATION_MS 10000UL
+
+
+typedef struct  nodeReplayStruct {
+
+radarContext * radar = NULL;
+
+mockScanEnvironment * env = NULL;
+
+unsigned long cycles = 0;
+
+uint32_t levelsHash = 2166136261UL; // FNV-1a of every published level, the node fingerprint
+
+} nodeReplay;
+
+
+
+void buildNode(nodeReplay * node, int nodeIndex) { // every node gets its own room: access points, channels, levels and walk-in times differ
+  mock_scan_backend_reset(node->env, 1000 + nodeIndex);
+  char SSIDprefix[16];
+  snprintf(SSIDprefix, sizeof(SSIDprefix), "node%d_", nodeIndex);
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = ACCESS_POINTS_NUMBER;
+  row.BSSIDtag = (uint8_t) nodeIndex;
+  row.SSIDprefix = SSIDprefix;
+  row.channelOffset = nodeIndex;
+  row.strongestRSSI = -45;
+  row.RSSIoffset = nodeIndex;
+  row.RSSIspread = 30;
+  row.noise = 1;
+  mock_scan_backend_add_synthetic_aps(node->env, &row);
+
+  delete node->radar;
+  node->radar = new radarContext; // a fresh radar, nothing left from a previous run (big: on the heap)
+  multistatic_interference_radar_set_debug_level(node->radar, 0);
+  multistatic_interference_radar_set_scan_backend(node->radar, mock_scan_backend(node->env));
+  multistatic_interference_radar_init(node->radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_enable_targeted_scan(node->radar, nodeIndex % 2); // half the nodes on each scan mode
+  node->cycles = 0;
+  node->levelsHash = 2166136261UL;
+}
+
+
+void replayNode(nodeReplay * node, int nodeIndex, unsigned long simulatedMs) {
+  unsigned long eventOffsetMs = (nodeIndex * 7919UL) % EVENT_PERIOD_MS;
+  while (mock_scan_backend_clock(node->env) < simulatedMs) {
+    int walking = ((mock_scan_backend_clock(node->env) + eventOffsetMs) % EVENT_PERIOD_MS) < EVENT_DURATION_MS;
+    for (int apIndex = 0; apIndex < mock_scan_backend_ap_number(node->env); apIndex++) {
+      mock_scan_backend_ap(node->env, apIndex)->noise = walking ? 12 : 1;
+    }
+    int level = multistatic_interference_radar(node->radar);
+    node->levelsHash = (node->levelsHash ^ (uint32_t) level) * 16777619UL;
+    node->cycles++;
+    mock_scan_backend_advance(node->env, LOOP_DELAY_MS);
+  }
+}
+
+
+double replayAll(std::vector<nodeReplay> & nodes, int threadsNumber, unsigned long simulatedMs) { // returns the wall time, in seconds
+  for (int nodeIndex = 0; nodeIndex < (int) nodes.size(); nodeIndex++) {
+    buildNode(&nodes[nodeIndex], nodeIndex);
+  }
+
+  std::atomic<int> nextNode(0);
+  std::vector<std::thread> workers;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int threadIndex = 0; threadIndex < threadsNumber; threadIndex++) {
+    workers.push_back(std::thread([&]() {
+      int nodeIndex = 0;
+      while ((nodeIndex = nextNode.fetch_add(1)) < (int) nodes.size()) { // the next node nobody took yet
+        replayNode(&nodes[nodeIndex], nodeIndex, simulatedMs);
+      }
+    }));
+  }
+  for (size_t threadIndex = 0; threadIndex < workers.size(); threadIndex++) {
+    workers[threadIndex].join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+int main(int argc, char ** argv) {
+
+  int nodesNumber = (argc > 1) ? atoi(argv[1]) : 64;
+  int threadsNumber = (argc > 2) ? atoi(argv[2]) : (int) std::thread::hardware_concurrency();
+  unsigned long simulatedMs = (argc > 3) ? (unsigned long) atol(argv[3]) * 1000UL : 900UL * 1000UL;
+  if (threadsNumber < 1) {
+    threadsNumber = 1;
+  }
+
+  std::vector<nodeReplay> nodes(nodesNumber);
+  for (int nodeIndex = 0; nodeIndex < nodesNumber; nodeIndex++) {
+    nodes[nodeIndex].env = new mockScanEnvironment;
+  }
+
+  double parallelSeconds = replayAll(nodes, threadsNumber, simulatedMs);
+  std::vector<uint32_t> parallelHashes(nodesNumber);
+  unsigned long cycles = 0;
+  for (int nodeIndex = 0; nodeIndex < nodesNumber; nodeIndex++) {
+    parallelHashes[nodeIndex] = nodes[nodeIndex].levelsHash;
+    cycles = cycles + nodes[nodeIndex].cycles;
+  }
+
+  double serialSeconds = replayAll(nodes, 1, simulatedMs);
+  int mismatches = 0;
+  for (int nodeIndex = 0; nodeIndex < nodesNumber; nodeIndex++) {
+    if (nodes[nodeIndex].levelsHash != parallelHashes[nodeIndex]) {
+      mismatches++;
+    }
+  }
+
+  printf("nodes=%d threads=%d simulated_s=%lu cycles=%lu serial_s=%.2f parallel_s=%.2f serial_cycles_per_s=%.0f parallel_cycles_per_s=%.0f speedup=%.2f mismatching_nodes=%d\n",
+         nodesNumber, threadsNumber, simulatedMs / 1000, cycles, serialSeconds, parallelSeconds, cycles / serialSeconds, cycles / parallelSeconds,
+         serialSeconds / parallelSeconds, mismatches);
+
+  for (int nodeIndex = 0; nodeIndex < nodesNumber; nodeIndex++) {
+    delete nodes[nodeIndex].radar;
+    delete nodes[nodeIndex].env;
+  }
+  return (mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,449 @@
+// Host tuning harness: labelled RSSI traces are replayed through the radar core (multistatic_interference_radar_process()) for every combination of a parameter grid,
+// the combinations spread over all cores. Per combination:
+// - the detection latency distribution, from the start of each labelled event to the first alarm (alarmStatus of any link, as updated by the radar cycle), "missed" if the event ends first,
+// - the false alarms: alarm rising edges with no event for at least the settle time, per hour of such quiet time, and the fraction of that quiet time spent in alarm
+//   (a stuck alarm is one rising edge, but it is false all along),
+// - the CPU time per sample (thread CPU time, so it does not depend on how busy the other cores are).
+// Then the combinations no other one beats on p90 latency, misses and false alarm time at once: the latency / accuracy frontier, cheapest first.
+
+// traces: CSV files with a header line, as written by rf_generator_bench: a time_ms column, an occupancy (or label) column, > 0 during the events,
+// and one column per link named link<n> (or rssi<n>), in dBm; the other columns are ignored. Without traces, four rooms of the synthetic generator are used.
+// grid: key=v1,v2,... arguments, the keys are
+//   threshold   varianceThreshold (default 16)                   attenuation secondOrderAttenutationCoefficient (16)
+//   integrator  varianceIntegratorLimit (3)                      samples     sampleBufferSize (32)
+//   average     mobileAverageFilterSize (32)                     variances   varianceBufferSize (16)
+//   autoregressive  0|1 (0)                                      second_order secondOrderFilter 0|1 (1)
+// combinations with average > samples or integrator > variances are skipped. Other arguments: threads=<n> (all cores), settle_s=<s> (30), csv=<file> (every combination).
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o parameter_sweep parameter_sweep.cpp rf_generator.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./parameter_sweep [trace.csv ...] [threshold=8,12,16,24] [attenuation=4,8,16,32] [integrator=2,3,4,6] [samples=16,32] ...
+
+#include "../../multistatic_interference_radar.h"
+#include "rf_generator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+#define SWEEP_PARAMETERS_NUMBER 8
+#define SWEEP_LINE_LEN 4096
+#define SYNTHETIC_ROOMS 4
+#define SYNTHETIC_HOURS 2.0
+
+
+const char * parameterKeys[SWEEP_PARAMETERS_NUMBER] = {"threshold", "attenuation", "integrator", "samples", "average", "variances", "autoregressive", "second_order"};
+
+const int parameterDefaults[SWEEP_PARAMETERS_NUMBER] = {VARIANCE_THRESHOLD, 16, VARIANCE_INTEGRATOR_LIMIT, MAX_SAMPLEBUFFERSIZE_MULTI, MAX_SAMPLEBUFFERSIZE_MULTI, MAX_VARIANCEBUFFERSIZE_MULTI, 0, ENABLE_FIR_IIR_SECOND_ORDER};
+
+const int parameterLimits[SWEEP_PARAMETERS_NUMBER][2] = {{0, 10000}, {2, 1024}, {1, MAX_VARIANCEBUFFERSIZE_MULTI}, {2, MAX_SAMPLEBUFFERSIZE_MULTI}, {1, MAX_SAMPLEBUFFERSIZE_MULTI},
+                                                         {1, MAX_VARIANCEBUFFERSIZE_MULTI}, {0, 1}, {0, 1}};
+
+
+typedef struct  labelledTraceStruct {
+
+std::string name;
+
+int linksNumber = 0;
+
+std::vector<double> timeMs;
+
+std::vector<int> label; // > 0 during an event
+
+std::vector<int8_t> rssi; // step * linksNumber + link
+
+} labelledTrace;
+
+
+typedef struct  sweepResultStruct {
+
+int parameters[SWEEP_PARAMETERS_NUMBER] = {0};
+
+long samples = 0;
+
+double cpuNs = 0;
+
+int events = 0;
+
+int missed = 0;
+
+int falseAlarms = 0;
+
+double quietHours = 0;
+
+double falseAlarmHours = 0;
+
+std::vector<double> latenciesMs;
+
+int frontier = 0;
+
+} sweepResult;
+
+
+double threadCpuNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+
+int loadTrace(const char * fileName, labelledTrace * trace) { // returns 0, -1 on errors (reported)
+  FILE * traceFile = fopen(fileName, "r");
+  if (traceFile == NULL) {
+    printf("cannot open %s\n", fileName);
+    return -1;
+  }
+  char line[SWEEP_LINE_LEN];
+  std::vector<int> linkColumns;
+  int timeColumn = -1;
+  int labelColumn = -1;
+  int lineNumber = 0;
+  trace->name = fileName;
+
+  while (fgets(line, sizeof(line), traceFile) != NULL) {
+    lineNumber++;
+    int column = 0;
+    char * save = NULL;
+    if (lineNumber == 1) {
+      for (char * field = strtok_r(line, ",\r\n", &save); field != NULL; field = strtok_r(NULL, ",\r\n", &save), column++) {
+        if (strcmp(field, "time_ms") == 0) {
+          timeColumn = column;
+        } else if ((strcmp(field, "occupancy") == 0) || (strcmp(field, "label") == 0)) {
+          labelColumn = column;
+        } else if ((strncmp(field, "link", 4) == 0) || (strncmp(field, "rssi", 4) == 0)) {
+          linkColumns.push_back(column);
+        }
+      }
+      if ((timeColumn < 0) || (labelColumn < 0) || (linkColumns.empty()) || ((int) linkColumns.size() > MAX_ALLOWED_TRANSMITTERS_NUMBER)) {
+        printf("%s: the header needs time_ms, occupancy (or label) and 1 to %d link columns\n", fileName, MAX_ALLOWED_TRANSMITTERS_NUMBER);
+        fclose(traceFile);
+        return -1;
+      }
+      trace->linksNumber = (int) linkColumns.size();
+      continue;
+    }
+    size_t linkIndex = 0;
+    int fields = 0;
+    for (char * field = strtok_r(line, ",\r\n", &save); field != NULL; field = strtok_r(NULL, ",\r\n", &save), column++) {
+      if (column == timeColumn) {
+        trace->timeMs.push_back(atof(field));
+        fields++;
+      } else if (column == labelColumn) {
+        trace->label.push_back(atoi(field));
+        fields++;
+      } else if ((linkIndex < linkColumns.size()) && (column == linkColumns[linkIndex])) {
+        trace->rssi.push_back((int8_t) atoi(field));
+        linkIndex++;
+        fields++;
+      }
+    }
+    if (fields == 0) {
+      continue; // empty line
+    }
+    if (fields != 2 + trace->linksNumber) {
+      printf("%s: line %d: missing columns\n", fileName, lineNumber);
+      fclose(traceFile);
+      return -1;
+    }
+  }
+  fclose(traceFile);
+  return 0;
+}
+
+
+void syntheticTrace(int room, labelledTrace * trace) { // a room of the synthetic generator, 12 links, 2 people
+  rfEnvironment * env = new rfEnvironment;
+  rf_generator_floor_plan(env, 12, 2, SYNTHETIC_HOURS * 3600000.0, 1000 + room);
+  long stepsNumber = (long) (SYNTHETIC_HOURS * 3600000.0 / env->sampleIntervalMs);
+  std::vector<rfGroundTruth> truth(stepsNumber);
+  trace->name = "synthetic room " + std::to_string(room);
+  trace->linksNumber = 12;
+  trace->rssi.resize(stepsNumber * trace->linksNumber);
+  rf_generator_generate_parallel(env, 0, stepsNumber, &trace->rssi[0], &truth[0], 0);
+  for (long step = 0; step < stepsNumber; step++) {
+    trace->timeMs.push_back(truth[step].timeMs);
+    trace->label.push_back(truth[step].occupancy);
+  }
+  delete env;
+}
+
+
+void replayTrace(radarContext * radar, const labelledTrace * trace, sweepResult * result, double settleMs) {
+  const int * parameters = result->parameters;
+  std::vector<transmitterData> links(trace->linksNumber);
+  for (int linkIndex = 0; linkIndex < trace->linksNumber; linkIndex++) {
+    links[linkIndex].enableThreshold = 1;
+    links[linkIndex].varianceThreshold = parameters[0];
+    links[linkIndex].varianceIntegratorLimit = parameters[2];
+    links[linkIndex].sampleBufferSize = parameters[3];
+    links[linkIndex].mobileAverageFilterSize = parameters[4];
+    links[linkIndex].varianceBufferSize = parameters[5];
+    links[linkIndex].enableAutoRegressive = (parameters[6] == 1);
+  }
+  radar->accessPoints.secondOrderAttenutationCoefficient = parameters[1];
+  radar->accessPoints.secondOrderFilter = parameters[7];
+
+  long stepsNumber = (long) trace->timeMs.size();
+  int pending = 0;
+  int alarmPrev = 0;
+  double eventStartMs = 0;
+  double quietSinceMs = (stepsNumber > 0) ? trace->timeMs[0] : 0;
+
+  double startNs = threadCpuNs();
+  for (long step = 0; step < stepsNumber; step++) {
+    const int8_t * stepRSSI = &trace->rssi[step * trace->linksNumber];
+    int alarm = 0;
+    for (int linkIndex = 0; linkIndex < trace->linksNumber; linkIndex++) {
+      transmitterData * link = &links[linkIndex];
+      int level = multistatic_interference_radar_process(radar, stepRSSI[linkIndex], link);
+      link->alarmStatus = ((link->enableThreshold >= 1) && (level >= link->varianceThreshold)) ? level : 0; // as the radar cycle does it
+      if (link->alarmStatus > 0) {
+        alarm = 1;
+      }
+    }
+
+    double nowMs = trace->timeMs[step];
+    int event = (trace->label[step] > 0) ? 1 : 0;
+    int eventPrev = (step > 0) ? ((trace->label[step - 1] > 0) ? 1 : 0) : 0;
+    if ((event == 1) && (eventPrev == 0)) {
+      result->events++;
+      pending = 1;
+      eventStartMs = nowMs;
+    }
+    if ((event == 0) && (eventPrev == 1)) {
+      if (pending == 1) {
+        result->missed++;
+        pending = 0;
+      }
+      quietSinceMs = nowMs;
+    }
+    if ((alarm == 1) && (pending == 1)) {
+      result->latenciesMs.push_back(nowMs - eventStartMs);
+      pending = 0;
+    }
+    int settled = ((event == 0) && (nowMs - quietSinceMs >= settleMs)) ? 1 : 0;
+    if ((settled == 1) && (alarm == 1) && (alarmPrev == 0)) {
+      result->falseAlarms++;
+    }
+    if ((settled == 1) && (step > 0)) {
+      result->quietHours = result->quietHours + (nowMs - trace->timeMs[step - 1]) / 3600000.0;
+      if (alarm == 1) {
+        result->falseAlarmHours = result->falseAlarmHours + (nowMs - trace->timeMs[step - 1]) / 3600000.0;
+      }
+    }
+    alarmPrev = alarm;
+  }
+  result->cpuNs = result->cpuNs + threadCpuNs() - startNs;
+  result->samples = result->samples + stepsNumber * trace->linksNumber;
+}
+
+
+double latencyPercentile(const sweepResult * result, int percent) {
+  if (result->latenciesMs.empty()) {
+    return -1;
+  }
+  return result->latenciesMs[(result->latenciesMs.size() - 1) * percent / 100];
+}
+
+
+double missRate(const sweepResult * result) {
+  return (result->events > 0) ? (double) result->missed / result->events : 0.0;
+}
+
+
+double falseAlarmRate(const sweepResult * result) {
+  return (result->quietHours > 0) ? result->falseAlarms / result->quietHours : 0.0;
+}
+
+
+double falseAlarmTime(const sweepResult * result) {
+  return (result->quietHours > 0) ? result->falseAlarmHours / result->quietHours : 0.0;
+}
+
+
+int dominates(const sweepResult * first, const sweepResult * second) { // first at least as good everywhere, better somewhere; no detection at all is the worst latency
+  double firstLatency = (first->latenciesMs.empty()) ? 1e300 : latencyPercentile(first, 90);
+  double secondLatency = (second->latenciesMs.empty()) ? 1e300 : latencyPercentile(second, 90);
+  if ((firstLatency > secondLatency) || (missRate(first) > missRate(second)) || (falseAlarmTime(first) > falseAlarmTime(second))) {
+    return 0;
+  }
+  return ((firstLatency < secondLatency) || (missRate(first) < missRate(second)) || (falseAlarmTime(first) < falseAlarmTime(second))) ? 1 : 0;
+}
+
+
+void printResult(FILE * output, const sweepResult * result) {
+  for (int parameterIndex = 0; parameterIndex < SWEEP_PARAMETERS_NUMBER; parameterIndex++) {
+    fprintf(output, "%s=%d ", parameterKeys[parameterIndex], result->parameters[parameterIndex]);
+  }
+  double meanMs = 0;
+  for (size_t latencyIndex = 0; latencyIndex < result->latenciesMs.size(); latencyIndex++) {
+    meanMs = meanMs + result->latenciesMs[latencyIndex] / result->latenciesMs.size();
+  }
+  fprintf(output, "events=%d detected=%d miss_rate=%.3f latency_ms mean=%.0f p50=%.0f p90=%.0f max=%.0f false_alarms=%d false_alarms_per_h=%.2f false_alarm_time=%.4f cpu_ns_per_sample=%.1f\n",
+          result->events, (int) result->latenciesMs.size(), missRate(result), meanMs, latencyPercentile(result, 50), latencyPercentile(result, 90), latencyPercentile(result, 100),
+          result->falseAlarms, falseAlarmRate(result), falseAlarmTime(result), (result->samples > 0) ? result->cpuNs / result->samples : 0.0);
+}
+
+
+int main(int argc, char ** argv) {
+
+  std::vector<int> grid[SWEEP_PARAMETERS_NUMBER];
+  std::vector<labelledTrace> traces;
+  int threadsNumber = (int) std::thread::hardware_concurrency();
+  double settleMs = 30000.0;
+  const char * csvName = NULL;
+
+  for (int argIndex = 1; argIndex < argc; argIndex++) {
+    char * equal = strchr(argv[argIndex], '=');
+    if (equal == NULL) {
+      labelledTrace trace;
+      if (loadTrace(argv[argIndex], &trace) != 0) {
+        return 1;
+      }
+      traces.push_back(trace);
+      continue;
+    }
+    *equal = 0;
+    const char * values = equal + 1;
+    if (strcmp(argv[argIndex], "threads") == 0) {
+      threadsNumber = atoi(values);
+    } else if (strcmp(argv[argIndex], "settle_s") == 0) {
+      settleMs = atof(values) * 1000.0;
+    } else if (strcmp(argv[argIndex], "csv") == 0) {
+      csvName = values;
+    } else {
+      int parameterIndex = 0;
+      while ((parameterIndex < SWEEP_PARAMETERS_NUMBER) && (strcmp(argv[argIndex], parameterKeys[parameterIndex]) != 0)) {
+        parameterIndex++;
+      }
+      if (parameterIndex == SWEEP_PARAMETERS_NUMBER) {
+        printf("unknown key %s\n", argv[argIndex]);
+        return 1;
+      }
+      for (const char * cursor = values; *cursor != 0; cursor = (strchr(cursor, ',') != NULL) ? strchr(cursor, ',') + 1 : cursor + strlen(cursor)) {
+        int value = atoi(cursor);
+        if ((value < parameterLimits[parameterIndex][0]) || (value > parameterLimits[parameterIndex][1])) {
+          printf("%s: %d out of range %d to %d\n", parameterKeys[parameterIndex], value, parameterLimits[parameterIndex][0], parameterLimits[parameterIndex][1]);
+          return 1;
+        }
+        grid[parameterIndex].push_back(value);
+      }
+    }
+  }
+  if (threadsNumber < 1) {
+    threadsNumber = 1;
+  }
+  for (int parameterIndex = 0; parameterIndex < SWEEP_PARAMETERS_NUMBER; parameterIndex++) {
+    if (grid[parameterIndex].empty()) {
+      grid[parameterIndex].push_back(parameterDefaults[parameterIndex]);
+    }
+  }
+  if (traces.empty()) {
+    for (int room = 0; room < SYNTHETIC_ROOMS; room++) {
+      traces.push_back(labelledTrace());
+      syntheticTrace(room, &traces.back());
+    }
+  }
+
+  // the grid, valid combinations only
+  std::vector<sweepResult> results;
+  int odometer[SWEEP_PARAMETERS_NUMBER] = {0};
+  int done = 0;
+  while (done == 0) {
+    sweepResult result;
+    for (int parameterIndex = 0; parameterIndex < SWEEP_PARAMETERS_NUMBER; parameterIndex++) {
+      result.parameters[parameterIndex] = grid[parameterIndex][odometer[parameterIndex]];
+    }
+    if ((result.parameters[4] <= result.parameters[3]) && (result.parameters[2] <= result.parameters[5])) {
+      results.push_back(result);
+    }
+    int parameterIndex = SWEEP_PARAMETERS_NUMBER - 1;
+    while ((parameterIndex >= 0) && (++odometer[parameterIndex] == (int) grid[parameterIndex].size())) {
+      odometer[parameterIndex] = 0;
+      parameterIndex--;
+    }
+    done = (parameterIndex < 0) ? 1 : 0;
+  }
+
+  long traceSamples = 0;
+  for (size_t traceIndex = 0; traceIndex < traces.size(); traceIndex++) {
+    traceSamples = traceSamples + (long) traces[traceIndex].timeMs.size() * traces[traceIndex].linksNumber;
+  }
+  printf("traces=%d samples_per_combination=%ld combinations=%d threads=%d\n", (int) traces.size(), traceSamples, (int) results.size(), threadsNumber);
+
+  // the sweep: every worker takes the next combination, with its own radar context
+  std::atomic<size_t> nextCombination(0);
+  std::vector<std::thread> workers;
+  for (int threadIndex = 0; threadIndex < threadsNumber; threadIndex++) {
+    workers.push_back(std::thread([&]() {
+      radarContext * radar = new radarContext;
+      multistatic_interference_radar_set_debug_level(radar, 0);
+      for (size_t combination = nextCombination.fetch_add(1); combination < results.size(); combination = nextCombination.fetch_add(1)) {
+        for (size_t traceIndex = 0; traceIndex < traces.size(); traceIndex++) {
+          replayTrace(radar, &traces[traceIndex], &results[combination], settleMs);
+        }
+        std::sort(results[combination].latenciesMs.begin(), results[combination].latenciesMs.end());
+      }
+      delete radar;
+    }));
+  }
+  for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++) {
+    workers[workerIndex].join();
+  }
+
+  // the frontier
+  std::vector<sweepResult *> frontier;
+  for (size_t candidate = 0; candidate < results.size(); candidate++) {
+    results[candidate].frontier = 1;
+    for (size_t other = 0; (other < results.size()) && (results[candidate].frontier == 1); other++) {
+      if (dominates(&results[other], &results[candidate]) == 1) {
+        results[candidate].frontier = 0;
+      }
+    }
+    if (results[candidate].frontier == 1) {
+      frontier.push_back(&results[candidate]);
+    }
+  }
+  std::sort(frontier.begin(), frontier.end(), [](const sweepResult * first, const sweepResult * second) {
+    return first->cpuNs / first->samples < second->cpuNs / second->samples;
+  });
+
+  if (csvName != NULL) {
+    FILE * csvFile = fopen(csvName, "w");
+    if (csvFile == NULL) {
+      printf("cannot write %s\n", csvName);
+      return 1;
+    }
+    for (int parameterIndex = 0; parameterIndex < SWEEP_PARAMETERS_NUMBER; parameterIndex++) {
+      fprintf(csvFile, "%s,", parameterKeys[parameterIndex]);
+    }
+    fprintf(csvFile, "events,detected,miss_rate,latency_p50_ms,latency_p90_ms,latency_max_ms,false_alarms_per_h,false_alarm_time,cpu_ns_per_sample,frontier\n");
+    for (size_t resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+      const sweepResult * result = &results[resultIndex];
+      for (int parameterIndex = 0; parameterIndex < SWEEP_PARAMETERS_NUMBER; parameterIndex++) {
+        fprintf(csvFile, "%d,", result->parameters[parameterIndex]);
+      }
+      fprintf(csvFile, "%d,%d,%.4f,%.0f,%.0f,%.0f,%.3f,%.5f,%.1f,%d\n", result->events, (int) result->latenciesMs.size(), missRate(result), latencyPercentile(result, 50),
+              latencyPercentile(result, 90), latencyPercentile(result, 100), falseAlarmRate(result), falseAlarmTime(result), result->cpuNs / result->samples, result->frontier);
+    }
+    fclose(csvFile);
+  } else if (results.size() <= 64) {
+    for (size_t resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+      printResult(stdout, &results[resultIndex]);
+    }
+  }
+
+  printf("frontier=%d of %d, cheapest first:\n", (int) frontier.size(), (int) results.size());
+  for (size_t frontierIndex = 0; frontierIndex < frontier.size(); frontierIndex++) {
+    printResult(stdout, frontier[frontierIndex]);
+  }
+  return 0;
+}
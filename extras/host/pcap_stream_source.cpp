@@ -0,0 +1,262 @@
+// Radiotap pcap producer, see pcap_stream_source.h
+
+#include "pcap_stream_source.h"
+#include "../../multistatic_interference_radar.h"
+
+#include <string.h>
+
+
+#define PCAP_MAGIC_US 0xa1b2c3d4UL
+#define PCAP_MAGIC_NS 0xa1b23c4dUL
+
+#define RADIOTAP_FLAGS_FCS 0x10 // the frame carries its 4 bytes FCS at the end
+
+
+
+uint32_t pcapSwap32(uint32_t value) {
+  return ((value & 0xff) << 24) | ((value & 0xff00) << 8) | ((value >> 8) & 0xff00) | (value >> 24);
+}
+
+
+uint32_t pcapRead32(const pcapStream * stream, const uint8_t * bytes) { // file byte order
+  uint32_t value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+  return stream->swapped ? pcapSwap32(value) : value;
+}
+
+
+uint32_t radiotapRead32(const uint8_t * bytes) { // radiotap is always little endian
+  return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+
+int parseRadiotap(const uint8_t * record, int recordLength, int * rssi, int * headerLength, int * flags) { // returns 0 if the header is usable
+  if ((recordLength < 8) || (record[0] != 0)) { // version 0 only
+    return -1;
+  }
+  *headerLength = record[2] | (record[3] << 8);
+  if ((*headerLength < 8) || (*headerLength > recordLength)) {
+    return -1;
+  }
+
+  // present words: the first one describes the standard fields, the extended ones only shift where the fields start
+  uint32_t present = radiotapRead32(&record[4]);
+  int offset = 4;
+  uint32_t word = present;
+  while (word & 0x80000000UL) {
+    offset = offset + 4;
+    if (offset + 4 > *headerLength) {
+      return -1;
+    }
+    word = radiotapRead32(&record[offset]);
+  }
+  offset = offset + 4;
+
+  // fields in bit order, each one aligned to its natural size from the start of the header
+  static const int fieldAlign[6] = {8, 1, 1, 2, 1, 1}; // TSFT, flags, rate, channel, FHSS, dBm antenna signal
+  static const int fieldSize[6] = {8, 1, 1, 4, 2, 1};
+  *rssi = ABSOLUTE_RSSI_LIMIT;
+  *flags = 0;
+  for (int field = 0; field < 6; field++) {
+    if ((present & (1UL << field)) == 0) {
+      continue;
+    }
+    offset = (offset + fieldAlign[field] - 1) & ~(fieldAlign[field] - 1);
+    if (offset + fieldSize[field] > *headerLength) {
+      return -1;
+    }
+    if (field == 1) {
+      *flags = record[offset];
+    }
+    if (field == 5) {
+      *rssi = (int8_t) record[offset];
+    }
+    offset = offset + fieldSize[field];
+  }
+  return 0;
+}
+
+
+
+int pcap_stream_open(pcapStream * stream, const char * path) {
+  uint8_t header[24];
+
+  stream->file = fopen(path, "rb");
+  if (stream->file == NULL) {
+    return -1;
+  }
+  if (fread(header, 1, sizeof(header), stream->file) != sizeof(header)) {
+    pcap_stream_close(stream);
+    return -1;
+  }
+
+  uint32_t magic = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t) header[3] << 24);
+  stream->swapped = ((magic == pcapSwap32(PCAP_MAGIC_US)) || (magic == pcapSwap32(PCAP_MAGIC_NS))) ? 1 : 0;
+  if (stream->swapped) {
+    magic = pcapSwap32(magic);
+  }
+  if ((magic != PCAP_MAGIC_US) && (magic != PCAP_MAGIC_NS)) {
+    pcap_stream_close(stream);
+    return -1;
+  }
+  stream->nanoseconds = (magic == PCAP_MAGIC_NS) ? 1 : 0;
+
+  if (pcapRead32(stream, &header[20]) != PCAP_LINKTYPE_RADIOTAP) {
+    pcap_stream_close(stream);
+    return -1;
+  }
+
+  stream->firstRecord = 1;
+  return 0;
+}
+
+
+int pcap_stream_next(pcapStream * stream, pcapFrame * frame) {
+  uint8_t header[16];
+
+  while (1) {
+    size_t got = fread(header, 1, sizeof(header), stream->file);
+    if (got == 0) {
+      return 0;
+    }
+    if (got != sizeof(header)) {
+      return -1;
+    }
+    uint32_t seconds = pcapRead32(stream, &header[0]);
+    uint32_t fraction = pcapRead32(stream, &header[4]);
+    uint32_t capturedLength = pcapRead32(stream, &header[8]);
+    if (capturedLength > PCAP_MAX_FRAME_LEN) {
+      return -1;
+    }
+    if (fread(stream->record, 1, capturedLength, stream->file) != capturedLength) {
+      return -1;
+    }
+
+    uint64_t timestampUs = (uint64_t) seconds * 1000000ULL + (stream->nanoseconds ? fraction / 1000 : fraction);
+    if (stream->firstRecord) {
+      stream->firstTimestampUs = timestampUs;
+      stream->firstRecord = 0;
+    }
+
+    int rssi = 0;
+    int headerLength = 0;
+    int flags = 0;
+    if (parseRadiotap(stream->record, (int) capturedLength, &rssi, &headerLength, &flags) != 0) {
+      continue;
+    }
+    int frameLength = (int) capturedLength - headerLength;
+    if (flags & RADIOTAP_FLAGS_FCS) {
+      frameLength = frameLength - 4;
+    }
+    if (frameLength <= 0) {
+      continue;
+    }
+
+    frame->frame = &stream->record[headerLength];
+    frame->frameLength = frameLength;
+    frame->rssi = rssi;
+    frame->timestampMs = (uint32_t) ((timestampUs - stream->firstTimestampUs) / 1000);
+    return 1;
+  }
+}
+
+
+void pcap_stream_close(pcapStream * stream) {
+  if (stream->file != NULL) {
+    fclose(stream->file);
+    stream->file = NULL;
+  }
+}
+
+
+int pcap_stream_ingest_file(radarContext * radar, const char * path) {
+  pcapStream stream;
+  pcapFrame frame;
+  int accepted = 0;
+
+  if (pcap_stream_open(&stream, path) != 0) {
+    return -1;
+  }
+  while (pcap_stream_next(&stream, &frame) == 1) {
+    if (frame.rssi == ABSOLUTE_RSSI_LIMIT) {
+      continue;
+    }
+    if (multistatic_interference_radar_stream_ingest_frame(radar, frame.frame, frame.frameLength, frame.rssi, frame.timestampMs) == 1) {
+      accepted++;
+    }
+  }
+  pcap_stream_close(&stream);
+  return accepted;
+}
+
+
+int pcap_stream_ingest_file(const char * path) {
+  return pcap_stream_ingest_file(&defaultRadarContext, path);
+}
+
+
+
+FILE * pcap_stream_create(const char * path) {
+  FILE * file = fopen(path, "wb");
+  if (file == NULL) {
+    return NULL;
+  }
+  // little endian, microseconds, version 2.4, snaplen 65535, radiotap
+  const uint8_t header[24] = {0xd4, 0xc3, 0xb2, 0xa1, 2, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 0, 0, PCAP_LINKTYPE_RADIOTAP, 0, 0, 0};
+  fwrite(header, 1, sizeof(header), file);
+  return file;
+}
+
+
+void pcapPut32(uint8_t * bytes, uint32_t value) { // little endian
+  bytes[0] = value & 0xff;
+  bytes[1] = (value >> 8) & 0xff;
+  bytes[2] = (value >> 16) & 0xff;
+  bytes[3] = (value >> 24) & 0xff;
+}
+
+
+int pcap_stream_write_beacon(FILE * file, uint32_t timestampMs, const uint8_t * BSSID, const char * SSID, int channel, int rssi) {
+  uint8_t record[16 + 15 + 24 + 12 + 2 + 32 + 3];
+  int SSIDlength = (int) strnlen(SSID, 32);
+  int length = 0;
+
+  // radiotap: flags (bit 1), channel (bit 3), dBm antenna signal (bit 5)
+  uint8_t * radiotap = &record[16];
+  memset(radiotap, 0, 15);
+  radiotap[2] = 15;
+  pcapPut32(&radiotap[4], (1UL << 1) | (1UL << 3) | (1UL << 5));
+  int frequency = (channel == 14) ? 2484 : 2407 + 5 * channel;
+  radiotap[10] = frequency & 0xff;
+  radiotap[11] = (frequency >> 8) & 0xff;
+  radiotap[12] = 0x80; // 2 GHz channel
+  radiotap[14] = (uint8_t) (int8_t) rssi;
+  length = 15;
+
+  // 802.11 beacon header: frame control, duration, broadcast destination, source, BSSID, sequence
+  uint8_t * dot11 = &record[16 + length];
+  memset(dot11, 0, 24 + 12);
+  dot11[0] = 0x80;
+  memset(&dot11[4], 0xff, 6);
+  memcpy(&dot11[10], BSSID, 6);
+  memcpy(&dot11[16], BSSID, 6);
+  // fixed fields: timestamp (8), beacon interval (100 TU), capabilities (ESS)
+  dot11[24 + 8] = 100;
+  dot11[24 + 10] = 0x01;
+  length = length + 24 + 12;
+
+  // SSID and DS parameter set elements
+  record[16 + length] = 0;
+  record[16 + length + 1] = (uint8_t) SSIDlength;
+  memcpy(&record[16 + length + 2], SSID, SSIDlength);
+  length = length + 2 + SSIDlength;
+  record[16 + length] = 3;
+  record[16 + length + 1] = 1;
+  record[16 + length + 2] = (uint8_t) channel;
+  length = length + 3;
+
+  pcapPut32(&record[0], timestampMs / 1000);
+  pcapPut32(&record[4], (timestampMs % 1000) * 1000);
+  pcapPut32(&record[8], length);
+  pcapPut32(&record[12], length);
+  return (fwrite(record, 1, 16 + length, file) == (size_t) (16 + length)) ? 0 : -1;
+}
@@ -0,0 +1,75 @@
+// Radiotap pcap files as producers of the streaming ingest, for host (Linux) builds of the multistatic interference radar library.
+
+// Reads captures taken in monitor mode with radiotap headers (pcap link type 127, e.g. tcpdump -i wlan0mon -w capture.pcap),
+// and hands each 802.11 frame with its dBm antenna signal to multistatic_interference_radar_stream_ingest_frame(), exactly like the ESP32 promiscuous callback does.
+// A minimal writer is provided too, to synthesize beacon captures for tests.
+
+#ifndef PCAP_STREAM_SOURCE_H
+#define PCAP_STREAM_SOURCE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../../multistatic_interference_radar.h"
+
+
+#define PCAP_LINKTYPE_RADIOTAP 127
+
+#define PCAP_MAX_FRAME_LEN 4096
+
+
+typedef struct  pcapFrameStruct {
+
+const uint8_t * frame = NULL; // 802.11 frame, from the frame control field on (radiotap header and FCS removed)
+
+int frameLength = 0;
+
+int rssi = -128; // dBm antenna signal, -128 when the radiotap header has none
+
+uint32_t timestampMs = 0; // capture time, relative to the first record
+
+} pcapFrame;
+
+
+typedef struct  pcapStreamStruct {
+
+FILE * file = NULL;
+
+int swapped = 0; // file written with the other byte order
+
+int nanoseconds = 0; // nanosecond resolution timestamps
+
+int firstRecord = 1;
+
+uint64_t firstTimestampUs = 0;
+
+uint8_t record[PCAP_MAX_FRAME_LEN];
+
+} pcapStream;
+
+
+// current status: IMPLEMENTED
+int pcap_stream_open(pcapStream *, const char * path); // returns 0 on success, -1 if the file cannot be read or is not a radiotap capture
+
+// current status: IMPLEMENTED
+int pcap_stream_next(pcapStream *, pcapFrame *); // returns 1 and fills the frame (valid until the next call), 0 at the end of the file, -1 on a malformed file; records without a usable radiotap header are skipped
+
+// current status: IMPLEMENTED
+void pcap_stream_close(pcapStream *);
+
+// current status: IMPLEMENTED
+int pcap_stream_ingest_file(const char * path); // replays a whole capture into multistatic_interference_radar_stream_ingest_frame(), returns the number of accepted frames or -1; please note it does not wait for the consumer, ring overflows are possible
+
+// current status: IMPLEMENTED
+int pcap_stream_ingest_file(radarContext *, const char * path); // the same, into the stream of the given radar context
+
+
+// writer
+
+// current status: IMPLEMENTED
+FILE * pcap_stream_create(const char * path); // writes the radiotap pcap file header, returns NULL on failure
+
+// current status: IMPLEMENTED
+int pcap_stream_write_beacon(FILE *, uint32_t timestampMs, const uint8_t * BSSID, const char * SSID, int channel, int rssi); // appends one beacon with a radiotap header carrying flags, channel and dBm antenna signal
+
+#endif
@@ -0,0 +1,134 @@
+// Host check of the pipelined mode: the same simulated room is watched by a loop calling multistatic_interference_radar() (blocking)
+// and by a loop calling multistatic_interference_radar_pipelined(), both loops also doing some unrelated application work per iteration.
+// Someone walks in every eventPeriod seconds (every access point gets a much noisier RSSI for a while), the detection latency is
+// the simulated time from the walk-in to the first published level above the detection threshold.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o pipeline_latency_check pipeline_latency_check.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./pipeline_latency_check [loop work ms=50] [processing ms=20] [results latency ms=0] [targeted scan=1] [simulated seconds=3600]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#define ACCESS_POINTS_NUMBER 12
+#define QUIET_NOISE 1
+#define WALK_NOISE 12
+#define WARMUP_MS 300000UL
+#define EVENT_PERIOD_MS 60000UL
+#define EVENT_DURATION_MS 10000UL
+
+
+void buildEnvironment(unsigned long resultsLatencyMs) {
+  mock_scan_backend_reset(4242);
+  mock_scan_backend_timing()->resultsLatencyMs = resultsLatencyMs;
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = ACCESS_POINTS_NUMBER;
+  row.SSIDprefix = "room";
+  row.strongestRSSI = -45;
+  row.RSSIspread = 30;
+  row.noise = QUIET_NOISE;
+  mock_scan_backend_add_synthetic_aps(&row);
+}
+
+
+void setWalking(int walking) {
+  for (int apIndex = 0; apIndex < mock_scan_backend_ap_number(); apIndex++) {
+    mock_scan_backend_ap(apIndex)->noise = walking ? WALK_NOISE : QUIET_NOISE;
+  }
+}
+
+
+void runMode(const char * modeName, int pipelined, unsigned long loopWorkMs, unsigned long processingMs, unsigned long resultsLatencyMs, int targeted, unsigned long simulatedMs) {
+
+  buildEnvironment(resultsLatencyMs);
+  multistatic_interference_radar_set_debug_level(0);
+  multistatic_interference_radar_set_scan_backend(mock_scan_backend());
+  multistatic_interference_radar_init(TRANSMITTERS_POOL_SIZE);
+  accessPoints.scanPlan = scanScheduler();
+  accessPoints.pipeline = scanPipeline();
+  accessPoints.scanResults = accessPoints.scanBuffers;
+  multistatic_interference_radar_enable_targeted_scan(targeted);
+
+  int threshold = 0;
+  unsigned long cycles = 0;
+  unsigned long loops = 0;
+  unsigned long eventStartMs = 0;
+  int eventPending = 0;
+  unsigned long events = 0;
+  unsigned long missedEvents = 0;
+  unsigned long latencySumMs = 0;
+  unsigned long latencyMaxMs = 0;
+  unsigned long falseAlarms = 0;
+
+  while (mock_scan_backend_clock() < WARMUP_MS + simulatedMs) {
+
+    unsigned long nowMs = mock_scan_backend_clock();
+    int walking = (nowMs >= WARMUP_MS) && (((nowMs - WARMUP_MS) % EVENT_PERIOD_MS) < EVENT_DURATION_MS);
+    if (walking && ((nowMs - WARMUP_MS) / EVENT_PERIOD_MS + 1 > events)) { // a new walk-in, timed from when it really started
+      eventStartMs = WARMUP_MS + ((nowMs - WARMUP_MS) / EVENT_PERIOD_MS) * EVENT_PERIOD_MS;
+      eventPending = 1;
+      events++;
+    }
+    if ((walking == 0) && (eventPending == 1)) { // walked out before being detected
+      eventPending = 0;
+      missedEvents++;
+    }
+    setWalking(walking);
+
+    int level = pipelined ? multistatic_interference_radar_pipelined() : multistatic_interference_radar();
+    loops++;
+
+    if (level != RADAR_RESULTS_PENDING) {
+      cycles++;
+      mock_scan_backend_advance(processingMs); // housekeeping and DSP time, not simulated by the host CPU
+      unsigned long publishMs = mock_scan_backend_clock();
+      if (publishMs < WARMUP_MS) {
+        if (level > threshold) {
+          threshold = level; // the quietest room we'll ever see
+        }
+      } else if (level > 2 * threshold) {
+        if (eventPending == 1) {
+          unsigned long latencyMs = publishMs - eventStartMs;
+          latencySumMs = latencySumMs + latencyMs;
+          if (latencyMs > latencyMaxMs) {
+            latencyMaxMs = latencyMs;
+          }
+          eventPending = 0;
+        } else if ((walking == 0) && (((publishMs - WARMUP_MS) % EVENT_PERIOD_MS) > 2 * EVENT_DURATION_MS)) {
+          falseAlarms++; // well after the walk-out
+        }
+      }
+    }
+
+    mock_scan_backend_advance(loopWorkMs); // the rest of the application loop
+  }
+
+  unsigned long detected = events - missedEvents - eventPending;
+  printf("mode=%s loop_work_ms=%lu cycles=%lu loops=%lu cycles_per_s=%.3f events=%lu detected=%lu mean_latency_ms=%.0f max_latency_ms=%lu false_alarms=%lu threshold=%d\n",
+         modeName, loopWorkMs, cycles, loops, cycles / ((WARMUP_MS + simulatedMs) / 1000.0), events, detected,
+         (detected > 0) ? (double) latencySumMs / detected : 0.0, latencyMaxMs, falseAlarms, 2 * threshold);
+}
+
+
+int main(int argc, char ** argv) {
+
+  unsigned long loopWorkMs = (argc > 1) ? (unsigned long) atol(argv[1]) : 50;
+  unsigned long processingMs = (argc > 2) ? (unsigned long) atol(argv[2]) : 20;
+  unsigned long resultsLatencyMs = (argc > 3) ? (unsigned long) atol(argv[3]) : 0;
+  int targeted = (argc > 4) ? atoi(argv[4]) : 1;
+  unsigned long simulatedMs = (argc > 5) ? (unsigned long) atol(argv[5]) * 1000UL : 3600UL * 1000UL;
+
+  if (loopWorkMs == 0) {
+    loopWorkMs = 1; // the pipelined loop needs time to pass between two polls
+  }
+
+  runMode("blocking", 0, loopWorkMs, processingMs, resultsLatencyMs, targeted, simulatedMs);
+  runMode("pipelined", 1, loopWorkMs, processingMs, resultsLatencyMs, targeted, simulatedMs);
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+// Where the time of a radar cycle goes: runs the unmodified cycle on the mock scan backend, with access points switching off and back on now and then,
+// and prints what multistatic_interference_radar_get_profile() reports: per stage count, mean, min, max, percentiles and histogram, and the churn counters.
+// The host time per cycle is printed too, the best of RUNS_NUMBER runs of the same cycles on fresh contexts (the run to run noise is larger than the probes):
+// build a second binary with -DRADAR_PROFILING=0 and pass its host_us_per_cycle to this one to get what the probes cost against the host processing time.
+// The mock scans take no host time, so this is the processing alone, and the probes have to stay under 1% of it.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o profile_report profile_report.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+//   g++ -std=gnu++11 -O2 -pthread -DRADAR_PROFILING=0 -o profile_report_off profile_report.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./profile_report [cycles=20000] [transmitters=8] [access points=24] [churn period in cycles=200, 0 = none] [host us per cycle without the probes, 0 = unknown]
+// for example:
+//   ./profile_report 20000 8 24 200 $(./profile_report_off | sed -n 's/.*host_us_per_cycle=\([0-9.]*\).*/\1/p')
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+
+#define CHURN_OFF_CYCLES 20 // how long a switched off access point stays off
+
+#define LOOP_DELAY_MS 100 // the application delay() between two cycles, not part of the cycle
+
+#define RUNS_NUMBER 5
+
+
+double runCycles(radarContext * radar, mockScanEnvironment * env, int cycles, int transmitters, int accessPointsNumber, int churnPeriod, double * radioMsPerCycle) { // returns the host us per cycle
+  mock_scan_backend_reset(env, 3);
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = accessPointsNumber;
+  mock_scan_backend_add_synthetic_aps(env, &row);
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_set_scan_backend(radar, mock_scan_backend(env));
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(radar, transmitters);
+  multistatic_interference_radar_enable_targeted_scan(radar, 1);
+  multistatic_interference_radar_enable_bootstrap(radar, 1);
+  multistatic_interference_radar_set_shadow_trackers(radar, 2);
+
+  int switchedOff = -1;
+  int switchedOffCycle = 0;
+  unsigned long startMs = mock_scan_backend_clock(env);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int cycle = 0; cycle < cycles; cycle++) {
+    if ((churnPeriod > 0) && (cycle % churnPeriod == churnPeriod - 1) && (switchedOff < 0)) { // one of the strongest goes away for a while
+      switchedOff = (cycle / churnPeriod) % transmitters;
+      mock_scan_backend_ap(env, switchedOff)->present = 0;
+      switchedOffCycle = cycle;
+    }
+    if ((switchedOff >= 0) && (cycle - switchedOffCycle >= CHURN_OFF_CYCLES)) {
+      mock_scan_backend_ap(env, switchedOff)->present = 1;
+      switchedOff = -1;
+    }
+    multistatic_interference_radar(radar);
+    mock_scan_backend_advance(env, LOOP_DELAY_MS);
+  }
+  *radioMsPerCycle = (double) (mock_scan_backend_clock(env) - startMs - (unsigned long) cycles * LOOP_DELAY_MS) / cycles; // simulated scan time
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / cycles;
+}
+
+
+int main(int argc, char ** argv) {
+
+  int cycles = (argc > 1) ? atoi(argv[1]) : 20000;
+  int transmitters = (argc > 2) ? atoi(argv[2]) : 8;
+  int accessPointsNumber = (argc > 3) ? atoi(argv[3]) : 24;
+  int churnPeriod = (argc > 4) ? atoi(argv[4]) : 200;
+  double baselineCycleUs = (argc > 5) ? atof(argv[5]) : 0;
+  if ((cycles < 1) || (transmitters < 1) || (transmitters > TRANSMITTERS_POOL_SIZE) || (accessPointsNumber < 1) || (accessPointsNumber > MOCK_MAX_ACCESS_POINTS) || (churnPeriod < 0) || (baselineCycleUs < 0)) {
+    printf("usage: %s [cycles=20000] [transmitters=8, 1 to %d] [access points=24, 1 to %d] [churn period in cycles=200, 0 = none] [host us per cycle without the probes, 0 = unknown]\n", argv[0], TRANSMITTERS_POOL_SIZE, MOCK_MAX_ACCESS_POINTS);
+    return 1;
+  }
+
+  radarContext * radar = NULL;
+  mockScanEnvironment * env = NULL;
+  double cycleUs = 0;
+  double radioMsPerCycle = 0;
+  for (int run = 0; run < RUNS_NUMBER; run++) { // the last run is the one reported
+    delete radar;
+    delete env;
+    radar = new radarContext;
+    env = new mockScanEnvironment;
+    double runUs = runCycles(radar, env, cycles, transmitters, accessPointsNumber, churnPeriod, &radioMsPerCycle);
+    cycleUs = ((run == 0) || (runUs < cycleUs)) ? runUs : cycleUs;
+  }
+
+  radarProfileReport report = multistatic_interference_radar_get_profile(radar);
+  printf("profiling=%d sample_interval=%u cycles=%d transmitters=%d access_points=%d churn_period=%d host_us_per_cycle=%.3f radio_ms_per_cycle=%.1f ticks_per_us=%.1f\n", report.compiledIn,
+         report.sampleInterval, cycles, transmitters, accessPointsNumber, churnPeriod, cycleUs, radioMsPerCycle, report.ticksPerUs);
+  for (int stage = 0; stage < RADAR_STAGES_NUMBER; stage++) {
+    const radarStageReport * stageReport = &report.stages[stage];
+    printf("stage=%-18s count=%-6u mean_us=%-8.3f min_us=%-8.3f p50_us=%-8.3f p90_us=%-8.3f p99_us=%-8.3f max_us=%-8.3f histogram=", multistatic_interference_radar_stage_name(stage),
+           stageReport->count, stageReport->meanUs, stageReport->minUs, stageReport->p50Us, stageReport->p90Us, stageReport->p99Us, stageReport->maxUs);
+    int printed = 0;
+    for (int bucket = 0; bucket < RADAR_PROFILE_BUCKETS; bucket++) { // non empty buckets only, as lower bound in us:count
+      if (stageReport->histogram[bucket] > 0) {
+        printf("%s%.3g:%u", (printed > 0) ? "," : "", ((bucket == 0) ? 0.0 : (double) (1ULL << bucket)) / report.ticksPerUs, stageReport->histogram[bucket]);
+        printed++;
+      }
+    }
+    printf("\n");
+  }
+  if (baselineCycleUs > 0) {
+    double probesUs = cycleUs - baselineCycleUs; // may come out slightly negative: the probes are within the run to run noise
+    printf("overhead probes_us_per_cycle=%.3f vs_host_processing=%.2f%% budget=1%% %s\n", probesUs, 100.0 * probesUs / baselineCycleUs, (probesUs < 0.01 * baselineCycleUs) ? "ok" : "OVER");
+  } else {
+    printf("overhead: pass the host_us_per_cycle of a -DRADAR_PROFILING=0 build to compute the probes overhead\n");
+  }
+  printf("counters cycles=%u inoperable_cycles=%u rankings=%u slot_assignments=%u slot_releases=%u shadow_promotions=%u filter_resets=%u\n", report.cycles,
+         report.inoperableCycles, report.rankings, report.slotAssignments, report.slotReleases, report.shadowPromotions, report.filterResets);
+
+  delete env;
+  delete radar;
+  return 0;
+}
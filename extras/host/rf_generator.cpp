@@ -0,0 +1,260 @@
+// Synthetic RF environment, see rf_generator.h
+
+#include "rf_generator.h"
+
+#include <math.h>
+#include <thread>
+
+
+#define RF_STREAM_SHADOWING 1 // independent random streams of the hash
+#define RF_STREAM_FADING 2
+
+
+uint64_t rfHash(uint32_t seed, uint32_t stream, uint32_t link, uint64_t step) { // splitmix64 finalizer of the packed coordinates
+  uint64_t value = ((uint64_t) seed << 32) ^ ((uint64_t) stream << 56) ^ ((uint64_t) link << 40) ^ step;
+  value = value + 0x9e3779b97f4a7c15ULL;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+
+double rfGaussian(uint64_t hash) { // Box-Muller on the two halves of the hash
+  double first = ((double) (hash >> 32) + 0.5) * (1.0 / 4294967296.0);
+  double second = ((double) (hash & 0xffffffffULL) + 0.5) * (1.0 / 4294967296.0);
+  return sqrt(-2.0 * log(first)) * cos(2.0 * M_PI * second);
+}
+
+
+double rfDistance(rfPoint first, rfPoint second) {
+  return sqrt((first.x - second.x) * (first.x - second.x) + (first.y - second.y) * (first.y - second.y));
+}
+
+
+double rfSegmentDistance(rfPoint point, rfPoint start, rfPoint end) { // from the point to the closest point of the segment
+  double dx = end.x - start.x;
+  double dy = end.y - start.y;
+  double lengthSquared = dx * dx + dy * dy;
+  double along = (lengthSquared > 0) ? ((point.x - start.x) * dx + (point.y - start.y) * dy) / lengthSquared : 0.0;
+  along = (along < 0) ? 0 : ((along > 1) ? 1 : along);
+  rfPoint closest;
+  closest.x = start.x + along * dx;
+  closest.y = start.y + along * dy;
+  return rfDistance(point, closest);
+}
+
+
+int rf_generator_body_position(const rfBody * body, double timeMs, rfPoint * position) {
+  const std::vector<rfWaypoint> & trajectory = body->trajectory;
+  if ((trajectory.size() == 0) || (timeMs < trajectory.front().timeMs) || (timeMs > trajectory.back().timeMs)) {
+    return 0;
+  }
+  size_t next = 1;
+  while ((next < trajectory.size()) && (trajectory[next].timeMs < timeMs)) {
+    next++;
+  }
+  if (next >= trajectory.size()) {
+    *position = trajectory.back().position;
+    return 1;
+  }
+  const rfWaypoint * from = &trajectory[next - 1];
+  const rfWaypoint * to = &trajectory[next];
+  double progress = (to->timeMs > from->timeMs) ? (timeMs - from->timeMs) / (to->timeMs - from->timeMs) : 1.0;
+  position->x = from->position.x + (to->position.x - from->position.x) * progress;
+  position->y = from->position.y + (to->position.y - from->position.y) * progress;
+  return 1;
+}
+
+
+uint32_t rfNextRandom(uint32_t * state) { // xorshift32, for the floor plan only
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+
+double rfUniform(uint32_t * state, double low, double high) {
+  return low + (high - low) * ((rfNextRandom(state) >> 8) * (1.0 / 16777216.0));
+}
+
+
+void rf_generator_floor_plan(rfEnvironment * env, int transmittersNumber, int bodiesNumber, double durationMs, uint32_t seed) {
+  const double walkSpeedMs = 1.0 / 1000.0; // 1 m/s, in m/ms
+  uint32_t state = (seed == 0) ? 1 : seed;
+
+  env->seed = seed;
+  env->receiver.x = 0.5;
+  env->receiver.y = 0.5;
+  env->transmitters.clear();
+  env->bodies.clear();
+
+  // transmitters evenly spread along the walls away from the receiver corner (from 30% to 90% of the perimeter, counterclockwise from the origin)
+  double perimeter = 2.0 * (env->widthM + env->heightM);
+  if (transmittersNumber > RF_MAX_TRANSMITTERS) {
+    transmittersNumber = RF_MAX_TRANSMITTERS;
+  }
+  for (int transmitterIndex = 0; transmitterIndex < transmittersNumber; transmitterIndex++) {
+    double along = perimeter * (0.3 + 0.6 * (transmitterIndex + 0.5) / transmittersNumber);
+    rfTransmitter transmitter;
+    if (along < env->widthM) {
+      transmitter.position.x = along;
+      transmitter.position.y = 0;
+    } else if (along < env->widthM + env->heightM) {
+      transmitter.position.x = env->widthM;
+      transmitter.position.y = along - env->widthM;
+    } else if (along < 2.0 * env->widthM + env->heightM) {
+      transmitter.position.x = 2.0 * env->widthM + env->heightM - along;
+      transmitter.position.y = env->heightM;
+    } else {
+      transmitter.position.x = 0;
+      transmitter.position.y = perimeter - along;
+    }
+    transmitter.txPowerDbm = -30.0 - 5.0 * (transmitterIndex % 3);
+    env->transmitters.push_back(transmitter);
+  }
+
+  // every person comes in through the door, wanders between a few spots with pauses, leaves through the door, stays away for a while, and so on
+  rfPoint door;
+  door.x = env->widthM / 2.0;
+  door.y = env->heightM;
+  for (int bodyIndex = 0; bodyIndex < bodiesNumber; bodyIndex++) {
+    double timeMs = rfUniform(&state, 60000.0, 300000.0); // the room starts empty: the filters settle
+    while (timeMs < durationMs) {
+      rfBody visit;
+      rfWaypoint waypoint;
+      waypoint.timeMs = timeMs;
+      waypoint.position = door;
+      visit.trajectory.push_back(waypoint);
+      int spots = 2 + (int) (rfNextRandom(&state) % 4);
+      for (int spot = 0; spot <= spots; spot++) {
+        rfPoint target = door; // the last leg goes back to the door
+        if (spot < spots) {
+          target.x = rfUniform(&state, 0.5, env->widthM - 0.5);
+          target.y = rfUniform(&state, 0.5, env->heightM - 0.5);
+        }
+        waypoint.timeMs = waypoint.timeMs + rfDistance(waypoint.position, target) / walkSpeedMs;
+        waypoint.position = target;
+        visit.trajectory.push_back(waypoint);
+        if (spot < spots) {
+          waypoint.timeMs = waypoint.timeMs + rfUniform(&state, 0.0, 20000.0); // standing there for a while
+          visit.trajectory.push_back(waypoint);
+        }
+      }
+      env->bodies.push_back(visit);
+      timeMs = waypoint.timeMs + rfUniform(&state, 60000.0, 600000.0);
+    }
+  }
+
+  // sorted by entry time
+  for (size_t sortedIndex = 1; sortedIndex < env->bodies.size(); sortedIndex++) {
+    for (size_t bodyIndex = sortedIndex; (bodyIndex > 0) && (env->bodies[bodyIndex].trajectory.front().timeMs < env->bodies[bodyIndex - 1].trajectory.front().timeMs); bodyIndex--) {
+      env->bodies[bodyIndex].trajectory.swap(env->bodies[bodyIndex - 1].trajectory);
+    }
+  }
+}
+
+
+void rf_generator_generate(const rfEnvironment * env, long firstStep, long stepsNumber, int8_t * rssi, rfGroundTruth * truth) {
+  int linksNumber = (int) env->transmitters.size();
+  if (linksNumber > RF_MAX_TRANSMITTERS) {
+    linksNumber = RF_MAX_TRANSMITTERS;
+  }
+
+  // per link constants: mean RSSI (path loss and shadowing) and geometry
+  double meanRSSI[RF_MAX_TRANSMITTERS];
+  double linkLengthM[RF_MAX_TRANSMITTERS];
+  for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+    const rfTransmitter * transmitter = &env->transmitters[linkIndex];
+    linkLengthM[linkIndex] = rfDistance(transmitter->position, env->receiver);
+    double distanceM = (linkLengthM[linkIndex] < 0.1) ? 0.1 : linkLengthM[linkIndex];
+    meanRSSI[linkIndex] = transmitter->txPowerDbm - 10.0 * env->pathLossExponent * log10(distanceM)
+                          + env->shadowingSigmaDb * rfGaussian(rfHash(env->seed, RF_STREAM_SHADOWING, linkIndex, 0));
+  }
+
+  std::vector<rfPoint> inRoom;
+  inRoom.reserve(16);
+  size_t firstCandidate = 0; // bodies are sorted by entry time: the leading ones that already left are skipped for good
+  double twoWidthsSquared = 2.0 * env->bodyWidthM * env->bodyWidthM;
+  double phasePerM = 2.0 * M_PI / env->wavelengthM;
+
+  for (long stepIndex = 0; stepIndex < stepsNumber; stepIndex++) {
+    long step = firstStep + stepIndex;
+    double timeMs = step * env->sampleIntervalMs;
+
+    inRoom.clear();
+    while ((firstCandidate < env->bodies.size()) && ((env->bodies[firstCandidate].trajectory.size() == 0) || (env->bodies[firstCandidate].trajectory.back().timeMs < timeMs))) {
+      firstCandidate++;
+    }
+    for (size_t bodyIndex = firstCandidate; bodyIndex < env->bodies.size(); bodyIndex++) {
+      const rfBody * body = &env->bodies[bodyIndex];
+      if ((body->trajectory.size() > 0) && (body->trajectory.front().timeMs > timeMs)) {
+        break;
+      }
+      rfPoint position;
+      if (rf_generator_body_position(body, timeMs, &position) == 1) {
+        inRoom.push_back(position);
+      }
+    }
+
+    int disturbedLinks = 0;
+    int8_t * stepRSSI = rssi + stepIndex * linksNumber;
+    for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+      rfPoint transmitterPosition = env->transmitters[linkIndex].position;
+      double value = meanRSSI[linkIndex];
+      double fadingVariance = env->fastFadingSigmaDb * env->fastFadingSigmaDb;
+      int disturbed = 0;
+
+      for (size_t bodyIndex = 0; bodyIndex < inRoom.size(); bodyIndex++) {
+        double offLinkM = rfSegmentDistance(inRoom[bodyIndex], transmitterPosition, env->receiver);
+        double excessM = rfDistance(transmitterPosition, inRoom[bodyIndex]) + rfDistance(inRoom[bodyIndex], env->receiver) - linkLengthM[linkIndex]; // extra length of the reflected path
+        value = value - env->bodyLossDb * exp(-offLinkM * offLinkM / twoWidthsSquared);
+        value = value + env->bodyScatterDb / (1.0 + excessM) * cos(phasePerM * excessM);
+        double extraFading = env->bodyFadingSigmaDb * exp(-offLinkM);
+        fadingVariance = fadingVariance + extraFading * extraFading;
+        if (offLinkM < env->bodyWidthM) {
+          disturbed = 1;
+        }
+      }
+      disturbedLinks = disturbedLinks + disturbed;
+
+      value = value + sqrt(fadingVariance) * rfGaussian(rfHash(env->seed, RF_STREAM_FADING, linkIndex, (uint64_t) step));
+      int rounded = (int) lround(value);
+      stepRSSI[linkIndex] = (int8_t) ((rounded > -1) ? -1 : ((rounded < -100) ? -100 : rounded));
+    }
+
+    if (truth != NULL) {
+      truth[stepIndex].timeMs = timeMs;
+      truth[stepIndex].occupancy = (int) inRoom.size();
+      truth[stepIndex].disturbedLinks = disturbedLinks;
+      if (inRoom.size() > 0) {
+        truth[stepIndex].position = inRoom[0];
+      }
+    }
+  }
+}
+
+
+void rf_generator_generate_parallel(const rfEnvironment * env, long firstStep, long stepsNumber, int8_t * rssi, rfGroundTruth * truth, int threadsNumber) {
+  if (threadsNumber <= 0) {
+    threadsNumber = (int) std::thread::hardware_concurrency();
+  }
+  if (threadsNumber > stepsNumber) {
+    threadsNumber = (int) stepsNumber;
+  }
+  if (threadsNumber <= 1) {
+    rf_generator_generate(env, firstStep, stepsNumber, rssi, truth);
+    return;
+  }
+
+  int linksNumber = (env->transmitters.size() > RF_MAX_TRANSMITTERS) ? RF_MAX_TRANSMITTERS : (int) env->transmitters.size();
+  std::vector<std::thread> workers;
+  long chunkSteps = (stepsNumber + threadsNumber - 1) / threadsNumber;
+  for (long chunkStart = 0; chunkStart < stepsNumber; chunkStart = chunkStart + chunkSteps) {
+    long chunkLength = (chunkStart + chunkSteps > stepsNumber) ? stepsNumber - chunkStart : chunkSteps;
+    workers.push_back(std::thread(rf_generator_generate, env, firstStep + chunkStart, chunkLength, rssi + chunkStart * linksNumber, (truth != NULL) ? truth + chunkStart : NULL));
+  }
+  for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++) {
+    workers[workerIndex].join();
+  }
+}
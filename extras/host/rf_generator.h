@@ -0,0 +1,119 @@
+// Synthetic RF environment for host (Linux) benchmarks of the multistatic interference radar library: RSSI streams with ground truth, no hardware.
+
+// A 2D floor plan (meters) holds a receiver, the transmitters and people walking along scripted trajectories. The RSSI of each link, at every step, is:
+// - log-distance path loss: txPowerDbm (RSSI at 1 m) - 10 * pathLossExponent * log10(distance),
+// - plus a static shadowing term per link, gaussian with shadowingSigmaDb (walls and furniture, drawn once per link from the seed),
+// - plus fast fading, gaussian with fastFadingSigmaDb at every step,
+// - plus the people: a body near the line of sight of a link attenuates it by up to bodyLossDb (gaussian profile over the distance from the link segment,
+//   bodyWidthM wide, about the first Fresnel zone at 2.4 GHz), and every body scatters a path whose phase follows the excess length of the reflection
+//   (multipath perturbation, bodyScatterDb at 1 m from the link, fading with the reflected path length), and adds bodyFadingSigmaDb of extra fading nearby.
+// The result is rounded to dBm and clamped to [-100, -1], as a radio would report it.
+// Every random number is a hash of (seed, link, step): the output does not depend on how the steps are split between threads, or on the order they are generated.
+
+#ifndef RF_GENERATOR_H
+#define RF_GENERATOR_H
+
+#include <stdint.h>
+#include <vector>
+
+
+#define RF_MAX_TRANSMITTERS 64 // links of one environment
+
+#define RF_BEACON_INTERVAL_MS 102.4 // the usual beacon interval, 100 TU
+
+
+typedef struct  rfPointStruct {
+
+double x = 0; // meters
+
+double y = 0;
+
+} rfPoint;
+
+
+typedef struct  rfTransmitterStruct {
+
+rfPoint position;
+
+double txPowerDbm = -35.0; // RSSI at 1 m
+
+} rfTransmitter;
+
+
+typedef struct  rfWaypointStruct {
+
+double timeMs = 0;
+
+rfPoint position;
+
+} rfWaypoint;
+
+
+typedef struct  rfBodyStruct { // a visit of a person: in the room from the first waypoint time to the last one, moving linearly between waypoints
+
+std::vector<rfWaypoint> trajectory; // sorted by time
+
+} rfBody;
+
+
+typedef struct  rfEnvironmentStruct {
+
+double widthM = 10.0; // floor plan size, informative (trajectories may leave it to leave the room)
+
+double heightM = 8.0;
+
+rfPoint receiver;
+
+std::vector<rfTransmitter> transmitters;
+
+std::vector<rfBody> bodies; // sorted by entry time
+
+double pathLossExponent = 3.0; // 2 = free space, 3 to 4 indoors
+
+double shadowingSigmaDb = 4.0;
+
+double fastFadingSigmaDb = 1.0;
+
+double bodyLossDb = 6.0;
+
+double bodyWidthM = 0.35;
+
+double bodyScatterDb = 3.0;
+
+double bodyFadingSigmaDb = 2.0;
+
+double wavelengthM = 0.125; // 2.4 GHz
+
+double sampleIntervalMs = RF_BEACON_INTERVAL_MS; // beacon rate, or the scan cycle time
+
+uint32_t seed = 1;
+
+} rfEnvironment;
+
+
+typedef struct  rfGroundTruthStruct { // one per step
+
+double timeMs = 0;
+
+int occupancy = 0; // people in the room
+
+int disturbedLinks = 0; // links with somebody in their line of sight (within bodyWidthM of the link segment)
+
+rfPoint position; // of the first person in the room, meaningless when occupancy = 0
+
+} rfGroundTruth;
+
+
+// current status: IMPLEMENTED
+void rf_generator_floor_plan(rfEnvironment *, int transmittersNumber, int bodiesNumber, double durationMs, uint32_t seed); // a ready made room: the receiver in a corner, the transmitters along the walls, people coming in, wandering, pausing and leaving
+
+// current status: IMPLEMENTED
+int rf_generator_body_position(const rfBody *, double timeMs, rfPoint * position); // returns 1 and the position if the person is in the room at that time, 0 otherwise
+
+// current status: IMPLEMENTED
+void rf_generator_generate(const rfEnvironment *, long firstStep, long stepsNumber, int8_t * rssi, rfGroundTruth * truth); // stepsNumber steps from firstStep: rssi[step * transmitters + link], truth[step] (truth may be NULL)
+
+// current status: IMPLEMENTED
+void rf_generator_generate_parallel(const rfEnvironment *, long firstStep, long stepsNumber, int8_t * rssi, rfGroundTruth * truth, int threadsNumber); // same output, the steps split between threads (0 = all cores)
+
+#endif
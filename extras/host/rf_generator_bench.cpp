@@ -0,0 +1,210 @@
+// Host benchmark on the synthetic RF environment (see rf_generator.h): a room with transmitters along the walls and people coming and going.
+// 1) generation: samples per second with 1 thread up to all cores, and the check that every thread count gives the very same stream,
+// 2) processing: the generated links fed sample by sample through multistatic_interference_radar_process() and through the batch kernel, samples per second,
+// 3) detection against the ground truth: the level is the sum of the valid link outputs, the threshold twice the highest level of the first, empty, minutes;
+//    the latency is from somebody entering the empty room to the first level above the threshold, "missed" if the room is empty again first,
+//    a false alarm is a rising edge above the threshold with the room empty for at least the settle time.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o rf_generator_bench rf_generator_bench.cpp rf_generator.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./rf_generator_bench [transmitters=16] [people=2] [simulated hours=4] [sample interval ms=102.4] [threads=all cores] [csv file of the first 10 minutes]
+
+#include "../../multistatic_interference_radar.h"
+#include "rf_generator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+#define SETTLE_MS 30000.0 // after the room empties, the windows still hold the disturbance for a while
+#define CSV_MS 600000.0
+
+
+double elapsedS(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+void processStream(radarContext * radar, const rfEnvironment * env, const std::vector<int8_t> & rssi, const std::vector<rfGroundTruth> & truth, int batchEngine) {
+  int linksNumber = (int) env->transmitters.size();
+  long stepsNumber = (long) truth.size();
+  std::vector<int> levels(stepsNumber, 0);
+
+  std::vector<transmitterData> links(linksNumber);
+  transmittersBatchData * batch = new transmittersBatchData;
+  batch->linksNumber = linksNumber;
+  batch->secondOrderFilter = radar->accessPoints.secondOrderFilter;
+  batch->secondOrderAttenutationCoefficient = radar->accessPoints.secondOrderAttenutationCoefficient;
+  for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+    batch->minimum_RSSI[linkIndex] = links[linkIndex].minimum_RSSI;
+    batch->varianceThreshold[linkIndex] = links[linkIndex].varianceThreshold;
+  }
+
+  int samples[MAX_ALLOWED_TRANSMITTERS_NUMBER];
+  int results[MAX_ALLOWED_TRANSMITTERS_NUMBER];
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (long step = 0; step < stepsNumber; step++) {
+    const int8_t * stepRSSI = &rssi[step * linksNumber];
+    int level = 0;
+    if (batchEngine == 1) {
+      for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+        samples[linkIndex] = stepRSSI[linkIndex];
+      }
+      multistatic_interference_radar_process_batch(samples, results, batch);
+    } else {
+      for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+        results[linkIndex] = multistatic_interference_radar_process(radar, stepRSSI[linkIndex], &links[linkIndex]);
+      }
+    }
+    for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+      if (results[linkIndex] > 0) {
+        level = level + results[linkIndex];
+      }
+    }
+    levels[step] = level;
+  }
+  double processS = elapsedS(start);
+  delete batch;
+
+  // the threshold: the empty room before anybody comes in
+  int threshold = 0;
+  long step = 0;
+  while ((step < stepsNumber) && (truth[step].occupancy == 0)) {
+    if ((truth[step].timeMs > SETTLE_MS) && (levels[step] > threshold)) {
+      threshold = levels[step];
+    }
+    step++;
+  }
+  threshold = 2 * threshold;
+
+  std::vector<double> latenciesMs;
+  int events = 0;
+  int missed = 0;
+  int falseAlarms = 0;
+  int pending = 0;
+  int above = 0;
+  double entryMs = 0;
+  double emptySinceMs = 0;
+  for (; step < stepsNumber; step++) {
+    if ((truth[step].occupancy > 0) && (step > 0) && (truth[step - 1].occupancy == 0)) {
+      events++;
+      pending = 1;
+      entryMs = truth[step].timeMs;
+    }
+    if ((truth[step].occupancy == 0) && (step > 0) && (truth[step - 1].occupancy > 0)) {
+      emptySinceMs = truth[step].timeMs;
+      if (pending == 1) {
+        missed++;
+        pending = 0;
+      }
+    }
+    if (levels[step] > threshold) {
+      if (pending == 1) {
+        latenciesMs.push_back(truth[step].timeMs - entryMs);
+        pending = 0;
+      } else if ((above == 0) && (truth[step].occupancy == 0) && (truth[step].timeMs - emptySinceMs > SETTLE_MS)) {
+        falseAlarms++;
+      }
+      above = 1;
+    } else {
+      above = 0;
+    }
+  }
+
+  std::sort(latenciesMs.begin(), latenciesMs.end());
+  double meanMs = 0;
+  for (size_t latencyIndex = 0; latencyIndex < latenciesMs.size(); latencyIndex++) {
+    meanMs = meanMs + latenciesMs[latencyIndex] / latenciesMs.size();
+  }
+  double hours = (stepsNumber * env->sampleIntervalMs) / 3600000.0;
+  printf("engine=%s samples=%ld process_samples_per_s=%.0f ns_per_sample=%.1f threshold=%d events=%d detected=%d missed=%d latency_ms mean=%.0f p50=%.0f p90=%.0f max=%.0f "
+         "false_alarms=%d false_alarms_per_h=%.2f\n",
+         batchEngine ? "batch" : "scalar", stepsNumber * linksNumber, stepsNumber * linksNumber / processS, processS * 1e9 / (stepsNumber * linksNumber), threshold,
+         events, (int) latenciesMs.size(), missed, meanMs, latenciesMs.empty() ? 0.0 : latenciesMs[latenciesMs.size() / 2],
+         latenciesMs.empty() ? 0.0 : latenciesMs[latenciesMs.size() * 9 / 10], latenciesMs.empty() ? 0.0 : latenciesMs.back(), falseAlarms, falseAlarms / hours);
+}
+
+
+int main(int argc, char ** argv) {
+
+  int transmitters = (argc > 1) ? atoi(argv[1]) : 16;
+  int people = (argc > 2) ? atoi(argv[2]) : 2;
+  double hours = (argc > 3) ? atof(argv[3]) : 4.0;
+  double sampleIntervalMs = (argc > 4) ? atof(argv[4]) : RF_BEACON_INTERVAL_MS;
+  int maxThreads = (argc > 5) ? atoi(argv[5]) : (int) std::thread::hardware_concurrency();
+  const char * csvName = (argc > 6) ? argv[6] : NULL;
+  if ((transmitters < 1) || (transmitters > MAX_ALLOWED_TRANSMITTERS_NUMBER) || (transmitters > RF_MAX_TRANSMITTERS) || (sampleIntervalMs <= 0) || (hours <= 0)) {
+    printf("transmitters: 1 to %d, positive duration and sample interval\n", (MAX_ALLOWED_TRANSMITTERS_NUMBER < RF_MAX_TRANSMITTERS) ? MAX_ALLOWED_TRANSMITTERS_NUMBER : RF_MAX_TRANSMITTERS);
+    return 1;
+  }
+  if (maxThreads < 1) {
+    maxThreads = 1;
+  }
+
+  rfEnvironment * env = new rfEnvironment;
+  env->sampleIntervalMs = sampleIntervalMs;
+  rf_generator_floor_plan(env, transmitters, people, hours * 3600000.0, 2024);
+  long stepsNumber = (long) (hours * 3600000.0 / sampleIntervalMs);
+  long samplesNumber = stepsNumber * transmitters;
+
+  // generation, 1 thread up to all cores: same output every time
+  std::vector<int8_t> rssi(samplesNumber);
+  std::vector<rfGroundTruth> truth(stepsNumber);
+  std::vector<int8_t> reference;
+  int mismatches = 0;
+  for (int threadsNumber = 1; threadsNumber <= maxThreads; threadsNumber = (threadsNumber * 2 > maxThreads && threadsNumber < maxThreads) ? maxThreads : threadsNumber * 2) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    rf_generator_generate_parallel(env, 0, stepsNumber, &rssi[0], &truth[0], threadsNumber);
+    double generateS = elapsedS(start);
+    if (reference.empty()) {
+      reference = rssi;
+    } else if (memcmp(&reference[0], &rssi[0], samplesNumber) != 0) {
+      mismatches++;
+    }
+    printf("generate threads=%d samples=%ld samples_per_s=%.0f simulated_speedup=%.0f identical=%d\n", threadsNumber, samplesNumber, samplesNumber / generateS,
+           hours * 3600.0 / generateS, (memcmp(&reference[0], &rssi[0], samplesNumber) == 0) ? 1 : 0);
+  }
+
+  long occupiedSteps = 0;
+  for (long step = 0; step < stepsNumber; step++) {
+    occupiedSteps = occupiedSteps + ((truth[step].occupancy > 0) ? 1 : 0);
+  }
+  printf("room transmitters=%d people=%d visits=%d simulated_h=%.1f sample_interval_ms=%.1f occupied=%.3f\n", transmitters, people, (int) env->bodies.size(), hours,
+         sampleIntervalMs, (double) occupiedSteps / stepsNumber);
+
+  if (csvName != NULL) {
+    FILE * csvFile = fopen(csvName, "w");
+    if (csvFile == NULL) {
+      printf("cannot write %s\n", csvName);
+      return 1;
+    }
+    fprintf(csvFile, "time_ms,occupancy,disturbed_links,x,y");
+    for (int linkIndex = 0; linkIndex < transmitters; linkIndex++) {
+      fprintf(csvFile, ",link%d", linkIndex);
+    }
+    fprintf(csvFile, "\n");
+    for (long step = 0; (step < stepsNumber) && (truth[step].timeMs < CSV_MS); step++) {
+      fprintf(csvFile, "%.1f,%d,%d,%.2f,%.2f", truth[step].timeMs, truth[step].occupancy, truth[step].disturbedLinks, truth[step].position.x, truth[step].position.y);
+      for (int linkIndex = 0; linkIndex < transmitters; linkIndex++) {
+        fprintf(csvFile, ",%d", rssi[step * transmitters + linkIndex]);
+      }
+      fprintf(csvFile, "\n");
+    }
+    fclose(csvFile);
+  }
+
+  radarContext * radar = new radarContext;
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  processStream(radar, env, rssi, truth, 0);
+  processStream(radar, env, rssi, truth, 1);
+
+  delete radar;
+  delete env;
+  return (mismatches == 0) ? 0 : 1;
+}
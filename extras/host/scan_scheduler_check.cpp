@@ -0,0 +1,168 @@
+// Host check of the scan scheduler: runs the unmodified radar cycle against the mock scan backend,
+// once with a full sweep every cycle and once with targeted scans, and reports the per link sample rate in simulated time.
+// Then it checks two corner cases of the targeted scheduler, and exits with 1 if any of them fails:
+// - partial_pool: fewer access points than transmitters, the free slots must not force a full sweep every cycle,
+// - single_miss: a tracked transmitter missed by one targeted scan keeps its slot and its filter, one gone for SCAN_TARGETED_MISS_LIMIT scans is replaced.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o scan_scheduler_check scan_scheduler_check.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./scan_scheduler_check [transmitters=4] [access points=24] [simulated seconds=3600] [miss probability=0.02]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+void buildEnvironment(int accessPointsNumber, double missProbability) {
+  mock_scan_backend_reset(12345);
+  mock_scan_backend_timing()->missProbability = missProbability;
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = accessPointsNumber;
+  row.RSSIstep = 7;
+  row.RSSIspread = 45;
+  mock_scan_backend_add_synthetic_aps(&row);
+}
+
+
+void runMode(const char * modeName, int targeted, int transmitters, unsigned long simulatedMs) {
+
+  multistatic_interference_radar_set_debug_level(0);
+  multistatic_interference_radar_set_scan_backend(mock_scan_backend());
+  multistatic_interference_radar_init(TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(transmitters);
+  accessPoints.scanPlan = scanScheduler();
+  multistatic_interference_radar_enable_targeted_scan(targeted);
+
+  unsigned long startMs = mock_scan_backend_clock();
+  unsigned long cycles = 0;
+  unsigned long linkSamples = 0; // samples processed on valid slots
+  unsigned long slotLosses = 0;
+
+  while (mock_scan_backend_clock() - startMs < simulatedMs) {
+    int validBefore = 0;
+    for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+      validBefore = validBefore + ((accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_VALID) && (accessPoints.BSSIDkeys[slotIndex] != 0));
+    }
+    multistatic_interference_radar();
+    cycles++;
+    int validAfter = 0;
+    for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+      validAfter = validAfter + ((accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_VALID) && (accessPoints.BSSIDkeys[slotIndex] != 0));
+    }
+    linkSamples = linkSamples + validAfter;
+    if (validAfter < validBefore) {
+      slotLosses = slotLosses + (validBefore - validAfter);
+    }
+  }
+
+  double simulatedSeconds = (mock_scan_backend_clock() - startMs) / 1000.0;
+  printf("mode=%s transmitters=%d cycles=%lu simulated_s=%.1f radio_ms_per_cycle=%.1f link_samples_per_s=%.3f full_sweeps=%lu targeted_cycles=%lu channel_scans=%lu slot_losses=%lu\n",
+         modeName, transmitters, cycles, simulatedSeconds, (double) accessPoints.scanPlan.totalScanMs / cycles,
+         linkSamples / simulatedSeconds / transmitters, accessPoints.scanPlan.fullSweeps, accessPoints.scanPlan.targetedCycles, accessPoints.scanPlan.channelScans, slotLosses);
+}
+
+
+int countValidSlots() {
+  int valid = 0;
+  for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+    valid = valid + ((accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_VALID) && (accessPoints.BSSIDkeys[slotIndex] != 0));
+  }
+  return valid;
+}
+
+
+void startTargeted(int transmitters) {
+  multistatic_interference_radar_set_debug_level(0);
+  multistatic_interference_radar_set_scan_backend(mock_scan_backend());
+  multistatic_interference_radar_init(TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(transmitters);
+  accessPoints.scanPlan = scanScheduler();
+  multistatic_interference_radar_enable_targeted_scan(1);
+}
+
+
+int checkPartialPool() { // 4 access points for 8 transmitters: after the first sweeps, most cycles must be targeted
+  buildEnvironment(4, 0.0);
+  startTargeted(8);
+  for (int cycle = 0; cycle < 200; cycle++) {
+    multistatic_interference_radar();
+  }
+  int ok = (countValidSlots() == 4) && (accessPoints.scanPlan.targetedCycles > 3 * accessPoints.scanPlan.fullSweeps);
+  printf("check=partial_pool access_points=4 transmitters=8 cycles=200 valid_slots=%d full_sweeps=%lu targeted_cycles=%lu result=%s\n", countValidSlots(),
+         accessPoints.scanPlan.fullSweeps, accessPoints.scanPlan.targetedCycles, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+
+int nextCycleTargeted() {
+  return (accessPoints.scanPlan.fullSweepRequested == 0) && (accessPoints.scanPlan.cyclesSinceFullSweep + SCAN_TARGETED_MISS_LIMIT < accessPoints.scanPlan.fullSweepInterval - 1);
+}
+
+
+int checkSingleMiss() { // the first slot transmitter goes missing for one targeted scan, then for SCAN_TARGETED_MISS_LIMIT of them
+  buildEnvironment(24, 0.0);
+  startTargeted(4);
+  int cycle = 0;
+  while ((cycle < 1000) && ((countValidSlots() < 4) || (accessPoints.transmittersData[0].sampleBufferValid == 0) || (nextCycleTargeted() == 0))) {
+    multistatic_interference_radar();
+    cycle++;
+  }
+  uint64_t trackedKey = accessPoints.BSSIDkeys[0];
+  int apIndex = -1;
+  for (int index = 0; index < mock_scan_backend_ap_number(); index++) {
+    if (memcmp(mock_scan_backend_ap(index)->BSSID, accessPoints.BSSIDs[0], 6) == 0) {
+      apIndex = index;
+    }
+  }
+  if (apIndex < 0) {
+    printf("check=single_miss result=FAIL (no tracked transmitter after %d cycles)\n", cycle);
+    return 0;
+  }
+
+  mock_scan_backend_ap(apIndex)->present = 0; // one missed targeted scan
+  multistatic_interference_radar();
+  mock_scan_backend_ap(apIndex)->present = 1;
+  int keptSlot = (accessPoints.BSSIDkeys[0] == trackedKey) && (accessPoints.APslotStatus[0] == AP_SLOT_STATUS_VALID);
+  int keptFilter = (accessPoints.transmittersData[0].sampleBufferValid == 1) && (accessPoints.transmittersData[0].resetRequest == 0);
+  multistatic_interference_radar();
+  int noSweep = (accessPoints.scanPlan.fullSweepRequested == 0);
+
+  while ((cycle < 2000) && (nextCycleTargeted() == 0)) {
+    multistatic_interference_radar();
+    cycle++;
+  }
+  mock_scan_backend_ap(apIndex)->present = 0; // gone for good
+  for (int miss = 0; miss < SCAN_TARGETED_MISS_LIMIT; miss++) {
+    multistatic_interference_radar();
+  }
+  int replaced = (accessPoints.BSSIDkeys[0] != trackedKey);
+  mock_scan_backend_ap(apIndex)->present = 1;
+
+  int ok = keptSlot && keptFilter && noSweep && replaced;
+  printf("check=single_miss kept_slot=%d kept_filter=%d no_sweep=%d replaced_after_%d_misses=%d result=%s\n", keptSlot, keptFilter, noSweep, SCAN_TARGETED_MISS_LIMIT, replaced, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+
+int main(int argc, char ** argv) {
+
+  int transmitters = (argc > 1) ? atoi(argv[1]) : 4;
+  int accessPointsNumber = (argc > 2) ? atoi(argv[2]) : 24;
+  unsigned long simulatedMs = (argc > 3) ? (unsigned long) atol(argv[3]) * 1000UL : 3600UL * 1000UL;
+  double missProbability = (argc > 4) ? atof(argv[4]) : 0.02;
+
+  buildEnvironment(accessPointsNumber, missProbability);
+  runMode("full_sweep", 0, transmitters, simulatedMs);
+
+  buildEnvironment(accessPointsNumber, missProbability);
+  runMode("targeted", 1, transmitters, simulatedMs);
+
+  int ok = checkPartialPool();
+  ok = checkSingleMiss() && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// Runs the unmodified radar cycle on the mock backend, driven by a scenario file (see mock_scenario.h), as fast as the host can go.
+// The application loop is simulated: one cycle (blocking or pipelined), then the scenario loop_delay. Reported:
+// - cycles, simulated and wall time, and how much faster than real time it ran,
+// - coverage: the fraction of the cycles every tracked link has a valid output, and the transmitter replacements (cold loads and shadow promotions),
+// - for every mark of the scenario, the detection latency: the simulated time from the mark to the first published level above the threshold
+//   (the threshold is learned before the first mark when not given: twice the highest level seen), "missed" if the next mark or the end comes first,
+// - the rising edges above the threshold with no pending mark, i.e. false alarms if the marks are the whole ground truth.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o scenario_run scenario_run.cpp mock_scenario.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./scenario_run <scenario file> [transmitters=4] [targeted scan=1] [pipelined=0] [threshold=0 (learned)] [csv file of the published levels]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+#include "mock_scenario.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+
+int main(int argc, char ** argv) {
+
+  if (argc < 2) {
+    printf("usage: %s <scenario file> [transmitters=4] [targeted scan=1] [pipelined=0] [threshold=0 (learned)] [csv file]\n", argv[0]);
+    return 1;
+  }
+  int transmitters = (argc > 2) ? atoi(argv[2]) : 4;
+  int targeted = (argc > 3) ? atoi(argv[3]) : 1;
+  int pipelined = (argc > 4) ? atoi(argv[4]) : 0;
+  int threshold = (argc > 5) ? atoi(argv[5]) : 0;
+  const char * csvName = (argc > 6) ? argv[6] : NULL;
+
+  mockScanEnvironment * env = new mockScanEnvironment;
+  mockScenario * scenario = new mockScenario;
+  if (mock_scenario_load(scenario, env, argv[1]) != 0) {
+    printf("%s: %s\n", argv[1], scenario->error);
+    return 1;
+  }
+  FILE * csvFile = NULL;
+  if (csvName != NULL) {
+    csvFile = fopen(csvName, "w");
+    if (csvFile == NULL) {
+      printf("cannot write %s\n", csvName);
+      return 1;
+    }
+    fprintf(csvFile, "time_ms,level\n");
+  }
+
+  radarContext * radar = new radarContext;
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_set_scan_backend(radar, mock_scan_backend(env));
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(radar, transmitters);
+  multistatic_interference_radar_enable_targeted_scan(radar, targeted);
+
+  int learnThreshold = (threshold <= 0) ? 1 : 0;
+  long cycles = 0;
+  long validCycles = 0;
+  long unmarkedAlarms = 0;
+  int above = 0;
+  size_t marksSeen = 0;
+  int markPending = 0;
+  unsigned long markMs = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  while (mock_scan_backend_clock(env) < scenario->durationMs) {
+
+    int level = pipelined ? multistatic_interference_radar_pipelined(radar) : multistatic_interference_radar(radar);
+    mock_scenario_update(scenario); // the marks up to the publication time
+
+    while (marksSeen < scenario->marks.size()) {
+      const mockScenarioMark * mark = &scenario->marks[marksSeen];
+      if (markPending == 1) {
+        printf("mark=%s at_s=%.1f latency_ms=missed\n", scenario->marks[marksSeen - 1].label, markMs / 1000.0);
+      }
+      if (learnThreshold == 1) {
+        threshold = 2 * threshold;
+        learnThreshold = 0;
+      }
+      markPending = 1;
+      markMs = mark->timeMs;
+      marksSeen++;
+    }
+
+    if (level != RADAR_RESULTS_PENDING) {
+      unsigned long publishMs = mock_scan_backend_clock(env);
+      cycles++;
+      int validLinks = 0;
+      for (int slotIndex = 0; slotIndex < transmitters; slotIndex++) {
+        if (radar->accessPoints.latestVariances[slotIndex] >= 0) {
+          validLinks++;
+        }
+      }
+      if (validLinks == transmitters) {
+        validCycles++;
+      }
+      if (csvFile != NULL) {
+        fprintf(csvFile, "%lu,%d\n", publishMs, level);
+      }
+      if (learnThreshold == 1) {
+        if (level > threshold) {
+          threshold = level; // the quietest room we'll ever see
+        }
+      } else if (level > threshold) {
+        if (markPending == 1) {
+          printf("mark=%s at_s=%.1f latency_ms=%lu\n", scenario->marks[marksSeen - 1].label, markMs / 1000.0, publishMs - markMs);
+          markPending = 0;
+        } else if (above == 0) {
+          unmarkedAlarms++;
+        }
+        above = 1;
+      } else {
+        above = 0;
+      }
+    }
+
+    mock_scan_backend_advance(env, (scenario->loopDelayMs > 0) ? scenario->loopDelayMs : (pipelined ? 1 : 0)); // the pipelined loop needs time to pass between two polls
+  }
+  if (markPending == 1) {
+    printf("mark=%s at_s=%.1f latency_ms=missed\n", scenario->marks[marksSeen - 1].label, markMs / 1000.0);
+  }
+
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double simulatedS = mock_scan_backend_clock(env) / 1000.0;
+  radarShadows * shadows = &radar->accessPoints.shadows;
+  printf("scenario=%s mode=%s scan=%s transmitters=%d cycles=%ld simulated_s=%.0f wall_s=%.2f speedup=%.0f coverage=%.4f replacements=%lu cold_loads=%lu "
+         "marks=%lu unmarked_alarms=%ld threshold=%d\n",
+         argv[1], pipelined ? "pipelined" : "blocking", targeted ? "targeted" : "full_sweep", transmitters, cycles, simulatedS, wallS,
+         (wallS > 0) ? simulatedS / wallS : 0.0, (cycles > 0) ? (double) validCycles / cycles : 0.0,
+         shadows->coldLoads + shadows->promotedWarm + shadows->promotedBooting, shadows->coldLoads, (unsigned long) scenario->marks.size(), unmarkedAlarms, threshold);
+
+  if (csvFile != NULL) {
+    fclose(csvFile);
+  }
+  delete radar;
+  delete scenario;
+  delete env;
+  return 0;
+}
@@ -0,0 +1,179 @@
+// Host benchmark of the hot standby shadow trackers under access point churn.
+// The strongest access points (the ones the radar tracks) are switched off now and then for a few minutes, on a schedule that only depends on the simulated clock,
+// and every scan may miss an access point now and then (a single miss is enough for checkDeadTransmitters() to drop a slot). Each replacement is either a cold load,
+// blind until its windows are full, or a shadow promotion. Reported per configuration:
+// - coverage: the fraction of the link cycles (after the first all-valid cycle) with a valid output, and the blind link time per replacement,
+// - the replacements split into cold loads and promoted shadows (warm, or still booting),
+// - the cost: radio time per cycle (with targeted scans the shadow channels are scanned too) and the host wall time per cycle, next to the cost of one filter update.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o shadow_churn_bench shadow_churn_bench.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./shadow_churn_bench [transmitters=4] [simulated hours=6] [churn period s=180] [miss probability=0.01]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+
+#define ACCESS_POINTS_NUMBER 16
+#define DOWNTIME_MIN_S 60
+#define DOWNTIME_MAX_S 600
+
+
+uint32_t nextRandom(uint32_t * state) { // xorshift32
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+
+void buildEnvironment(mockScanEnvironment * env, double missProbability) {
+  mock_scan_backend_reset(env, 4242);
+  mock_scan_backend_timing(env)->missProbability = missProbability;
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = ACCESS_POINTS_NUMBER;
+  row.RSSIstep = 2;
+  row.noise = 2;
+  mock_scan_backend_add_synthetic_aps(env, &row);
+}
+
+
+double filterUpdateNs() { // one multistatic_interference_radar_process() call, the per cycle cost of a shadow
+  radarContext * radar = new radarContext;
+  transmitterData * link = new transmitterData;
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  uint32_t state = 99;
+  int checksum = 0;
+  const int updates = 4000000;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int update = 0; update < updates; update++) {
+    checksum = checksum + multistatic_interference_radar_process(radar, -60 + (int) (nextRandom(&state) % 7) - 3, link);
+  }
+  double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  if (checksum == 42) { // keeps the loop alive
+    printf("\n");
+  }
+  delete link;
+  delete radar;
+  return elapsedNs / updates;
+}
+
+
+void churnRun(int transmitters, int shadowsNumber, int targeted, int batch, double hours, int churnPeriodS, double missProbability) {
+
+  mockScanEnvironment * env = new mockScanEnvironment;
+  radarContext * radar = new radarContext;
+  buildEnvironment(env, missProbability);
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_set_scan_backend(radar, mock_scan_backend(env));
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(radar, transmitters);
+  multistatic_interference_radar_enable_targeted_scan(radar, targeted);
+  multistatic_interference_radar_enable_batch_processing(radar, batch);
+  multistatic_interference_radar_set_shadow_trackers(radar, shadowsNumber);
+
+  // churn schedule: every churnPeriodS one of the strongest transmitters + 2 access points goes off for a while, same script for every configuration
+  uint32_t churnState = 2024;
+  unsigned long nextChurnMs = (unsigned long) churnPeriodS * 1000;
+  unsigned long returnMs[ACCESS_POINTS_NUMBER] = {0};
+  int churnEvents = 0;
+
+  unsigned long endMs = (unsigned long) (hours * 3600.0 * 1000.0);
+  long cycles = 0;
+  long measuredLinkCycles = 0;
+  long blindLinkCycles = 0;
+  double blindLinkMs = 0;
+  int measuring = 0;
+  unsigned long coldLoadsAtStart = 0;
+  unsigned long promotedWarmAtStart = 0;
+  unsigned long promotedBootingAtStart = 0;
+  double wallNs = 0;
+
+  while (mock_scan_backend_clock(env) < endMs) {
+    unsigned long nowMs = mock_scan_backend_clock(env);
+    for (int apIndex = 0; apIndex < ACCESS_POINTS_NUMBER; apIndex++) {
+      if ((mock_scan_backend_ap(env, apIndex)->present == 0) && (nowMs >= returnMs[apIndex])) {
+        mock_scan_backend_ap(env, apIndex)->present = 1;
+      }
+    }
+    if (nowMs >= nextChurnMs) {
+      int victim = (int) (nextRandom(&churnState) % (uint32_t) (transmitters + 2));
+      int downtimeS = DOWNTIME_MIN_S + (int) (nextRandom(&churnState) % (uint32_t) (DOWNTIME_MAX_S - DOWNTIME_MIN_S));
+      if (mock_scan_backend_ap(env, victim)->present == 1) {
+        mock_scan_backend_ap(env, victim)->present = 0;
+        returnMs[victim] = nowMs + (unsigned long) downtimeS * 1000;
+        churnEvents++;
+      }
+      nextChurnMs = nextChurnMs + (unsigned long) churnPeriodS * 1000;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    multistatic_interference_radar(radar);
+    wallNs = wallNs + std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    double cycleMs = (double) (mock_scan_backend_clock(env) - nowMs);
+    cycles++;
+
+    radarShadows * shadows = &radar->accessPoints.shadows;
+    int blindLinks = 0;
+    for (int slotIndex = 0; slotIndex < transmitters; slotIndex++) {
+      if (radar->accessPoints.latestVariances[slotIndex] < 0) {
+        blindLinks++;
+      }
+    }
+    if ((measuring == 0) && (blindLinks == 0)) { // the first boot is the same for everybody, measure from the first all-valid cycle
+      measuring = 1;
+      coldLoadsAtStart = shadows->coldLoads;
+      promotedWarmAtStart = shadows->promotedWarm;
+      promotedBootingAtStart = shadows->promotedBooting;
+    }
+    if (measuring == 1) {
+      measuredLinkCycles = measuredLinkCycles + transmitters;
+      blindLinkCycles = blindLinkCycles + blindLinks;
+      blindLinkMs = blindLinkMs + blindLinks * cycleMs;
+    }
+  }
+
+  radarShadows * shadows = &radar->accessPoints.shadows;
+  unsigned long coldLoads = shadows->coldLoads - coldLoadsAtStart;
+  unsigned long promotedWarm = shadows->promotedWarm - promotedWarmAtStart;
+  unsigned long promotedBooting = shadows->promotedBooting - promotedBootingAtStart;
+  unsigned long replacements = coldLoads + promotedWarm + promotedBooting;
+  printf("shadows=%d scan=%s engine=%s cycles=%ld churn_events=%d replacements=%lu promoted_warm=%lu promoted_booting=%lu cold_loads=%lu dropped_shadows=%lu "
+         "coverage=%.4f blind_s_per_replacement=%.1f radio_ms_per_cycle=%.1f wall_us_per_cycle=%.2f\n",
+         shadowsNumber, targeted ? "targeted" : "full_sweep", batch ? "batch" : "scalar", cycles, churnEvents, replacements, promotedWarm, promotedBooting, coldLoads,
+         shadows->droppedShadows, (measuredLinkCycles > 0) ? 1.0 - (double) blindLinkCycles / measuredLinkCycles : 0.0,
+         (replacements > 0) ? blindLinkMs / 1000.0 / replacements : 0.0, (double) mock_scan_backend_clock(env) / cycles, wallNs / 1000.0 / cycles);
+
+  delete radar;
+  delete env;
+}
+
+
+int main(int argc, char ** argv) {
+
+  int transmitters = (argc > 1) ? atoi(argv[1]) : 4;
+  double hours = (argc > 2) ? atof(argv[2]) : 6.0;
+  int churnPeriodS = (argc > 3) ? atoi(argv[3]) : 180;
+  double missProbability = (argc > 4) ? atof(argv[4]) : 0.01;
+  if ((transmitters < 1) || (transmitters > ACCESS_POINTS_NUMBER - 6) || (churnPeriodS < 1)) {
+    printf("transmitters: 1 to %d, churn period: at least 1 s\n", ACCESS_POINTS_NUMBER - 6);
+    return 1;
+  }
+
+  printf("filter_update_ns=%.1f\n", filterUpdateNs());
+
+  const int shadowsTested[] = {0, 1, 2, 4};
+  for (int targeted = 0; targeted <= 1; targeted++) {
+    for (unsigned int testIndex = 0; testIndex < sizeof(shadowsTested) / sizeof(shadowsTested[0]); testIndex++) {
+      churnRun(transmitters, shadowsTested[testIndex], targeted, 0, hours, churnPeriodS, missProbability);
+    }
+  }
+  churnRun(transmitters, 2, 1, 1, hours, churnPeriodS, missProbability); // the batch kernel takes the promoted windows too
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+// Host check of the streaming ingest: a radiotap capture is replayed by a producer thread through multistatic_interference_radar_stream_ingest_frame()
+// while the main thread drains the ring with multistatic_interference_radar_stream_process(), exactly like the ESP32 WiFi task and loop do.
+// The transmitters are discovered first, with one scan cycle on a mock backend populated with the access points found in the capture.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o stream_replay_check stream_replay_check.cpp pcap_stream_source.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./stream_replay_check synth capture.pcap [seconds=120] [access points=8]   writes a synthetic capture: beacons every 102.4 ms, someone walking in between 60% and 75% of it
+//   ./stream_replay_check capture.pcap [transmitters=4]                         replays a capture, prints the per link sample rates and a detection timeline
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+#include "pcap_stream_source.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+
+
+#define TIMELINE_BUCKET_MS 5000
+#define MAX_TIMELINE_BUCKETS 1024
+#define FULL_SCAN_PERIOD_MS 4000 // what a full sweep costs, one sample per link each (see scan_scheduler_check)
+
+
+int synthesizeCapture(const char * path, int seconds, int accessPointsNumber) {
+  FILE * file = pcap_stream_create(path);
+  if (file == NULL) {
+    return -1;
+  }
+  uint32_t random = 777;
+  int frames = 0;
+  for (uint32_t timeUs = 0; timeUs < (uint32_t) seconds * 1000000UL; timeUs = timeUs + 102400) { // 100 TU beacon interval
+    int walking = (timeUs >= (uint32_t) seconds * 600000UL) && (timeUs < (uint32_t) seconds * 750000UL);
+    for (int apIndex = 0; apIndex < accessPointsNumber; apIndex++) {
+      uint8_t BSSID[6] = {0x02, 0, 0, 0, 0, (uint8_t) apIndex};
+      char SSID[SSID_STORAGE_LEN];
+      snprintf(SSID, sizeof(SSID), "stream%d", apIndex);
+      random ^= random << 13;
+      random ^= random >> 17;
+      random ^= random << 5;
+      int noise = walking ? 10 : 1;
+      int rssi = -45 - (apIndex * 4) % 30 + (int) (random % (uint32_t) (2 * noise + 1)) - noise;
+      pcap_stream_write_beacon(file, timeUs / 1000 + apIndex * 7, BSSID, SSID, 1 + (apIndex * 5) % 13, rssi);
+      frames++;
+    }
+  }
+  fclose(file);
+  printf("synthesized %d beacons from %d access points over %d seconds into %s\n", frames, accessPointsNumber, seconds, path);
+  return 0;
+}
+
+
+int discoverAccessPoints(const char * path) { // the mock backend gets every BSSID beaconing in the capture, at its mean RSSI
+  pcapStream stream;
+  pcapFrame frame;
+  long RSSIsum[MOCK_MAX_ACCESS_POINTS] = {0};
+  long beacons[MOCK_MAX_ACCESS_POINTS] = {0};
+
+  if (pcap_stream_open(&stream, path) != 0) {
+    return -1;
+  }
+  mock_scan_backend_reset(1);
+  while (pcap_stream_next(&stream, &frame) == 1) {
+    if ((frame.frameLength < 36) || (frame.frame[0] != 0x80) || (frame.rssi == ABSOLUTE_RSSI_LIMIT)) { // beacons with a signal only
+      continue;
+    }
+    int apIndex = 0;
+    while ((apIndex < mock_scan_backend_ap_number()) && (memcmp(mock_scan_backend_ap(apIndex)->BSSID, &frame.frame[16], 6) != 0)) {
+      apIndex++;
+    }
+    if (apIndex == mock_scan_backend_ap_number()) {
+      mockAccessPoint ap;
+      memcpy(ap.BSSID, &frame.frame[16], 6);
+      ap.noise = 0;
+      // tagged elements: SSID (0) and DS parameter set (3)
+      for (int offset = 36; offset + 2 <= frame.frameLength; offset = offset + 2 + frame.frame[offset + 1]) {
+        int elementLength = frame.frame[offset + 1];
+        if (offset + 2 + elementLength > frame.frameLength) {
+          break;
+        }
+        if ((frame.frame[offset] == 0) && (elementLength < SSID_STORAGE_LEN)) {
+          memcpy(ap.SSID, &frame.frame[offset + 2], elementLength);
+          ap.SSID[elementLength] = 0;
+        }
+        if ((frame.frame[offset] == 3) && (elementLength == 1)) {
+          ap.channel = frame.frame[offset + 2];
+        }
+      }
+      if (mock_scan_backend_add_ap(&ap) < 0) {
+        continue;
+      }
+    }
+    RSSIsum[apIndex] = RSSIsum[apIndex] + frame.rssi;
+    beacons[apIndex]++;
+  }
+  pcap_stream_close(&stream);
+
+  for (int apIndex = 0; apIndex < mock_scan_backend_ap_number(); apIndex++) {
+    mock_scan_backend_ap(apIndex)->RSSI = (int) (RSSIsum[apIndex] / beacons[apIndex]);
+  }
+  return mock_scan_backend_ap_number();
+}
+
+
+int replayCapture(const char * path, int transmitters) {
+
+  int accessPointsNumber = discoverAccessPoints(path);
+  if (accessPointsNumber <= 0) {
+    printf("no usable radiotap beacons in %s\n", path);
+    return -1;
+  }
+
+  multistatic_interference_radar_set_debug_level(0);
+  multistatic_interference_radar_set_scan_backend(mock_scan_backend());
+  multistatic_interference_radar_set_txN_limit(transmitters);
+  multistatic_interference_radar(); // one discovery cycle loads the slots
+  multistatic_interference_radar_enable_stream(1);
+
+  // producer: the capture, as fast as the ring allows
+  std::atomic<int> producerDone(0);
+  std::atomic<uint32_t> producerTimeMs(0);
+  long waits = 0;
+  std::thread producer([&]() {
+    pcapStream stream;
+    pcapFrame frame;
+    if (pcap_stream_open(&stream, path) == 0) {
+      while (pcap_stream_next(&stream, &frame) == 1) {
+        if (frame.rssi == ABSOLUTE_RSSI_LIMIT) {
+          continue;
+        }
+        producerTimeMs.store(frame.timestampMs, std::memory_order_relaxed);
+        while (multistatic_interference_radar_stream_ingest_frame(frame.frame, frame.frameLength, frame.rssi, frame.timestampMs) < 0) { // offline: wait for the consumer instead of losing the beacon
+          waits++;
+          std::this_thread::yield();
+        }
+      }
+      pcap_stream_close(&stream);
+    }
+    producerDone.store(1, std::memory_order_release);
+  });
+
+  // consumer: the loop
+  int timeline[MAX_TIMELINE_BUCKETS] = {0};
+  int buckets = 0;
+  while (1) {
+    int done = producerDone.load(std::memory_order_acquire);
+    int processed = multistatic_interference_radar_stream_process();
+    if (processed > 0) {
+      int bucket = accessPoints.stream.latestTimestampMs / TIMELINE_BUCKET_MS;
+      int level = 0;
+      for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+        if (accessPoints.latestVariances[slotIndex] > 0) {
+          level = level + accessPoints.latestVariances[slotIndex];
+        }
+      }
+      if ((bucket < MAX_TIMELINE_BUCKETS) && (level > timeline[bucket])) {
+        timeline[bucket] = level;
+      }
+      if (bucket + 1 > buckets) {
+        buckets = (bucket < MAX_TIMELINE_BUCKETS) ? bucket + 1 : MAX_TIMELINE_BUCKETS;
+      }
+    }
+    if (done && (processed == 0)) {
+      break;
+    }
+  }
+  producer.join();
+
+  double seconds = producerTimeMs.load() / 1000.0;
+  printf("capture=%s access_points=%d transmitters=%d seconds=%.1f frames_seen=%u accepted=%u processed=%u discarded=%u producer_waits=%ld\n",
+         path, accessPointsNumber, accessPoints.transmittersListLen, seconds, accessPoints.stream.framesSeen.load(), accessPoints.stream.framesAccepted.load(),
+         accessPoints.stream.samplesProcessed, accessPoints.stream.samplesDiscarded, waits);
+  double perLinkRate = accessPoints.stream.samplesProcessed / seconds / accessPoints.transmittersListLen;
+  printf("per_link_samples_per_s=%.2f full_scan_samples_per_s=%.2f gain=%.1fx\n", perLinkRate, 1000.0 / FULL_SCAN_PERIOD_MS, perLinkRate * FULL_SCAN_PERIOD_MS / 1000.0);
+  printf("timeline (max total variance per %d s):", TIMELINE_BUCKET_MS / 1000);
+  for (int bucket = 0; bucket < buckets; bucket++) {
+    printf(" %d", timeline[bucket]);
+  }
+  printf("\n");
+  return 0;
+}
+
+
+int main(int argc, char ** argv) {
+
+  if ((argc >= 3) && (strcmp(argv[1], "synth") == 0)) {
+    return synthesizeCapture(argv[2], (argc > 3) ? atoi(argv[3]) : 120, (argc > 4) ? atoi(argv[4]) : 8) == 0 ? 0 : 1;
+  }
+  if (argc >= 2) {
+    return replayCapture(argv[1], (argc > 2) ? atoi(argv[2]) : 4) == 0 ? 0 : 1;
+  }
+  printf("usage: %s synth capture.pcap [seconds] [access points] | %s capture.pcap [transmitters]\n", argv[0], argv[0]);
+  return 1;
+}
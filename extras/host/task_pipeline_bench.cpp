@@ -0,0 +1,137 @@
+// Host benchmark of the threaded mode: throughput and queue latency of the acquisition / signal processing task pair,
+// against the single threaded loop calling multistatic_interference_radar(), on the same simulated environment.
+// The mock backend scans instantly on its simulated clock; here each scan also blocks the calling thread for scanUs real microseconds,
+// like the radio blocks the acquisition task on the ESP32.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o task_pipeline_bench task_pipeline_bench.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./task_pipeline_bench [scan us=2000] [transmitters=16] [access points=64] [seconds=3]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+int scanUs = 2000;
+
+radarScanBackend benchBackend;
+
+
+int benchStartScan(void * backendData, int channel, int dwellMs) {
+  int scanRes = mock_scan_backend()->startScan(backendData, channel, dwellMs);
+  std::this_thread::sleep_for(std::chrono::microseconds(scanUs)); // the radio at work
+  return scanRes;
+}
+
+
+unsigned long benchMicros() {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return (unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+void buildEnvironment(int accessPointsNumber) {
+  mock_scan_backend_reset(99);
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = accessPointsNumber;
+  row.SSIDprefix = "bench";
+  row.SSIDvariety = 8; // a few shared SSIDs, like a real building
+  row.RSSIstep = 1;
+  row.noise = 2;
+  mock_scan_backend_add_synthetic_aps(&row);
+  benchBackend = *mock_scan_backend();
+  benchBackend.startScan = benchStartScan;
+  benchBackend.startScanAsync = NULL; // blocking scans only: the acquisition task blocks on them
+  benchBackend.scanStatus = NULL;
+}
+
+
+void printLatencies(const char * name, std::vector<unsigned long> & values) {
+  if (values.empty()) {
+    printf(" %s_p50_us=0 %s_p99_us=0 %s_max_us=0", name, name, name);
+    return;
+  }
+  std::sort(values.begin(), values.end());
+  printf(" %s_p50_us=%lu %s_p99_us=%lu %s_max_us=%lu", name, values[values.size() / 2], name, values[(values.size() * 99) / 100], name, values.back());
+}
+
+
+void runSerial(int transmitters, int accessPointsNumber, double seconds) {
+  buildEnvironment(accessPointsNumber);
+  multistatic_interference_radar_set_debug_level(0);
+  multistatic_interference_radar_set_scan_backend(&benchBackend);
+  multistatic_interference_radar_init(TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(transmitters);
+
+  std::vector<unsigned long> ages;
+  unsigned long cycles = 0;
+  unsigned long startUs = benchMicros();
+  while (benchMicros() - startUs < seconds * 1e6) {
+    unsigned long cycleStartUs = benchMicros();
+    multistatic_interference_radar();
+    ages.push_back(benchMicros() - cycleStartUs); // scan start to result
+    cycles++;
+  }
+  double elapsed = (benchMicros() - startUs) / 1e6;
+  printf("mode=serial scan_us=%d transmitters=%d cycles=%lu cycles_per_s=%.1f", scanUs, transmitters, cycles, cycles / elapsed);
+  printLatencies("age", ages);
+  printf("\n");
+}
+
+
+void runThreaded(int transmitters, int accessPointsNumber, double seconds) {
+  buildEnvironment(accessPointsNumber);
+  multistatic_interference_radar_set_debug_level(0);
+  multistatic_interference_radar_set_scan_backend(&benchBackend);
+  multistatic_interference_radar_init(TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(transmitters);
+
+  std::vector<unsigned long> queueLatencies;
+  std::vector<unsigned long> ages;
+  radarResult result;
+  unsigned long firstCycle = accessPoints.tasks.processedCycles.load();
+
+  multistatic_interference_radar_start_tasks();
+  unsigned long startUs = benchMicros();
+  while (benchMicros() - startUs < seconds * 1e6) {
+    while (multistatic_interference_radar_poll_result(&result) == 1) {
+      queueLatencies.push_back(result.publishedUs - result.acquiredUs); // waiting for the DSP task plus processing
+      ages.push_back(result.publishedUs - result.scanStartUs);
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(200)); // the application loop
+  }
+  multistatic_interference_radar_stop_tasks();
+  double elapsed = (benchMicros() - startUs) / 1e6;
+  while (multistatic_interference_radar_poll_result(&result) == 1) {
+    queueLatencies.push_back(result.publishedUs - result.acquiredUs);
+    ages.push_back(result.publishedUs - result.scanStartUs);
+  }
+
+  unsigned long cycles = accessPoints.tasks.processedCycles.load() - firstCycle;
+  printf("mode=threaded scan_us=%d transmitters=%d cycles=%lu cycles_per_s=%.1f acquired=%u results_dropped=%u", scanUs, transmitters, cycles, cycles / elapsed,
+         accessPoints.tasks.acquiredCycles.load(), accessPoints.tasks.resultsDropped.load());
+  printLatencies("queue", queueLatencies);
+  printLatencies("age", ages);
+  printf("\n");
+}
+
+
+int main(int argc, char ** argv) {
+
+  scanUs = (argc > 1) ? atoi(argv[1]) : 2000;
+  int transmitters = (argc > 2) ? atoi(argv[2]) : 16;
+  int accessPointsNumber = (argc > 3) ? atoi(argv[3]) : 64;
+  double seconds = (argc > 4) ? atof(argv[4]) : 3.0;
+
+  runSerial(transmitters, accessPointsNumber, seconds);
+  runThreaded(transmitters, accessPointsNumber, seconds);
+
+  return 0;
+}
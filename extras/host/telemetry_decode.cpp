@@ -0,0 +1,314 @@
+// Converts a capture of the radar binary telemetry (see the telemetry section of multistatic_interference_radar.h) into CSV, or into columnar files:
+// one little endian array per column (int32, the BSSIDs as uint64 keys) and a schema.txt listing them, ready for numpy.fromfile() or a Parquet converter.
+// Two helper modes run the unmodified radar on the mock scan backend, with the beacon stream fed by synthetic beacons (10 per second per access point):
+// - capture: the telemetry of a few hundred cycles on stdout, to try the decoder on,
+// - compare: the bytes the same data take as telemetry and as CSV text, per cycle and per second, against what a 115200 baud UART carries,
+//   and a lossless check: every decoded cycle row against the radar state read right after its cycle.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o telemetry_decode telemetry_decode.cpp telemetry_decoder.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./telemetry_decode <capture file, - for stdin> [csv | columns <output directory>]
+//   ./telemetry_decode capture [cycles=200] [access points=16] > capture.bin
+//   ./telemetry_decode compare [cycles=500] [access points=16]
+
+#include "telemetry_decoder.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+
+
+#define UART_BYTES_PER_S 11520 // 115200 baud, 10 bits per byte
+
+#define CYCLE_DELAY_MS 1000 // between two cycles, as in the example sketch
+
+#define STREAM_SLICE_MS 100 // the beacons are processed this often during the delay
+
+#define BEACONS_PER_S 10 // per access point, for the projection at beacon rate
+
+
+int formatCSVRow(const telemetryRow * row, char * text, int textLength) {
+  return snprintf(text, textLength, "%u,%s,%u,%d,%d,%02X:%02X:%02X:%02X:%02X:%02X,%d,%d,%d,%d,%d\n", row->sequence, (row->kind == TELEMETRY_RECORD_CYCLE) ? "cycle" : "sample",
+                  row->timestampMs, row->detectionLevel, row->slot, row->BSSID[0], row->BSSID[1], row->BSSID[2], row->BSSID[3], row->BSSID[4], row->BSSID[5],
+                  row->channel, row->alarm, row->RSSI, row->average, row->variance);
+}
+
+#define CSV_HEADER "sequence,kind,timestamp_ms,level,slot,bssid,channel,alarm,rssi,average,variance\n"
+
+
+void printCSVRow(const telemetryRow * row, void * /* userData */) {
+  char text[160];
+  formatCSVRow(row, text, sizeof(text));
+  fputs(text, stdout);
+}
+
+
+typedef struct  columnsStruct {
+std::vector<int32_t> sequence, kind, timestampMs, level, slot, channel, alarm, RSSI, average, variance;
+std::vector<uint64_t> BSSID;
+} columns;
+
+
+void appendColumnsRow(const telemetryRow * row, void * userData) {
+  columns * table = (columns *) userData;
+  uint64_t key = 0;
+  for (int byteIndex = 0; byteIndex < 6; byteIndex++) {
+    key = (key << 8) | row->BSSID[byteIndex];
+  }
+  table->sequence.push_back((int32_t) row->sequence);
+  table->kind.push_back(row->kind);
+  table->timestampMs.push_back((int32_t) row->timestampMs);
+  table->level.push_back(row->detectionLevel);
+  table->slot.push_back(row->slot);
+  table->BSSID.push_back(key);
+  table->channel.push_back(row->channel);
+  table->alarm.push_back(row->alarm);
+  table->RSSI.push_back(row->RSSI);
+  table->average.push_back(row->average);
+  table->variance.push_back(row->variance);
+}
+
+
+template <typename T>
+int writeColumn(const char * directory, const char * name, const char * type, const std::vector<T> & values, FILE * schema) { // host byte order: little endian on the usual hosts
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s.bin", directory, name);
+  FILE * columnFile = fopen(path, "wb");
+  if (columnFile == NULL) {
+    fprintf(stderr, "cannot write %s\n", path);
+    return -1;
+  }
+  if (values.size() > 0) {
+    fwrite(values.data(), sizeof(T), values.size(), columnFile);
+  }
+  fclose(columnFile);
+  fprintf(schema, "%s %s %lu\n", name, type, (unsigned long) values.size());
+  return 0;
+}
+
+
+int decode(const char * fileName, const char * format, const char * directory) {
+  FILE * captureFile = (strcmp(fileName, "-") == 0) ? stdin : fopen(fileName, "rb");
+  if (captureFile == NULL) {
+    fprintf(stderr, "cannot read %s\n", fileName);
+    return 1;
+  }
+  int columnar = (strcmp(format, "columns") == 0) ? 1 : 0;
+  if ((columnar == 1) && (directory == NULL)) {
+    fprintf(stderr, "columns needs an output directory\n");
+    return 1;
+  }
+
+  telemetryDecoder * decoder = new telemetryDecoder;
+  columns table;
+  if (columnar == 0) {
+    fputs(CSV_HEADER, stdout);
+  }
+  uint8_t piece[4096];
+  size_t pieceLength;
+  while ((pieceLength = fread(piece, 1, sizeof(piece), captureFile)) > 0) {
+    telemetry_decoder_feed(decoder, piece, (int) pieceLength, (columnar == 1) ? appendColumnsRow : printCSVRow, &table);
+  }
+  if (captureFile != stdin) {
+    fclose(captureFile);
+  }
+
+  int result = 0;
+  if (columnar == 1) {
+    mkdir(directory, 0755);
+    char path[512];
+    snprintf(path, sizeof(path), "%s/schema.txt", directory);
+    FILE * schema = fopen(path, "w");
+    if (schema == NULL) {
+      fprintf(stderr, "cannot write %s\n", path);
+      return 1;
+    }
+    fprintf(schema, "# column type rows, one <column>.bin file each; kind: %d cycle, %d sample; bssid: 48 bit key, first byte highest\n", TELEMETRY_RECORD_CYCLE, TELEMETRY_RECORD_SAMPLE);
+    result = writeColumn(directory, "sequence", "uint32", table.sequence, schema) | writeColumn(directory, "kind", "int32", table.kind, schema) |
+             writeColumn(directory, "timestamp_ms", "uint32", table.timestampMs, schema) | writeColumn(directory, "level", "int32", table.level, schema) |
+             writeColumn(directory, "slot", "int32", table.slot, schema) | writeColumn(directory, "bssid", "uint64", table.BSSID, schema) |
+             writeColumn(directory, "channel", "int32", table.channel, schema) | writeColumn(directory, "alarm", "int32", table.alarm, schema) |
+             writeColumn(directory, "rssi", "int32", table.RSSI, schema) | writeColumn(directory, "average", "int32", table.average, schema) |
+             writeColumn(directory, "variance", "int32", table.variance, schema);
+    fclose(schema);
+  }
+  fprintf(stderr, "chunks=%u records=%u rows=%u lost_chunks=%u crc_errors=%u malformed_chunks=%u skipped_bytes=%u\n", decoder->chunks, decoder->records, decoder->rows,
+          decoder->lostChunks, decoder->crcErrors, decoder->malformedChunks, decoder->skippedBytes);
+  delete decoder;
+  return (result == 0) ? 0 : 1;
+}
+
+
+void setupRadar(radarContext * radar, mockScanEnvironment * env, int accessPointsNumber) {
+  mock_scan_backend_reset(env, 11);
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = accessPointsNumber;
+  mock_scan_backend_add_synthetic_aps(env, &row);
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_set_scan_backend(radar, mock_scan_backend(env));
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(radar, accessPointsNumber);
+  multistatic_interference_radar_enable_bootstrap(radar, 1);
+  multistatic_interference_radar_enable_stream(radar, 1);
+}
+
+
+void feedBeacons(radarContext * radar, mockScanEnvironment * env, uint32_t fromMs, uint32_t toMs) { // every access point beacons every 102 ms, on the producer side
+  uint8_t frame[36] = {0x80, 0x00}; // beacon: frame control, then the addresses, fixed parameters left at 0
+  memset(&frame[4], 0xFF, 6);
+  for (int apIndex = 0; apIndex < mock_scan_backend_ap_number(env); apIndex++) {
+    mockAccessPoint * ap = mock_scan_backend_ap(env, apIndex);
+    memcpy(&frame[10], ap->BSSID, 6);
+    memcpy(&frame[16], ap->BSSID, 6);
+    for (uint32_t timeMs = fromMs + (apIndex * 7) % 100; timeMs < toMs; timeMs = timeMs + 102) {
+      int rssi = ap->RSSI + (rand() % (2 * ap->noise + 1)) - ap->noise;
+      multistatic_interference_radar_stream_ingest_frame(radar, frame, sizeof(frame), rssi, timeMs);
+    }
+  }
+}
+
+
+typedef struct  compareStateStruct {
+std::vector<telemetryRow> expected; // the cycle rows read from the radar right after each cycle
+std::vector<telemetryRow> decoded; // the cycle rows decoded from the chunks, as they leave the node
+long sampleRows = 0;
+long csvBytes = 0; // the same rows as CSV text
+telemetryDecoder decoder;
+} compareState;
+
+
+void compareRow(const telemetryRow * row, void * userData) {
+  compareState * state = (compareState *) userData;
+  char text[160];
+  state->csvBytes = state->csvBytes + formatCSVRow(row, text, sizeof(text));
+  if (row->kind == TELEMETRY_RECORD_SAMPLE) {
+    state->sampleRows++;
+  } else {
+    state->decoded.push_back(*row);
+  }
+}
+
+
+long countMismatches(const compareState * state) { // after the run: a chunk may leave the node within the cycle, before its expected rows are read
+  long mismatches = labs((long) state->decoded.size() - (long) state->expected.size());
+  for (size_t rowIndex = 0; (rowIndex < state->decoded.size()) && (rowIndex < state->expected.size()); rowIndex++) {
+    const telemetryRow * row = &state->decoded[rowIndex];
+    const telemetryRow * expected = &state->expected[rowIndex];
+    if ((row->slot != expected->slot) || (row->timestampMs != expected->timestampMs) || (row->RSSI != expected->RSSI) || (row->average != expected->average) ||
+        (row->variance != expected->variance) || (row->alarm != expected->alarm) || (row->channel != expected->channel) || (memcmp(row->BSSID, expected->BSSID, 6) != 0)) {
+      mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+
+void compareSink(const uint8_t * chunk, int length, void * sinkData) { // decodes the chunks as they leave the node
+  compareState * state = (compareState *) sinkData;
+  telemetry_decoder_feed(&state->decoder, chunk, length, compareRow, state);
+}
+
+
+void recordExpectedRows(radarContext * radar, mockScanEnvironment * env, compareState * state) { // what the cycle record just encoded must decode to
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    if (radar->accessPoints.APslotStatus[slotIndex] != AP_SLOT_STATUS_VALID) {
+      continue;
+    }
+    telemetryRow row;
+    row.timestampMs = (uint32_t) mock_scan_backend_clock(env);
+    row.slot = slotIndex;
+    memcpy(row.BSSID, radar->accessPoints.BSSIDs[slotIndex], 6);
+    row.channel = radar->accessPoints.channels[slotIndex];
+    row.alarm = (radar->accessPoints.transmittersData[slotIndex].alarmStatus != 0) ? 1 : 0;
+    row.RSSI = radar->accessPoints.transmittersData[slotIndex].latestReceivedSample;
+    row.average = radar->accessPoints.transmittersData[slotIndex].mobileAverage;
+    row.variance = radar->accessPoints.latestVariances[slotIndex];
+    state->expected.push_back(row);
+  }
+}
+
+
+void runCycle(radarContext * radar, mockScanEnvironment * env, compareState * state) { // one cycle, then the beacons of the delay, processed as the loop would
+  multistatic_interference_radar(radar);
+  if (state != NULL) {
+    recordExpectedRows(radar, env, state);
+  }
+  for (int sliceMs = 0; sliceMs < CYCLE_DELAY_MS; sliceMs = sliceMs + STREAM_SLICE_MS) {
+    uint32_t sliceStartMs = (uint32_t) mock_scan_backend_clock(env);
+    mock_scan_backend_advance(env, STREAM_SLICE_MS);
+    feedBeacons(radar, env, sliceStartMs, (uint32_t) mock_scan_backend_clock(env));
+    multistatic_interference_radar_stream_process(radar);
+  }
+}
+
+
+int main(int argc, char ** argv) {
+
+  if (argc < 2) {
+    printf("usage: %s <capture file, - for stdin> [csv | columns <output directory>] | capture [cycles=200] [access points=16] | compare [cycles=500] [access points=16]\n", argv[0]);
+    return 1;
+  }
+
+  int capture = (strcmp(argv[1], "capture") == 0) ? 1 : 0;
+  int compare = (strcmp(argv[1], "compare") == 0) ? 1 : 0;
+  if ((capture == 0) && (compare == 0)) {
+    return decode(argv[1], (argc > 2) ? argv[2] : "csv", (argc > 3) ? argv[3] : NULL);
+  }
+
+  int cycles = (argc > 2) ? atoi(argv[2]) : (capture ? 200 : 500);
+  int accessPointsNumber = (argc > 3) ? atoi(argv[3]) : 16;
+  if ((cycles < 1) || (accessPointsNumber < 1) || (accessPointsNumber > MOCK_MAX_ACCESS_POINTS) || (accessPointsNumber > TRANSMITTERS_POOL_SIZE)) {
+    fprintf(stderr, "cycles >= 1, access points 1 to %d\n", (MOCK_MAX_ACCESS_POINTS < TRANSMITTERS_POOL_SIZE) ? MOCK_MAX_ACCESS_POINTS : TRANSMITTERS_POOL_SIZE);
+    return 1;
+  }
+  radarContext * radar = new radarContext;
+  mockScanEnvironment * env = new mockScanEnvironment;
+  srand(5);
+  setupRadar(radar, env, accessPointsNumber);
+
+  if (capture == 1) {
+    multistatic_interference_radar_enable_telemetry(radar, 1);
+    for (int cycle = 0; cycle < cycles; cycle++) {
+      runCycle(radar, env, NULL);
+    }
+    multistatic_interference_radar_enable_telemetry(radar, 0);
+    fflush(stdout);
+    fprintf(stderr, "cycles=%d access_points=%d chunks=%u bytes=%u records=%u\n", cycles, accessPointsNumber, radar->telemetry.chunksSent, radar->telemetry.bytesSent,
+            radar->telemetry.recordsSent);
+  } else {
+    compareState * state = new compareState;
+    multistatic_interference_radar_set_telemetry_sink(radar, compareSink, state);
+    multistatic_interference_radar_enable_telemetry(radar, 1);
+    for (int cycle = 0; cycle < cycles; cycle++) {
+      runCycle(radar, env, state);
+    }
+    multistatic_interference_radar_enable_telemetry(radar, 0);
+
+    double seconds = mock_scan_backend_clock(env) / 1000.0;
+    double telemetryRate = radar->telemetry.bytesSent / seconds;
+    double csvRate = state->csvBytes / seconds;
+    printf("cycles=%d access_points=%d simulated_s=%.0f cycle_rows=%ld sample_rows=%ld streamed_samples=%u chunks=%u lost_chunks=%u crc_errors=%u\n", cycles, accessPointsNumber,
+           seconds, (long) state->decoded.size(), state->sampleRows, radar->accessPoints.stream.samplesProcessed, state->decoder.chunks, state->decoder.lostChunks, state->decoder.crcErrors);
+    printf("format=telemetry bytes=%u bytes_per_row=%.2f bytes_per_s=%.0f uart_load=%.2f\n", radar->telemetry.bytesSent,
+           (double) radar->telemetry.bytesSent / ((long) state->decoded.size() + state->sampleRows), telemetryRate, telemetryRate / UART_BYTES_PER_S);
+    printf("format=csv bytes=%ld bytes_per_row=%.2f bytes_per_s=%.0f uart_load=%.2f\n", state->csvBytes, (double) state->csvBytes / ((long) state->decoded.size() + state->sampleRows),
+           csvRate, csvRate / UART_BYTES_PER_S);
+    double rowBytes = (double) radar->telemetry.bytesSent / ((long) state->decoded.size() + state->sampleRows);
+    double csvRowBytes = (double) state->csvBytes / ((long) state->decoded.size() + state->sampleRows);
+    for (int links = 4; links <= 64; links = links * 4) { // every link streaming all its beacons, e.g. all the transmitters on one channel
+      printf("beacon_rate_projection links=%d rows_per_s=%d telemetry_uart_load=%.2f csv_uart_load=%.2f\n", links, links * BEACONS_PER_S,
+             links * BEACONS_PER_S * rowBytes / UART_BYTES_PER_S, links * BEACONS_PER_S * csvRowBytes / UART_BYTES_PER_S);
+    }
+    printf("lossless_check cycle_rows=%lu expected=%lu mismatches=%ld sample_rows_vs_streamed=%ld\n", (unsigned long) state->decoded.size(),
+           (unsigned long) state->expected.size(), countMismatches(state), state->sampleRows - (long) radar->accessPoints.stream.samplesProcessed);
+    delete state;
+  }
+
+  delete env;
+  delete radar;
+  return 0;
+}
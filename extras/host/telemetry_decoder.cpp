@@ -0,0 +1,226 @@
+// Binary telemetry decoder, see telemetry_decoder.h
+
+#include "telemetry_decoder.h"
+
+#include <string.h>
+
+
+
+uint32_t telemetry_crc32(const uint8_t * bytes, int length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (int byteIndex = 0; byteIndex < length; byteIndex++) {
+    crc = crc ^ bytes[byteIndex];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+  }
+  return ~crc;
+}
+
+
+int telemetryGetVarint(const uint8_t * bytes, int length, int * position, uint32_t * value) { // returns 0 on success, -1 if truncated or longer than 5 bytes
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift = shift + 7) {
+    if (*position >= length) {
+      return -1;
+    }
+    uint8_t byte = bytes[*position];
+    (*position)++;
+    result = result | ((uint32_t) (byte & 0x7F) << shift);
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+
+int telemetryGetDelta(const uint8_t * bytes, int length, int * position, int32_t * previous) { // adds the zigzag delta to previous, modulo 2^32
+  uint32_t zigzag = 0;
+  if (telemetryGetVarint(bytes, length, position, &zigzag) != 0) {
+    return -1;
+  }
+  uint32_t delta = (zigzag >> 1) ^ (0 - (zigzag & 1));
+  *previous = (int32_t) ((uint32_t) *previous + delta);
+  return 0;
+}
+
+
+typedef struct  telemetrySlotStateStruct {
+uint8_t BSSID[6];
+int channel;
+int32_t RSSI;
+int32_t average;
+int32_t variance;
+} telemetrySlotState;
+
+
+int telemetryGetLinkValues(const uint8_t * bytes, int length, int * position, telemetrySlotState * slotState, telemetryRow * row) {
+  if ((telemetryGetDelta(bytes, length, position, &slotState->RSSI) != 0) || (telemetryGetDelta(bytes, length, position, &slotState->average) != 0) ||
+      (telemetryGetDelta(bytes, length, position, &slotState->variance) != 0)) {
+    return -1;
+  }
+  memcpy(row->BSSID, slotState->BSSID, 6);
+  row->channel = slotState->channel;
+  row->RSSI = slotState->RSSI;
+  row->average = slotState->average;
+  row->variance = slotState->variance;
+  return 0;
+}
+
+
+int telemetry_decode_payload(const uint8_t * payload, int payloadLength, uint32_t sequence, telemetryRowCallback callback, void * userData, uint32_t * records) {
+  static const telemetrySlotState emptySlot = { {0}, 0, 0, 0, 0 };
+  telemetrySlotState slots[TELEMETRY_DECODER_MAX_SLOTS];
+  for (int slotIndex = 0; slotIndex < TELEMETRY_DECODER_MAX_SLOTS; slotIndex++) {
+    slots[slotIndex] = emptySlot;
+  }
+  int32_t timestampMs = 0;
+  int rows = 0;
+  int position = 0;
+
+  while (position < payloadLength) {
+    int recordType = payload[position];
+    position++;
+    if (records != NULL) {
+      (*records)++;
+    }
+
+    if (recordType == TELEMETRY_RECORD_LINK) {
+      if ((position + TELEMETRY_LINK_RECORD_LEN - 1 > payloadLength) || (payload[position] >= TELEMETRY_DECODER_MAX_SLOTS)) {
+        return -1;
+      }
+      telemetrySlotState * slotState = &slots[payload[position]];
+      *slotState = emptySlot; // a new transmitter on the slot: its deltas restart
+      memcpy(slotState->BSSID, &payload[position + 1], 6);
+      slotState->channel = payload[position + 7];
+      position = position + TELEMETRY_LINK_RECORD_LEN - 1;
+
+    } else if (recordType == TELEMETRY_RECORD_CYCLE) {
+      telemetryRow row;
+      row.kind = TELEMETRY_RECORD_CYCLE;
+      row.sequence = sequence;
+      int32_t detectionLevel = 0;
+      uint32_t linksNumber = 0;
+      if ((telemetryGetDelta(payload, payloadLength, &position, &timestampMs) != 0) || (telemetryGetDelta(payload, payloadLength, &position, &detectionLevel) != 0) ||
+          (telemetryGetVarint(payload, payloadLength, &position, &linksNumber) != 0) || (linksNumber > TELEMETRY_DECODER_MAX_SLOTS)) {
+        return -1;
+      }
+      int bitmapLength = ((int) linksNumber + 7) / 8;
+      if (position + 2 * bitmapLength > payloadLength) {
+        return -1;
+      }
+      const uint8_t * validBitmap = &payload[position];
+      const uint8_t * alarmBitmap = &payload[position + bitmapLength];
+      position = position + 2 * bitmapLength;
+      row.timestampMs = (uint32_t) timestampMs;
+      row.detectionLevel = detectionLevel;
+      int validLinks = 0;
+      for (int slotIndex = 0; slotIndex < (int) linksNumber; slotIndex++) {
+        if ((validBitmap[slotIndex / 8] & (1 << (slotIndex % 8))) == 0) {
+          continue;
+        }
+        row.slot = slotIndex;
+        row.alarm = ((alarmBitmap[slotIndex / 8] & (1 << (slotIndex % 8))) != 0) ? 1 : 0;
+        if (telemetryGetLinkValues(payload, payloadLength, &position, &slots[slotIndex], &row) != 0) {
+          return -1;
+        }
+        callback(&row, userData);
+        rows++;
+        validLinks++;
+      }
+      if (validLinks == 0) { // keeps the detection level of the cycle
+        row.slot = -1;
+        callback(&row, userData);
+        rows++;
+      }
+
+    } else if (recordType == TELEMETRY_RECORD_SAMPLE) {
+      telemetryRow row;
+      row.kind = TELEMETRY_RECORD_SAMPLE;
+      row.sequence = sequence;
+      uint32_t slotAlarm = 0;
+      if ((telemetryGetVarint(payload, payloadLength, &position, &slotAlarm) != 0) || ((slotAlarm >> 1) >= TELEMETRY_DECODER_MAX_SLOTS) ||
+          (telemetryGetDelta(payload, payloadLength, &position, &timestampMs) != 0)) {
+        return -1;
+      }
+      row.slot = (int) (slotAlarm >> 1);
+      row.alarm = (int) (slotAlarm & 1);
+      row.timestampMs = (uint32_t) timestampMs;
+      if (telemetryGetLinkValues(payload, payloadLength, &position, &slots[row.slot], &row) != 0) {
+        return -1;
+      }
+      callback(&row, userData);
+      rows++;
+
+    } else {
+      return -1;
+    }
+  }
+  return rows;
+}
+
+
+void telemetry_decoder_reset(telemetryDecoder * decoder) {
+  *decoder = telemetryDecoder();
+}
+
+
+int telemetry_decoder_feed(telemetryDecoder * decoder, const uint8_t * bytes, int length, telemetryRowCallback callback, void * userData) {
+  int rows = 0;
+  while (length > 0) {
+    int copied = (int) sizeof(decoder->pending) - decoder->pendingLength;
+    copied = (copied < length) ? copied : length;
+    memcpy(&decoder->pending[decoder->pendingLength], bytes, copied);
+    decoder->pendingLength = decoder->pendingLength + copied;
+    bytes = bytes + copied;
+    length = length - copied;
+
+    const uint8_t * pending = decoder->pending;
+    int position = 0;
+    while (decoder->pendingLength - position >= TELEMETRY_CHUNK_HEADER_LEN) {
+      const uint8_t * chunk = &pending[position];
+      int payloadLength = chunk[8] | (chunk[9] << 8);
+      if ((chunk[0] != TELEMETRY_SYNC0) || (chunk[1] != TELEMETRY_SYNC1) || (payloadLength > TELEMETRY_CHUNK_PAYLOAD_MAX)) {
+        position++;
+        decoder->skippedBytes++;
+        continue;
+      }
+      int chunkLength = TELEMETRY_CHUNK_HEADER_LEN + payloadLength + 4;
+      if (decoder->pendingLength - position < chunkLength) {
+        break; // wait for the rest
+      }
+      uint32_t crc = (uint32_t) chunk[chunkLength - 4] | ((uint32_t) chunk[chunkLength - 3] << 8) | ((uint32_t) chunk[chunkLength - 2] << 16) | ((uint32_t) chunk[chunkLength - 1] << 24);
+      if (telemetry_crc32(&chunk[2], chunkLength - 6) != crc) { // corrupted, or sync bytes inside other data: resync from the next byte
+        decoder->crcErrors++;
+        position++;
+        decoder->skippedBytes++;
+        continue;
+      }
+      uint32_t sequence = (uint32_t) chunk[4] | ((uint32_t) chunk[5] << 8) | ((uint32_t) chunk[6] << 16) | ((uint32_t) chunk[7] << 24);
+      if ((decoder->synced == 1) && (sequence != decoder->nextSequence)) {
+        uint32_t gap = sequence - decoder->nextSequence;
+        decoder->lostChunks = decoder->lostChunks + ((gap < 0x80000000) ? gap : 0); // a node restart goes back to 0: not a loss
+      }
+      decoder->synced = 1;
+      decoder->nextSequence = sequence + 1;
+      decoder->chunks++;
+      if (chunk[2] != TELEMETRY_VERSION) {
+        decoder->malformedChunks++;
+      } else {
+        int chunkRows = telemetry_decode_payload(&chunk[TELEMETRY_CHUNK_HEADER_LEN], payloadLength, sequence, callback, userData, &decoder->records);
+        if (chunkRows < 0) {
+          decoder->malformedChunks++;
+        } else {
+          rows = rows + chunkRows;
+          decoder->rows = decoder->rows + chunkRows;
+        }
+      }
+      position = position + chunkLength;
+    }
+    memmove(decoder->pending, &decoder->pending[position], decoder->pendingLength - position);
+    decoder->pendingLength = decoder->pendingLength - position;
+  }
+  return rows;
+}
@@ -0,0 +1,91 @@
+// Host decoder of the binary telemetry written by the radar (see the telemetry section of multistatic_interference_radar.h), e.g. from a serial capture of a live node.
+
+// The bytes are fed as they come, in pieces of any size: the chunks are found by their sync bytes and checked with their CRC, anything else (boot messages,
+// debug text, a chunk cut by the start of the capture or corrupted on the line) is skipped, and the gaps in the chunk sequence numbers are counted as lost chunks.
+// Every record becomes rows handed to a callback: one row per valid link of each cycle, one row per streamed sample.
+// Only the constants of the library header are used, the decoder does not link the library.
+
+#ifndef TELEMETRY_DECODER_H
+#define TELEMETRY_DECODER_H
+
+#include "../../multistatic_interference_radar.h"
+
+#include <stdint.h>
+
+
+#define TELEMETRY_DECODER_MAX_SLOTS 128 // the format allows slot indexes up to 127, whatever the pool size of the node
+
+
+typedef struct  telemetryRowStruct {
+
+int kind = TELEMETRY_RECORD_CYCLE; // TELEMETRY_RECORD_CYCLE or TELEMETRY_RECORD_SAMPLE
+
+uint32_t sequence = 0; // of the chunk the row came from
+
+uint32_t timestampMs = 0; // node time
+
+int detectionLevel = 0; // cycle rows: what the cycle returned
+
+int slot = -1; // -1 on the single row of a cycle without valid links
+
+uint8_t BSSID[6] = {0}; // from the latest link record of the slot
+
+int channel = 0;
+
+int alarm = 0;
+
+int RSSI = 0; // latest sample, dBm
+
+int average = 0; // mobile average, dBm
+
+int variance = 0; // the slot's latest variance (latestVariances[])
+
+} telemetryRow;
+
+
+typedef void (*telemetryRowCallback)(const telemetryRow *, void * userData);
+
+
+typedef struct  telemetryDecoderStruct {
+
+uint8_t pending[2 * TELEMETRY_CHUNK_SIZE]; // bytes not consumed yet, at most one chunk and the next piece
+
+int pendingLength = 0;
+
+int synced = 0; // 1 once a chunk has been decoded: from then on, sequence gaps are lost chunks
+
+uint32_t nextSequence = 0;
+
+// statistics
+
+uint32_t chunks = 0;
+
+uint32_t records = 0;
+
+uint32_t rows = 0;
+
+uint32_t lostChunks = 0; // sequence gaps
+
+uint32_t crcErrors = 0; // chunk headers whose CRC did not match: corrupted or false sync
+
+uint32_t malformedChunks = 0; // CRC ok, unknown version or record layout
+
+uint32_t skippedBytes = 0; // outside any valid chunk
+
+} telemetryDecoder;
+
+
+// current status: IMPLEMENTED
+void telemetry_decoder_reset(telemetryDecoder *);
+
+// current status: IMPLEMENTED
+int telemetry_decoder_feed(telemetryDecoder *, const uint8_t * bytes, int length, telemetryRowCallback callback, void * userData); // returns the number of rows produced by these bytes
+
+// current status: IMPLEMENTED
+ // decodes the payload of one chunk already checked (no sync, no CRC), returns the number of rows, -1 on a malformed payload (the rows before the error are delivered)
+int telemetry_decode_payload(const uint8_t * payload, int payloadLength, uint32_t sequence, telemetryRowCallback callback, void * userData, uint32_t * records);
+
+// current status: IMPLEMENTED
+uint32_t telemetry_crc32(const uint8_t * bytes, int length); // CRC-32 (IEEE), the chunk check
+
+#endif
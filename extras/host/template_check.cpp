@@ -0,0 +1,120 @@
+// Host check of the compile-time core (multistatic_interference_radar_template.h): the same sample stream goes through a transmitterDataT
+// and through the runtime multistatic_interference_radar_process() configured the same way, for the four second order filter / autoregressive smoother
+// combinations, with and without the alarm threshold, on the default window sizes and on non power of two ones (the template divides by shifting only on powers of two).
+// Every returned value and the published fields (variance, mobile average, deviation, detection level) must be identical; exits with 1 otherwise.
+// The stream has a person walking by now and then, weak samples under minimum_RSSI and link resets. The bootstrap mode has no template counterpart, it stays off.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o template_check template_check.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./template_check [samples=20000]
+
+#include "../../multistatic_interference_radar.h"
+#include "../../multistatic_interference_radar_template.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+
+#define ATTENUATION 16 // the runtime default, multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient()
+#define RESET_EVERY 1500 // samples between two link resets
+
+
+std::vector<int> buildStream(int samplesNumber) {
+  std::vector<int> stream(samplesNumber);
+  uint32_t randomState = 2024;
+  for (int sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++) { // xorshift32
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    int walking = ((sampleIndex / 400) % 3 == 1); // 400 samples out of 1200
+    int sample = -62 + (int) (randomState % 7) - 3;
+    if (walking) {
+      sample = sample + (int) ((randomState >> 8) % 21) - 10;
+    }
+    if ((randomState >> 16) % 97 == 0) {
+      sample = -95; // under minimum_RSSI: replaced by the mobile average
+    }
+    stream[sampleIndex] = sample;
+  }
+  return stream;
+}
+
+
+template <int SampleBufferSize, int VarianceBufferSize, int VarianceIntegratorLimit, bool SecondOrderFilter, bool AutoRegressive, bool Threshold>
+int compareStream(radarContext * radar, const std::vector<int> & stream) { // returns the mismatching samples
+  typedef transmitterDataT<SampleBufferSize, SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, SecondOrderFilter, ATTENUATION, AutoRegressive, Threshold> templateLink;
+  templateLink * compiled = new templateLink;
+  transmitterData * runtime = new transmitterData;
+
+  multistatic_interference_radar_enable_second_order_variance_filtering(radar, SecondOrderFilter ? 1 : 0);
+  multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient(radar, ATTENUATION);
+  multistatic_interference_radar_enable_bootstrap(radar, 0);
+  runtime->sampleBufferSize = SampleBufferSize;
+  runtime->mobileAverageFilterSize = SampleBufferSize;
+  runtime->varianceBufferSize = VarianceBufferSize;
+  runtime->varianceIntegratorLimit = VarianceIntegratorLimit;
+  runtime->enableAutoRegressive = AutoRegressive;
+  runtime->enableThreshold = Threshold ? 1 : 0;
+
+  int mismatches = 0;
+  for (size_t sampleIndex = 0; sampleIndex < stream.size(); sampleIndex++) {
+    if ((sampleIndex > 0) && (sampleIndex % RESET_EVERY == 0)) {
+      compiled->resetRequest = 1;
+      runtime->resetRequest = 1;
+    }
+    int compiledLevel = multistatic_interference_radar_process(stream[sampleIndex], compiled);
+    int runtimeLevel = multistatic_interference_radar_process(radar, stream[sampleIndex], runtime);
+    if ((compiledLevel != runtimeLevel) || (compiled->variance != runtime->variance) || (compiled->mobileAverage != runtime->mobileAverage) ||
+        (compiled->varianceSample != runtime->varianceSample) || (compiled->detectionLevel != runtime->detectionLevel)) {
+      if (mismatches == 0) {
+        printf("first_mismatch sample=%u template=%d/%d/%d/%u runtime=%d/%d/%d/%u (level/variance/average/deviation)\n", (unsigned) sampleIndex, compiledLevel, compiled->variance,
+               compiled->mobileAverage, compiled->varianceSample, runtimeLevel, runtime->variance, runtime->mobileAverage, runtime->varianceSample);
+      }
+      mismatches++;
+    }
+  }
+  printf("template_vs_runtime window=%d variance_buffer=%d integrator=%d second_order=%d autoregressive=%d threshold=%d samples=%u mismatches=%d\n", SampleBufferSize,
+         VarianceBufferSize, VarianceIntegratorLimit, SecondOrderFilter ? 1 : 0, AutoRegressive ? 1 : 0, Threshold ? 1 : 0, (unsigned) stream.size(), mismatches);
+
+  delete runtime;
+  delete compiled;
+  return mismatches;
+}
+
+
+template <int SampleBufferSize, int VarianceBufferSize, int VarianceIntegratorLimit>
+int compareCombinations(radarContext * radar, const std::vector<int> & stream) { // the four filter / smoother combinations, with and without threshold
+  int mismatches = 0;
+  mismatches = mismatches + compareStream<SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, false, false, false>(radar, stream);
+  mismatches = mismatches + compareStream<SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, true, false, false>(radar, stream);
+  mismatches = mismatches + compareStream<SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, false, true, false>(radar, stream);
+  mismatches = mismatches + compareStream<SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, true, true, false>(radar, stream);
+  mismatches = mismatches + compareStream<SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, false, false, true>(radar, stream);
+  mismatches = mismatches + compareStream<SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, true, false, true>(radar, stream);
+  mismatches = mismatches + compareStream<SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, false, true, true>(radar, stream);
+  mismatches = mismatches + compareStream<SampleBufferSize, VarianceBufferSize, VarianceIntegratorLimit, true, true, true>(radar, stream);
+  return mismatches;
+}
+
+
+int main(int argc, char ** argv) {
+
+  int samplesNumber = (argc > 1) ? atoi(argv[1]) : 20000;
+  if (samplesNumber < 1) {
+    printf("usage: %s [samples=20000]\n", argv[0]);
+    return 1;
+  }
+
+  radarContext * radar = new radarContext;
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  std::vector<int> stream = buildStream(samplesNumber);
+
+  int mismatches = compareCombinations<MAX_SAMPLEBUFFERSIZE_MULTI, MAX_VARIANCEBUFFERSIZE_MULTI, VARIANCE_INTEGRATOR_LIMIT>(radar, stream);
+  mismatches = mismatches + compareCombinations<24, 12, 5>(radar, stream);
+
+  printf("template_check mismatches=%d result=%s\n", mismatches, (mismatches == 0) ? "ok" : "FAIL");
+  delete radar;
+  return (mismatches == 0) ? 0 : 1;
+}
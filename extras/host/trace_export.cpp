@@ -0,0 +1,289 @@
+// Cycle timelines for Perfetto: the spans recorded by the radar tracing (see the tracing section of multistatic_interference_radar.h) as Chrome trace-event JSON,
+// to open in ui.perfetto.dev or chrome://tracing, and the slowest cycles with what their time went into, printed on stderr.
+// - decode: a serial capture of multistatic_interference_radar_trace_dump() frames (from a live ESP32, boot messages and debug text around them are skipped),
+//   every frame becomes one process of the timeline,
+// - run: the unmodified radar on the mock scan backend, with access points switching off and back on now and then, traced and written with
+//   multistatic_interference_radar_trace_write_json(),
+// - capture: the same run, dumped with multistatic_interference_radar_trace_dump() on stdout, to try the decoder on.
+// On the host the mock scans take no time: the scan spans only show the bookkeeping around them.
+
+// build (from this directory), with a ring holding the whole run:
+//   g++ -std=gnu++11 -O2 -pthread -DRADAR_TRACE_EVENTS=65536 -o trace_export trace_export.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run:
+//   ./trace_export <capture file, - for stdin> [json file=radar_trace.json]
+//   ./trace_export run [cycles=2000] [transmitters=8] [churn period in cycles=200, 0 = none] [json file=radar_trace.json]
+//   ./trace_export capture [cycles=2000] [transmitters=8] [churn period in cycles=200] > capture.bin
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+
+#define CHURN_OFF_CYCLES 20 // how long a switched off access point stays off
+
+#define SLOWEST_CYCLES 5 // printed with their breakdown
+
+
+typedef struct  traceSpanStruct {
+uint64_t startTicks = 0; // unwrapped
+uint32_t durationTicks = 0;
+int arg = 0;
+int id = 0;
+} traceSpan;
+
+typedef struct  traceDumpStruct {
+double ticksPerUs = 0;
+uint32_t overwritten = 0;
+std::vector<traceSpan> spans;
+} traceDump;
+
+
+uint32_t crc32(const uint8_t * bytes, size_t length) { // CRC-32 (IEEE), the frame check
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t byteIndex = 0; byteIndex < length; byteIndex++) {
+    crc = crc ^ bytes[byteIndex];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+  }
+  return ~crc;
+}
+
+
+uint32_t getLittleEndian32(const uint8_t * bytes) {
+  return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+
+size_t decodeFrame(const uint8_t * bytes, size_t available, traceDump * dump) { // returns the frame length, 0 if there is no valid frame at bytes
+  if ((available < RADAR_TRACE_HEADER_LEN + 4) || (bytes[0] != RADAR_TRACE_SYNC0) || (bytes[1] != RADAR_TRACE_SYNC1) || (bytes[2] != RADAR_TRACE_VERSION)) {
+    return 0;
+  }
+  uint32_t eventsNumber = getLittleEndian32(&bytes[8]);
+  if (eventsNumber > (available - RADAR_TRACE_HEADER_LEN - 4) / RADAR_TRACE_EVENT_LEN) {
+    return 0;
+  }
+  size_t length = RADAR_TRACE_HEADER_LEN + (size_t) eventsNumber * RADAR_TRACE_EVENT_LEN + 4;
+  if (crc32(&bytes[2], length - 6) != getLittleEndian32(&bytes[length - 4])) {
+    return 0;
+  }
+  dump->ticksPerUs = getLittleEndian32(&bytes[4]) / 1000.0;
+  dump->overwritten = getLittleEndian32(&bytes[12]);
+  dump->spans.clear();
+  // the spans are recorded when they end: the end times grow, so they unwrap one after the other (a scan span of the acquisition task may end a little out of order)
+  uint64_t endTicks = 0;
+  uint32_t previousEnd = 0;
+  for (uint32_t eventIndex = 0; eventIndex < eventsNumber; eventIndex++) {
+    const uint8_t * event = &bytes[RADAR_TRACE_HEADER_LEN + eventIndex * RADAR_TRACE_EVENT_LEN];
+    traceSpan span;
+    span.durationTicks = getLittleEndian32(&event[4]);
+    span.arg = (int16_t) (event[8] | (event[9] << 8));
+    span.id = event[10];
+    uint32_t end = getLittleEndian32(&event[0]) + span.durationTicks;
+    endTicks = (eventIndex == 0) ? ((uint64_t) 1 << 32) + end : endTicks + (int64_t) (int32_t) (end - previousEnd); // starts one lap up: the first start may be before it
+    previousEnd = end;
+    span.startTicks = endTicks - span.durationTicks;
+    dump->spans.push_back(span);
+  }
+  return length;
+}
+
+
+void writeSpans(FILE * jsonFile, const traceDump * dump, int pid) { // the spans of a dump as complete events, on the same tracks as multistatic_interference_radar_trace_write_json(); pid 1 opens the array
+  uint64_t originTicks = 0;
+  for (size_t spanIndex = 0; spanIndex < dump->spans.size(); spanIndex++) {
+    originTicks = ((spanIndex == 0) || (dump->spans[spanIndex].startTicks < originTicks)) ? dump->spans[spanIndex].startTicks : originTicks;
+  }
+  fprintf(jsonFile, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"dump %d\"}}", (pid == 1) ? "\n" : ",\n", pid, pid);
+  fprintf(jsonFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":1,\"args\":{\"name\":\"acquisition\"}}", pid);
+  fprintf(jsonFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":2,\"args\":{\"name\":\"processing\"}}", pid);
+  for (size_t spanIndex = 0; spanIndex < dump->spans.size(); spanIndex++) {
+    const traceSpan * span = &dump->spans[spanIndex];
+    fprintf(jsonFile, ",\n{\"name\":\"%s\",\"cat\":\"radar\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"arg\":%d}}",
+            multistatic_interference_radar_stage_name(span->id), pid, (span->id == RADAR_STAGE_SCAN) ? 1 : 2, (double) (span->startTicks - originTicks) / dump->ticksPerUs,
+            span->durationTicks / dump->ticksPerUs, span->arg);
+  }
+}
+
+
+void printSlowest(const traceDump * dump) { // the slowest multistatic_interference_radar() calls (processing cycles in the threaded mode) and the spans inside them
+  int outerId = RADAR_TRACE_RADAR;
+  std::vector<size_t> outer;
+  for (int pass = 0; (pass < 2) && (outer.empty()); pass++) {
+    outerId = (pass == 0) ? RADAR_TRACE_RADAR : RADAR_STAGE_CYCLE;
+    for (size_t spanIndex = 0; spanIndex < dump->spans.size(); spanIndex++) {
+      if (dump->spans[spanIndex].id == outerId) {
+        outer.push_back(spanIndex);
+      }
+    }
+  }
+  std::sort(outer.begin(), outer.end(), [dump](size_t a, size_t b) { return dump->spans[a].durationTicks > dump->spans[b].durationTicks; });
+  uint64_t originTicks = dump->spans.empty() ? 0 : dump->spans[0].startTicks;
+  for (size_t spanIndex = 0; spanIndex < dump->spans.size(); spanIndex++) {
+    originTicks = (dump->spans[spanIndex].startTicks < originTicks) ? dump->spans[spanIndex].startTicks : originTicks;
+  }
+  for (size_t rank = 0; (rank < outer.size()) && (rank < SLOWEST_CYCLES); rank++) {
+    const traceSpan * slow = &dump->spans[outer[rank]];
+    double totalUs[RADAR_TRACE_IDS_NUMBER] = {0};
+    int counts[RADAR_TRACE_IDS_NUMBER] = {0};
+    for (size_t spanIndex = 0; spanIndex < dump->spans.size(); spanIndex++) {
+      const traceSpan * span = &dump->spans[spanIndex];
+      if ((spanIndex != outer[rank]) && (span->id < RADAR_TRACE_IDS_NUMBER) && (span->startTicks >= slow->startTicks) &&
+          (span->startTicks + span->durationTicks <= slow->startTicks + slow->durationTicks)) {
+        totalUs[span->id] = totalUs[span->id] + span->durationTicks / dump->ticksPerUs;
+        counts[span->id]++;
+      }
+    }
+    fprintf(stderr, "slowest=%d span=%s ts_us=%.3f dur_us=%.3f level=%d inside=", (int) rank + 1, multistatic_interference_radar_stage_name(outerId),
+            (double) (slow->startTicks - originTicks) / dump->ticksPerUs, slow->durationTicks / dump->ticksPerUs, slow->arg);
+    int printed = 0;
+    for (int id = 0; id < RADAR_TRACE_IDS_NUMBER; id++) {
+      if (counts[id] > 0) {
+        fprintf(stderr, "%s%s:%d:%.3f", (printed > 0) ? "," : "", multistatic_interference_radar_stage_name(id), counts[id], totalUs[id]);
+        printed++;
+      }
+    }
+    fprintf(stderr, "\n");
+  }
+}
+
+
+int decode(const char * fileName, const char * jsonName) {
+  FILE * captureFile = (strcmp(fileName, "-") == 0) ? stdin : fopen(fileName, "rb");
+  if (captureFile == NULL) {
+    fprintf(stderr, "cannot read %s\n", fileName);
+    return 1;
+  }
+  std::vector<uint8_t> bytes;
+  uint8_t chunk[4096];
+  size_t chunkLength;
+  while ((chunkLength = fread(chunk, 1, sizeof(chunk), captureFile)) > 0) {
+    bytes.insert(bytes.end(), chunk, chunk + chunkLength);
+  }
+  if (captureFile != stdin) {
+    fclose(captureFile);
+  }
+
+  FILE * jsonFile = fopen(jsonName, "w");
+  if (jsonFile == NULL) {
+    fprintf(stderr, "cannot write %s\n", jsonName);
+    return 1;
+  }
+  fprintf(jsonFile, "{\"traceEvents\":[");
+  int frames = 0;
+  long spans = 0;
+  long skippedBytes = 0;
+  traceDump dump;
+  size_t position = 0;
+  while (position < bytes.size()) {
+    size_t length = decodeFrame(&bytes[position], bytes.size() - position, &dump);
+    if (length == 0) {
+      position++;
+      skippedBytes++;
+      continue;
+    }
+    position = position + length;
+    frames++;
+    spans = spans + (long) dump.spans.size();
+    writeSpans(jsonFile, &dump, frames);
+    fprintf(stderr, "dump=%d spans=%lu overwritten_spans=%u ticks_per_us=%.3f\n", frames, (unsigned long) dump.spans.size(), dump.overwritten, dump.ticksPerUs);
+    printSlowest(&dump);
+  }
+  fprintf(jsonFile, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  fclose(jsonFile);
+  fprintf(stderr, "bytes=%lu dumps=%d spans=%ld skipped_bytes=%ld json=%s\n", (unsigned long) bytes.size(), frames, spans, skippedBytes, jsonName);
+  return 0;
+}
+
+
+void runRadar(radarContext * radar, mockScanEnvironment * env, int cycles, int transmitters, int churnPeriod) {
+  mock_scan_backend_reset(env, 3);
+  mockSyntheticAccessPoints row;
+  mock_scan_backend_add_synthetic_aps(env, &row);
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_set_scan_backend(radar, mock_scan_backend(env));
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(radar, transmitters);
+  multistatic_interference_radar_enable_targeted_scan(radar, 1);
+  multistatic_interference_radar_set_shadow_trackers(radar, 2);
+  multistatic_interference_radar_enable_tracing(radar, 1);
+
+  int switchedOff = -1;
+  int switchedOffCycle = 0;
+  for (int cycle = 0; cycle < cycles; cycle++) {
+    if ((churnPeriod > 0) && (cycle % churnPeriod == churnPeriod - 1) && (switchedOff < 0)) { // one of the strongest goes away for a while
+      switchedOff = (cycle / churnPeriod) % transmitters;
+      mock_scan_backend_ap(env, switchedOff)->present = 0;
+      switchedOffCycle = cycle;
+    }
+    if ((switchedOff >= 0) && (cycle - switchedOffCycle >= CHURN_OFF_CYCLES)) {
+      mock_scan_backend_ap(env, switchedOff)->present = 1;
+      switchedOff = -1;
+    }
+    multistatic_interference_radar(radar);
+    mock_scan_backend_advance(env, 100);
+  }
+}
+
+
+int main(int argc, char ** argv) {
+
+  if (argc < 2) {
+    printf("usage: %s <capture file, - for stdin> [json file=radar_trace.json] | run [cycles=2000] [transmitters=8] [churn period=200] [json file=radar_trace.json] "
+           "| capture [cycles=2000] [transmitters=8] [churn period=200]\n", argv[0]);
+    return 1;
+  }
+
+  if ((strcmp(argv[1], "run") != 0) && (strcmp(argv[1], "capture") != 0)) {
+    return decode(argv[1], (argc > 2) ? argv[2] : "radar_trace.json");
+  }
+
+  int capture = (strcmp(argv[1], "capture") == 0) ? 1 : 0;
+  int cycles = (argc > 2) ? atoi(argv[2]) : 2000;
+  int transmitters = (argc > 3) ? atoi(argv[3]) : 8;
+  int churnPeriod = (argc > 4) ? atoi(argv[4]) : 200;
+  const char * jsonName = (argc > 5) ? argv[5] : "radar_trace.json";
+  if ((cycles < 1) || (transmitters < 1) || (transmitters > TRANSMITTERS_POOL_SIZE) || (churnPeriod < 0)) {
+    fprintf(stderr, "cycles >= 1, transmitters 1 to %d, churn period >= 0\n", TRANSMITTERS_POOL_SIZE);
+    return 1;
+  }
+
+  radarContext * radar = new radarContext;
+  mockScanEnvironment * env = new mockScanEnvironment;
+  runRadar(radar, env, cycles, transmitters, churnPeriod);
+
+  uint32_t recorded = radar->trace.head.load();
+  if (capture == 1) {
+    int length = multistatic_interference_radar_trace_dump(radar);
+    fflush(stdout);
+    fprintf(stderr, "cycles=%d spans=%u dump_bytes=%d\n", cycles, recorded, length);
+  } else {
+    int written = multistatic_interference_radar_trace_write_json(radar, jsonName);
+    if (written < 0) {
+      fprintf(stderr, "cannot write %s\n", jsonName);
+      return 1;
+    }
+    fprintf(stderr, "cycles=%d spans=%d overwritten_spans=%u json=%s\n", cycles, written, recorded - (uint32_t) written, jsonName);
+    traceDump dump; // the ring as the decoder would see it, for the slowest cycles
+    dump.ticksPerUs = multistatic_interference_radar_get_profile(radar).ticksPerUs;
+    for (uint32_t position = recorded - (uint32_t) written; position != recorded; position++) {
+      const radarTraceEvent * event = &radar->trace.events[position & (radar->trace.capacity - 1)];
+      traceSpan span;
+      span.startTicks = event->startTicks;
+      span.durationTicks = event->durationTicks;
+      span.arg = event->arg;
+      span.id = event->id;
+      dump.spans.push_back(span);
+    }
+    printSlowest(&dump);
+  }
+
+  delete env;
+  delete radar;
+  return 0;
+}
@@ -0,0 +1,185 @@
+// Host check of the warm start: a radar runs for a while on the mock backend and stores its snapshot, then a fresh radar ("after the reboot")
+// loads it and keeps going in lockstep with the original one, on an identical copy of the environment. The restored radar must produce valid output
+// from its first cycle, and exactly the same levels as the radar that never rebooted. Snapshots of a different room, or of a room that changed, must be
+// rejected by the validation of the first scan, falling back to a cold start.
+
+// build (from this directory):
+//   g++ -std=gnu++11 -O2 -pthread -o warm_start_check warm_start_check.cpp mock_scan_backend.cpp ../../multistatic_interference_radar.cpp
+// run (writes warmcheck.snapshot in the current directory):
+//   ./warm_start_check [transmitters=4] [cycles before the reboot=600] [cycles after=300]
+
+#include "../../multistatic_interference_radar.h"
+#include "mock_scan_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#define ACCESS_POINTS_NUMBER 12
+#define LOOP_DELAY_MS 1000
+
+
+void buildEnvironment(mockScanEnvironment * env, int room) { // room changes the BSSIDs: somebody else's snapshot
+  mock_scan_backend_reset(env, 777);
+  char SSIDprefix[16];
+  snprintf(SSIDprefix, sizeof(SSIDprefix), "room%d_ap", room);
+  mockSyntheticAccessPoints row;
+  row.accessPointsNumber = ACCESS_POINTS_NUMBER;
+  row.BSSIDtag = (uint8_t) room;
+  row.SSIDprefix = SSIDprefix;
+  row.strongestRSSI = -42;
+  row.RSSIstep = 4;
+  row.RSSIspread = 36;
+  row.noise = 2;
+  mock_scan_backend_add_synthetic_aps(env, &row);
+}
+
+
+void setupRadar(radarContext * radar, mockScanEnvironment * env, int transmitters, int batch) { // what the sketch setup() does, every boot
+  multistatic_interference_radar_set_debug_level(radar, 0);
+  multistatic_interference_radar_set_scan_backend(radar, mock_scan_backend(env));
+  multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  multistatic_interference_radar_set_txN_limit(radar, transmitters);
+  multistatic_interference_radar_enable_batch_processing(radar, batch);
+  multistatic_interference_radar_set_snapshot_name(radar, "warmcheck");
+}
+
+
+int runCycle(radarContext * radar, mockScanEnvironment * env) {
+  int level = multistatic_interference_radar(radar);
+  mock_scan_backend_advance(env, LOOP_DELAY_MS);
+  return level;
+}
+
+
+int coldStartCycles(int transmitters, int batch, int maxCycles) { // cycles until the first valid (>= 0) level
+  mockScanEnvironment * env = new mockScanEnvironment;
+  radarContext * radar = new radarContext;
+  buildEnvironment(env, 1);
+  setupRadar(radar, env, transmitters, batch);
+  int cycles = 0;
+  while ((cycles < maxCycles) && (runCycle(radar, env) < 0)) {
+    cycles++;
+  }
+  delete radar;
+  delete env;
+  return cycles + 1;
+}
+
+
+// runs the original radar, stores the snapshot, then reboots into a fresh radar on a copy of the environment (optionally a different room, or with one
+// access point moved) and compares the two; returns 0 when the outcome is the expected one
+int warmStart(const char * scenario, int transmitters, int savedBatch, int restoredBatch, int room, int movedDb, int cyclesBefore, int cyclesAfter) {
+
+  mockScanEnvironment * env = new mockScanEnvironment;
+  radarContext * original = new radarContext;
+  buildEnvironment(env, 1);
+  setupRadar(original, env, transmitters, savedBatch);
+  for (int cycle = 0; cycle < cyclesBefore; cycle++) {
+    runCycle(original, env);
+  }
+  int snapshotLength = multistatic_interference_radar_store_snapshot(original);
+
+  mockScanEnvironment * rebootedEnv = new mockScanEnvironment;
+  *rebootedEnv = *env; // same access points, same clock, same noise sequence from here on
+  if (room != 1) {
+    buildEnvironment(rebootedEnv, room);
+  }
+  if (movedDb != 0) { // the first tracked access point moved (or a wall appeared)
+    int movedSlot = 0;
+    for (int apIndex = 0; apIndex < mock_scan_backend_ap_number(rebootedEnv); apIndex++) {
+      if (mock_scan_backend_ap(rebootedEnv, apIndex)->BSSID[5] == original->accessPoints.BSSIDs[movedSlot][5]) {
+        mock_scan_backend_ap(rebootedEnv, apIndex)->RSSI = mock_scan_backend_ap(rebootedEnv, apIndex)->RSSI - movedDb;
+      }
+    }
+  }
+  radarContext * rebooted = new radarContext;
+  setupRadar(rebooted, rebootedEnv, transmitters, restoredBatch);
+  int restoredLinks = multistatic_interference_radar_load_snapshot(rebooted);
+
+  int cyclesToValid = -1;
+  int mismatches = 0;
+  for (int cycle = 0; cycle < cyclesAfter; cycle++) {
+    int originalLevel = runCycle(original, env);
+    int rebootedLevel = runCycle(rebooted, rebootedEnv);
+    if ((cyclesToValid < 0) && (rebootedLevel >= 0)) {
+      cyclesToValid = cycle + 1;
+    }
+    if (rebootedLevel != originalLevel) {
+      mismatches++;
+    }
+  }
+
+  radarWarmStart * warm = &rebooted->accessPoints.warmStart;
+  printf("scenario=%s saved=%s restored=%s snapshot_bytes=%d restored_links=%d confirmed=%d dropped=%d cycles_to_valid=%d mismatching_cycles=%d\n",
+         scenario, savedBatch ? "batch" : "scalar", restoredBatch ? "batch" : "scalar", snapshotLength, restoredLinks, warm->confirmedLinks, warm->droppedLinks,
+         cyclesToValid, mismatches);
+
+  int failed = 0;
+  if ((room == 1) && (movedDb == 0)) { // same room: valid right away, and nothing lost by the reboot (across engines the kernels may round differently)
+    failed = (restoredLinks != transmitters) || (warm->droppedLinks != 0) || (cyclesToValid != 1) || ((savedBatch == restoredBatch) && (mismatches != 0));
+  } else if (room != 1) { // somebody else's room: nothing confirmed, cold start
+    failed = (warm->confirmedLinks != 0) || (warm->droppedLinks != restoredLinks);
+  } else { // one access point moved: that one only is dropped
+    failed = (warm->droppedLinks != 1) || (warm->confirmedLinks != transmitters - 1);
+  }
+
+  delete original;
+  delete rebooted;
+  delete env;
+  delete rebootedEnv;
+  return failed;
+}
+
+
+int corruptedSnapshot(int transmitters, int cyclesBefore) { // every flipped byte must be caught before the radar is touched; returns 0 when they all are
+  mockScanEnvironment * env = new mockScanEnvironment;
+  radarContext * radar = new radarContext;
+  buildEnvironment(env, 1);
+  setupRadar(radar, env, transmitters, 0);
+  for (int cycle = 0; cycle < cyclesBefore; cycle++) {
+    runCycle(radar, env);
+  }
+  static uint8_t snapshot[RADAR_SNAPSHOT_MAX_LEN(MAX_ALLOWED_TRANSMITTERS_NUMBER)];
+  int length = multistatic_interference_radar_save_state(radar, snapshot, sizeof(snapshot));
+  int accepted = 0;
+  for (int byteIndex = 0; byteIndex < length; byteIndex++) {
+    snapshot[byteIndex] = snapshot[byteIndex] ^ 0x10;
+    if (multistatic_interference_radar_restore_state(radar, snapshot, length) != RADAR_SNAPSHOT_INVALID) {
+      accepted++;
+    }
+    snapshot[byteIndex] = snapshot[byteIndex] ^ 0x10;
+  }
+  int truncated = multistatic_interference_radar_restore_state(radar, snapshot, length - 1);
+  printf("scenario=corrupted snapshot_bytes=%d flipped_bytes_accepted=%d truncated=%d\n", length, accepted, truncated);
+  delete radar;
+  delete env;
+  return (accepted != 0) || (truncated != RADAR_SNAPSHOT_INVALID);
+}
+
+
+int main(int argc, char ** argv) {
+
+  int transmitters = (argc > 1) ? atoi(argv[1]) : 4;
+  int cyclesBefore = (argc > 2) ? atoi(argv[2]) : 600;
+  int cyclesAfter = (argc > 3) ? atoi(argv[3]) : 300;
+  if ((transmitters < 2) || (transmitters > ACCESS_POINTS_NUMBER)) {
+    printf("transmitters: 2 to %d\n", ACCESS_POINTS_NUMBER);
+    return 1;
+  }
+
+  printf("scenario=cold engine=scalar cycles_to_valid=%d\n", coldStartCycles(transmitters, 0, cyclesAfter));
+  printf("scenario=cold engine=batch cycles_to_valid=%d\n", coldStartCycles(transmitters, 1, cyclesAfter));
+
+  int failures = 0;
+  failures = failures + warmStart("warm", transmitters, 0, 0, 1, 0, cyclesBefore, cyclesAfter);
+  failures = failures + warmStart("warm", transmitters, 1, 1, 1, 0, cyclesBefore, cyclesAfter);
+  failures = failures + warmStart("warm_cross_engine", transmitters, 0, 1, 1, 0, cyclesBefore, cyclesAfter);
+  failures = failures + warmStart("warm_cross_engine", transmitters, 1, 0, 1, 0, cyclesBefore, cyclesAfter);
+  failures = failures + warmStart("other_room", transmitters, 0, 0, 2, 0, cyclesBefore, cyclesAfter);
+  failures = failures + warmStart("one_ap_moved", transmitters, 0, 0, 1, 20, cyclesBefore, cyclesAfter);
+  failures = failures + corruptedSnapshot(transmitters, cyclesBefore);
+
+  printf("failures=%d\n", failures);
+  return (failures == 0) ? 0 : 1;
+}
@@ -1,27 +1,546 @@
 #include "multistatic_interference_radar.h"
 
+#if defined(ARDUINO)
+
 #include <Arduino.h>  // only for diagnostic messages via Serial
 
 #include <WiFi.h>  // THIS WILL MAKE THE LIBRARY WORK ONLY IN STA MODE OR AP_STA MODE AS LONG AS YOU'RE CONNECTED AS A STATION, TO ANOTHER ACCESS POINT
 
 #include "esp_wifi.h"   // IF YOU HAVE AN ESP32, THIS WILL MAKE THE LIBRARY WORK IN MULTISTATIC MODE AND SOFT AP MODE AS LONG AS YOU'VE GOT AT LEAST ONE STATION CONNECTED TO YOUR SoftAP
 
+#include "freertos/FreeRTOS.h"  // threaded mode tasks
+#include "freertos/task.h"
+
+#include <Preferences.h>  // warm start snapshots in NVS
+
+#else
+
+#include "multistatic_interference_radar_host.h"  // host builds: Serial and millis() replacements, the scan backend is provided by the application (see extras/host)
+
+#include <thread>  // threaded mode tasks
+
+#include <stdio.h>  // warm start snapshots in files
+
+#endif
+
 #include <math.h>  // testing some new improvements
-int debugRadarMsg = 3;
+#include <string.h>
+#include <stdlib.h>
+radarContext defaultRadarContext; // the radar of the functions without a context parameter
+
+multistaticData & accessPoints = defaultRadarContext.accessPoints;
+
+
+
+#if defined(ARDUINO)
+
+// the default scan backend: the ESP32 WiFi class
+
+int esp32StartScan(void * backendData, int channel, int dwellMs) {
+  return (int) WiFi.scanNetworks(false, false, false, dwellMs, channel); //scanNetworks(bool async = false, bool show_hidden = false, bool passive = false, uint32_t max_ms_per_chan = 300, uint8_t channel = 0);  // channel 0 means all channels
+}
+
+int esp32ReadResult(void * backendData, int index, scanSnapshotEntry * entry, char * SSID) {
+  // reading the raw driver record: unlike WiFi.SSID() this does not allocate a String
+  wifi_ap_record_t * record = (wifi_ap_record_t *) WiFi.getScanInfoByIndex(index);
+  if (record == NULL) {
+    return -1;
+  }
+  for (int bssidIndex = 0; bssidIndex < 6; bssidIndex++) {
+    entry->BSSID[bssidIndex] = record->bssid[bssidIndex];
+  }
+  entry->RSSI = record->rssi;
+  entry->channel = record->primary;
+  strncpy(SSID, (const char *) record->ssid, SSID_STORAGE_LEN - 1);
+  SSID[SSID_STORAGE_LEN - 1] = 0;
+  return 0;
+}
+
+void esp32ReleaseResults(void * backendData) {
+  WiFi.scanDelete();
+}
+
+unsigned long esp32Millis(void * backendData) {
+  return millis();
+}
+
+int esp32StartScanAsync(void * backendData, int channel, int dwellMs) {
+  int scanRes = (int) WiFi.scanNetworks(true, false, false, dwellMs, channel); // returns WIFI_SCAN_RUNNING right away, the results are collected by the WiFi task
+  return (scanRes == WIFI_SCAN_FAILED) ? RADAR_SCAN_FAILED : 0;
+}
+
+int esp32ScanStatus(void * backendData) {
+  int scanRes = (int) WiFi.scanComplete();
+  if (scanRes == WIFI_SCAN_RUNNING) {
+    return RADAR_SCAN_RUNNING;
+  }
+  return (scanRes < 0) ? RADAR_SCAN_FAILED : scanRes;
+}
+
+const radarScanBackend esp32ScanBackend = { esp32StartScan, esp32ReadResult, esp32ReleaseResults, esp32Millis, esp32StartScanAsync, esp32ScanStatus, NULL }; // one radio, nothing per instance
+
+#endif
+
+
+const radarScanBackend * activeScanBackend(radarContext * radar) { // the backend set by the user, or the platform default one (none on the host)
+  if (radar->accessPoints.scanBackend != NULL) {
+    return radar->accessPoints.scanBackend;
+  }
+#if defined(ARDUINO)
+  return &esp32ScanBackend;
+#else
+  return NULL;
+#endif
+}
+
+
+
+// logging: the event table (indexed by the RADAR_EVENT_ ids), the producer side of the ring and the formatting, see the logging section of the header
+
+typedef struct  radarLogEventInfoStruct {
+
+uint8_t argsNumber;
+
+const char * format; // printf format, every arg is passed as a long
+
+} radarLogEventInfo;
+
+const radarLogEventInfo radarLogEvents[RADAR_EVENTS_NUMBER] = {
+  { 1, "log: %ld events dropped, the ring was full" },
+  { 0, "multistatic_interference_radar_process(): alarm: no transmitter data: did you call multistatic_interference_radar_init()?" },
+  { 2, "multistatic_interference_radar_process(): warning: RSSI %ld under the minimum RSSI %ld, replaced" },
+  { 6, "multistatic_interference_radar_process(): rxRSSI: %ld prcsRSSI: %ld, mobileAverage: %ld, variance: %ld, varianceIntegral: %ld, varianceAR: %ld" },
+  { 2, "multistatic_interference_radar_process(): detected variance signal above threshold: %ld (threshold %ld)" },
+  { 2, "multistatic_interference_radar_process(): variance signal under threshold: %ld (threshold %ld)" },
+  { 2, "multistatic_interference_radar(): warning: detected an abnormally large number of transmitters during scan: %ld; fixing it to the maximum hardwired allowed limit: %ld" },
+  { 3, "multistatic_interference_radar(): processing netItem number: %ld on channel: %ld with RSSI: %ld" },
+  { 4, "multistatic_interference_radar(): processing recorded AP: RSSI too low for netItem: %ld on channel: %ld with RSSI: %ld, slot %ld freed" },
+  { 1, "searchScanResultsByBSSIDslotIndex(): found slot already empty or clean or invalid: slot: %ld" },
+  { 5, "searchScanResultsByBSSIDslotIndex(): slot: %ld stored BSSID: %04lX%04lX%04lX found netItem: %ld" },
+  { 1, "searchScanResultsByBSSIDslotIndex(): will need to clean tx slot: NO matched BSSID for slot index: %ld" },
+  { 1, "searchScanResultsByBSSIDslotIndex(): matched BSSID for slot index: %ld" },
+  { 6, "loadScanResults(): sorted by RSSI: item number: %ld; net number: %ld; detected RSSI: %ld; BSSID: %04lX%04lX%04lX" },
+  { 3, "multistatic_interference_radar(): tx: %ld var: %ld rssi: %ld" },
+  { 4, "accountScanRequest(): full sweep: %ld; targeted channels: %ld; results: %ld; radio time ms: %ld" },
+  { 3, "promoteShadow(): shadow %ld promoted to slot %ld with samples: %ld" },
+  { 0, "multistatic_interference_radar(): no connection or no AP in the vicinity: the radar is inoperable" },
+  { 1, "checkInvalidTXdata(): cleaned invalid tx data slots: %ld" },
+  { 1, "checkDeadTransmitters(): cleaned dead transmitters: %ld" },
+  { 1, "multistatic_interference_radar(): transmitters lost to low signal that were once valid: %ld" },
+  { 1, "multistatic_interference_radar(): shadow trackers promoted: %ld" },
+  { 1, "multistatic_interference_radar(): loadScanResults() response: %ld" },
+  { 1, "multistatic_interference_radar(): transmitters gone out of range or dead: %ld" },
+  { 1, "multistatic_interference_radar(): no scan backend available (pipelined: %ld): set one via multistatic_interference_radar_set_scan_backend()" },
+  { 3, "multistatic_interference_radar_stream_process(): processed samples: %ld; discarded: %ld; ring overflows so far: %ld" }
+};
+
+
+int multistatic_interference_radar_log_format(const radarLogRecord * record, char * text, int textLength) {
+  if ((record == NULL) || (text == NULL) || (textLength <= 0)) {
+    return 0;
+  }
+  if (record->eventId >= RADAR_EVENTS_NUMBER) {
+    return snprintf(text, textLength, "unknown event %u", (unsigned) record->eventId);
+  }
+  const int32_t * args = record->args;
+  int length = snprintf(text, textLength, radarLogEvents[record->eventId].format, (long) args[0], (long) args[1], (long) args[2], (long) args[3], (long) args[4], (long) args[5]);
+  return (length < textLength) ? length : textLength - 1;
+}
+
+
+int multistatic_interference_radar_log_encode(const radarLogRecord * record, uint8_t * frame) {
+  int argsNumber = (record->argsNumber <= RADAR_LOG_MAX_ARGS) ? record->argsNumber : RADAR_LOG_MAX_ARGS;
+  int length = 0;
+  frame[length++] = RADAR_LOG_FRAME_SYNC0;
+  frame[length++] = RADAR_LOG_FRAME_SYNC1;
+  frame[length++] = (uint8_t) (record->eventId & 0xFF);
+  frame[length++] = (uint8_t) (record->eventId >> 8);
+  frame[length++] = record->level;
+  frame[length++] = (uint8_t) argsNumber;
+  for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+    frame[length++] = (uint8_t) (record->timestampUs >> (8 * byteIndex));
+  }
+  for (int argIndex = 0; argIndex < argsNumber; argIndex++) {
+    for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+      frame[length++] = (uint8_t) ((uint32_t) record->args[argIndex] >> (8 * byteIndex));
+    }
+  }
+  uint8_t checksum = 0;
+  for (int byteIndex = 2; byteIndex < length; byteIndex++) {
+    checksum = (uint8_t) (checksum + frame[byteIndex]);
+  }
+  frame[length++] = checksum;
+  return length;
+}
+
+
+void printLogRecord(radarContext * radar, const radarLogRecord * record, int withTimestamp) { // text or binary, after the log mode
+  if (radar->debugLog.mode == RADAR_LOG_MODE_RING_BINARY) {
+    uint8_t frame[RADAR_LOG_FRAME_MAX_LEN];
+    Serial.write(frame, multistatic_interference_radar_log_encode(record, frame));
+    return;
+  }
+  char text[192];
+  multistatic_interference_radar_log_format(record, text, sizeof(text));
+  if (withTimestamp == 1) {
+    Serial.print(record->timestampUs);
+    Serial.print(" ");
+  }
+  Serial.println(text);
+}
+
+
+int logPush(radarLog * debugLog, const radarLogRecord * record) { // any task, lock-free: returns 1 if queued, 0 if the ring was full (the record is dropped and counted)
+  uint32_t position = debugLog->head.load(std::memory_order_relaxed);
+  radarLogCell * cell;
+  for (;;) {
+    cell = &debugLog->cells[position & (RADAR_LOG_RING_SIZE - 1)];
+    uint32_t lap = position - (position & (RADAR_LOG_RING_SIZE - 1));
+    int32_t state = (int32_t) (cell->sequence.load(std::memory_order_acquire) - lap);
+    if (state == 0) { // free for this lap: claim it
+      if (debugLog->head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (state < 0) { // still holding the record of the previous lap
+      debugLog->dropped.fetch_add(1, std::memory_order_relaxed);
+      return 0;
+    } else { // another producer took it, try the next position
+      position = debugLog->head.load(std::memory_order_relaxed);
+    }
+  }
+  cell->record = *record;
+  cell->sequence.store(position - (position & (RADAR_LOG_RING_SIZE - 1)) + 1, std::memory_order_release);
+  return 1;
+}
+
+
+int logPop(radarLog * debugLog, radarLogRecord * record) { // the single consumer: returns 1 and the oldest record, 0 if there is none
+  radarLogCell * cell = &debugLog->cells[debugLog->tail & (RADAR_LOG_RING_SIZE - 1)];
+  uint32_t lap = debugLog->tail - (debugLog->tail & (RADAR_LOG_RING_SIZE - 1));
+  if (cell->sequence.load(std::memory_order_acquire) != lap + 1) {
+    return 0; // empty, or the producer of this position has not finished writing it yet
+  }
+  *record = cell->record;
+  cell->sequence.store(lap + RADAR_LOG_RING_SIZE, std::memory_order_release); // free for the next lap
+  debugLog->tail++;
+  return 1;
+}
 
 
+void radarLogWrite(radarContext * radar, int level, int eventId, int32_t arg0 = 0, int32_t arg1 = 0, int32_t arg2 = 0, int32_t arg3 = 0, int32_t arg4 = 0, int32_t arg5 = 0) { // use RADAR_LOG()
+  radarLogRecord record;
+  record.timestampUs = (uint32_t) micros();
+  record.eventId = (uint16_t) eventId;
+  record.level = (uint8_t) level;
+  record.argsNumber = radarLogEvents[eventId].argsNumber;
+  record.args[0] = arg0;
+  record.args[1] = arg1;
+  record.args[2] = arg2;
+  record.args[3] = arg3;
+  record.args[4] = arg4;
+  record.args[5] = arg5;
+  if (radar->debugLog.mode == RADAR_LOG_MODE_SERIAL) {
+    printLogRecord(radar, &record, 0);
+    return;
+  }
+  logPush(&radar->debugLog, &record);
+}
+
+// the level test comes first and is constant against RADAR_LOG_MAX_LEVEL: above the floor the whole call, arguments included, is compiled out
+#define RADAR_LOG(radar, level, ...) do { if (RADAR_LOG_ENABLED(radar, level)) { radarLogWrite(radar, level, __VA_ARGS__); } } while (0)
+
+
+
+// profiling and tracing probes, see the profiling and tracing sections of the header. With RADAR_PROFILING and RADAR_TRACING 0 they compile to nothing:
+// RADAR_PROFILE_TICKS declares a start time, RADAR_PROFILE_STAGE records the time since it into a stage (and into the trace ring) and moves it to now, so that
+// the next stage can start from it without reading the clock again, RADAR_PROFILE_SPAN records the time between two such times, RADAR_PROFILE_COUNT bumps a counter.
+// The clock is only read on the sampled cycles (RADAR_PROFILE_SAMPLE counts one and decides) or while tracing; RADAR_PROFILE_SCAN_TICKS and RADAR_PROFILE_SCAN_STAGE
+// are the same for the scan stage, on its own sampling.
+// RADAR_TRACE_BEGIN and RADAR_TRACE_END time a span for the trace only, and read the clock only while tracing is enabled
+
+#if RADAR_PROFILING || RADAR_TRACING
+
+#if defined(ARDUINO)
+static inline radarProfileTicks radarTicks() {
+  return (radarProfileTicks) ESP.getCycleCount(); // CCOUNT
+}
+#else
+static inline radarProfileTicks radarTicks() {
+  return (radarProfileTicks) radarHostTicks();
+}
+#endif
+
+#endif
+
+#if RADAR_PROFILING
+static inline void profileRecord(radarProfile * profile, int stage, radarProfileTicks ticks) {
+  radarStageStats * stats = &profile->stages[stage];
+  int bucket = 63 - __builtin_clzll((uint64_t) ticks | 1); // floor(log2()), one instruction on both targets
+  bucket = (bucket < RADAR_PROFILE_BUCKETS) ? bucket : RADAR_PROFILE_BUCKETS - 1;
+  stats->histogram[bucket]++;
+  stats->minTicks = ((stats->count == 0) || (ticks < stats->minTicks)) ? ticks : stats->minTicks;
+  stats->maxTicks = (ticks > stats->maxTicks) ? ticks : stats->maxTicks;
+  stats->totalTicks = stats->totalTicks + ticks;
+  stats->count++;
+}
+#define RADAR_PROFILE_TIMED(radar, flag) ((radar)->profile.flag == 1)
+#define RADAR_PROFILE_SAMPLE(radar, counter, flag) (radar)->profile.flag = ((((radar)->profile.counter)++ & (RADAR_PROFILE_SAMPLE_INTERVAL - 1)) == 0) ? 1 : 0
+#else
+#define RADAR_PROFILE_TIMED(radar, flag) 0 // the stage timers are out: the trace is the only reason to read the clock
+#define RADAR_PROFILE_SAMPLE(radar, counter, flag) do { } while (0)
+#endif
+
+#if RADAR_TRACING
+#define RADAR_CLOCK_NEEDED(radar, flag) (RADAR_PROFILE_TIMED(radar, flag) || ((radar)->trace.enabled == 1))
+#else
+#define RADAR_CLOCK_NEEDED(radar, flag) RADAR_PROFILE_TIMED(radar, flag)
+#endif
+
+#if RADAR_TRACING
+static inline void traceRecord(radarTrace * trace, int id, radarProfileTicks startTicks, radarProfileTicks endTicks, int arg) { // one span into the ring, overwriting the oldest
+  uint32_t position = trace->head.fetch_add(1, std::memory_order_relaxed);
+  radarTraceEvent * event = &trace->events[position & (trace->capacity - 1)];
+  event->startTicks = startTicks;
+  event->durationTicks = (uint32_t) (endTicks - startTicks);
+  event->arg = (int16_t) ((arg < -32768) ? -32768 : ((arg > 32767) ? 32767 : arg));
+  event->id = (uint8_t) id;
+}
+
+#define RADAR_TRACE_BEGIN(radar, name) radarProfileTicks name = ((radar)->trace.enabled == 1) ? radarTicks() : 0
+#define RADAR_TRACE_END(radar, id, arg, name) do { if ((radar)->trace.enabled == 1) { traceRecord(&(radar)->trace, id, name, radarTicks(), arg); } } while (0)
+#else
+#define RADAR_TRACE_BEGIN(radar, name) do { } while (0)
+#define RADAR_TRACE_END(radar, id, arg, name) do { } while (0)
+#endif
+
+#if RADAR_PROFILING || RADAR_TRACING
+
+static inline void profileSpan(radarContext * radar, int stage, int timed, radarProfileTicks startTicks, radarProfileTicks endTicks) { // timed: a sampled cycle, otherwise the span is only traced
+#if RADAR_PROFILING
+  if (timed) {
+    profileRecord(&radar->profile, stage, endTicks - startTicks);
+  }
+#else
+  (void) timed;
+#endif
+#if RADAR_TRACING
+  if (radar->trace.enabled == 1) {
+    traceRecord(&radar->trace, stage, startTicks, endTicks, 0);
+  }
+#endif
+}
+
+static inline radarProfileTicks profileStage(radarContext * radar, int stage, int timed, int clockNeeded, radarProfileTicks startTicks) { // returns the end time, the start of the next stage: consecutive stages share a clock read
+  if (!clockNeeded) {
+    return 0;
+  }
+  radarProfileTicks nowTicks = radarTicks();
+  profileSpan(radar, stage, timed, startTicks, nowTicks);
+  return nowTicks;
+}
+
+#define RADAR_PROFILE_TICKS(radar, name) radarProfileTicks name = RADAR_CLOCK_NEEDED(radar, timedCycle) ? radarTicks() : 0
+#define RADAR_PROFILE_RESTART(radar, name) name = RADAR_CLOCK_NEEDED(radar, timedCycle) ? radarTicks() : 0
+#define RADAR_PROFILE_STAGE(radar, stage, name) name = profileStage(radar, stage, RADAR_PROFILE_TIMED(radar, timedCycle), RADAR_CLOCK_NEEDED(radar, timedCycle), name)
+#define RADAR_PROFILE_SPAN(radar, stage, startName, endName) do { if (RADAR_CLOCK_NEEDED(radar, timedCycle)) { profileSpan(radar, stage, RADAR_PROFILE_TIMED(radar, timedCycle), startName, endName); } } while (0)
+#define RADAR_PROFILE_SCAN_TICKS(radar, name) RADAR_PROFILE_SAMPLE(radar, scans, timedScan); radarProfileTicks name = RADAR_CLOCK_NEEDED(radar, timedScan) ? radarTicks() : 0
+#define RADAR_PROFILE_SCAN_STAGE(radar, stage, name) name = profileStage(radar, stage, RADAR_PROFILE_TIMED(radar, timedScan), RADAR_CLOCK_NEEDED(radar, timedScan), name)
+
+#else
+
+#define RADAR_PROFILE_TICKS(radar, name) do { } while (0)
+#define RADAR_PROFILE_RESTART(radar, name) do { } while (0)
+#define RADAR_PROFILE_STAGE(radar, stage, name) do { } while (0)
+#define RADAR_PROFILE_SPAN(radar, stage, startName, endName) do { } while (0)
+#define RADAR_PROFILE_SCAN_TICKS(radar, name) do { } while (0)
+#define RADAR_PROFILE_SCAN_STAGE(radar, stage, name) do { } while (0)
+
+#endif
+
+#if RADAR_PROFILING
+#define RADAR_PROFILE_COUNT(radar, counter, amount) (radar)->profile.counter = (radar)->profile.counter + (amount)
+#else
+#define RADAR_PROFILE_COUNT(radar, counter, amount) do { } while (0)
+#endif
+
+
+
+
+void clearTransmitterBuffers(transmitterData *transmitterX) { // zeroes the sample and variance buffers together with their running sums
+  for (int sampleIndex = 0; sampleIndex < MAX_SAMPLEBUFFERSIZE_MULTI; sampleIndex++) {
+    transmitterX->sampleBuffer[sampleIndex] = 0;
+  }
+  for (int varianceIndex = 0; varianceIndex < MAX_VARIANCEBUFFERSIZE_MULTI; varianceIndex++) {
+    transmitterX->varianceBuffer[varianceIndex] = 0;
+  }
+  transmitterX->mobileAverageSum = 0;
+  transmitterX->varianceBufferSum = 0;
+  transmitterX->varianceIntegral = 0;
+}
 
 
+void resyncRunningSums(transmitterData *transmitterX) { // rebuilds the running sums from the buffers, called only when the window sizes have been changed, it is the slow path
 
+  // safety clamps, the windows cannot exceed the buffers they slide on
+  if ((transmitterX->sampleBufferSize < 1) || (transmitterX->sampleBufferSize > MAX_SAMPLEBUFFERSIZE_MULTI)) {
+    transmitterX->sampleBufferSize = MAX_SAMPLEBUFFERSIZE_MULTI;
+  }
+  if ((transmitterX->varianceBufferSize < 1) || (transmitterX->varianceBufferSize > MAX_VARIANCEBUFFERSIZE_MULTI)) {
+    transmitterX->varianceBufferSize = MAX_VARIANCEBUFFERSIZE_MULTI;
+  }
+  if (transmitterX->mobileAverageFilterSize < 1) {
+    transmitterX->mobileAverageFilterSize = 1;
+  }
+  if (transmitterX->mobileAverageFilterSize > transmitterX->sampleBufferSize) {
+    transmitterX->mobileAverageFilterSize = transmitterX->sampleBufferSize;
+  }
+  if (transmitterX->varianceIntegratorLimit < 1) {
+    transmitterX->varianceIntegratorLimit = 1;
+  }
+  if (transmitterX->varianceIntegratorLimit > transmitterX->varianceBufferSize) {
+    transmitterX->varianceIntegratorLimit = transmitterX->varianceBufferSize;
+  }
+  if (transmitterX->sampleBufferIndex >= transmitterX->sampleBufferSize) {
+    transmitterX->sampleBufferIndex = 0;
+  }
+  if (transmitterX->varianceBufferIndex >= transmitterX->varianceBufferSize) {
+    transmitterX->varianceBufferIndex = 0;
+  }
 
-int multistatic_interference_radar_process(int sample, transmitterData *transmitterX) { // send the RSSI signal, returns the detection level ( < 0 -> error, == 0 -> no detection, > 0 -> detection level in dBm)
+  // a shrunk ring leaves older values past its end: clear them, or they would come back into the windows (and into varianceBufferSum) if it grows again
+  for (int sampleIndex = transmitterX->sampleBufferSize; sampleIndex < MAX_SAMPLEBUFFERSIZE_MULTI; sampleIndex++) {
+    transmitterX->sampleBuffer[sampleIndex] = 0;
+  }
+  for (int varianceIndex = transmitterX->varianceBufferSize; varianceIndex < MAX_VARIANCEBUFFERSIZE_MULTI; varianceIndex++) {
+    transmitterX->varianceBuffer[varianceIndex] = 0;
+  }
 
+  // the latest samples sit right before the current write index
+  int pointer = 0;
+  transmitterX->mobileAverageSum = 0;
+  for (int sampleIndex = 1; sampleIndex <= transmitterX->mobileAverageFilterSize; sampleIndex++) {
+    pointer = transmitterX->sampleBufferIndex - sampleIndex;
+    if (pointer < 0) {
+      pointer = pointer + transmitterX->sampleBufferSize;
+    }
+    transmitterX->mobileAverageSum = transmitterX->mobileAverageSum + transmitterX->sampleBuffer[pointer];
+  }
 
-  if ((transmitterX->sampleBuffer == NULL) || (transmitterX->mobileAverageBuffer == NULL) || (transmitterX->varianceBuffer == NULL)) {
+  transmitterX->varianceBufferSum = 0;
+  for (int varianceIndex = 0; varianceIndex < transmitterX->varianceBufferSize; varianceIndex++) {
+    transmitterX->varianceBufferSum = transmitterX->varianceBufferSum + transmitterX->varianceBuffer[varianceIndex];
+  }
 
-    if (debugRadarMsg >= 1) {
-      Serial.print("multistatic_interference_radar_process(): alarm: detected unallocated buffers: did you call bistatic_interference_radar_init() to allocate the buffers?");
+  transmitterX->varianceIntegral = 0;
+  for (int varianceIndex = 1; varianceIndex <= transmitterX->varianceIntegratorLimit; varianceIndex++) {
+    pointer = transmitterX->varianceBufferIndex - varianceIndex;
+    if (pointer < 0) {
+      pointer = pointer + transmitterX->varianceBufferSize;
     }
+    transmitterX->varianceIntegral = transmitterX->varianceIntegral + transmitterX->varianceBuffer[pointer];
+  }
+
+  transmitterX->mobileAverageSumSize = transmitterX->mobileAverageFilterSize;
+  transmitterX->varianceIntegralSize = transmitterX->varianceIntegratorLimit;
+  transmitterX->sampleBufferSumSize = transmitterX->sampleBufferSize;
+  transmitterX->varianceBufferSumSize = transmitterX->varianceBufferSize;
+}
+
+
+
+
+
+
+int bootstrapVarianceSample(int varianceSample, int meanWindow, int filterSize) { // bootstrap mode: the squared deviation from the mean of the m samples it is part of is biased low by (m - 1) / m, 
+  // it is rescaled to the bias of the full window estimator, (F - 1) / F, so that nothing jumps when the full window takes over
+  if ((meanWindow < 2) || (meanWindow >= filterSize)) {
+    return varianceSample;
+  }
+  return (varianceSample * meanWindow * (filterSize - 1) + (meanWindow - 1) * filterSize / 2) / ((meanWindow - 1) * filterSize); // rounded: the squared deviations are small integers, truncating would eat most of the correction
+}
+
+
+int bootstrapIntegral(int varianceIntegral, int varianceUpdates, int integratorLimit) { // bootstrap mode: the integrator has only seen varianceUpdates entries yet, the others are zeroes
+  if (varianceUpdates >= integratorLimit) {
+    return varianceIntegral;
+  }
+  return varianceIntegral * integratorLimit / varianceUpdates;
+}
+
+
+int bootstrapAR(int varianceAR, int varianceUpdates) { // bootstrap mode: the autoregressive filter starts from 0, after k updates of a steady input it only holds (1 - 2^-k) of it
+  if (varianceUpdates >= 30) {
+    return varianceAR;
+  }
+  return varianceAR + varianceAR / ((1 << varianceUpdates) - 1);
+}
+
+
+
+
+void freeTransmitterSlot(radarContext * radar, int slotIndex);
+void setSlotBSSID(radarContext * radar, int slotIndex, const uint8_t * newBSSID);
+
+
+int multistatic_interference_radar_init(radarContext * radar, int poolSize) { // binds the transmitters pool to the arena and cleans it, returns the pool size
+
+  if ((poolSize < 1) || (poolSize > TRANSMITTERS_POOL_SIZE)) {
+    poolSize = TRANSMITTERS_POOL_SIZE;
+  }
+
+  radar->accessPoints.transmittersData = radar->transmittersArena;
+  radar->accessPoints.transmittersPoolSize = poolSize;
+
+  for (int slotIndex = 0; slotIndex < poolSize; slotIndex++) {
+    radar->accessPoints.transmittersData[slotIndex] = transmitterData(); // back to the defaults declared in the header
+    freeTransmitterSlot(radar, slotIndex);
+  }
+
+  if (radar->accessPoints.transmittersListLen > poolSize) {
+    radar->accessPoints.transmittersListLen = poolSize;
+  }
+  if (radar->accessPoints.transmittersListLen < 1) {
+    radar->accessPoints.transmittersListLen = 1;
+  }
+  radar->accessPoints.initComplete = 0; // the free slots will be filled with the next scan
+  radar->accessPoints.scanPlan.fullSweepRequested = 1;
+
+  if (RADAR_LOG_ENABLED(radar, 1)) {
+    Serial.print("multistatic_interference_radar_init(): transmitters pool size: ");
+    Serial.print(poolSize);
+    Serial.print("; active transmitters: ");
+    Serial.println(radar->accessPoints.transmittersListLen);
+  }
+
+  return poolSize;
+}
+
+
+void checkTransmittersPool(radarContext * radar) { // binds the pool on first use, for those who never call multistatic_interference_radar_init()
+  if (radar->accessPoints.transmittersData == NULL) {
+    multistatic_interference_radar_init(radar, TRANSMITTERS_POOL_SIZE);
+  }
+}
+
+
+void freeTransmitterSlot(radarContext * radar, int slotIndex) { // empties a slot and requests a reset of its transmitter data
+  setSlotBSSID(radar, slotIndex, NULL);
+  radar->accessPoints.SSIDs[slotIndex][0] = 0;
+  radar->accessPoints.APslotStatus[slotIndex] = AP_SLOT_STATUS_FREE;
+  radar->accessPoints.latestVariances[slotIndex] = 0;
+  radar->accessPoints.transmittersData[slotIndex].alarmStatus = 0;
+  radar->accessPoints.transmittersData[slotIndex].resetRequest = 1;
+}
+
+
+
+
+int processLinkSample(radarContext * radar, int sample, transmitterData *transmitterX) { // send the RSSI signal, returns the detection level ( < 0 -> error, == 0 -> no detection, > 0 -> detection level in dBm)
+
+
+  if (transmitterX == NULL) {
+
+    RADAR_LOG(radar, 1, RADAR_EVENT_PROCESS_UNINITIALIZED);
     return RADAR_UNINITIALIZED; // unallocated buffers
   }
 
@@ -30,19 +549,34 @@ int multistatic_interference_radar_process(int sample, transmitterData *transmit
   // did we receive a rest request? 
 
   if (transmitterX->resetRequest == 1) {
+    RADAR_PROFILE_COUNT(radar, filterResets, 1);
     transmitterX->resetRequest = 0;
     transmitterX->sampleBufferIndex = 0;
-    transmitterX->mobileAverageBufferIndex = 0;
     transmitterX->varianceBufferIndex = 0;
     transmitterX->resetRequest = 0;
     transmitterX->sampleBufferValid = 0;
-    transmitterX->mobileAverageBufferValid = 0;
     transmitterX->varianceBufferValid = 0;
     transmitterX->variance = -1;
+    transmitterX->varianceAR = 0; // a new transmitter does not inherit the filter state of the previous one (same as the batch kernel), the bootstrap correction counts on it
+    clearTransmitterBuffers(transmitterX); // the running sums need clean buffers, stale data from the previous instance would otherwise leak into the new windows
+  }
+
+  // the running sums are only meaningful for the window and ring sizes they were built with: if the sizes have been changed from the outside, rebuild them now (this is the only full window scan left)
+  if ((transmitterX->mobileAverageSumSize != transmitterX->mobileAverageFilterSize) || (transmitterX->varianceIntegralSize != transmitterX->varianceIntegratorLimit) ||
+      (transmitterX->sampleBufferSumSize != transmitterX->sampleBufferSize) || (transmitterX->varianceBufferSumSize != transmitterX->varianceBufferSize)) {
+    resyncRunningSums(transmitterX);
   }
 
 
-  // store a copy of the actual received sample, whatever it is, for external usage
+  // the compact layout holds the samples in 8 bits and sizes the sums on that range: nothing a radio reports is outside of it
+  if (sample < ABSOLUTE_RSSI_LIMIT) {
+    sample = ABSOLUTE_RSSI_LIMIT;
+  }
+  if (sample > 0) {
+    sample = 0;
+  }
+
+  // store a copy of the actual received sample, for external usage
   transmitterX->latestReceivedSample = sample; 
   
   // now doing the minimum_RSSI test and updating the internat structure status
@@ -52,9 +586,7 @@ int multistatic_interference_radar_process(int sample, transmitterData *transmit
   
   if (sample < transmitterX->minimum_RSSI) {
     
-    if (debugRadarMsg >= 4) {
-      Serial.print("multistatic_interference_radar_process(): warning: RSSI under the minimum RSSI threshold detected for the current instance");
-    }
+    RADAR_LOG(radar, 4, RADAR_EVENT_PROCESS_WEAK_RSSI, sample, transmitterX->minimum_RSSI);
     if (transmitterX->sampleBufferValid == 1) {
       sample = transmitterX->mobileAverage;
     }
@@ -67,6 +599,13 @@ int multistatic_interference_radar_process(int sample, transmitterData *transmit
   }
   
 
+  // sliding the mobile average window: add the newest sample, subtract the one falling out of the window (mobileAverageFilterSize samples ago, it is still in the buffer since the filter size never exceeds the buffer size)
+  int evictedSampleIndex = transmitterX->sampleBufferIndex - transmitterX->mobileAverageFilterSize;
+  if (evictedSampleIndex < 0) {
+    evictedSampleIndex = evictedSampleIndex + transmitterX->sampleBufferSize;
+  }
+  transmitterX->mobileAverageSum = transmitterX->mobileAverageSum + sample - transmitterX->sampleBuffer[evictedSampleIndex]; // please note: read the evicted sample BEFORE overwriting, with a full size filter the two positions coincide
+
   transmitterX->sampleBuffer[transmitterX->sampleBufferIndex] = sample;
   transmitterX->sampleBufferIndex++;
   if ( transmitterX->sampleBufferIndex >= transmitterX->sampleBufferSize ) { // circular buffer, rewinding the index, if the buffer has been filled at least once, then we may start processing valid data
@@ -74,105 +613,77 @@ int multistatic_interference_radar_process(int sample, transmitterData *transmit
     transmitterX->sampleBufferValid = 1;
   }
   
-  if (transmitterX->sampleBufferValid >= 1) {
-    // filling in the mobile average data buffer
-    // the mobile average can be re-calculated even on a full sampleBufferSize set of valid samples, I see no problem in terms of computational load
-    // calculating the current mobile average now.  the sampleBufferIndex points now to the oldest sample
-    transmitterX->mobileAverageTemp = 0;
-    int mobilePointer = 0;
-    for (int mobileAverageSampleIndex = 0; mobileAverageSampleIndex < transmitterX->mobileAverageFilterSize; mobileAverageSampleIndex++) {
-      mobilePointer = transmitterX->sampleBufferIndex - mobileAverageSampleIndex;
-      if (mobilePointer <= 0) {
-        mobilePointer = mobilePointer + (transmitterX->sampleBufferSize -1);
-      }
-      transmitterX->mobileAverageTemp = transmitterX->mobileAverageTemp + transmitterX->sampleBuffer[mobilePointer];
+  // bootstrap mode: a booting link with at least BOOTSTRAP_MIN_SAMPLES samples is processed as well, over the samples it has (the older buffer entries are still zeroes)
+  int samplesSoFar = transmitterX->sampleBufferIndex; // only meaningful while the sample buffer is not valid yet
+  int bootstrapping = (radar->accessPoints.bootstrapMode >= 1) && (transmitterX->sampleBufferValid == 0) && (samplesSoFar >= BOOTSTRAP_MIN_SAMPLES);
+  int varianceUpdates = samplesSoFar - BOOTSTRAP_MIN_SAMPLES + 1; // bootstrap mode: variance samples produced since the reset, this one included
+
+  if ((transmitterX->sampleBufferValid >= 1) || bootstrapping) {
+    // the mobile average over the latest mobileAverageFilterSize samples comes straight from the running sum
+    int meanWindow = transmitterX->mobileAverageFilterSize;
+    if (bootstrapping && (samplesSoFar < meanWindow)) { // growing window
+      meanWindow = samplesSoFar;
     }
-    transmitterX->mobileAverage = transmitterX->mobileAverageTemp / transmitterX->mobileAverageFilterSize;
-    // filling in the mobile average buffer with the fresh new value
-    transmitterX->mobileAverageBuffer[transmitterX->mobileAverageBufferIndex] = transmitterX->mobileAverage;  // to be fair, this buffer is filled but still ...really unused.
-    // truth being said, I'm filling the transmitterX->mobileAverageBuffer for future logging purposes. (TBD)
+    transmitterX->mobileAverage = transmitterX->mobileAverageSum / meanWindow;
     
     // since we have the current mobile average data, we can also extract the current variance data. 
-    // the variable named "variance" at this point still contains the *previous* value of the variance   
-    transmitterX->variancePrev = transmitterX->variance;
     // deviation of the current sample
-    transmitterX->varianceSample = (sample - transmitterX->mobileAverageBuffer[transmitterX->mobileAverageBufferIndex])*(sample - transmitterX->mobileAverageBuffer[transmitterX->mobileAverageBufferIndex]);
+    transmitterX->varianceSample = (sample - transmitterX->mobileAverage)*(sample - transmitterX->mobileAverage);
+    if (bootstrapping) {
+      transmitterX->varianceSample = bootstrapVarianceSample(transmitterX->varianceSample, meanWindow, transmitterX->mobileAverageFilterSize);
+    }
     
     // FIRsecondOrderFilter operations // please note, I'm improperly using the term FIR here: there is an IIR component too. 
     transmitterX->FIRvarianceAvg = 0;
-    if (accessPoints.secondOrderFilter >= 1) {
-      // computing FIRvarianceAvg
-      int FIRvarianceAvgTemp = 0;
-      for (int varianceSampleIndex = 0; varianceSampleIndex < transmitterX->varianceBufferSize; varianceSampleIndex++) {
-        FIRvarianceAvgTemp = FIRvarianceAvgTemp + transmitterX->varianceBuffer[varianceSampleIndex];
+    if (radar->accessPoints.secondOrderFilter >= 1) {
+      // FIRvarianceAvg comes from the running sum of the whole variance buffer (still holding the previous values at this point)
+      int varianceEntries = transmitterX->varianceBufferSize;
+      if (bootstrapping && (varianceUpdates - 1 < varianceEntries)) { // growing window: only the entries written so far
+        varianceEntries = (varianceUpdates > 1) ? varianceUpdates - 1 : 1;
       }
-      transmitterX->FIRvarianceAvg = (FIRvarianceAvgTemp / transmitterX->varianceBufferSize) / accessPoints.secondOrderAttenutationCoefficient;
+      transmitterX->FIRvarianceAvg = (transmitterX->varianceBufferSum / varianceEntries) / radar->accessPoints.secondOrderAttenutationCoefficient;
       transmitterX->varianceSample = abs(transmitterX->varianceSample - transmitterX->FIRvarianceAvg); // subtracting the mobile average variance from the variance sample
 
      
     }
     
     
-    // filling in the variance buffer
+    // the following is a mobile integrator filter over the latest varianceIntegratorLimit entries of the circular buffer called varianceBuffer, kept as a running sum as well
+    int evictedVarianceIndex = transmitterX->varianceBufferIndex - transmitterX->varianceIntegratorLimit;
+    if (evictedVarianceIndex < 0) {
+      evictedVarianceIndex = evictedVarianceIndex + transmitterX->varianceBufferSize;
+    }
+    transmitterX->varianceIntegral = transmitterX->varianceIntegral + transmitterX->varianceSample - transmitterX->varianceBuffer[evictedVarianceIndex]; // the full effect of this operation is to make the system more sensitive to continued variations of the RSSI, possibly meaning there's a moving object around the area.
+    transmitterX->varianceBufferSum = transmitterX->varianceBufferSum + transmitterX->varianceSample - transmitterX->varianceBuffer[transmitterX->varianceBufferIndex];
+
+    // filling in the variance buffer (only now: the evicted values above had to be read first)
     transmitterX->varianceBuffer[transmitterX->varianceBufferIndex] = transmitterX->varianceSample;
 
-    
-    
-    // the following is a mobile integrator filter that parses the circular buffer called varianceBuffer
-    transmitterX->varianceIntegral = 0;
-    int variancePointer = 0;
-    for (int varianceBufferIndexTemp = 0; varianceBufferIndexTemp < transmitterX->varianceIntegratorLimit; varianceBufferIndexTemp++) {
-     variancePointer = transmitterX->varianceBufferIndex - varianceBufferIndexTemp;
-     if (variancePointer <=0) {
-        variancePointer = variancePointer + (transmitterX->varianceBufferSize -1);
-     }
-     transmitterX->varianceIntegral = transmitterX->varianceIntegral + transmitterX->varianceBuffer[variancePointer]; // the full effect of this operation is to make the system more sensitive to continued variations of the RSSI, possibly meaning there's a moving object around the area.
-    }
     // increasing and checking the variance buffer index
     transmitterX->varianceBufferIndex++;
     if ( transmitterX->varianceBufferIndex >= transmitterX->varianceBufferSize ) { // circular buffer, rewinding the index, if the buffer has been filled at least once, then we may start processing valid data
       transmitterX->varianceBufferIndex = 0;
       transmitterX->varianceBufferValid = 1; //please note we DO NOT need to have a fully validated buffer to work with the current M.A. data
     }
+    int varianceIntegral = transmitterX->varianceIntegral;
+    if (bootstrapping) {
+      varianceIntegral = bootstrapIntegral(varianceIntegral, varianceUpdates, transmitterX->varianceIntegratorLimit);
+    }
     // applying the autoregressive part
-    transmitterX->varianceAR = (transmitterX->varianceIntegral + transmitterX->varianceAR) / 2; // the effect of this filter is to "smooth" down the signal over time, so it's a simple IIR (infinite impulse response) low pass filter. It makes the system less sensitive to noisy signals, especially those with a variance of less than 1dBm.
+    transmitterX->varianceAR = (varianceIntegral + transmitterX->varianceAR) / 2; // the effect of this filter is to "smooth" down the signal over time, so it's a simple IIR (infinite impulse response) low pass filter. It makes the system less sensitive to noisy signals, especially those with a variance of less than 1dBm.
 
       // diagnostics section
-    if (debugRadarMsg >= 2) {
-      Serial.println("");
-      Serial.print("multistatic_interference_radar_process(): sampleBufferValid: yes: ");
-      Serial.print(" rxRSSI: "); 
-      Serial.print(transmitterX->latestReceivedSample);
-      Serial.print(" prcsRSSI: "); 
-      Serial.print(sample);
-      Serial.print(", mobileAverage: "); 
-      Serial.print(transmitterX->mobileAverage);
-      Serial.print(", deviation: "); 
-      Serial.print(sample - transmitterX->mobileAverage);
-      Serial.print(", variance: "); 
-      Serial.print(transmitterX->varianceSample);
-      Serial.print(", varianceIntegral: "); 
-      Serial.print(transmitterX->varianceIntegral);
-      Serial.print(", varianceAR: "); 
-      Serial.println(transmitterX->varianceAR);
-
-    }
+    RADAR_LOG(radar, 2, RADAR_EVENT_PROCESS_SAMPLE, transmitterX->latestReceivedSample, sample, transmitterX->mobileAverage, transmitterX->varianceSample, 
+              transmitterX->varianceIntegral, transmitterX->varianceAR);
     
     // assigning the values according to the settings
     transmitterX->variance = transmitterX->varianceSample; 
     
     if (transmitterX->enableAutoRegressive) {
-      transmitterX->variance = transmitterX->varianceAR;
+      transmitterX->variance = bootstrapping ? bootstrapAR(transmitterX->varianceAR, varianceUpdates) : transmitterX->varianceAR;
     }
     if (! transmitterX->enableAutoRegressive) {
-      transmitterX->variance = transmitterX->varianceIntegral;
-    }
-    
-    // note: we needed to point to the current mobile average data for future operations, so we increase the MA buffer index only as the last step
-    transmitterX->mobileAverageBufferIndex++;
-    if ( transmitterX->mobileAverageBufferIndex >= transmitterX->mobileAverageBufferSize ) { // circular buffer, rewinding the index, if the buffer has been filled at least once, then we may start processing valid data
-      transmitterX->mobileAverageBufferIndex = 0;
-      transmitterX->mobileAverageBufferValid = 1; //please note we DO NOT need to have a fully validated buffer to work with the current M.A. data
+      transmitterX->variance = varianceIntegral;
     }
     
   }
@@ -181,19 +692,13 @@ int multistatic_interference_radar_process(int sample, transmitterData *transmit
   // final check to determine if the detected variance signal is above the detection threshold, this is only done if enableThreshold > 0 
   if ((transmitterX->variance >= transmitterX->varianceThreshold) && (transmitterX->enableThreshold > 0)) {
     transmitterX->detectionLevel = transmitterX->variance;
-    if (debugRadarMsg >= 1) {
-    	Serial.print("multistatic_interference_radar_process(): detected variance signal above threshold: ");
-    	Serial.print(transmitterX->detectionLevel);
-    }
+    RADAR_LOG(radar, 1, RADAR_EVENT_PROCESS_DETECTION, transmitterX->detectionLevel, transmitterX->varianceThreshold);
     return transmitterX->detectionLevel;
   }
   // variance signal under threshold, but otherwise valid?
   if ((transmitterX->variance < transmitterX->varianceThreshold) && (transmitterX->variance >= 0) && (transmitterX->enableThreshold > 0) ) {
     transmitterX->detectionLevel = 0;
-    if (debugRadarMsg >= 2) {
-    	Serial.print("multistatic_interference_radar_process(): variance signal under threshold: ");
-    	Serial.print(transmitterX->variance);
-    }
+    RADAR_LOG(radar, 2, RADAR_EVENT_PROCESS_UNDER_THRESHOLD, transmitterX->variance, transmitterX->varianceThreshold);
     return transmitterX->detectionLevel;
   }
   
@@ -202,113 +707,420 @@ int multistatic_interference_radar_process(int sample, transmitterData *transmit
 }
 
 
+int multistatic_interference_radar_process(radarContext * radar, int sample, transmitterData *transmitterX) { // processLinkSample(), traced
+#if RADAR_TRACING
+  if (radar->trace.enabled == 1) {
+    RADAR_TRACE_BEGIN(radar, processTicks);
+    int res = processLinkSample(radar, sample, transmitterX);
+    int slotIndex = (int) (transmitterX - radar->accessPoints.transmittersData);
+    slotIndex = ((radar->accessPoints.transmittersData != NULL) && (slotIndex >= 0) && (slotIndex < radar->accessPoints.transmittersPoolSize)) ? slotIndex : -1;
+    RADAR_TRACE_END(radar, RADAR_TRACE_PROCESS, slotIndex, processTicks);
+    return res;
+  }
+#endif
+  return processLinkSample(radar, sample, transmitterX);
+}
 
 
-uint8_t strongestBSSID[6] = {0};
-int strongestRSSI = -100;
-int strongestChannel = 0;
-int strongestAPfound = 0; // if found set to 1
 
 
-uint8_t * currentBSSID;
-int currentRSSI = 0;
-int currentChannel = 0;
+void resetBatchLink(transmittersBatchData *batch, int link) { // cleans a single link column of the batch data
+  for (int sampleIndex = 0; sampleIndex < MAX_SAMPLEBUFFERSIZE_MULTI; sampleIndex++) {
+    batch->sampleRing[sampleIndex][link] = 0;
+  }
+  for (int varianceIndex = 0; varianceIndex < MAX_VARIANCEBUFFERSIZE_MULTI; varianceIndex++) {
+    batch->varianceRing[varianceIndex][link] = 0;
+  }
+  batch->samplesCount[link] = 0;
+  batch->mobileAverageSum[link] = 0;
+  batch->varianceBufferSum[link] = 0;
+  batch->varianceIntegral[link] = 0;
+  batch->varianceAR[link] = 0;
+  batch->mobileAverage[link] = 0;
+  batch->variance[link] = -1;
+  batch->varianceSample[link] = 0;
+  batch->resetRequest[link] = 0;
+}
 
 
-char * multistatic_find_next_strongest_AP() {
-  
+void setupBatchWindows(transmittersBatchData *batch) { // window sizes changed (or never set up)? clamp them and restart every link, the slow path
+  if ((batch->windowsSize == batch->mobileAverageFilterSize) && (batch->integratorSize == batch->varianceIntegratorLimit)) {
+    return;
+  }
+  if ((batch->sampleBufferSize < 1) || (batch->sampleBufferSize > MAX_SAMPLEBUFFERSIZE_MULTI)) {
+    batch->sampleBufferSize = MAX_SAMPLEBUFFERSIZE_MULTI;
+  }
+  if ((batch->varianceBufferSize < 1) || (batch->varianceBufferSize > MAX_VARIANCEBUFFERSIZE_MULTI)) {
+    batch->varianceBufferSize = MAX_VARIANCEBUFFERSIZE_MULTI;
+  }
+  if ((batch->mobileAverageFilterSize < 1) || (batch->mobileAverageFilterSize > batch->sampleBufferSize)) {
+    batch->mobileAverageFilterSize = batch->sampleBufferSize;
+  }
+  if ((batch->varianceIntegratorLimit < 1) || (batch->varianceIntegratorLimit > batch->varianceBufferSize)) {
+    batch->varianceIntegratorLimit = batch->varianceBufferSize;
+  }
+  for (int link = 0; link < MAX_ALLOWED_TRANSMITTERS_NUMBER; link++) {
+    resetBatchLink(batch, link);
+  }
+  batch->sampleBufferIndex = 0;
+  batch->varianceBufferIndex = 0;
+  batch->windowsSize = batch->mobileAverageFilterSize;
+  batch->integratorSize = batch->varianceIntegratorLimit;
 }
 
 
-int searchSlotByBSSID(uint8_t * searchBSSID) {  // returns -1 if not found, returns the slot index for the transmitters list if found
-  int res = -1;
-  int bssidScanOK = 0;
-
-  for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
-    bssidScanOK = 0;
-    for (int bssidIndex = 0; bssidIndex < 6; bssidIndex++) { // compare with the recorded BSSID, byte by byte
-        if (searchBSSID[bssidIndex] == accessPoints.BSSIDs[slotIndex][bssidIndex]) {
-          bssidScanOK = 1; 
-        } else {
-          bssidScanOK = 0; // match failed, resetting the flag 
-          break; // no matter wich single byte failed to match, we break out of the compare loop
-        }
-    } // BSSID compare loop
-    if (bssidScanOK == 1) { // result found!
-      return slotIndex;
+int multistatic_interference_radar_process_batch(const int *samples, int *results, transmittersBatchData *batch) { // one sample per link, returns the number of processed links
+
+  int linksNumber = batch->linksNumber;
+  if (linksNumber > MAX_ALLOWED_TRANSMITTERS_NUMBER) {
+    linksNumber = MAX_ALLOWED_TRANSMITTERS_NUMBER;
+  }
+  if (linksNumber <= 0) {
+    return 0;
+  }
+
+  setupBatchWindows(batch);
+
+  // per link reset requests, rare, kept out of the main loop
+  for (int link = 0; link < linksNumber; link++) {
+    if (batch->resetRequest[link] == 1) {
+      resetBatchLink(batch, link);
     }
-  } // main for loop
+  }
 
-  // if we get up to this point, clearly no matching BSSID was found
-  return res;
-  
+  // the window positions are shared by all the links: resolve the rows once
+  int evictedSampleIndex = batch->sampleBufferIndex - batch->mobileAverageFilterSize;
+  if (evictedSampleIndex < 0) {
+    evictedSampleIndex = evictedSampleIndex + batch->sampleBufferSize;
+  }
+  int evictedVarianceIndex = batch->varianceBufferIndex - batch->varianceIntegratorLimit;
+  if (evictedVarianceIndex < 0) {
+    evictedVarianceIndex = evictedVarianceIndex + batch->varianceBufferSize;
+  }
+  int8_t *sampleRow = batch->sampleRing[batch->sampleBufferIndex];
+  const int8_t *evictedSampleRow = batch->sampleRing[evictedSampleIndex];
+  uint16_t *varianceRow = batch->varianceRing[batch->varianceBufferIndex];
+  const uint16_t *evictedVarianceRow = batch->varianceRing[evictedVarianceIndex];
+
+  const int sampleBufferSize = batch->sampleBufferSize;
+  const int filterSize = batch->mobileAverageFilterSize;
+  const int varianceBufferSize = batch->varianceBufferSize;
+  const int secondOrderFilter = batch->secondOrderFilter;
+  const int attenuation = batch->secondOrderAttenutationCoefficient;
+  const int bootstrapMode = (batch->bootstrapMode >= 1);
+  const int integratorLimit = batch->varianceIntegratorLimit;
+
+  // the main loop: no calls, no early exits, every decision is a select, so that one iteration is the same for every link
+  // please note: the evicted rows must be read before the current rows are written, with full size windows they are the same row
+  for (int link = 0; link < linksNumber; link++) {
+    int sample = samples[link];
+    sample = (sample < ABSOLUTE_RSSI_LIMIT) ? ABSOLUTE_RSSI_LIMIT : ((sample > 0) ? 0 : sample); // the 8 bit rings, same clamp as the scalar version
+    batch->latestReceivedSample[link] = sample;
+
+    int validBefore = (batch->samplesCount[link] >= sampleBufferSize);
+    int rssiOK = (sample >= batch->minimum_RSSI[link]);
+    batch->currentRSSI[link] = rssiOK ? sample : batch->currentRSSI[link];
+    sample = rssiOK ? sample : (validBefore ? batch->mobileAverage[link] : batch->currentRSSI[link]); // weak samples are replaced, just like the scalar version
+
+    int sum = batch->mobileAverageSum[link] + sample - evictedSampleRow[link];
+    batch->mobileAverageSum[link] = sum;
+    sampleRow[link] = sample;
+
+    int count = batch->samplesCount[link] + 1;
+    count = (count > sampleBufferSize) ? sampleBufferSize : count;
+    batch->samplesCount[link] = count;
+    int valid = (count >= sampleBufferSize);
+    int bootstrapping = bootstrapMode && (valid == 0) && (count >= BOOTSTRAP_MIN_SAMPLES); // same growing windows and corrections as the scalar version
+    int active = valid || bootstrapping;
+    int updates = count - BOOTSTRAP_MIN_SAMPLES + 1; // bootstrapping links only: variance samples produced, this one included
+    updates = (updates < 1) ? 1 : ((updates > 30) ? 30 : updates);
+
+    int meanWindow = (count < filterSize) ? count : filterSize; // filterSize once valid
+    int mean = sum / meanWindow;
+    batch->mobileAverage[link] = active ? mean : batch->mobileAverage[link];
+
+    int varianceSample = (sample - mean) * (sample - mean);
+    int shortWindow = bootstrapping && (meanWindow >= 2) && (meanWindow < filterSize);
+    int correctionDivisor = (shortWindow ? meanWindow - 1 : 1) * filterSize;
+    varianceSample = shortWindow ? (varianceSample * meanWindow * (filterSize - 1) + correctionDivisor / 2) / correctionDivisor : varianceSample;
+    int varianceEntries = (bootstrapping && (updates - 1 < varianceBufferSize)) ? ((updates > 1) ? updates - 1 : 1) : varianceBufferSize;
+    int FIRvarianceAvg = secondOrderFilter ? (batch->varianceBufferSum[link] / varianceEntries) / attenuation : 0; // only evaluated with the filter on, like the scalar version: the coefficient may be anything when it is off
+    int filtered = varianceSample - FIRvarianceAvg;
+    filtered = (filtered < 0) ? -filtered : filtered;
+    varianceSample = secondOrderFilter ? filtered : varianceSample;
+    varianceSample = active ? varianceSample : 0; // booting links keep writing zeroes, their columns stay clean
+    batch->varianceSample[link] = active ? varianceSample : batch->varianceSample[link];
+
+    int integral = batch->varianceIntegral[link] + varianceSample - evictedVarianceRow[link];
+    batch->varianceIntegral[link] = integral;
+    batch->varianceBufferSum[link] = batch->varianceBufferSum[link] + varianceSample - varianceRow[link];
+    varianceRow[link] = varianceSample;
+    integral = (bootstrapping && (updates < integratorLimit)) ? integral * integratorLimit / updates : integral;
+
+    int varianceAR = (integral + batch->varianceAR[link]) / 2;
+    batch->varianceAR[link] = active ? varianceAR : batch->varianceAR[link];
+    varianceAR = bootstrapping ? varianceAR + varianceAR / ((1 << updates) - 1) : varianceAR;
+
+    int variance = batch->enableAutoRegressive[link] ? varianceAR : integral;
+    variance = active ? variance : batch->variance[link];
+    batch->variance[link] = variance;
+
+    // threshold: above -> variance, valid but under -> 0, otherwise the raw (possibly booting) value
+    int thresholdEnabled = (batch->enableThreshold[link] > 0);
+    int underThreshold = (variance < batch->varianceThreshold[link]) && (variance >= 0);
+    results[link] = (thresholdEnabled && underThreshold) ? 0 : variance;
+  }
+
+  batch->sampleBufferIndex++;
+  if (batch->sampleBufferIndex >= sampleBufferSize) {
+    batch->sampleBufferIndex = 0;
+  }
+  batch->varianceBufferIndex++;
+  if (batch->varianceBufferIndex >= varianceBufferSize) {
+    batch->varianceBufferIndex = 0;
+  }
+
+  return linksNumber;
 }
 
-void checkTXlist() {
-  // now checking the transmitters list
-    for (int dbgSlotIndex = 0; dbgSlotIndex < accessPoints.transmittersListLen; dbgSlotIndex++) {
-      Serial.print("checkTXlist(): debug parsing the extant transmitters list: accessPoints.APslotStatus[dbgSlotIndex] values: ");
-      Serial.print(accessPoints.APslotStatus[dbgSlotIndex]);
-      Serial.print(" and BSSID: ");
-      for (int dbgbssidIndex = 0; dbgbssidIndex < 6; dbgbssidIndex++) {
-        Serial.print(accessPoints.BSSIDs[dbgSlotIndex][dbgbssidIndex], HEX);
-      }
-      Serial.println("");
-    }
+
+
+
+char * multistatic_find_next_strongest_AP() {
+  return NULL; // not implemented
 }
 
-int checkInvalidTXdata() {
-  int res = 0;
-  
-  for (int itxSlotIndex = 0; itxSlotIndex < accessPoints.transmittersListLen; itxSlotIndex++) {
-    if (accessPoints.APslotStatus[itxSlotIndex] == AP_SLOT_STATUS_VALID) {
-      if ((accessPoints.BSSIDs[itxSlotIndex][0] == 0) && (accessPoints.BSSIDs[itxSlotIndex][1] == 0) && (accessPoints.BSSIDs[itxSlotIndex][2] == 0) && (accessPoints.BSSIDs[itxSlotIndex][3] == 0) && (accessPoints.BSSIDs[itxSlotIndex][4] == 0) && (accessPoints.BSSIDs[itxSlotIndex][5] == 0) ) {
-        accessPoints.APslotStatus[itxSlotIndex] = AP_SLOT_STATUS_FREE;
-        //accessPoints.transmittersData[itxSlotIndex].sampleBufferValid = 0;
-        //accessPoints.transmittersData[itxSlotIndex].mobileAverageBufferValid = 0;
-        //accessPoints.transmittersData[itxSlotIndex].varianceBufferValid = 0;
-        accessPoints.transmittersData[itxSlotIndex].resetRequest = 1; // forces all of the above commented, to be done internally
-        res++;
-      }
-    }
+
+uint64_t packBSSID(const uint8_t * BSSIDtoPack) { // packs the 6 bytes BSSID into a 48 bit key, a NULL or all zeroes BSSID gives 0
+  uint64_t key = 0;
+  if (BSSIDtoPack == NULL) {
+    return 0;
   }
-  /*
-  if (debugRadarMsg >= 17) {
-        Serial.print("checkInvalidTXdata(): final check: calling checkTXlist(): ");
-        checkTXlist();
+  for (int bssidIndex = 0; bssidIndex < 6; bssidIndex++) {
+    key = (key << 8) | BSSIDtoPack[bssidIndex];
   }
-  */
+  return key;
+}
 
-  
-  return res;
+
+constexpr int bssidIndexBits(int size) { // log2 of a power of two, at compile time
+  return (size <= 1) ? 0 : 1 + bssidIndexBits(size >> 1);
 }
 
+int bssidIndexHash(uint64_t key) { // multiplicative hashing, the top bits of the product are the best mixed ones
+  return (int)((key * 0x9E3779B97F4A7C15ULL) >> (64 - bssidIndexBits(BSSID_INDEX_SIZE))); // keep the top log2(BSSID_INDEX_SIZE) bits, always a valid entry
+}
 
-int checkInvalidRSSI() {  // returns how many invalid results have been found (how many transmitters that were previously OK, now have weak signals and are unsuitable. 
 
-  int res = 0; // all fine
-  
-  // first, parse all the APs, detect if they are already in the data structures and if so, check the RSSI for adequate levels, if inadequate mark the slot for reinitialization
+void bssidIndexClear(bssidIndex * index) {
+  for (int entry = 0; entry < BSSID_INDEX_SIZE; entry++) {
+    index->keys[entry] = 0;
+  }
+}
 
-    // please note the BSSD and SSDI can be transferred by memcpy, for example: memcpy ( strongestBSSID, currentBSSID, (sizeof(uint8_t) * 6));
 
-  // also note: accessPoints.discoveredNetworks has already been checked and guaranteed to have at least one result
+int bssidIndexInsert(bssidIndex * index, uint64_t key, int value) { // returns the entry used, -1 if the key is 0 or the table is full; the first insertion of a key wins, just like the old linear searches returned the first match
+  if (key == 0) {
+    return -1;
+  }
+  int entry = bssidIndexHash(key);
+  for (int probe = 0; probe < BSSID_INDEX_SIZE; probe++) {
+    if (index->keys[entry] == key) {
+      return entry;
+    }
+    if (index->keys[entry] == 0) {
+      index->keys[entry] = key;
+      index->values[entry] = (int16_t)value;
+      return entry;
+    }
+    entry = (entry + 1) & (BSSID_INDEX_SIZE - 1); // linear probing
+  }
+  return -1;
+}
 
-  for (int netItem = 0; netItem < accessPoints.discoveredNetworks; netItem++) {
-      currentBSSID = WiFi.BSSID(netItem);
-      currentRSSI = WiFi.RSSI(netItem);
-      currentChannel = WiFi.channel(netItem);
-      if (debugRadarMsg >= 4) {
-        Serial.print("multistatic_interference_radar(): processing netItem number: ");
-        Serial.print(netItem);
-        Serial.print(" with SSID: ");
-        Serial.print(WiFi.SSID(netItem));
-        Serial.print(" on channel: ");
-        Serial.print(currentChannel);
-        Serial.print(" with RSSI: ");
-        Serial.println(currentRSSI);
-        
+
+int bssidIndexFind(const bssidIndex * index, uint64_t key) { // returns the value stored for the key, -1 if not found
+  if (key == 0) {
+    return -1;
+  }
+  int entry = bssidIndexHash(key);
+  for (int probe = 0; probe < BSSID_INDEX_SIZE; probe++) {
+    if (index->keys[entry] == key) {
+      return index->values[entry];
+    }
+    if (index->keys[entry] == 0) {
+      return -1;
+    }
+    entry = (entry + 1) & (BSSID_INDEX_SIZE - 1);
+  }
+  return -1;
+}
+
+
+uint32_t hashSSID(const char * SSIDtoHash) { // FNV-1a, only used to speed up the SSID interning
+  uint32_t hash = 2166136261UL;
+  for (int charIndex = 0; (charIndex < SSID_STORAGE_LEN) && (SSIDtoHash[charIndex] != 0); charIndex++) {
+    hash = (hash ^ (uint8_t)SSIDtoHash[charIndex]) * 16777619UL;
+  }
+  return hash;
+}
+
+
+int internSSID(scanSnapshot * snapshot, const char * SSIDtoIntern) { // returns the index of the SSID in the snapshot SSIDs table, adding it if not there yet
+  uint32_t hash = hashSSID(SSIDtoIntern);
+  for (int SSIDindex = 0; SSIDindex < snapshot->SSIDsNumber; SSIDindex++) {
+    if ((snapshot->SSIDhashes[SSIDindex] == hash) && (strncmp(snapshot->SSIDs[SSIDindex], SSIDtoIntern, SSID_STORAGE_LEN) == 0)) {
+      return SSIDindex;
+    }
+  }
+  int SSIDindex = snapshot->SSIDsNumber; // never full: there are as many slots as scan entries
+  strncpy(snapshot->SSIDs[SSIDindex], SSIDtoIntern, SSID_STORAGE_LEN - 1);
+  snapshot->SSIDs[SSIDindex][SSID_STORAGE_LEN - 1] = 0;
+  snapshot->SSIDhashes[SSIDindex] = hash;
+  snapshot->SSIDsNumber++;
+  return SSIDindex;
+}
+
+
+void resetScanSnapshot(scanSnapshot * snapshot) {
+  snapshot->entriesNumber = 0;
+  snapshot->SSIDsNumber = 0;
+}
+
+
+int appendScanResults(radarContext * radar, const radarScanBackend * backend, scanSnapshot * snapshot, int scanResultsNumber) { // copies the latest backend scan results at the end of the snapshot in one pass, then frees the backend results memory; returns the number of entries added
+  char localSSID[SSID_STORAGE_LEN] = {0};
+  int added = 0;
+
+  for (int netItem = 0; netItem < scanResultsNumber; netItem++) {
+    if (snapshot->entriesNumber >= ABSOLUTE_MAX_SCAN_RESULTS) {
+      RADAR_LOG(radar, 1, RADAR_EVENT_SCAN_TOO_MANY_RESULTS, scanResultsNumber, ABSOLUTE_MAX_SCAN_RESULTS);
+      break;
+    }
+    scanSnapshotEntry * entry = &snapshot->entries[snapshot->entriesNumber];
+    if (backend->readResult(backend->backendData, netItem, entry, localSSID) != 0) {
+      continue;
+    }
+    entry->BSSIDkey = packBSSID(entry->BSSID);
+    entry->SSIDindex = (uint8_t) internSSID(snapshot, localSSID);
+    snapshot->entriesNumber++;
+    added++;
+  }
+
+  backend->releaseResults(backend->backendData); // everything we need is in the snapshot now
+
+  return added;
+}
+
+
+const char * snapshotSSID(radarContext * radar, int netItem) {
+  return radar->accessPoints.scanResults->SSIDs[radar->accessPoints.scanResults->entries[netItem].SSIDindex];
+}
+
+
+void rebuildScanResultsIndex(radarContext * radar) { // once per scan, right after the scan
+  bssidIndexClear(&radar->accessPoints.scanResultsIndex);
+  for (int netItem = 0; netItem < radar->accessPoints.discoveredNetworks; netItem++) {
+    bssidIndexInsert(&radar->accessPoints.scanResultsIndex, radar->accessPoints.scanResults->entries[netItem].BSSIDkey, netItem);
+  }
+}
+
+
+void rebuildSlotsIndex(radarContext * radar) { // only the active transmitters are indexed
+  bssidIndexClear(&radar->accessPoints.slotsIndex);
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    bssidIndexInsert(&radar->accessPoints.slotsIndex, radar->accessPoints.BSSIDkeys[slotIndex], slotIndex);
+  }
+  radar->accessPoints.slotsIndexDirty = 0;
+}
+
+
+void setSlotBSSID(radarContext * radar, int slotIndex, const uint8_t * newBSSID) { // the only way slots BSSIDs are changed: keeps the packed keys and the slots index coherent; NULL clears the slot BSSID
+  uint64_t previousKey = radar->accessPoints.BSSIDkeys[slotIndex];
+  for (int bssidIndex = 0; bssidIndex < 6; bssidIndex++) {
+    radar->accessPoints.BSSIDs[slotIndex][bssidIndex] = (newBSSID == NULL) ? 0 : newBSSID[bssidIndex];
+  }
+  radar->accessPoints.BSSIDkeys[slotIndex] = packBSSID(radar->accessPoints.BSSIDs[slotIndex]);
+  radar->accessPoints.missedScans[slotIndex] = 0;
+  radar->accessPoints.slotsIndexDirty = 1;
+  if (radar->accessPoints.BSSIDkeys[slotIndex] != previousKey) { // the same transmitter set again is no churn
+    if (previousKey != 0) {
+      RADAR_PROFILE_COUNT(radar, slotReleases, 1);
+    }
+    if (radar->accessPoints.BSSIDkeys[slotIndex] != 0) {
+      RADAR_PROFILE_COUNT(radar, slotAssignments, 1);
+    }
+  }
+}
+
+
+int searchSlotByKey(radarContext * radar, uint64_t searchKey) { // same as below, with a packed BSSID
+  if (radar->accessPoints.slotsIndexDirty == 1) {
+    rebuildSlotsIndex(radar);
+  }
+  return bssidIndexFind(&radar->accessPoints.slotsIndex, searchKey);
+}
+
+
+int searchSlotByBSSID(radarContext * radar, uint8_t * searchBSSID) {  // returns -1 if not found, returns the slot index for the transmitters list if found
+  return searchSlotByKey(radar, packBSSID(searchBSSID));
+}
+
+void checkTXlist(radarContext * radar) {
+  // now checking the transmitters list
+    for (int dbgSlotIndex = 0; dbgSlotIndex < radar->accessPoints.transmittersListLen; dbgSlotIndex++) {
+      Serial.print("checkTXlist(): debug parsing the extant transmitters list: accessPoints.APslotStatus[dbgSlotIndex] values: ");
+      Serial.print(radar->accessPoints.APslotStatus[dbgSlotIndex]);
+      Serial.print(" and BSSID: ");
+      for (int dbgbssidIndex = 0; dbgbssidIndex < 6; dbgbssidIndex++) {
+        Serial.print(radar->accessPoints.BSSIDs[dbgSlotIndex][dbgbssidIndex], HEX);
+      }
+      Serial.println("");
+    }
+}
+
+int checkInvalidTXdata(radarContext * radar) {
+  int res = 0;
+  
+  for (int itxSlotIndex = 0; itxSlotIndex < radar->accessPoints.transmittersListLen; itxSlotIndex++) {
+    if (radar->accessPoints.APslotStatus[itxSlotIndex] == AP_SLOT_STATUS_VALID) {
+      if (radar->accessPoints.BSSIDkeys[itxSlotIndex] == 0) {
+        radar->accessPoints.APslotStatus[itxSlotIndex] = AP_SLOT_STATUS_FREE;
+        //accessPoints.transmittersData[itxSlotIndex].sampleBufferValid = 0;
+        //accessPoints.transmittersData[itxSlotIndex].mobileAverageBufferValid = 0;
+        //accessPoints.transmittersData[itxSlotIndex].varianceBufferValid = 0;
+        radar->accessPoints.transmittersData[itxSlotIndex].resetRequest = 1; // forces all of the above commented, to be done internally
+        res++;
       }
+    }
+  }
+  /*
+  if (debugRadarMsg >= 17) {
+        Serial.print("checkInvalidTXdata(): final check: calling checkTXlist(): ");
+        checkTXlist();
+  }
+  */
+
+  
+  return res;
+}
+
+
+int checkInvalidRSSI(radarContext * radar) {  // returns how many invalid results have been found (how many transmitters that were previously OK, now have weak signals and are unsuitable. 
+
+  int res = 0; // all fine
+  
+  // first, parse all the APs, detect if they are already in the data structures and if so, check the RSSI for adequate levels, if inadequate mark the slot for reinitialization
+
+    // please note the BSSD and SSDI can be transferred by memcpy, for example: memcpy ( strongestBSSID, currentBSSID, (sizeof(uint8_t) * 6));
+
+  // also note: accessPoints.discoveredNetworks has already been checked and guaranteed to have at least one result
+
+  for (int netItem = 0; netItem < radar->accessPoints.discoveredNetworks; netItem++) {
+      uint8_t * currentBSSID = radar->accessPoints.scanResults->entries[netItem].BSSID;
+      int currentRSSI = radar->accessPoints.scanResults->entries[netItem].RSSI;
+      int currentChannel = radar->accessPoints.scanResults->entries[netItem].channel;
+      RADAR_LOG(radar, 4, RADAR_EVENT_RSSI_CHECK_ITEM, netItem, currentChannel, currentRSSI);
       /*
       if (debugRadarMsg >= 17) {
         Serial.print("checkInvalidRSSI(): calling checkTXlist(): ");
@@ -316,24 +1128,19 @@ int checkInvalidRSSI() {  // returns how many invalid results have been found (h
       }
       */
 
-      if ((currentRSSI > accessPoints.absoluteRSSIlimit) || (currentRSSI < 0)) { // we at least have a valid result // please note: this does not mean the RSSI isn't excessively low anyways
+      if ((currentRSSI > radar->accessPoints.absoluteRSSIlimit) || (currentRSSI < 0)) { // we at least have a valid result // please note: this does not mean the RSSI isn't excessively low anyways
         // see if we already have it in a slot, also detect excessively low RSSI, in such instance empty the slots
-        accessPoints.currentTransmitterIndex = searchSlotByBSSID(currentBSSID);
-        if (accessPoints.currentTransmitterIndex >= 0) { // valid index, AP found
-          if (currentRSSI < accessPoints.transmittersData[accessPoints.currentTransmitterIndex].minimum_RSSI) { // INVALID RSSI, let's clean the spot and mark it free
+        radar->accessPoints.currentTransmitterIndex = searchSlotByBSSID(radar, currentBSSID);
+        if (radar->accessPoints.currentTransmitterIndex >= 0) { // valid index, AP found
+          if (currentRSSI < radar->accessPoints.transmittersData[radar->accessPoints.currentTransmitterIndex].minimum_RSSI) { // INVALID RSSI, let's clean the spot and mark it free
             //accessPoints.initComplete = 0; // I don't think we'll ever need this one
-            accessPoints.transmittersData[accessPoints.currentTransmitterIndex].initComplete = 0;
-            accessPoints.transmittersData[accessPoints.currentTransmitterIndex].sampleBufferValid = 0;
-            accessPoints.transmittersData[accessPoints.currentTransmitterIndex].varianceBufferValid = 0;
-            accessPoints.transmittersData[accessPoints.currentTransmitterIndex].mobileAverageBufferValid = 0;
-            accessPoints.BSSIDs[accessPoints.currentTransmitterIndex][0] = 0; // YES, I know I could use memset. This looks ugly? Yes. Do I mind? Nope ;)
-            accessPoints.BSSIDs[accessPoints.currentTransmitterIndex][1] = 0;
-            accessPoints.BSSIDs[accessPoints.currentTransmitterIndex][2] = 0;
-            accessPoints.BSSIDs[accessPoints.currentTransmitterIndex][3] = 0;
-            accessPoints.BSSIDs[accessPoints.currentTransmitterIndex][4] = 0;
-            accessPoints.BSSIDs[accessPoints.currentTransmitterIndex][5] = 0;
+            radar->accessPoints.transmittersData[radar->accessPoints.currentTransmitterIndex].initComplete = 0;
+            radar->accessPoints.transmittersData[radar->accessPoints.currentTransmitterIndex].sampleBufferValid = 0;
+            radar->accessPoints.transmittersData[radar->accessPoints.currentTransmitterIndex].varianceBufferValid = 0;
+            setSlotBSSID(radar, radar->accessPoints.currentTransmitterIndex, NULL);
           
-            accessPoints.APslotStatus[accessPoints.currentTransmitterIndex] = AP_SLOT_STATUS_INVALID; 
+            radar->accessPoints.APslotStatus[radar->accessPoints.currentTransmitterIndex] = AP_SLOT_STATUS_INVALID; 
+            radar->accessPoints.scanPlan.fullSweepRequested = 1; // look for a replacement everywhere
 
             //accessPoints.transmittersData[accessPoints.currentTransmitterIndex].sampleBufferValid = 0;
             //accessPoints.transmittersData[accessPoints.currentTransmitterIndex].mobileAverageBufferValid = 0;
@@ -341,14 +1148,7 @@ int checkInvalidRSSI() {  // returns how many invalid results have been found (h
 
             res++; // found at least one invalid result, let's increase the invalid results counter
             
-            if (debugRadarMsg >= 3) {
-              Serial.print("multistatic_interference_radar(): processing recorded AP: RSSI too low for netItem: ");
-              Serial.print(WiFi.SSID(netItem));
-              Serial.print(" on channel: ");
-              Serial.print(currentChannel);
-              Serial.print(" with RSSI: ");
-              Serial.println(currentRSSI);
-            } // debug messages end
+            RADAR_LOG(radar, 3, RADAR_EVENT_RSSI_TOO_LOW, netItem, currentChannel, currentRSSI, radar->accessPoints.currentTransmitterIndex);
           }
         }
         
@@ -363,32 +1163,8 @@ int checkInvalidRSSI() {  // returns how many invalid results have been found (h
 }
 
 
-int searchScanResultsByBSSID(uint8_t * BSSIDtoSearch) { // receives a pointer to the BSSID 6 bytes array //returns -1 if the BSSID is not in the scan results, if found, it returns the scan index (netItem)
-  int res = -1;
-  int bssidScanOK = 0;
-
-  for (int netItem = 0; netItem < accessPoints.discoveredNetworks; netItem++) {
-      currentBSSID = WiFi.BSSID(netItem);
-      //currentRSSI = WiFi.RSSI(netItem);
-      //currentChannel = WiFi.channel(netItem);
-
-      for (int bssidIndex = 0; bssidIndex < 6; bssidIndex++) { // compare with the recorded BSSID, byte by byte
-        if (currentBSSID[bssidIndex] == BSSIDtoSearch[bssidIndex]) {
-          bssidScanOK = 1; 
-        } else {
-          bssidScanOK = 0; // match failed, resetting the flag 
-          break; // no matter wich single byte failed to match, we break out of the compare loop
-        }
-    } // BSSID compare loop
-    if (bssidScanOK == 1) { // result found!
-      return netItem; // we also show *where* it has been found
-    }
-
-  }
-
-  // if we get up to this point, clearly no matching BSSID was found
-  return res;
-  
+int searchScanResultsByBSSID(radarContext * radar, uint8_t * BSSIDtoSearch) { // receives a pointer to the BSSID 6 bytes array //returns -1 if the BSSID is not in the scan results, if found, it returns the scan index (netItem)
+  return bssidIndexFind(&radar->accessPoints.scanResultsIndex, packBSSID(BSSIDtoSearch));
 }
 
 void serialPrintBSSID(uint8_t * localBSSID) {
@@ -402,100 +1178,73 @@ void serialPrintBSSID(uint8_t * localBSSID) {
   }
 }
 
-int searchScanResultsByBSSIDslotIndex(int txSlotIndex) { // receives the index pointing to a specific position of the BSSID in the access points data structure //returns -1 if the BSSID is not in the scan results, if found it returns the scan index (netItem); if the slot status is not valid, return the slot index as there is no need to further clean it. 
+int searchScanResultsByBSSIDslotIndex(radarContext * radar, int txSlotIndex) { // receives the index pointing to a specific position of the BSSID in the access points data structure //returns -1 if the BSSID is not in the scan results, if found it returns the scan index (netItem); if the slot status is not valid, return the slot index as there is no need to further clean it. 
   int res = -1;
-  int bssidScanOK = 0;
 
-  if ((accessPoints.APslotStatus[txSlotIndex] != AP_SLOT_STATUS_VALID) || ((accessPoints.BSSIDs[txSlotIndex][0] == 0) && (accessPoints.BSSIDs[txSlotIndex][1] == 0) && (accessPoints.BSSIDs[txSlotIndex][2] == 0) && (accessPoints.BSSIDs[txSlotIndex][3] == 0) && (accessPoints.BSSIDs[txSlotIndex][4] == 0) && (accessPoints.BSSIDs[txSlotIndex][5] == 0) )) {
-    if (debugRadarMsg >= 5) {
-      Serial.print("searchScanResultsByBSSIDslotIndex(): found slot already empty or clean or invalid: slot: ");
-      Serial.println(txSlotIndex);
-    }
+  if ((radar->accessPoints.APslotStatus[txSlotIndex] != AP_SLOT_STATUS_VALID) || (radar->accessPoints.BSSIDkeys[txSlotIndex] == 0)) {
+    RADAR_LOG(radar, 5, RADAR_EVENT_SLOT_ALREADY_FREE, txSlotIndex);
     return txSlotIndex;
   }
 
-  for (int netItem = 0; netItem < accessPoints.discoveredNetworks; netItem++) {
-      currentBSSID = WiFi.BSSID(netItem);
-      //currentRSSI = WiFi.RSSI(netItem);
-      //currentChannel = WiFi.channel(netItem);
-      if (debugRadarMsg >= 16) {
-        Serial.print(" searchScanResultsByBSSIDslotIndex(): looking for stored BSSID: ");
-        serialPrintBSSID(accessPoints.BSSIDs[txSlotIndex]);
-        Serial.print(" vs netItem BSSID: ");
-        serialPrintBSSID(currentBSSID);
-      }
+  res = bssidIndexFind(&radar->accessPoints.scanResultsIndex, radar->accessPoints.BSSIDkeys[txSlotIndex]);
 
-      for (int bssidIndex = 0; bssidIndex < 6; bssidIndex++) { // compare with the recorded BSSID, byte by byte
-        /*
-        if (debugRadarMsg >= 17) {
-          Serial.print(" checking byte by byte: ");
-          Serial.print(accessPoints.BSSIDs[txSlotIndex][bssidIndex], HEX);
-          Serial.print(" vs: ");
-          Serial.print(currentBSSID[bssidIndex], HEX);
-        }
-        */
-        if (currentBSSID[bssidIndex] == accessPoints.BSSIDs[txSlotIndex][bssidIndex]) {
-          bssidScanOK = 1; 
-        } else {
-          bssidScanOK = 0; // match failed, resetting the flag 
-          break; // no matter wich single byte failed to match, we break out of the compare loop
-        }
-    } // BSSID compare loop
-    if (bssidScanOK == 1) { // result found!
-      if (debugRadarMsg >= 6) {
-        Serial.print("searchScanResultsByBSSIDslotIndex(): matched BSSID for slot index: ");
-        Serial.println(txSlotIndex);
-      }
-      return netItem; // we also show *where* it has been found
-    }
+  uint64_t slotKey = radar->accessPoints.BSSIDkeys[txSlotIndex];
+  RADAR_LOG(radar, 16, RADAR_EVENT_SLOT_LOOKUP, txSlotIndex, (int32_t) ((slotKey >> 32) & 0xFFFF), (int32_t) ((slotKey >> 16) & 0xFFFF), (int32_t) (slotKey & 0xFFFF), res);
 
+  if (res < 0) {
+    RADAR_LOG(radar, 6, RADAR_EVENT_SLOT_NOT_HEARD, txSlotIndex);
   }
-
-  if (debugRadarMsg >= 6) {
-    Serial.print("searchScanResultsByBSSIDslotIndex(): will need to clean tx slot: NO matched BSSID for slot index: ");
-    Serial.println(txSlotIndex);
+  if (res >= 0) {
+    RADAR_LOG(radar, 6, RADAR_EVENT_SLOT_HEARD, txSlotIndex);
   }
 
-  // if we get up to this point, clearly no matching BSSID was found
   return res;
   
 }
 
 
 
-int checkDeadTransmitters() {
+int checkDeadTransmitters(radarContext * radar) {
   int res = 0; // all fine
   int bssidSearchRes = 0;
 
-  for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+
+    bssidSearchRes = searchScanResultsByBSSIDslotIndex(radar, slotIndex);
+    if ((radar->accessPoints.APslotStatus[slotIndex] != AP_SLOT_STATUS_VALID) || (radar->accessPoints.BSSIDkeys[slotIndex] == 0)) { // already free: nothing to clean, and no reason for a sweep (the ranking fills free slots from every scan, the periodic sweeps bring in the newcomers)
+      continue;
+    }
+
+    if ((bssidSearchRes < 0) && (radar->accessPoints.scanResults->fullSweep == 0) && (radar->accessPoints.missedScans[slotIndex] + 1 < SCAN_TARGETED_MISS_LIMIT)) { // a short targeted dwell missed it: keep the slot and its filter for now
+      radar->accessPoints.missedScans[slotIndex]++;
+      continue;
+    }
 
-    bssidSearchRes = searchScanResultsByBSSIDslotIndex(slotIndex);
-    if ((bssidSearchRes < 0)|| ((accessPoints.BSSIDs[slotIndex][0] == 0) && (accessPoints.BSSIDs[slotIndex][1] == 0) && (accessPoints.BSSIDs[slotIndex][2] == 0) && (accessPoints.BSSIDs[slotIndex][3] == 0) && (accessPoints.BSSIDs[slotIndex][4] == 0) && (accessPoints.BSSIDs[slotIndex][5] == 0) )) { // on no AP found via the scan
+    if (bssidSearchRes < 0) { // on no AP found via the scan
       
       // clean the slot
       //accessPoints.initComplete = 0; // I don't think we'll ever need this one
-      accessPoints.transmittersData[slotIndex].initComplete = 0;
-      accessPoints.transmittersData[slotIndex].sampleBufferValid = 0;
-      accessPoints.transmittersData[slotIndex].varianceBufferValid = 0;
-      accessPoints.transmittersData[slotIndex].mobileAverageBufferValid = 0;
-      accessPoints.BSSIDs[slotIndex][0] = 0; // YES, I know I could use memset. This looks ugly? Yes. Do I mind? Nope ;)
-      accessPoints.BSSIDs[slotIndex][1] = 0;
-      accessPoints.BSSIDs[slotIndex][2] = 0;
-      accessPoints.BSSIDs[slotIndex][3] = 0;
-      accessPoints.BSSIDs[slotIndex][4] = 0;
-      accessPoints.BSSIDs[slotIndex][5] = 0;
+      radar->accessPoints.transmittersData[slotIndex].initComplete = 0;
+      radar->accessPoints.transmittersData[slotIndex].sampleBufferValid = 0;
+      radar->accessPoints.transmittersData[slotIndex].varianceBufferValid = 0;
+      setSlotBSSID(radar, slotIndex, NULL);
 
 
       //accessPoints.transmittersData[slotIndex].sampleBufferValid = 0;
       //accessPoints.transmittersData[slotIndex].mobileAverageBufferValid = 0;
       //accessPoints.transmittersData[slotIndex].varianceBufferValid = 0;
-      accessPoints.transmittersData[slotIndex].resetRequest = 1; // forces all of the above commented, to be done internally
+      radar->accessPoints.transmittersData[slotIndex].resetRequest = 1; // forces all of the above commented, to be done internally
           
-      accessPoints.APslotStatus[slotIndex] = AP_SLOT_STATUS_INVALID; // transmitter disappeared / out of range
+      radar->accessPoints.APslotStatus[slotIndex] = AP_SLOT_STATUS_INVALID; // transmitter disappeared / out of range
 
-      accessPoints.initComplete = 0; // guess we need to reinit the AP list
+      radar->accessPoints.initComplete = 0; // guess we need to reinit the AP list
+      radar->accessPoints.scanPlan.fullSweepRequested = 1; // and look for a replacement everywhere
 
       res++;
+    } else {
+      radar->accessPoints.missedScans[slotIndex] = 0;
+      radar->accessPoints.netItemNumbers[slotIndex] = (uint8_t)(bssidSearchRes & 0xff); // the scan order changes from scan to scan: keep the netItem of the live transmitters up to date
+      radar->accessPoints.channels[slotIndex] = radar->accessPoints.scanResults->entries[bssidSearchRes].channel; // APs may move to another channel, the scan scheduler needs to know
     }
     
   } // main for cycle, parse the transmitters data
@@ -507,7 +1256,7 @@ int checkDeadTransmitters() {
 
 
 
-int checkTransmitterArray() {  // if there are empty, free, invalid slots then the result is 0, if the slot array is full and ok, then the result is 1
+int checkTransmitterArray(radarContext * radar) {  // if there are empty, free, invalid slots then the result is 0, if the slot array is full and ok, then the result is 1
 
   int res = 1; // all fine
 
@@ -517,9 +1266,9 @@ int checkTransmitterArray() {  // if there are empty, free, invalid slots then t
   }
   */
   
-  for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
     
-    if ((accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_FREE) || (accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_INVALID)|| (accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_INIT)) {
+    if ((radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_FREE) || (radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_INVALID)|| (radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_INIT)) {
       res = 0;
     }
   }
@@ -529,155 +1278,115 @@ int checkTransmitterArray() {  // if there are empty, free, invalid slots then t
 }
 
 
-int searchScanResultInPowerRank(int scanRes) { // returns the ranking position if an item was already recorded, or -1 if not found
-
-  int res = -1; // not found!
-  int tempRes = -1;
-
-  for (int scanItem = 0; scanItem < accessPoints.discoveredNetworks; scanItem++) {
-    /*
-    if (debugRadarMsg >= 19) {
-      Serial.print("searchScanResultInPowerRank(): scanItem: ");
-      Serial.print(scanItem);
-      Serial.print(" looking for netItem: ");
-      Serial.print(scanRes);
-      Serial.print(" in accessPoints.scanIndexByPower[scanItem]: found: ");
-      Serial.println(accessPoints.scanIndexByPower[scanItem]);
-    }
-    */
-    tempRes = accessPoints.scanIndexByPower[scanItem];
-    if (scanRes == tempRes) {
-      res = scanItem;
-    }
+int rankedBefore(int rssiA, int netItemA, int rssiB, int netItemB) { // ranking order: stronger RSSI first, on ties the lower netItem first (stable with respect to the scan order)
+  if (rssiA != rssiB) {
+    return (rssiA > rssiB) ? 1 : 0;
   }
-  return res;
+  return (netItemA < netItemB) ? 1 : 0;
 }
 
-int localDCSRNIStrongestRSSI = ABSOLUTE_RSSI_LIMIT; // let's start from the smallest possible level.
-int localDCSRNIStrongestResult = -1;
 
-int detectCurrentStrongestRSSInetItem() {
-
-  //uint8_t localCurrentBSSID[6] = {0};
-  int localCurrentRSSI = ABSOLUTE_RSSI_LIMIT;
-  //int localStrongestRSSI = ABSOLUTE_RSSI_LIMIT; // let's start from the smallest possible level. // moved outside to the global space and renamed
-  //int localStrongestResult = -1; // moved outside to the global space and renamed
-  int localScanItemFound = -1;
-  int res = -1;
-
-  localDCSRNIStrongestRSSI = ABSOLUTE_RSSI_LIMIT; // let'see, the idea is to totally exclude existing results from the search
-  
-  // processing each scan result
-    for (int netItem = 0; netItem < accessPoints.discoveredNetworks; netItem++) {
-        //localCurrentBSSID = WiFi.BSSID(netItem);
-        //localCurrentRSSI = WiFi.RSSI(netItem);
-        localScanItemFound = searchScanResultInPowerRank(netItem);
-        
-        if (localScanItemFound < 0) { // item not found in the ranking array! Let's evaluate it
-          /*
-          if (debugRadarMsg >= 18) {
-            Serial.print("detectCurrentStrongestRSSInetItem():  current response: ");
-            Serial.println(res);
-          }
-          */
-                    
-          localCurrentRSSI = WiFi.RSSI(netItem); // moved here. we don't want to read RSSI from already-ranked results. 
-          if (localCurrentRSSI >= localDCSRNIStrongestRSSI) {
-            localDCSRNIStrongestRSSI = localCurrentRSSI;
-            localDCSRNIStrongestResult = netItem;
-            if (debugRadarMsg >= 18) {
-              Serial.print(" UPDATING localStrongestResult: ");
-              Serial.print(localDCSRNIStrongestResult);
-              Serial.print(" localStrongestRSSI: ");
-              Serial.println(localDCSRNIStrongestRSSI);
-            }
-            res = netItem; // this will be the returned value, the overall strongest with the exception of already registered results. 
-            break; // without this line you'd eventually be returning duplicate values, overwriting the first one!!!!
-          }
-        }
+void rankHeapSiftDown(int * heapItems, int * heapRSSI, int heapSize, int position) { // min-heap on the ranking order: the root is the weakest of the retained results
+  while (1) {
+    int weakest = position;
+    int left = 2 * position + 1;
+    int right = left + 1;
+    if ((left < heapSize) && rankedBefore(heapRSSI[weakest], heapItems[weakest], heapRSSI[left], heapItems[left])) {
+      weakest = left;
     }
-  /*
-  if (debugRadarMsg >= 18) {
-    Serial.print("detectCurrentStrongestRSSInetItem():  returning response: ");
-    Serial.println(res);
+    if ((right < heapSize) && rankedBefore(heapRSSI[weakest], heapItems[weakest], heapRSSI[right], heapItems[right])) {
+      weakest = right;
+    }
+    if (weakest == position) {
+      return;
+    }
+    int tempItem = heapItems[position];
+    int tempRSSI = heapRSSI[position];
+    heapItems[position] = heapItems[weakest];
+    heapRSSI[position] = heapRSSI[weakest];
+    heapItems[weakest] = tempItem;
+    heapRSSI[weakest] = tempRSSI;
+    position = weakest;
   }
-  */
-  return res;
-
-
 }
 
 
 
-void sortScanResultsByRSSI() {
+void sortScanResultsByRSSI(radarContext * radar) { // ranks the strongest scan results into scanIndexByPower[0 .. scanIndexByPowerFirstFreeSpot - 1], strongest first
   
-  //localDCSRNIStrongestRSSI = ABSOLUTE_RSSI_LIMIT; // let's start from the smallest possible level. // commented, not needed
-  localDCSRNIStrongestResult = -1;
-
-  int currentStrongestResult = -1;  
-  
-  
-
-  int newStrongestNetItem = -1;
-
-  int scanItemFound = -1;
-
-  // reset the scanIndexByPower array
-  //memset (accessPoints.scanIndexByPower, 0, ABSOLUTE_MAX_SCAN_RESULTS * sizeof(byte));  // commented out, I need to debug this matter, also, I'm no longer using uint8_t, now it's int.
-  for (int scanItem = 0; scanItem < accessPoints.discoveredNetworks; scanItem++) {
-    accessPoints.scanIndexByPower[scanItem] = -1;
+  // only the top transmittersListLen results can ever be loaded: the slots already taken are among them or elsewhere, either way the free slots are filled from within the top transmittersListLen
+  // the shadow trackers, if any, are filled from the following shadowsNumber results
+  int rankSize = radar->accessPoints.transmittersListLen + radar->accessPoints.shadows.shadowsNumber;
+  if (rankSize > radar->accessPoints.discoveredNetworks) {
+    rankSize = radar->accessPoints.discoveredNetworks;
   }
-  accessPoints.scanIndexByPowerFirstFreeSpot = 0;
-  
 
-    // processing each scan result
-    for (int netItem = 0; netItem < accessPoints.discoveredNetworks; netItem++) {
-        // detect the strongest overall netItem, excluding those already ranked
-        newStrongestNetItem = detectCurrentStrongestRSSInetItem();
-        scanItemFound = searchScanResultInPowerRank(netItem);
-        /*
-        if (debugRadarMsg >= 17) {
-          Serial.print("sortScanResultsByRSSI():  newStrongestNetItem: ");
-          Serial.print(newStrongestNetItem);
-          Serial.print(" scanItemFound: ");
-          Serial.println(scanItemFound);
-        }
-        */
-        if (scanItemFound < 0) {
-          // save the scan item in a new position
-          /*
-          if (debugRadarMsg >= 17) {
-            Serial.print("sortScanResultsByRSSI():  scanItemFound less than 0 -> not found: updating scanIndexByPower array at index: ");
-            Serial.print(accessPoints.scanIndexByPowerFirstFreeSpot);
-            Serial.print(" newStrongestNetItem: ");
-            Serial.print(newStrongestNetItem);
-            Serial.print(" and SSID: ");
-            Serial.println(WiFi.SSID(newStrongestNetItem));
-          }
-          */
-          accessPoints.scanIndexByPower[accessPoints.scanIndexByPowerFirstFreeSpot] = newStrongestNetItem;
-          accessPoints.scanIndexByPowerFirstFreeSpot++;
+  int heapItems[ABSOLUTE_MAX_SCAN_RESULTS];
+  int heapRSSI[ABSOLUTE_MAX_SCAN_RESULTS];
+  int heapSize = 0;
+  int localRSSI = ABSOLUTE_RSSI_LIMIT;
+
+  // one pass over the scan results, each RSSI is read once: O(n log k) instead of the previous O(n^3)
+  for (int netItem = 0; netItem < radar->accessPoints.discoveredNetworks; netItem++) {
+    localRSSI = radar->accessPoints.scanResults->entries[netItem].RSSI;
+    if (heapSize < rankSize) {
+      // growing the heap, sift the new item up
+      int position = heapSize;
+      heapItems[position] = netItem;
+      heapRSSI[position] = localRSSI;
+      heapSize++;
+      while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (! rankedBefore(heapRSSI[parent], heapItems[parent], heapRSSI[position], heapItems[position])) {
+          break;
         }
+        int tempItem = heapItems[position];
+        int tempRSSI = heapRSSI[position];
+        heapItems[position] = heapItems[parent];
+        heapRSSI[position] = heapRSSI[parent];
+        heapItems[parent] = tempItem;
+        heapRSSI[parent] = tempRSSI;
+        position = parent;
+      }
+    } else if ((heapSize > 0) && rankedBefore(localRSSI, netItem, heapRSSI[0], heapItems[0])) {
+      // stronger than the weakest retained result: replace it
+      heapItems[0] = netItem;
+      heapRSSI[0] = localRSSI;
+      rankHeapSiftDown(heapItems, heapRSSI, heapSize, 0);
     }
+  }
+
+  // drain the heap weakest first, filling the ranking from the bottom
+  for (int scanItem = 0; scanItem < ABSOLUTE_MAX_SCAN_RESULTS; scanItem++) {
+    radar->accessPoints.scanIndexByPower[scanItem] = -1;
+  }
+  radar->accessPoints.scanIndexByPowerFirstFreeSpot = heapSize;
+  while (heapSize > 0) {
+    heapSize--;
+    radar->accessPoints.scanIndexByPower[heapSize] = heapItems[0];
+    heapItems[0] = heapItems[heapSize];
+    heapRSSI[0] = heapRSSI[heapSize];
+    rankHeapSiftDown(heapItems, heapRSSI, heapSize, 0);
+  }
 
 
-  if (debugRadarMsg >= 17) {
+  if (RADAR_LOG_ENABLED(radar, 17)) {
     Serial.print("sortScanResultsByRSSI(): sorted scan data follows:");
     Serial.println();
-    for (int dgbSortItem = 0; dgbSortItem < accessPoints.discoveredNetworks; dgbSortItem++) {
+    for (int dgbSortItem = 0; dgbSortItem < radar->accessPoints.scanIndexByPowerFirstFreeSpot; dgbSortItem++) {
       Serial.print("sortN: ");
       Serial.print(dgbSortItem);
       Serial.print(" netItemN: ");
-      Serial.print(accessPoints.scanIndexByPower[dgbSortItem]);
+      Serial.print(radar->accessPoints.scanIndexByPower[dgbSortItem]);
       Serial.print(" RSSI: ");
-      Serial.print(WiFi.RSSI(accessPoints.scanIndexByPower[dgbSortItem]));
+      Serial.print(radar->accessPoints.scanResults->entries[radar->accessPoints.scanIndexByPower[dgbSortItem]].RSSI);
       Serial.print(" SSID: ");
-      Serial.print(WiFi.SSID(accessPoints.scanIndexByPower[dgbSortItem]));
+      Serial.print(snapshotSSID(radar, radar->accessPoints.scanIndexByPower[dgbSortItem]));
       Serial.println();
     }
 
     // now checking the transmitters list
-    checkTXlist();
+    checkTXlist(radar);
     
     
   }
@@ -687,12 +1396,10 @@ void sortScanResultsByRSSI() {
 }
 
 
-int loadSlotByNetItemIndex(int localNetItem, int localSlotIndex) {  // returns the slot position if the operation went OK, -1 otherwise
+int loadSlotByNetItemIndex(radarContext * radar, int localNetItem, int localSlotIndex) {  // returns the slot position if the operation went OK, -1 otherwise
   int res = -1;
 
-  uint8_t *localCurrentBSSID = WiFi.BSSID(localNetItem); // size 6 is fixed and hardwired
-  int localCurrentRSSI = WiFi.RSSI(localNetItem);
-  int localCurrentChannel = WiFi.channel(localNetItem);
+  uint8_t *localCurrentBSSID = radar->accessPoints.scanResults->entries[localNetItem].BSSID; // size 6 is fixed and hardwired
   //uint8_t *localCurrentSSID = NULL;
 
   /*
@@ -704,15 +1411,15 @@ int loadSlotByNetItemIndex(int localNetItem, int localSlotIndex) {  // returns t
       Serial.println(localSlotIndex);
   }
   */
-  accessPoints.APslotStatus[localSlotIndex] = AP_SLOT_STATUS_VALID;
-  accessPoints.netItemNumbers[localSlotIndex] = (uint8_t)(localNetItem & 0xff); // updates the new netItem number // NOTE: AT THE MOMENT THIS VALUE IS UPDATED DIRECTLY BEFORE CALLING THIS FUNCTION, WE ARE UPDATING IT AGAIN BECAUSE WE MIGHT BE USING THIS FUNCTION ELSEWHERE IN THE FUTURE
+  radar->accessPoints.APslotStatus[localSlotIndex] = AP_SLOT_STATUS_VALID;
+  radar->accessPoints.netItemNumbers[localSlotIndex] = (uint8_t)(localNetItem & 0xff); // updates the new netItem number // NOTE: AT THE MOMENT THIS VALUE IS UPDATED DIRECTLY BEFORE CALLING THIS FUNCTION, WE ARE UPDATING IT AGAIN BECAUSE WE MIGHT BE USING THIS FUNCTION ELSEWHERE IN THE FUTURE
   //memcpy(accessPoints.BSSIDs[localSlotIndex], localCurrentBSSID, (sizeof(uint8_t) * 6));
-  for (int bssidIndex = 0; bssidIndex < 6; bssidIndex++) {
-    accessPoints.BSSIDs[localSlotIndex][bssidIndex] = localCurrentBSSID[bssidIndex];
-  }
-  strncpy(accessPoints.SSIDs[localSlotIndex], WiFi.SSID(localNetItem).c_str(), 34);
+  setSlotBSSID(radar, localSlotIndex, localCurrentBSSID);
+  radar->accessPoints.channels[localSlotIndex] = radar->accessPoints.scanResults->entries[localNetItem].channel;
+  strncpy(radar->accessPoints.SSIDs[localSlotIndex], snapshotSSID(radar, localNetItem), sizeof(radar->accessPoints.SSIDs[localSlotIndex]) - 1);
+  radar->accessPoints.SSIDs[localSlotIndex][sizeof(radar->accessPoints.SSIDs[localSlotIndex]) - 1] = 0;
 
-  accessPoints.transmittersData[localSlotIndex].resetRequest = 1; // when a new tx is loaded o reloaded, it is customary to request a reset of any previous instance
+  radar->accessPoints.transmittersData[localSlotIndex].resetRequest = 1; // when a new tx is loaded o reloaded, it is customary to request a reset of any previous instance
   /*
   if (debugRadarMsg >= 17) {
       Serial.print("loadSlotByNetItemIndex(): loaded BSSID: ");
@@ -733,7 +1440,7 @@ int loadSlotByNetItemIndex(int localNetItem, int localSlotIndex) {  // returns t
 }
 
 
-int loadScanResults() { // return value: how many result have been loaded in the transmitter list // -1 if error, 0 if no trasmitters added
+int loadScanResults(radarContext * radar) { // return value: how many result have been loaded in the transmitter list // -1 if error, 0 if no trasmitters added
 
   int localNetItem = 0;
   int localCurrentRSSI = ABSOLUTE_RSSI_LIMIT;
@@ -749,27 +1456,17 @@ int loadScanResults() { // return value: how many result have been loaded in the
 
   int loadedRes = 0;  // return this value (count how many result have been loaded in the transmitter list
   
-  for (int scanItem = 0; scanItem < accessPoints.discoveredNetworks; scanItem++) {
+  for (int scanItem = 0; scanItem < radar->accessPoints.scanIndexByPowerFirstFreeSpot; scanItem++) { // only the ranked results
 
-    localCurrentBSSID = WiFi.BSSID(accessPoints.scanIndexByPower[scanItem]);
-    localCurrentRSSI = WiFi.RSSI(accessPoints.scanIndexByPower[scanItem]);
-    localCurrentChannel = WiFi.channel(accessPoints.scanIndexByPower[scanItem]);
-    //WiFi.SSID(accessPoints.scanIndexByPower[scanItem]).toCharArray(localCurrentSSID, 34);
-    strncpy(localCurrentSSID, WiFi.SSID(accessPoints.scanIndexByPower[scanItem]).c_str(), 34);
+    localCurrentBSSID = radar->accessPoints.scanResults->entries[radar->accessPoints.scanIndexByPower[scanItem]].BSSID;
+    localCurrentRSSI = radar->accessPoints.scanResults->entries[radar->accessPoints.scanIndexByPower[scanItem]].RSSI;
+    localCurrentChannel = radar->accessPoints.scanResults->entries[radar->accessPoints.scanIndexByPower[scanItem]].channel;
+    strncpy(localCurrentSSID, snapshotSSID(radar, radar->accessPoints.scanIndexByPower[scanItem]), sizeof(localCurrentSSID) - 1);
+    localCurrentSSID[sizeof(localCurrentSSID) - 1] = 0;
     
     //////strcpy(accessPoints.SSIDs[do not exceed MAX_ALLOWED_TRANSMITTERS_NUMBER], localCurrentSSID); // note: I leave this line because the code is going to be re-used. 
-    if (debugRadarMsg >= 4) {
-      //Serial.print("loadScanResults(): sorted by RSSI: detected BSSID: ");
-      serialPrintBSSID(localCurrentBSSID);
-      Serial.print(" detected RSSI: ");
-      Serial.print(localCurrentRSSI);
-      Serial.print("; item number: ");
-      Serial.print(scanItem);
-      Serial.print("; net number: ");
-      Serial.print(accessPoints.scanIndexByPower[scanItem]);
-      Serial.print("; SSID: ");
-      Serial.println(localCurrentSSID);
-    }
+    RADAR_LOG(radar, 4, RADAR_EVENT_RANKED_RESULT, scanItem, radar->accessPoints.scanIndexByPower[scanItem], localCurrentRSSI, 
+              (localCurrentBSSID[0] << 8) | localCurrentBSSID[1], (localCurrentBSSID[2] << 8) | localCurrentBSSID[3], (localCurrentBSSID[4] << 8) | localCurrentBSSID[5]);
     /*
     if (debugRadarMsg >= 17) {
       Serial.print("loadScanResults(): calling searchSlotByBSSID(localCurrentBSSID) with BSSID: ");
@@ -778,7 +1475,7 @@ int loadScanResults() { // return value: how many result have been loaded in the
       Serial.println(localCurrentSSID);
     }
     */
-    scanItemFound = searchSlotByBSSID(localCurrentBSSID); // search the BSSID, already registered?  // if > reports the slotIndex
+    scanItemFound = searchSlotByBSSID(radar, localCurrentBSSID); // search the BSSID, already registered?  // if > reports the slotIndex
 
     if (scanItemFound >= 0) {
       /*
@@ -789,7 +1486,7 @@ int loadScanResults() { // return value: how many result have been loaded in the
         Serial.println(scanItemFound);
       }
       */
-      accessPoints.netItemNumbers[scanItemFound] = (uint8_t)(scanItem & 0xff); // updates the netItem number for existing transmitters in the list. 
+      radar->accessPoints.netItemNumbers[scanItemFound] = (uint8_t)(radar->accessPoints.scanIndexByPower[scanItem] & 0xff); // updates the netItem number for existing transmitters in the list (the netItem, not the rank position). 
     }
 
     if (scanItemFound < 0) { // if not, proceed to load it on the first free slot // this is the most important part, we are doing it in order of strongest RSSI
@@ -801,7 +1498,7 @@ int loadScanResults() { // return value: how many result have been loaded in the
         Serial.println(scanItemFound);
       }
       */
-      for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+      for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
         /*
         if (debugRadarMsg >= 17) {
             Serial.print("loadScanResults(): locating free spots: parsing slotIndex: ");
@@ -810,7 +1507,7 @@ int loadScanResults() { // return value: how many result have been loaded in the
             Serial.println(accessPoints.APslotStatus[slotIndex]);
         }
         */
-        if ((accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_FREE) || (accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_INVALID) || (accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_INIT)) {
+        if ((radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_FREE) || (radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_INVALID) || (radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_INIT)) {
           /*
           if (debugRadarMsg >= 17) {
             Serial.print("loadScanResults(): detected available slot: proceeding to assign free slot: ");
@@ -820,9 +1517,10 @@ int loadScanResults() { // return value: how many result have been loaded in the
           }
           */
           // The netItem number for the newly inserted transmitter is updated now
-          accessPoints.netItemNumbers[slotIndex] = (uint8_t)(scanItem & 0xff); // WARNING: THIS NUMBER IS UPDATED AGAIN ALSO INSIDE THE loadSlotByNetItemIndex() FUNCTION, FOR RE-USABILITY REASONS
+          radar->accessPoints.netItemNumbers[slotIndex] = (uint8_t)(scanItem & 0xff); // WARNING: THIS NUMBER IS UPDATED AGAIN ALSO INSIDE THE loadSlotByNetItemIndex() FUNCTION, FOR RE-USABILITY REASONS
           
-          internalRes = loadSlotByNetItemIndex(accessPoints.scanIndexByPower[scanItem], slotIndex); // loads the new transmitter data 
+          internalRes = loadSlotByNetItemIndex(radar, radar->accessPoints.scanIndexByPower[scanItem], slotIndex); // loads the new transmitter data 
+          radar->accessPoints.shadows.coldLoads++; // hot standby statistics: this one starts from empty windows
           
           if (internalRes >= 0) {
             loadedRes++;
@@ -843,55 +1541,103 @@ int loadScanResults() { // return value: how many result have been loaded in the
 
 
 
-int multistatic_interference_radar_multiprocess() { // returns how many transmitters have been processed, or eventual error codes (values < 0).
+int slotSample(radarContext * radar, int slotIndex) { // the RSSI of the slot transmitter in the current scan results
+  if (radar->accessPoints.missedScans[slotIndex] > 0) { // not heard by the latest targeted scan: no signal, the filter replaces it with its mobile average like any weak sample
+    return ABSOLUTE_RSSI_LIMIT;
+  }
+  return radar->accessPoints.scanResults->entries[radar->accessPoints.netItemNumbers[slotIndex]].RSSI;
+}
+
+
+void multiprocessBatch(radarContext * radar) { // batch version of the per slot processing: gathers the samples, runs the batch kernel, then publishes the results back into the transmitters data
+
+  int localSamples[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+  transmittersBatchData *batch = &radar->accessPoints.batchData;
+
+  batch->linksNumber = radar->accessPoints.transmittersListLen;
+  batch->secondOrderFilter = radar->accessPoints.secondOrderFilter;
+  batch->bootstrapMode = radar->accessPoints.bootstrapMode;
+  batch->secondOrderAttenutationCoefficient = radar->accessPoints.secondOrderAttenutationCoefficient;
+
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    localSamples[slotIndex] = slotSample(radar, slotIndex);
+    // per link settings and reset requests are still owned by the transmitters data
+    if (radar->accessPoints.transmittersData[slotIndex].resetRequest == 1) {
+      radar->accessPoints.transmittersData[slotIndex].resetRequest = 0;
+      batch->resetRequest[slotIndex] = 1;
+      RADAR_PROFILE_COUNT(radar, filterResets, 1);
+    }
+    batch->minimum_RSSI[slotIndex] = radar->accessPoints.transmittersData[slotIndex].minimum_RSSI;
+    batch->enableThreshold[slotIndex] = radar->accessPoints.transmittersData[slotIndex].enableThreshold;
+    batch->enableAutoRegressive[slotIndex] = radar->accessPoints.transmittersData[slotIndex].enableAutoRegressive ? 1 : 0;
+    batch->varianceThreshold[slotIndex] = radar->accessPoints.transmittersData[slotIndex].varianceThreshold;
+  }
+
+  RADAR_TRACE_BEGIN(radar, batchTicks);
+  multistatic_interference_radar_process_batch(localSamples, radar->accessPoints.latestVariances, batch);
+  RADAR_TRACE_END(radar, RADAR_TRACE_PROCESS_BATCH, batch->linksNumber, batchTicks);
+
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    radar->accessPoints.transmittersData[slotIndex].latestReceivedSample = batch->latestReceivedSample[slotIndex];
+    radar->accessPoints.transmittersData[slotIndex].currentRSSI = batch->currentRSSI[slotIndex];
+    radar->accessPoints.transmittersData[slotIndex].mobileAverage = batch->mobileAverage[slotIndex];
+    radar->accessPoints.transmittersData[slotIndex].varianceIntegral = batch->varianceIntegral[slotIndex];
+    radar->accessPoints.transmittersData[slotIndex].varianceAR = batch->varianceAR[slotIndex];
+    radar->accessPoints.transmittersData[slotIndex].variance = batch->variance[slotIndex];
+    radar->accessPoints.transmittersData[slotIndex].varianceSample = batch->varianceSample[slotIndex];
+    if ((radar->accessPoints.transmittersData[slotIndex].enableThreshold > 0) && (batch->variance[slotIndex] >= 0)) { // same as the scalar version: only a valid output against an enabled threshold sets it
+      radar->accessPoints.transmittersData[slotIndex].detectionLevel = radar->accessPoints.latestVariances[slotIndex];
+    }
+    radar->accessPoints.transmittersData[slotIndex].sampleBufferValid = (batch->samplesCount[slotIndex] >= batch->sampleBufferSize) ? 1 : 0;
+  }
+}
+
+
+void updateSlotAlarm(radarContext * radar, int slotIndex) { // from the latest variance of the slot
+  radar->accessPoints.transmittersData[slotIndex].alarmStatus = 0; // first, clear the alarm
+  if (radar->accessPoints.transmittersData[slotIndex].enableThreshold >= 1) { // second, evaluate the threshold, if requested
+    if (radar->accessPoints.latestVariances[slotIndex] >= radar->accessPoints.transmittersData[slotIndex].varianceThreshold) {
+      radar->accessPoints.transmittersData[slotIndex].alarmStatus = radar->accessPoints.latestVariances[slotIndex]; // if triggered, update the alarm status with the variance value.
+    }
+  }
+}
+
+
+int multistatic_interference_radar_multiprocess(radarContext * radar) { // returns how many transmitters have been processed, or eventual error codes (values < 0).
 
   int res = 0; 
-  int localCurrentNetItem = 0;
   int localCurrentRSSI = ABSOLUTE_RSSI_LIMIT;
 
   int totalVariance = 0; // this will be the returned value
 
   // reset the whole results array and other data arrays
-  for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
-    accessPoints.latestVariances[slotIndex] = 0;
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    radar->accessPoints.latestVariances[slotIndex] = 0;
   }
   // loads new results
 
-  if (debugRadarMsg >= 1) { // formatting reasons
-    Serial.print("multistatic_interference_radar(): ");
+  if (radar->accessPoints.batchProcessing >= 1) { // all the transmitters in one go
+    multiprocessBatch(radar);
   }
   
-  for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
-    localCurrentNetItem = accessPoints.netItemNumbers[slotIndex];
-    localCurrentRSSI = WiFi.RSSI(localCurrentNetItem);
-    accessPoints.latestVariances[slotIndex] = multistatic_interference_radar_process(localCurrentRSSI, & accessPoints.transmittersData[slotIndex]); 
-    //accessPoints.latestVariances[slotIndex] = multistatic_interference_radar_process(localCurrentRSSI, slotIndex);
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    if (radar->accessPoints.batchProcessing == 0) {
+      localCurrentRSSI = slotSample(radar, slotIndex);
+      radar->accessPoints.latestVariances[slotIndex] = multistatic_interference_radar_process(radar, localCurrentRSSI, & radar->accessPoints.transmittersData[slotIndex]); 
+      //accessPoints.latestVariances[slotIndex] = multistatic_interference_radar_process(localCurrentRSSI, slotIndex);
+    }
 
     res++;
-    totalVariance = totalVariance + accessPoints.latestVariances[slotIndex];
+    totalVariance = totalVariance + radar->accessPoints.latestVariances[slotIndex];
     
     // debugging info here
-    if (debugRadarMsg >= 1) {
-      Serial.print(" tx: ");
-      Serial.print(slotIndex);
-      Serial.print(" var: ");
-      Serial.print(accessPoints.latestVariances[slotIndex]);
-    } 
+    RADAR_LOG(radar, 1, RADAR_EVENT_SLOT_VARIANCE, slotIndex, radar->accessPoints.latestVariances[slotIndex], radar->accessPoints.transmittersData[slotIndex].latestReceivedSample);
 
     // PROCESS ALARMS
     
-    accessPoints.transmittersData[slotIndex].alarmStatus = 0; // first, clear the alarm
-    if (accessPoints.transmittersData[slotIndex].enableThreshold >= 1) { // second, evaluate the threshold, if requested
-      if (accessPoints.latestVariances[slotIndex] >= accessPoints.transmittersData[slotIndex].varianceThreshold) {
-        accessPoints.transmittersData[slotIndex].alarmStatus = accessPoints.latestVariances[slotIndex]; // if triggered, update the alarm status with the variance value.
-      }
-    }
+    updateSlotAlarm(radar, slotIndex);
 
   } // main for cycle end
-  
-  if (debugRadarMsg >= 1) { // formatting reasons
-    Serial.println();
-  }
 
   //return res;
   return totalVariance;
@@ -899,46 +1645,46 @@ int multistatic_interference_radar_multiprocess() { // returns how many transmit
 }
 
 
-void serialPrintScanResults() {
+void serialPrintScanResults(radarContext * radar) {
 
     Serial.print("serialPrintScanResults(): requested to print scan data:");
     Serial.println();
-    for (int dgbSpNetItem = 0; dgbSpNetItem < accessPoints.discoveredNetworks; dgbSpNetItem++) {
+    for (int dgbSpNetItem = 0; dgbSpNetItem < radar->accessPoints.discoveredNetworks; dgbSpNetItem++) {
       Serial.print("netItemN: ");
       Serial.print(dgbSpNetItem);
       Serial.print(" BSSID: ");
-      serialPrintBSSID(WiFi.BSSID(dgbSpNetItem));
+      serialPrintBSSID(radar->accessPoints.scanResults->entries[dgbSpNetItem].BSSID);
       Serial.print(" RSSI: ");
-      Serial.print(WiFi.RSSI(dgbSpNetItem));
+      Serial.print(radar->accessPoints.scanResults->entries[dgbSpNetItem].RSSI);
       Serial.print(" SSID: ");
-      Serial.print(WiFi.SSID(dgbSpNetItem));
+      Serial.print(snapshotSSID(radar, dgbSpNetItem));
       Serial.print(" channel: ");
-      Serial.print(WiFi.channel(dgbSpNetItem));
+      Serial.print(radar->accessPoints.scanResults->entries[dgbSpNetItem].channel);
       
       Serial.println();
     }
 }
 
-void serialPrintCSVdata() {  // the Serial plotter function in Arduino IDE is smart enough to separately extract csv text data and use it as field names
+void serialPrintCSVdata(radarContext * radar) {  // the Serial plotter function in Arduino IDE is smart enough to separately extract csv text data and use it as field names
 
   int localVariance = 0;
   int localTVariance = 0;
 
-  for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
 
-    Serial.print(accessPoints.SSIDs[slotIndex]);
+    Serial.print(radar->accessPoints.SSIDs[slotIndex]);
     Serial.print("_RSSI");
-    Serial.print(accessPoints.transmittersData[slotIndex].latestReceivedSample);
+    Serial.print(radar->accessPoints.transmittersData[slotIndex].latestReceivedSample);
     Serial.print("_AVG");
-    Serial.print(accessPoints.transmittersData[slotIndex].mobileAverage);
+    Serial.print(radar->accessPoints.transmittersData[slotIndex].mobileAverage);
     Serial.print(",");
     
   }
   Serial.println();
 
-  for (int slotIndex = 0; slotIndex < accessPoints.transmittersListLen; slotIndex++) {
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
 
-    localVariance = accessPoints.latestVariances[slotIndex];
+    localVariance = radar->accessPoints.latestVariances[slotIndex];
     localTVariance = localTVariance + localVariance;
     
     Serial.print(localVariance);
@@ -953,160 +1699,2032 @@ void serialPrintCSVdata() {  // the Serial plotter function in Arduino IDE is sm
 }
 
 
-int multistatic_interference_radar() { // request the RSSI level internally, then process the signal and return the detection level in dBm
 
-  int rssi = 0;
-  int scanRes = 0;
+// CRC-32 (IEEE, reflected, the zlib and Ethernet one) shared by the snapshots, the telemetry chunks and the trace dumps
+
+uint32_t radarCRC32(const uint8_t * bytes, int length, uint32_t previousCRC = 0) { // one nibble at a time: a 64 bytes table instead of 1 KB; previousCRC continues a CRC over more pieces
+  static const uint32_t nibbleTable[16] = { 0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+                                            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C };
+  uint32_t crc = ~previousCRC;
+  for (int byteIndex = 0; byteIndex < length; byteIndex++) {
+    crc = (crc >> 4) ^ nibbleTable[(crc ^ bytes[byteIndex]) & 0x0F];
+    crc = (crc >> 4) ^ nibbleTable[(crc ^ (bytes[byteIndex] >> 4)) & 0x0F];
+  }
+  return ~crc;
+}
+
 
-  int res = 0;
 
+// binary telemetry, see the telemetry section of multistatic_interference_radar.h
 
-/* //// this part as a reference in case we decide to implement a more efficient scan type
-  if (strongestAPfound == 0) { // don't have a strongest AP on record yet? Do a slow full scan
-    scanRes = (int) WiFi.scanNetworks(false, false, false, 300, 0); //scanNetworks(bool async = false, bool show_hidden = false, bool passive = false, uint32_t max_ms_per_chan = 300, uint8_t channel = 0);
-  } else { // do a single channel active scan, this should be much faster
-    scanRes = (int) WiFi.scanNetworks(false, false, false, 200, strongestChannel); //scanNetworks(bool async = false, bool show_hidden = false, bool passive = false, uint32_t max_ms_per_chan = 300, uint8_t channel = 0);
+int telemetryPutVarint(uint8_t * bytes, uint32_t value) { // LEB128, returns the bytes written (1 to 5)
+  int length = 0;
+  while (value >= 0x80) {
+    bytes[length] = (uint8_t) (value | 0x80);
+    value = value >> 7;
+    length++;
   }
-*/
+  bytes[length] = (uint8_t) value;
+  return length + 1;
+}
 
 
-  // even if it's slower, we always do a full channel scan. 
+int telemetryPutSigned(uint8_t * bytes, int32_t value) { // zigzag varint: small magnitudes, small encodings, whatever the sign
+  return telemetryPutVarint(bytes, ((uint32_t) value << 1) ^ (uint32_t) (value >> 31));
+}
 
-  accessPoints.discoveredNetworks = (int) WiFi.scanNetworks(false, false, false, 300, 0); //scanNetworks(bool async = false, bool show_hidden = false, bool passive = false, uint32_t max_ms_per_chan = 300, uint8_t channel = 0);  // channel 0 means all channels
-  
-  
-  if (accessPoints.discoveredNetworks <= 0) {
-    if (debugRadarMsg >= 1) {
-      Serial.println("multistatic_interference_radar(): no connection or no AP in the vicinity: the radar is inoperable");
-    }
-    return RADAR_INOPERABLE;
-  }
 
-  // diagnostics
+int telemetryPutDelta(uint8_t * bytes, int32_t value, int32_t * previous) { // value - previous (modulo 2^32, lossless), then previous = value
+  int32_t delta = (int32_t) ((uint32_t) value - (uint32_t) *previous);
+  *previous = value;
+  return telemetryPutSigned(bytes, delta);
+}
+
 
-  if (debugRadarMsg >= 5) {
-    serialPrintScanResults();
+int telemetryFlush(radarContext * radar) { // closes the chunk, hands it to the sink and starts the next one; returns the chunk length, 0 if it was empty
+  radarTelemetry * telemetry = &radar->telemetry;
+  if (telemetry->recordsNumber == 0) {
+    return 0;
   }
-  
-  // safety checks on the results list
+  uint8_t * chunk = telemetry->chunk;
+  int length = TELEMETRY_CHUNK_HEADER_LEN + telemetry->payloadLength;
+  chunk[0] = TELEMETRY_SYNC0;
+  chunk[1] = TELEMETRY_SYNC1;
+  chunk[2] = TELEMETRY_VERSION;
+  chunk[3] = 0;
+  for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+    chunk[4 + byteIndex] = (uint8_t) (telemetry->sequence >> (8 * byteIndex));
+  }
+  chunk[8] = (uint8_t) telemetry->payloadLength;
+  chunk[9] = (uint8_t) (telemetry->payloadLength >> 8);
+  chunk[10] = (uint8_t) telemetry->recordsNumber;
+  chunk[11] = (uint8_t) (telemetry->recordsNumber >> 8);
+  uint32_t crc = radarCRC32(&chunk[2], length - 2);
+  for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+    chunk[length + byteIndex] = (uint8_t) (crc >> (8 * byteIndex));
+  }
+  length = length + 4;
 
-  if (accessPoints.discoveredNetworks >= ABSOLUTE_MAX_SCAN_RESULTS) {
-    
-    if (debugRadarMsg >= 1) {
-      Serial.print("multistatic_interference_radar(): warning: detected an abnornally large number of transmitters during scan: ");
-      Serial.print(accessPoints.discoveredNetworks);
-      Serial.print("; please look into this matter as soon as possible: fixing this number to the maximum hardwired allowed limit: ");
-      Serial.println(ABSOLUTE_MAX_SCAN_RESULTS);
-    }
-    accessPoints.discoveredNetworks = ABSOLUTE_MAX_SCAN_RESULTS;
+  if (telemetry->sink != NULL) {
+    telemetry->sink(chunk, length, telemetry->sinkData);
+  } else {
+    Serial.write(chunk, length);
   }
 
-  
-// now we'll do the reverse: parse the transmitters structure and clean transmitters that are no longer detected.
+  telemetry->chunksSent++;
+  telemetry->bytesSent = telemetry->bytesSent + length;
+  telemetry->recordsSent = telemetry->recordsSent + telemetry->recordsNumber;
+  telemetry->sequence++;
+  telemetry->payloadLength = 0;
+  telemetry->recordsNumber = 0;
+  telemetry->previousTimestampMs = 0; // the next chunk decodes on its own
+  memset(telemetry->previousRSSI, 0, sizeof(telemetry->previousRSSI));
+  memset(telemetry->previousAverage, 0, sizeof(telemetry->previousAverage));
+  memset(telemetry->previousVariance, 0, sizeof(telemetry->previousVariance));
+  memset(telemetry->linkKeys, 0, sizeof(telemetry->linkKeys));
+  return length;
+}
 
-  
-  res = checkInvalidTXdata(); // leave this, it is essential to correctly re-initialize the transmitters array
 
-  if (debugRadarMsg >= 4) {
-    Serial.print("checkInvalidTXdata(): cleaned invalid tx data slots: ");
-    Serial.println(res);
+uint8_t * telemetryReserve(radarContext * radar, uint32_t timestampMs, int maxLength) { // room for a record of at most maxLength bytes (link records included), returns where it goes
+  radarTelemetry * telemetry = &radar->telemetry;
+  if (telemetry->payloadLength + maxLength > TELEMETRY_CHUNK_PAYLOAD_MAX) {
+    telemetryFlush(radar);
   }
-
-  res = checkDeadTransmitters();
-  if (debugRadarMsg >= 4) {
-    Serial.print("checkDeadTransmitters(): cleaned dead transmitters: ");
-    Serial.println(res);
+  if (telemetry->recordsNumber == 0) {
+    telemetry->chunkStartMs = timestampMs;
   }
+  return &telemetry->chunk[TELEMETRY_CHUNK_HEADER_LEN + telemetry->payloadLength];
+}
 
-  // invalid transmitter slots are marked and freed
 
+void telemetryCommit(radarContext * radar, uint32_t timestampMs, int length) { // the record written at the reserved place is length bytes long
+  radarTelemetry * telemetry = &radar->telemetry;
+  telemetry->payloadLength = telemetry->payloadLength + length;
+  telemetry->recordsNumber++;
+  if (timestampMs - telemetry->chunkStartMs >= telemetry->flushIntervalMs) {
+    telemetryFlush(radar);
+  }
+}
 
-// uncomment when debugging
-  /* //// commenting this one, I'm moving the minimum_rssi logic inside the process function in order to implement a more elegant solution with the FIRsecondOrderFilter
-  res = checkInvalidRSSI(); // parse the scan results and clean transmitters that were once valid but now have very low signals
 
-  if ((debugRadarMsg >= 3) && (res > 0)) {
-    Serial.print("multistatic_interference_radar(): transmitters lost to low signal that were once valid: ");
-    Serial.println(res);
+int telemetryLink(radarContext * radar, uint8_t * record, int slotIndex) { // the link record of a slot, if this chunk has not described its transmitter yet; returns its length
+  radarTelemetry * telemetry = &radar->telemetry;
+  if (telemetry->linkKeys[slotIndex] == radar->accessPoints.BSSIDkeys[slotIndex]) {
+    return 0;
   }
-  */
+  telemetry->linkKeys[slotIndex] = radar->accessPoints.BSSIDkeys[slotIndex];
+  telemetry->previousRSSI[slotIndex] = 0; // a new transmitter on the slot: its deltas restart
+  telemetry->previousAverage[slotIndex] = 0;
+  telemetry->previousVariance[slotIndex] = 0;
+  record[0] = TELEMETRY_RECORD_LINK;
+  record[1] = (uint8_t) slotIndex;
+  memcpy(&record[2], radar->accessPoints.BSSIDs[slotIndex], 6);
+  record[8] = radar->accessPoints.channels[slotIndex];
+  telemetry->recordsNumber++;
+  return TELEMETRY_LINK_RECORD_LEN;
+}
 
-  // enable on debugging only
-  if (accessPoints.RSSIcleanerEnable == 1) { // if enabled, parse the scan results and clean transmitters that were once valid but now have very low signals
-    res = checkInvalidRSSI(); // leave this, it is essential to correctly re-initialize the transmitters array
-    if ((debugRadarMsg >= 3) && (res > 0)) {
-      Serial.print("multistatic_interference_radar(): transmitters lost to low signal that were once valid: ");
-      Serial.println(res);
+
+int telemetryLinkValues(radarContext * radar, uint8_t * bytes, int slotIndex) { // RSSI, mobile average and variance deltas of a slot
+  radarTelemetry * telemetry = &radar->telemetry;
+  transmitterData * transmitterX = &radar->accessPoints.transmittersData[slotIndex];
+  int length = telemetryPutDelta(bytes, transmitterX->latestReceivedSample, &telemetry->previousRSSI[slotIndex]);
+  length = length + telemetryPutDelta(&bytes[length], transmitterX->mobileAverage, &telemetry->previousAverage[slotIndex]);
+  length = length + telemetryPutDelta(&bytes[length], radar->accessPoints.latestVariances[slotIndex], &telemetry->previousVariance[slotIndex]);
+  return length;
+}
+
+
+void telemetryCycle(radarContext * radar, int detectionLevel) { // one cycle record, after the processing
+  radarTelemetry * telemetry = &radar->telemetry;
+  const radarScanBackend * backend = activeScanBackend(radar);
+  uint32_t timestampMs = (backend != NULL) ? (uint32_t) backend->millis(backend->backendData) : (uint32_t) millis();
+  int linksNumber = radar->accessPoints.transmittersListLen;
+  int bitmapLength = (linksNumber + 7) / 8;
+  uint8_t * record = telemetryReserve(radar, timestampMs, TELEMETRY_CYCLE_RECORD_MAX_LEN(linksNumber) + linksNumber * TELEMETRY_LINK_RECORD_LEN);
+  int length = 0;
+  int linkRecords = 0;
+
+  for (int slotIndex = 0; slotIndex < linksNumber; slotIndex++) { // the link records first, the decoder needs them to name the links of the cycle
+    if (radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_VALID) {
+      int linkLength = telemetryLink(radar, &record[length], slotIndex);
+      linkRecords = linkRecords + ((linkLength > 0) ? 1 : 0);
+      length = length + linkLength;
     }
   }
 
+  record[length] = TELEMETRY_RECORD_CYCLE;
+  length++;
+  length = length + telemetryPutDelta(&record[length], (int32_t) timestampMs, &telemetry->previousTimestampMs);
+  length = length + telemetryPutSigned(&record[length], detectionLevel);
+  length = length + telemetryPutVarint(&record[length], (uint32_t) linksNumber);
+  uint8_t * validBitmap = &record[length];
+  uint8_t * alarmBitmap = &record[length + bitmapLength];
+  memset(validBitmap, 0, 2 * bitmapLength);
+  length = length + 2 * bitmapLength;
+  for (int slotIndex = 0; slotIndex < linksNumber; slotIndex++) {
+    if (radar->accessPoints.APslotStatus[slotIndex] != AP_SLOT_STATUS_VALID) {
+      continue;
+    }
+    validBitmap[slotIndex / 8] |= (uint8_t) (1 << (slotIndex % 8));
+    if (radar->accessPoints.transmittersData[slotIndex].alarmStatus != 0) {
+      alarmBitmap[slotIndex / 8] |= (uint8_t) (1 << (slotIndex % 8));
+    }
+    length = length + telemetryLinkValues(radar, &record[length], slotIndex);
+  }
 
-  // check the completeness of the data
+  telemetryCommit(radar, timestampMs, length); // counts the cycle record, telemetryLink() counted its own
+}
 
-  accessPoints.initComplete = checkTransmitterArray();  // if there are empty, free, invalid slots then the result is 0, if the slot array is full and ok, then the result is 1
 
+void telemetrySample(radarContext * radar, int slotIndex, uint32_t timestampMs) { // one streamed sample record, after its processing
+  radarTelemetry * telemetry = &radar->telemetry;
+  uint8_t * record = telemetryReserve(radar, timestampMs, TELEMETRY_SAMPLE_RECORD_MAX_LEN + TELEMETRY_LINK_RECORD_LEN);
+  int length = telemetryLink(radar, record, slotIndex);
+  record[length] = TELEMETRY_RECORD_SAMPLE;
+  length++;
+  length = length + telemetryPutVarint(&record[length], (uint32_t) (slotIndex * 2 + ((radar->accessPoints.transmittersData[slotIndex].alarmStatus != 0) ? 1 : 0)));
+  length = length + telemetryPutDelta(&record[length], (int32_t) timestampMs, &telemetry->previousTimestampMs);
+  length = length + telemetryLinkValues(radar, &record[length], slotIndex);
+  telemetryCommit(radar, timestampMs, length);
+}
 
 
-  
+void planChannel(scanScheduler * plan, int channel) { // adds a channel to the targeted scan plan, once
+  if ((channel < 1) || (channel > WIFI_CHANNELS_NUMBER)) {
+    return;
+  }
+  for (int planIndex = 0; planIndex < plan->planChannelsNumber; planIndex++) {
+    if (plan->planChannels[planIndex] == channel) {
+      return;
+    }
+  }
+  plan->planChannels[plan->planChannelsNumber] = (uint8_t) channel;
+  plan->planChannelsNumber++;
+}
+
+
+void planScanCycle(radarContext * radar) { // decides what the current cycle scans: a full discovery sweep or only the channels of the tracked transmitters
+  scanScheduler * plan = &radar->accessPoints.scanPlan;
+  radarShadows * shadows = &radar->accessPoints.shadows;
+
+  plan->planFullSweep = 1;
+  plan->planChannelsNumber = 0;
+
+  if ((plan->targetedScan == 0) || (plan->fullSweepRequested == 1) || (plan->cyclesSinceFullSweep >= plan->fullSweepInterval - 1)) {
+    return;
+  }
+
+  // distinct channels of the valid slots
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    if ((radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_VALID) && (radar->accessPoints.BSSIDkeys[slotIndex] != 0)) {
+      planChannel(plan, radar->accessPoints.channels[slotIndex]);
+    }
+  }
+  // the shadows must keep receiving samples to stay warm
+  for (int shadowIndex = 0; shadowIndex < shadows->shadowsNumber; shadowIndex++) {
+    if (shadows->BSSIDkeys[shadowIndex] != 0) {
+      planChannel(plan, shadows->channels[shadowIndex]);
+    }
+  }
+
+  if (plan->planChannelsNumber > 0) { // nothing tracked: nothing to target, sweep
+    plan->planFullSweep = 0;
+  }
+}
+
+
+void buildScanRequest(radarContext * radar, scanRequest * request) { // plans the next cycle and hands the plan over to whoever does the scans
+  scanScheduler * plan = &radar->accessPoints.scanPlan;
+
+  planScanCycle(radar);
+  request->fullSweep = plan->planFullSweep;
+  request->channelsNumber = plan->planChannelsNumber;
+  for (int planIndex = 0; planIndex < plan->planChannelsNumber; planIndex++) {
+    request->channels[planIndex] = plan->planChannels[planIndex];
+  }
+  request->fullSweepDwellMs = plan->fullSweepDwellMs;
+  request->targetedDwellMs = plan->targetedDwellMs;
+  request->startMs = 0;
+  request->scanMs = 0;
+  request->channelScans = 0;
+}
+
+
+int runScanRequest(radarContext * radar, const radarScanBackend * backend, scanRequest * request, scanSnapshot * snapshot) { // does the scans of the request with blocking scans, fills the snapshot; returns the number of scan results
+  int scanRes = 0;
+
+  RADAR_PROFILE_SCAN_TICKS(radar, scanTicks);
+  request->startMs = backend->millis(backend->backendData);
+  resetScanSnapshot(snapshot);
+  snapshot->fullSweep = request->fullSweep;
+
+  if (request->fullSweep == 1) {
+    scanRes = backend->startScan(backend->backendData, 0, request->fullSweepDwellMs); // channel 0 means all channels
+    if (scanRes > 0) {
+      appendScanResults(radar, backend, snapshot, scanRes);
+    }
+  } else {
+    for (int planIndex = 0; planIndex < request->channelsNumber; planIndex++) {
+      scanRes = backend->startScan(backend->backendData, request->channels[planIndex], request->targetedDwellMs);
+      if (scanRes > 0) {
+        appendScanResults(radar, backend, snapshot, scanRes);
+      }
+      request->channelScans++;
+    }
+  }
+
+  request->scanMs = backend->millis(backend->backendData) - request->startMs;
+  RADAR_PROFILE_SCAN_STAGE(radar, RADAR_STAGE_SCAN, scanTicks);
+  return snapshot->entriesNumber;
+}
+
+
+void accountScanRequest(radarContext * radar, const scanRequest * request, const scanSnapshot * snapshot) { // scheduler bookkeeping and statistics, once all the scans of the request are in the snapshot
+  scanScheduler * plan = &radar->accessPoints.scanPlan;
+
+  if (request->fullSweep == 1) {
+    plan->fullSweepRequested = 0;
+    plan->cyclesSinceFullSweep = 0;
+    plan->fullSweeps++;
+  } else {
+    plan->cyclesSinceFullSweep++;
+    plan->targetedCycles++;
+  }
+
+  plan->channelScans = plan->channelScans + request->channelScans;
+  plan->lastCycleScanMs = request->scanMs;
+  plan->totalScanMs = plan->totalScanMs + request->scanMs;
+
+  RADAR_LOG(radar, 4, RADAR_EVENT_SCAN_REQUEST, request->fullSweep, (request->fullSweep == 1) ? 0 : request->channelsNumber, snapshot->entriesNumber, request->scanMs);
+}
+
+
+int runScanCycle(radarContext * radar, const radarScanBackend * backend) { // plans and scans one cycle with blocking scans, fills accessPoints.scanResults; returns the number of scan results
+  scanRequest request;
+
+  buildScanRequest(radar, &request);
+  runScanRequest(radar, backend, &request, radar->accessPoints.scanResults);
+  accountScanRequest(radar, &request, radar->accessPoints.scanResults);
+
+  return radar->accessPoints.scanResults->entriesNumber;
+}
+
+
+int startNextAsyncScan(radarContext * radar, const radarScanBackend * backend) { // starts the next scan of the request in the background, returns 1 if one has been started, 0 when the request is over
+  scanPipeline * pipe = &radar->accessPoints.pipeline;
+  scanRequest * request = &pipe->request;
+
+  if (request->fullSweep == 1) {
+    if (pipe->planIndex > 0) {
+      return 0;
+    }
+    pipe->planIndex = 1;
+    return (backend->startScanAsync(backend->backendData, 0, request->fullSweepDwellMs) >= 0) ? 1 : 0; // channel 0 means all channels
+  }
+
+  while (pipe->planIndex < request->channelsNumber) { // a channel that fails to start is skipped
+    int channel = request->channels[pipe->planIndex];
+    pipe->planIndex++;
+    request->channelScans++;
+    if (backend->startScanAsync(backend->backendData, channel, request->targetedDwellMs) >= 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+
+void topUpScanRequest(radarContext * radar, scanRequest * request) { // adds to a targeted request still running the channels of the slots and shadows loaded since it was planned
+  scanScheduler topUp;
+
+  if (request->fullSweep == 1) {
+    return;
+  }
+  topUp.planChannelsNumber = request->channelsNumber;
+  for (int planIndex = 0; planIndex < request->channelsNumber; planIndex++) {
+    topUp.planChannels[planIndex] = request->channels[planIndex];
+  }
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    if ((radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_VALID) && (radar->accessPoints.BSSIDkeys[slotIndex] != 0)) {
+      planChannel(&topUp, radar->accessPoints.channels[slotIndex]);
+    }
+  }
+  for (int shadowIndex = 0; shadowIndex < radar->accessPoints.shadows.shadowsNumber; shadowIndex++) {
+    if (radar->accessPoints.shadows.BSSIDkeys[shadowIndex] != 0) {
+      planChannel(&topUp, radar->accessPoints.shadows.channels[shadowIndex]);
+    }
+  }
+  for (int planIndex = request->channelsNumber; planIndex < topUp.planChannelsNumber; planIndex++) {
+    request->channels[planIndex] = topUp.planChannels[planIndex];
+  }
+  request->channelsNumber = topUp.planChannelsNumber;
+}
+
+
+int stepAsyncScanCycle(radarContext * radar, const radarScanBackend * backend) { // advances the background acquisition without ever waiting, returns 1 when a whole cycle is in the fill buffer
+  scanPipeline * pipe = &radar->accessPoints.pipeline;
+  scanSnapshot * fillSnapshot = &radar->accessPoints.scanBuffers[pipe->fillBuffer];
+
+  if (pipe->cycleRunning == 0) {
+    buildScanRequest(radar, &pipe->request);
+    pipe->request.startMs = backend->millis(backend->backendData);
+    resetScanSnapshot(fillSnapshot);
+    fillSnapshot->fullSweep = pipe->request.fullSweep;
+    pipe->planIndex = 0;
+    pipe->scanInFlight = 0;
+    pipe->cycleRunning = 1;
+  }
+
+  if (pipe->scanInFlight == 1) {
+    int scanRes = backend->scanStatus(backend->backendData);
+    if (scanRes == RADAR_SCAN_RUNNING) {
+      return 0;
+    }
+    pipe->scanInFlight = 0;
+    if (scanRes >= 0) {
+      appendScanResults(radar, backend, fillSnapshot, scanRes);
+    } else {
+      backend->releaseResults(backend->backendData);
+    }
+  }
+
+  if (startNextAsyncScan(radar, backend) == 1) {
+    pipe->scanInFlight = 1;
+    return 0;
+  }
+
+  pipe->request.scanMs = backend->millis(backend->backendData) - pipe->request.startMs;
+  accountScanRequest(radar, &pipe->request, fillSnapshot);
+  pipe->cycleRunning = 0;
+  return 1;
+}
+
+
+// warm start: snapshot and restore of the valid slots and of their filter windows, see the format in multistatic_interference_radar.h
+
+typedef struct  snapshotLinkStruct { // one link record of a snapshot, as parsed; the pointers point into the snapshot buffer
+
+int slot = 0;
+
+int channel = 0;
+
+const uint8_t * BSSID = NULL;
+
+const uint8_t * SSID = NULL;
+
+int SSIDlength = 0;
+
+int samplesNumber = 0;
+
+int variancesNumber = 0;
+
+int mobileAverage = 0;
+
+int currentRSSI = 0;
+
+int variance = 0;
+
+int varianceAR = 0;
+
+const uint8_t * samples = NULL; // samplesNumber signed bytes, oldest first
+
+const uint8_t * variances = NULL; // variancesNumber little endian 16 bit words, oldest first
+
+} snapshotLink;
+
+
+void snapshotPut16(uint8_t * bytes, uint32_t value) {
+  bytes[0] = value & 0xff;
+  bytes[1] = (value >> 8) & 0xff;
+}
+
+
+void snapshotPut32(uint8_t * bytes, uint32_t value) {
+  bytes[0] = value & 0xff;
+  bytes[1] = (value >> 8) & 0xff;
+  bytes[2] = (value >> 16) & 0xff;
+  bytes[3] = (value >> 24) & 0xff;
+}
+
+
+uint32_t snapshotGet16(const uint8_t * bytes) {
+  return bytes[0] | (bytes[1] << 8);
+}
+
+
+uint32_t snapshotGet32(const uint8_t * bytes) {
+  return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+
+int clampRSSI(int rssi) { // to the signed byte the snapshot stores
+  if (rssi < ABSOLUTE_RSSI_LIMIT) {
+    return ABSOLUTE_RSSI_LIMIT;
+  }
+  if (rssi > 127) {
+    return 127;
+  }
+  return rssi;
+}
+
+
+int readFilterWindows(const transmitterData * transmitterX, int * samples, int * variances, int * variancesNumber) { // copies the windows of a scalar filter, oldest first; returns the number of samples
+  *variancesNumber = 0;
+
+  if ((transmitterX->sampleBufferSize < 1) || (transmitterX->sampleBufferSize > MAX_SAMPLEBUFFERSIZE_MULTI) || (transmitterX->sampleBufferIndex >= transmitterX->sampleBufferSize)
+      || (transmitterX->varianceBufferSize < 1) || (transmitterX->varianceBufferSize > MAX_VARIANCEBUFFERSIZE_MULTI) || (transmitterX->varianceBufferIndex >= transmitterX->varianceBufferSize)) {
+    return 0; // sizes changed from the outside and not processed since: nothing trustworthy to save
+  }
+  int firstSample = 0;
+  int samplesNumber = transmitterX->sampleBufferIndex;
+  if (transmitterX->sampleBufferValid == 1) {
+    firstSample = transmitterX->sampleBufferIndex;
+    samplesNumber = transmitterX->sampleBufferSize;
+  }
+  for (int sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++) {
+    samples[sampleIndex] = transmitterX->sampleBuffer[(firstSample + sampleIndex) % transmitterX->sampleBufferSize];
+  }
+  if (transmitterX->sampleBufferValid == 1) { // the variance buffer is only written from then on, the entries not written yet are zeroes
+    *variancesNumber = transmitterX->varianceBufferSize;
+    for (int varianceIndex = 0; varianceIndex < transmitterX->varianceBufferSize; varianceIndex++) {
+      variances[varianceIndex] = transmitterX->varianceBuffer[(transmitterX->varianceBufferIndex + varianceIndex) % transmitterX->varianceBufferSize];
+    }
+  }
+  return samplesNumber;
+}
+
+
+int readLinkWindows(radarContext * radar, int slotIndex, int * samples, int * variances, int * variancesNumber) { // copies the windows of a slot, oldest first, from whichever engine is in use; returns the number of samples
+  transmitterData * transmitterX = &radar->accessPoints.transmittersData[slotIndex];
+  transmittersBatchData * batch = &radar->accessPoints.batchData;
+  int samplesNumber = 0;
+  *variancesNumber = 0;
+
+  if (transmitterX->resetRequest == 1) { // loaded this cycle and not processed yet: the windows still belong to the previous transmitter
+    return 0;
+  }
+
+  if (radar->accessPoints.batchProcessing >= 1) {
+    if ((batch->windowsSize != batch->mobileAverageFilterSize) || (batch->integratorSize != batch->varianceIntegratorLimit) || (batch->resetRequest[slotIndex] == 1)) {
+      return 0; // the kernel has not run with these windows yet
+    }
+    samplesNumber = batch->samplesCount[slotIndex];
+    for (int sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++) {
+      samples[sampleIndex] = batch->sampleRing[(batch->sampleBufferIndex - samplesNumber + sampleIndex + batch->sampleBufferSize) % batch->sampleBufferSize][slotIndex];
+    }
+    if (samplesNumber >= batch->sampleBufferSize) { // booting links only have zeroes in the variance ring
+      *variancesNumber = batch->varianceBufferSize;
+      for (int varianceIndex = 0; varianceIndex < batch->varianceBufferSize; varianceIndex++) {
+        variances[varianceIndex] = batch->varianceRing[(batch->varianceBufferIndex + varianceIndex) % batch->varianceBufferSize][slotIndex];
+      }
+    }
+    return samplesNumber;
+  }
+
+  return readFilterWindows(transmitterX, samples, variances, variancesNumber);
+}
+
+
+int saveState(radarContext * radar, uint8_t * buffer, int bufferLength) { // returns the snapshot length, RADAR_SNAPSHOT_STORAGE_FAILED if it does not fit
+
+  checkTransmittersPool(radar);
+  if ((buffer == NULL) || (bufferLength < RADAR_SNAPSHOT_HEADER_LEN + 4)) {
+    return RADAR_SNAPSHOT_STORAGE_FAILED;
+  }
+
+  int samples[MAX_SAMPLEBUFFERSIZE_MULTI] = {0};
+  int variances[MAX_VARIANCEBUFFERSIZE_MULTI] = {0};
+  int length = RADAR_SNAPSHOT_HEADER_LEN;
+  int linksNumber = 0;
+
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    if ((radar->accessPoints.APslotStatus[slotIndex] != AP_SLOT_STATUS_VALID) || (radar->accessPoints.BSSIDkeys[slotIndex] == 0)) {
+      continue; // free, invalid and booting slots are restored free anyway
+    }
+    transmitterData * transmitterX = &radar->accessPoints.transmittersData[slotIndex];
+    int variancesNumber = 0;
+    int samplesNumber = readLinkWindows(radar, slotIndex, samples, variances, &variancesNumber);
+    int SSIDlength = strnlen(radar->accessPoints.SSIDs[slotIndex], 32);
+
+    if (length + 21 + SSIDlength + samplesNumber + 2 * variancesNumber + 4 > bufferLength) {
+      if (RADAR_LOG_ENABLED(radar, 1)) {
+        Serial.println("multistatic_interference_radar_save_state(): the buffer is too small, see RADAR_SNAPSHOT_MAX_LEN()");
+      }
+      return RADAR_SNAPSHOT_STORAGE_FAILED;
+    }
+
+    uint8_t * record = &buffer[length];
+    record[0] = (uint8_t) slotIndex;
+    record[1] = radar->accessPoints.channels[slotIndex];
+    memcpy(&record[2], radar->accessPoints.BSSIDs[slotIndex], 6);
+    record[8] = (uint8_t) SSIDlength;
+    memcpy(&record[9], radar->accessPoints.SSIDs[slotIndex], SSIDlength);
+    record = &record[9 + SSIDlength];
+    record[0] = (uint8_t) samplesNumber;
+    record[1] = (uint8_t) variancesNumber;
+    record[2] = (uint8_t) (int8_t) clampRSSI(transmitterX->mobileAverage);
+    record[3] = (uint8_t) (int8_t) clampRSSI(transmitterX->currentRSSI);
+    snapshotPut32(&record[4], (uint32_t) transmitterX->variance);
+    snapshotPut32(&record[8], (uint32_t) transmitterX->varianceAR);
+    record = &record[12];
+    for (int sampleIndex = 0; sampleIndex < samplesNumber; sampleIndex++) {
+      record[sampleIndex] = (uint8_t) (int8_t) clampRSSI(samples[sampleIndex]);
+    }
+    record = &record[samplesNumber];
+    for (int varianceIndex = 0; varianceIndex < variancesNumber; varianceIndex++) {
+      int varianceValue = variances[varianceIndex];
+      if (varianceValue < 0) {
+        varianceValue = 0;
+      }
+      if (varianceValue > MAX_VARIANCE_MULTI) {
+        varianceValue = MAX_VARIANCE_MULTI;
+      }
+      snapshotPut16(&record[2 * varianceIndex], (uint32_t) varianceValue);
+    }
+
+    length = length + 21 + SSIDlength + samplesNumber + 2 * variancesNumber;
+    linksNumber++;
+  }
+
+  buffer[0] = 'M';
+  buffer[1] = 'I';
+  buffer[2] = 'R';
+  buffer[3] = 'S';
+  buffer[4] = RADAR_SNAPSHOT_VERSION;
+  buffer[5] = (radar->accessPoints.batchProcessing >= 1) ? 1 : 0;
+  snapshotPut16(&buffer[6], (uint32_t) linksNumber);
+  snapshotPut32(&buffer[8], (uint32_t) (length + 4));
+  snapshotPut32(&buffer[length], radarCRC32(buffer, length));
+
+  return length + 4;
+}
+
+
+int parseSnapshotLink(const uint8_t * record, const uint8_t * end, snapshotLink * link) { // returns the record length, -1 if it overruns the snapshot or makes no sense
+  if (end - record < 21) {
+    return -1;
+  }
+  link->slot = record[0];
+  link->channel = record[1];
+  link->BSSID = &record[2];
+  link->SSIDlength = record[8];
+  if ((link->slot >= MAX_ALLOWED_TRANSMITTERS_NUMBER) || (link->SSIDlength > 32) || (end - record < 21 + link->SSIDlength)) {
+    return -1;
+  }
+  link->SSID = &record[9];
+  const uint8_t * fields = &record[9 + link->SSIDlength];
+  link->samplesNumber = fields[0];
+  link->variancesNumber = fields[1];
+  link->mobileAverage = (int8_t) fields[2];
+  link->currentRSSI = (int8_t) fields[3];
+  link->variance = (int32_t) snapshotGet32(&fields[4]);
+  link->varianceAR = (int32_t) snapshotGet32(&fields[8]);
+  int length = 21 + link->SSIDlength + link->samplesNumber + 2 * link->variancesNumber;
+  if ((link->samplesNumber > MAX_SAMPLEBUFFERSIZE_MULTI) || (link->variancesNumber > MAX_VARIANCEBUFFERSIZE_MULTI) || (end - record < length)) {
+    return -1;
+  }
+  link->samples = &fields[12];
+  link->variances = &fields[12 + link->samplesNumber];
+  return length;
+}
+
+
+int fillBatchLink(transmittersBatchData *batch, int slotIndex, const int * samples, int samplesNumber, const int * variances, int variancesNumber) { // loads windows, oldest first, into a clean link column and rebuilds its running sums; returns the number of samples kept (the newest ones)
+  resetBatchLink(batch, slotIndex);
+  int samplesKept = (samplesNumber < batch->sampleBufferSize) ? samplesNumber : batch->sampleBufferSize;
+  int variancesKept = (variancesNumber < batch->varianceBufferSize) ? variancesNumber : batch->varianceBufferSize;
+  // the columns are filled so that the newest entries sit right before the shared write positions
+  for (int sampleIndex = 0; sampleIndex < samplesKept; sampleIndex++) {
+    batch->sampleRing[(batch->sampleBufferIndex - samplesKept + sampleIndex + batch->sampleBufferSize) % batch->sampleBufferSize][slotIndex] = samples[samplesNumber - samplesKept + sampleIndex];
+  }
+  for (int varianceIndex = 0; varianceIndex < variancesKept; varianceIndex++) {
+    batch->varianceRing[(batch->varianceBufferIndex - variancesKept + varianceIndex + batch->varianceBufferSize) % batch->varianceBufferSize][slotIndex] = variances[variancesNumber - variancesKept + varianceIndex];
+  }
+  for (int sampleIndex = 1; sampleIndex <= batch->mobileAverageFilterSize; sampleIndex++) {
+    batch->mobileAverageSum[slotIndex] = batch->mobileAverageSum[slotIndex] + batch->sampleRing[(batch->sampleBufferIndex - sampleIndex + batch->sampleBufferSize) % batch->sampleBufferSize][slotIndex];
+  }
+  for (int varianceIndex = 0; varianceIndex < batch->varianceBufferSize; varianceIndex++) {
+    batch->varianceBufferSum[slotIndex] = batch->varianceBufferSum[slotIndex] + batch->varianceRing[varianceIndex][slotIndex];
+  }
+  for (int varianceIndex = 1; varianceIndex <= batch->varianceIntegratorLimit; varianceIndex++) {
+    batch->varianceIntegral[slotIndex] = batch->varianceIntegral[slotIndex] + batch->varianceRing[(batch->varianceBufferIndex - varianceIndex + batch->varianceBufferSize) % batch->varianceBufferSize][slotIndex];
+  }
+  batch->samplesCount[slotIndex] = samplesKept;
+  return samplesKept;
+}
+
+
+void restoreLinkWindows(radarContext * radar, const snapshotLink * link) { // into whichever engine is in use; the newest saved entries win when the windows have shrunk since
+  transmitterData * transmitterX = &radar->accessPoints.transmittersData[link->slot];
+  transmittersBatchData * batch = &radar->accessPoints.batchData;
+  int slotIndex = link->slot;
+
+  if (radar->accessPoints.batchProcessing >= 1) {
+    int samples[MAX_SAMPLEBUFFERSIZE_MULTI] = {0};
+    int variances[MAX_VARIANCEBUFFERSIZE_MULTI] = {0};
+    for (int sampleIndex = 0; sampleIndex < link->samplesNumber; sampleIndex++) {
+      samples[sampleIndex] = (int8_t) link->samples[sampleIndex];
+    }
+    for (int varianceIndex = 0; varianceIndex < link->variancesNumber; varianceIndex++) {
+      variances[varianceIndex] = (int) snapshotGet16(&link->variances[2 * varianceIndex]);
+    }
+    int samplesKept = fillBatchLink(batch, slotIndex, samples, link->samplesNumber, variances, link->variancesNumber);
+    batch->mobileAverage[slotIndex] = link->mobileAverage;
+    batch->currentRSSI[slotIndex] = link->currentRSSI;
+    batch->varianceAR[slotIndex] = link->varianceAR;
+    batch->variance[slotIndex] = (samplesKept >= batch->sampleBufferSize) ? link->variance : RADAR_BOOTING;
+    batch->latestReceivedSample[slotIndex] = (samplesKept > 0) ? (int8_t) link->samples[link->samplesNumber - 1] : ABSOLUTE_RSSI_LIMIT;
+    transmitterX->sampleBufferValid = (samplesKept >= batch->sampleBufferSize) ? 1 : 0;
+    transmitterX->variance = batch->variance[slotIndex];
+  } else {
+    clearTransmitterBuffers(transmitterX);
+    resyncRunningSums(transmitterX); // only for its clamps of the window sizes
+    int samplesKept = (link->samplesNumber < transmitterX->sampleBufferSize) ? link->samplesNumber : transmitterX->sampleBufferSize;
+    int variancesKept = (link->variancesNumber < transmitterX->varianceBufferSize) ? link->variancesNumber : transmitterX->varianceBufferSize;
+    for (int sampleIndex = 0; sampleIndex < samplesKept; sampleIndex++) {
+      transmitterX->sampleBuffer[sampleIndex] = (int8_t) link->samples[link->samplesNumber - samplesKept + sampleIndex];
+    }
+    for (int varianceIndex = 0; varianceIndex < variancesKept; varianceIndex++) {
+      transmitterX->varianceBuffer[varianceIndex] = (int) snapshotGet16(&link->variances[2 * (link->variancesNumber - variancesKept + varianceIndex)]);
+    }
+    transmitterX->sampleBufferIndex = samplesKept % transmitterX->sampleBufferSize;
+    transmitterX->sampleBufferValid = (samplesKept >= transmitterX->sampleBufferSize) ? 1 : 0;
+    transmitterX->varianceBufferIndex = variancesKept % transmitterX->varianceBufferSize;
+    transmitterX->varianceBufferValid = (variancesKept >= transmitterX->varianceBufferSize) ? 1 : 0;
+    transmitterX->variance = (transmitterX->sampleBufferValid == 1) ? link->variance : RADAR_BOOTING;
+    resyncRunningSums(transmitterX); // now on the restored windows
+  }
+
+  transmitterX->mobileAverage = link->mobileAverage;
+  transmitterX->currentRSSI = link->currentRSSI;
+  transmitterX->varianceAR = link->varianceAR;
+  transmitterX->latestReceivedSample = (link->samplesNumber > 0) ? (int8_t) link->samples[link->samplesNumber - 1] : ABSOLUTE_RSSI_LIMIT;
+  transmitterX->resetRequest = 0; // freeTransmitterSlot() asked for one, the restored windows must survive the next cycle
+  transmitterX->alarmStatus = 0;
+}
+
+
+int restoreState(radarContext * radar, const uint8_t * buffer, int bufferLength) { // returns the number of restored links, or RADAR_SNAPSHOT_INVALID leaving the radar untouched
+
+  checkTransmittersPool(radar);
+
+  // the whole snapshot is checked before anything is touched
+  if ((buffer == NULL) || (bufferLength < RADAR_SNAPSHOT_HEADER_LEN + 4) || (buffer[0] != 'M') || (buffer[1] != 'I') || (buffer[2] != 'R') || (buffer[3] != 'S')) {
+    return RADAR_SNAPSHOT_INVALID;
+  }
+  if (buffer[4] != RADAR_SNAPSHOT_VERSION) {
+    if (RADAR_LOG_ENABLED(radar, 1)) {
+      Serial.print("multistatic_interference_radar_restore_state(): unsupported snapshot version: ");
+      Serial.println(buffer[4]);
+    }
+    return RADAR_SNAPSHOT_INVALID;
+  }
+  int length = (int) snapshotGet32(&buffer[8]);
+  if ((length < RADAR_SNAPSHOT_HEADER_LEN + 4) || (length > bufferLength) || (snapshotGet32(&buffer[length - 4]) != radarCRC32(buffer, length - 4))) {
+    if (RADAR_LOG_ENABLED(radar, 1)) {
+      Serial.println("multistatic_interference_radar_restore_state(): truncated or corrupted snapshot");
+    }
+    return RADAR_SNAPSHOT_INVALID;
+  }
+  int linksNumber = (int) snapshotGet16(&buffer[6]);
+  const uint8_t * end = &buffer[length - 4];
+  const uint8_t * record = &buffer[RADAR_SNAPSHOT_HEADER_LEN];
+  snapshotLink link;
+  for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+    int recordLength = parseSnapshotLink(record, end, &link);
+    if (recordLength < 0) {
+      return RADAR_SNAPSHOT_INVALID;
+    }
+    record = &record[recordLength];
+  }
+  if (record != end) {
+    return RADAR_SNAPSHOT_INVALID;
+  }
+
+  // now the slots: everything is freed, then the snapshot links are put back in their slots
+  radarWarmStart * warmStart = &radar->accessPoints.warmStart;
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    freeTransmitterSlot(radar, slotIndex);
+    warmStart->restoredSlots[slotIndex] = 0;
+  }
+  if (radar->accessPoints.batchProcessing >= 1) {
+    setupBatchWindows(&radar->accessPoints.batchData); // the kernel must not reset every link on its next call
+  }
+
+  int restored = 0;
+  record = &buffer[RADAR_SNAPSHOT_HEADER_LEN];
+  for (int linkIndex = 0; linkIndex < linksNumber; linkIndex++) {
+    record = &record[parseSnapshotLink(record, end, &link)];
+    if ((link.slot >= radar->accessPoints.transmittersListLen) || (warmStart->restoredSlots[link.slot] == 1)) {
+      continue; // fewer transmitters than when saved
+    }
+    setSlotBSSID(radar, link.slot, link.BSSID);
+    if (radar->accessPoints.BSSIDkeys[link.slot] == 0) {
+      continue;
+    }
+    memcpy(radar->accessPoints.SSIDs[link.slot], link.SSID, link.SSIDlength);
+    radar->accessPoints.SSIDs[link.slot][link.SSIDlength] = 0;
+    radar->accessPoints.channels[link.slot] = (uint8_t) link.channel;
+    radar->accessPoints.netItemNumbers[link.slot] = 0; // set by the next scan, before any use
+    radar->accessPoints.APslotStatus[link.slot] = AP_SLOT_STATUS_VALID;
+    restoreLinkWindows(radar, &link);
+
+    // what the validation expects to hear: the mobile average of a full window, otherwise the latest sample
+    warmStart->referenceRSSI[link.slot] = ABSOLUTE_RSSI_LIMIT;
+    if (link.samplesNumber > 0) {
+      warmStart->referenceRSSI[link.slot] = (radar->accessPoints.transmittersData[link.slot].sampleBufferValid == 1) ? link.mobileAverage : (int8_t) link.samples[link.samplesNumber - 1];
+    }
+    warmStart->restoredSlots[link.slot] = 1;
+    restored++;
+  }
+
+  warmStart->restoredLinks = restored;
+  warmStart->confirmedLinks = 0;
+  warmStart->droppedLinks = 0;
+  warmStart->validationPending = (restored > 0) ? 1 : 0;
+  radar->accessPoints.initComplete = 0;
+  radar->accessPoints.scanPlan.fullSweepRequested = 1; // the validation must see every restored transmitter, whatever its channel
+
+  if (RADAR_LOG_ENABLED(radar, 1)) {
+    Serial.print("multistatic_interference_radar_restore_state(): restored links: ");
+    Serial.print(restored);
+    Serial.print(" of ");
+    Serial.println(linksNumber);
+  }
+
+  return restored;
+}
+
+
+int validateRestoredSlots(radarContext * radar) { // first scan after a restore: drops the restored transmitters that are gone or moved, all of them if most are; returns how many have been dropped
+
+  radarWarmStart * warmStart = &radar->accessPoints.warmStart;
+  uint8_t confirmedSlots[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+  int restored = 0;
+  int confirmed = 0;
+  int dropped = 0;
+
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    if ((warmStart->restoredSlots[slotIndex] == 0) || (radar->accessPoints.APslotStatus[slotIndex] != AP_SLOT_STATUS_VALID)) {
+      continue;
+    }
+    restored++;
+    int netItem = bssidIndexFind(&radar->accessPoints.scanResultsIndex, radar->accessPoints.BSSIDkeys[slotIndex]);
+    if (netItem < 0) {
+      continue; // gone
+    }
+    int expectedRSSI = warmStart->referenceRSSI[slotIndex];
+    if ((expectedRSSI != ABSOLUTE_RSSI_LIMIT) && (abs(radar->accessPoints.scanResults->entries[netItem].RSSI - expectedRSSI) > warmStart->rssiTolerance)) {
+      continue; // moved, or the room changed: the saved windows would only produce a false detection
+    }
+    confirmedSlots[slotIndex] = 1;
+    confirmed++;
+  }
+
+  int stale = (confirmed * 2 < restored); // most of the snapshot does not match: it is somebody else's room, or a very old one
+
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    if ((warmStart->restoredSlots[slotIndex] == 1) && (radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_VALID) && (stale || (confirmedSlots[slotIndex] == 0))) {
+      freeTransmitterSlot(radar, slotIndex); // refilled from this very scan, as on a cold start
+      dropped++;
+    }
+    warmStart->restoredSlots[slotIndex] = 0;
+  }
+
+  warmStart->validationPending = 0;
+  warmStart->confirmedLinks = stale ? 0 : confirmed;
+  warmStart->droppedLinks = dropped;
+  if (dropped > 0) {
+    radar->accessPoints.initComplete = 0;
+    radar->accessPoints.scanPlan.fullSweepRequested = 1;
+  }
+
+  if (RADAR_LOG_ENABLED(radar, 3)) {
+    Serial.print("validateRestoredSlots(): restored: ");
+    Serial.print(restored);
+    Serial.print(" confirmed: ");
+    Serial.print(warmStart->confirmedLinks);
+    Serial.print(" dropped: ");
+    Serial.print(dropped);
+    Serial.println(stale ? " (stale snapshot: cold start)" : "");
+  }
+
+  return dropped;
+}
+
+
+int storeSnapshot(radarContext * radar) { // saves the state and writes it under the snapshot name, returns the snapshot length or RADAR_SNAPSHOT_STORAGE_FAILED
+
+  checkTransmittersPool(radar);
+  int bufferLength = RADAR_SNAPSHOT_MAX_LEN(radar->accessPoints.transmittersListLen);
+  uint8_t * buffer = (uint8_t *) malloc(bufferLength); // about 500 bytes with the default 4 transmitters, kept off the (small) task stacks; a snapshot is stored once in a while
+  if (buffer == NULL) {
+    return RADAR_SNAPSHOT_STORAGE_FAILED;
+  }
+
+  int length = saveState(radar, buffer, bufferLength);
+  if (length > 0) {
+
+#if defined(ARDUINO)
+
+    Preferences preferences;
+    if (preferences.begin(SNAPSHOT_NVS_NAMESPACE, false) == false) {
+      length = RADAR_SNAPSHOT_STORAGE_FAILED;
+    } else {
+      if (preferences.putBytes(radar->accessPoints.warmStart.name, buffer, length) != (size_t) length) { // NVS replaces the key atomically: a brown-out in the middle leaves the previous snapshot
+        length = RADAR_SNAPSHOT_STORAGE_FAILED;
+      }
+      preferences.end();
+    }
+
+#else
+
+    char path[SNAPSHOT_NAME_LEN + 16] = {0};
+    char temporaryPath[SNAPSHOT_NAME_LEN + 16] = {0};
+    snprintf(path, sizeof(path), "%s.snapshot", radar->accessPoints.warmStart.name);
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.snapshot.new", radar->accessPoints.warmStart.name);
+    FILE * snapshotFile = fopen(temporaryPath, "wb");
+    if (snapshotFile == NULL) {
+      length = RADAR_SNAPSHOT_STORAGE_FAILED;
+    } else {
+      int written = (int) fwrite(buffer, 1, length, snapshotFile);
+      if ((fclose(snapshotFile) != 0) || (written != length) || (rename(temporaryPath, path) != 0)) { // written aside then renamed: a crash in the middle leaves the previous snapshot
+        remove(temporaryPath);
+        length = RADAR_SNAPSHOT_STORAGE_FAILED;
+      }
+    }
+
+#endif
+
+  }
+  free(buffer);
+
+  if (length > 0) {
+    radar->accessPoints.warmStart.storedSnapshots++;
+  }
+  if (RADAR_LOG_ENABLED(radar, 3)) {
+    Serial.print("multistatic_interference_radar_store_snapshot(): ");
+    Serial.println(length);
+  }
+
+  return length;
+}
+
+
+// hot standby: the shadow trackers
+
+int searchShadowByKey(radarContext * radar, uint64_t searchKey) { // returns the shadow following the transmitter, -1 if none; a handful of entries, a linear search is fine
+  radarShadows * shadows = &radar->accessPoints.shadows;
+  if (searchKey == 0) {
+    return -1;
+  }
+  for (int shadowIndex = 0; shadowIndex < shadows->shadowsNumber; shadowIndex++) {
+    if (shadows->BSSIDkeys[shadowIndex] == searchKey) {
+      return shadowIndex;
+    }
+  }
+  return -1;
+}
+
+
+void freeShadow(radarContext * radar, int shadowIndex) {
+  radar->accessPoints.shadows.BSSIDkeys[shadowIndex] = 0;
+  radar->accessPoints.shadows.misses[shadowIndex] = 0;
+}
+
+
+int shadowWarmth(const transmitterData * filterX) { // samples gathered so far, the promotion order
+  if (filterX->resetRequest == 1) {
+    return 0;
+  }
+  return (filterX->sampleBufferValid == 1) ? filterX->sampleBufferSize : filterX->sampleBufferIndex;
+}
+
+
+void armShadow(radarContext * radar, int shadowIndex, int netItem) { // starts following a transmitter, this scan gives its first sample
+  radarShadows * shadows = &radar->accessPoints.shadows;
+  transmitterData * shadowX = &shadows->filters[shadowIndex];
+
+  shadows->BSSIDkeys[shadowIndex] = radar->accessPoints.scanResults->entries[netItem].BSSIDkey;
+  shadows->channels[shadowIndex] = radar->accessPoints.scanResults->entries[netItem].channel;
+  shadows->misses[shadowIndex] = 0;
+  *shadowX = radar->accessPoints.transmittersData[0]; // same window sizes and filter settings as the slots
+  shadowX->resetRequest = 1;
+  shadowX->alarmStatus = 0;
+  multistatic_interference_radar_process(radar, radar->accessPoints.scanResults->entries[netItem].RSSI, shadowX);
+}
+
+
+void promoteShadow(radarContext * radar, int shadowIndex, int netItem, int slotIndex) { // the slot takes over the transmitter of the shadow and its filter state, the slot alarm settings are kept
+  radarShadows * shadows = &radar->accessPoints.shadows;
+  transmitterData * transmitterX = &radar->accessPoints.transmittersData[slotIndex];
+  transmitterData * shadowX = &shadows->filters[shadowIndex];
+
+  if (shadowX->sampleBufferValid == 1) {
+    shadows->promotedWarm++;
+  } else {
+    shadows->promotedBooting++;
+  }
+
+  loadSlotByNetItemIndex(radar, netItem, slotIndex);
+  int enableThreshold = transmitterX->enableThreshold;
+  int varianceThreshold = transmitterX->varianceThreshold;
+  int minimumRSSI = transmitterX->minimum_RSSI;
+  bool enableAutoRegressive = transmitterX->enableAutoRegressive;
+  *transmitterX = *shadowX;
+  transmitterX->enableThreshold = enableThreshold;
+  transmitterX->varianceThreshold = varianceThreshold;
+  transmitterX->minimum_RSSI = minimumRSSI;
+  transmitterX->enableAutoRegressive = enableAutoRegressive;
+  transmitterX->resetRequest = 0; // loadSlotByNetItemIndex() asked for one, the windows of the shadow must survive
+  transmitterX->alarmStatus = 0;
+
+  if (radar->accessPoints.batchProcessing >= 1) { // the shadows always run the scalar filter: copy its windows into the link column
+    transmittersBatchData * batch = &radar->accessPoints.batchData;
+    int samples[MAX_SAMPLEBUFFERSIZE_MULTI] = {0};
+    int variances[MAX_VARIANCEBUFFERSIZE_MULTI] = {0};
+    int variancesNumber = 0;
+    setupBatchWindows(batch); // the kernel must not reset every link on its next call
+    int samplesNumber = readFilterWindows(shadowX, samples, variances, &variancesNumber);
+    int samplesKept = fillBatchLink(batch, slotIndex, samples, samplesNumber, variances, variancesNumber);
+    batch->mobileAverage[slotIndex] = shadowX->mobileAverage;
+    batch->currentRSSI[slotIndex] = shadowX->currentRSSI;
+    batch->varianceAR[slotIndex] = shadowX->varianceAR;
+    batch->variance[slotIndex] = (samplesKept >= batch->sampleBufferSize) ? shadowX->variance : RADAR_BOOTING;
+    batch->latestReceivedSample[slotIndex] = shadowX->latestReceivedSample;
+    transmitterX->sampleBufferValid = (samplesKept >= batch->sampleBufferSize) ? 1 : 0;
+  }
+
+  RADAR_LOG(radar, 3, RADAR_EVENT_SHADOW_PROMOTED, shadowIndex, slotIndex, shadowWarmth(shadowX));
+  freeShadow(radar, shadowIndex);
+}
+
+
+int promoteShadowTrackers(radarContext * radar) { // gives the free slots to the warmest shadows heard by this scan, before loadScanResults() fills the rest cold; returns how many have been promoted
+  radarShadows * shadows = &radar->accessPoints.shadows;
+  int promoted = 0;
+
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    int slotStatus = radar->accessPoints.APslotStatus[slotIndex];
+    if ((slotStatus != AP_SLOT_STATUS_FREE) && (slotStatus != AP_SLOT_STATUS_INVALID) && (slotStatus != AP_SLOT_STATUS_INIT)) {
+      continue;
+    }
+    int bestShadow = -1;
+    int bestNetItem = -1;
+    int bestWarmth = -1;
+    for (int shadowIndex = 0; shadowIndex < shadows->shadowsNumber; shadowIndex++) {
+      int netItem = bssidIndexFind(&radar->accessPoints.scanResultsIndex, shadows->BSSIDkeys[shadowIndex]);
+      if ((netItem < 0) || (searchSlotByKey(radar, shadows->BSSIDkeys[shadowIndex]) >= 0)) {
+        continue;
+      }
+      int warmth = shadowWarmth(&shadows->filters[shadowIndex]);
+      if (warmth > bestWarmth) {
+        bestShadow = shadowIndex;
+        bestNetItem = netItem;
+        bestWarmth = warmth;
+      }
+    }
+    if (bestShadow < 0) { // none left in this scan
+      break;
+    }
+    promoteShadow(radar, bestShadow, bestNetItem, slotIndex);
+    promoted++;
+  }
+
+  return promoted;
+}
+
+
+void updateShadowTrackers(radarContext * radar, int rankedThisCycle) { // once the slots are settled: feeds the shadows with this scan, drops the lost ones and fills the free ones from the ranking
+  radarShadows * shadows = &radar->accessPoints.shadows;
+  int freeShadows = 0;
+
+  if (shadows->shadowsNumber <= 0) {
+    return;
+  }
+
+  for (int shadowIndex = 0; shadowIndex < shadows->shadowsNumber; shadowIndex++) {
+    uint64_t shadowKey = shadows->BSSIDkeys[shadowIndex];
+    if (shadowKey == 0) {
+      freeShadows++;
+      continue;
+    }
+    if (searchSlotByKey(radar, shadowKey) >= 0) { // loaded into a slot some other way (restore, txN growth): the slot owns it now
+      freeShadow(radar, shadowIndex);
+      freeShadows++;
+      continue;
+    }
+    int netItem = bssidIndexFind(&radar->accessPoints.scanResultsIndex, shadowKey);
+    if (netItem < 0) {
+      shadows->misses[shadowIndex]++;
+      if (shadows->misses[shadowIndex] > SHADOW_MAX_MISSES) {
+        freeShadow(radar, shadowIndex);
+        shadows->droppedShadows++;
+        freeShadows++;
+      }
+      continue;
+    }
+    shadows->misses[shadowIndex] = 0;
+    shadows->channels[shadowIndex] = radar->accessPoints.scanResults->entries[netItem].channel;
+    multistatic_interference_radar_process(radar, radar->accessPoints.scanResults->entries[netItem].RSSI, &shadows->filters[shadowIndex]); // not reported, no alarms
+  }
+
+  shadows->cyclesSinceRefill++;
+  if ((freeShadows == 0) || ((rankedThisCycle == 0) && (shadows->cyclesSinceRefill < SHADOW_REFILL_INTERVAL))) {
+    return;
+  }
+  shadows->cyclesSinceRefill = 0;
+  if (rankedThisCycle == 0) {
+    sortScanResultsByRSSI(radar);
+  }
+
+  // the strongest results neither tracked nor shadowed yet
+  int shadowIndex = 0;
+  for (int scanItem = 0; (scanItem < radar->accessPoints.scanIndexByPowerFirstFreeSpot) && (freeShadows > 0); scanItem++) {
+    int netItem = radar->accessPoints.scanIndexByPower[scanItem];
+    uint64_t candidateKey = radar->accessPoints.scanResults->entries[netItem].BSSIDkey;
+    if ((candidateKey == 0) || (searchSlotByKey(radar, candidateKey) >= 0) || (searchShadowByKey(radar, candidateKey) >= 0)) {
+      continue;
+    }
+    while (shadows->BSSIDkeys[shadowIndex] != 0) {
+      shadowIndex++;
+    }
+    armShadow(radar, shadowIndex, netItem);
+    freeShadows--;
+  }
+}
+
+
+int processScanCycle(radarContext * radar) { // everything after the scan: housekeeping, ranking, slot loading and DSP on accessPoints.scanResults; returns the detection level
+
+  int res = 0;
+
+  RADAR_PROFILE_SAMPLE(radar, cycles, timedCycle); // counts the cycle, and decides whether its stages are timed
+  if (radar->accessPoints.discoveredNetworks <= 0) {
+    RADAR_PROFILE_COUNT(radar, inoperableCycles, 1);
+    radar->accessPoints.scanPlan.fullSweepRequested = 1; // whatever we were tracking is gone, go back to discovery
+    RADAR_LOG(radar, 1, RADAR_EVENT_RADAR_INOPERABLE);
+    return RADAR_INOPERABLE;
+  }
+
+  RADAR_PROFILE_TICKS(radar, cycleTicks);
+
+  rebuildScanResultsIndex(radar); // from now on every BSSID lookup in the scan results is a hash probe
+
+  if (radar->accessPoints.warmStart.validationPending == 1) { // first scan after a restore: does the snapshot still match the room?
+    validateRestoredSlots(radar);
+  }
+
+  // diagnostics
+
+  if (RADAR_LOG_ENABLED(radar, 5)) {
+    serialPrintScanResults(radar);
+  }
+
+  
+// now we'll do the reverse: parse the transmitters structure and clean transmitters that are no longer detected.
+
+  
+  RADAR_PROFILE_TICKS(radar, stageTicks);
+  res = checkInvalidTXdata(radar); // leave this, it is essential to correctly re-initialize the transmitters array
+  RADAR_PROFILE_STAGE(radar, RADAR_STAGE_CHECK_INVALID_TX, stageTicks);
+
+  RADAR_LOG(radar, 4, RADAR_EVENT_INVALID_TX_CLEANED, res);
+
+  res = checkDeadTransmitters(radar);
+  RADAR_PROFILE_STAGE(radar, RADAR_STAGE_CHECK_DEAD_TX, stageTicks);
+  RADAR_LOG(radar, 4, RADAR_EVENT_DEAD_TX_CLEANED, res);
+
+  // invalid transmitter slots are marked and freed
+
+
+// uncomment when debugging
+  /* //// commenting this one, I'm moving the minimum_rssi logic inside the process function in order to implement a more elegant solution with the FIRsecondOrderFilter
+  res = checkInvalidRSSI(); // parse the scan results and clean transmitters that were once valid but now have very low signals
+
+  if ((debugRadarMsg >= 3) && (res > 0)) {
+    Serial.print("multistatic_interference_radar(): transmitters lost to low signal that were once valid: ");
+    Serial.println(res);
+  }
+  */
+
+  // enable on debugging only
+  if (radar->accessPoints.RSSIcleanerEnable == 1) { // if enabled, parse the scan results and clean transmitters that were once valid but now have very low signals
+    RADAR_PROFILE_RESTART(radar, stageTicks);
+    res = checkInvalidRSSI(radar); // leave this, it is essential to correctly re-initialize the transmitters array
+    RADAR_PROFILE_STAGE(radar, RADAR_STAGE_CHECK_INVALID_RSSI, stageTicks);
+    if (res > 0) {
+      RADAR_LOG(radar, 3, RADAR_EVENT_LOW_SIGNAL_LOST, res);
+    }
+  }
+
+
+  // check the completeness of the data
+
+  radar->accessPoints.initComplete = checkTransmitterArray(radar);  // if there are empty, free, invalid slots then the result is 0, if the slot array is full and ok, then the result is 1
+
+
+
+  
   // fill empty slots if feasible, please note the BSSIDs must be unique occurrences in the array.
   
-  if (accessPoints.initComplete == 0) { // need to initialize or reinitialize, as empty slots have been detected
+  int rankedThisCycle = 0;
+  if (radar->accessPoints.initComplete == 0) { // need to initialize or reinitialize, as empty slots have been detected
+
+    // warm runner-ups first: the shadow trackers take over the free slots with their filter state
+    if (radar->accessPoints.shadows.shadowsNumber > 0) {
+      res = promoteShadowTrackers(radar);
+      if (res > 0) {
+        RADAR_PROFILE_COUNT(radar, shadowPromotions, res);
+        RADAR_LOG(radar, 3, RADAR_EVENT_SHADOWS_PROMOTED, res);
+      }
+    }
+
+    // sort the scan results by RSSI    // we do this part inside here on request since it's a bit computationally expensive.
+    RADAR_PROFILE_COUNT(radar, rankings, 1);
+    RADAR_PROFILE_RESTART(radar, stageTicks);
+    sortScanResultsByRSSI(radar);
+    RADAR_PROFILE_STAGE(radar, RADAR_STAGE_SORT, stageTicks);
+    rankedThisCycle = 1;
+
+    
+
+    // assign new slots if possible
+
+    res = loadScanResults(radar);
+    RADAR_PROFILE_STAGE(radar, RADAR_STAGE_LOAD, stageTicks);
+    RADAR_LOG(radar, 3, RADAR_EVENT_SLOTS_LOADED, res);
+    
+    
+
+    // finalizing
+    radar->accessPoints.initComplete = 1;
+  } // end filling empty slots
+
+  updateShadowTrackers(radar, rankedThisCycle); // after the slots, so that a promoted shadow does not see this scan twice
+
+  
 
-    // sort the scan results by RSSI    // we do this part inside here on request since it's a bit computationally expensive.
-    sortScanResultsByRSSI();
+  
+  if (res > 0) {
+    RADAR_LOG(radar, 3, RADAR_EVENT_TX_GONE, res);
+  }
 
+  RADAR_PROFILE_RESTART(radar, stageTicks);
+  if (radar->accessPoints.initComplete >= 1) { // process the data
     
+    res = multistatic_interference_radar_multiprocess(radar); // the returned value is a cumulative measure of the signal's variance. Data relative to each transmitter is saved within the relative structures and can be accessed globally.
+    RADAR_PROFILE_STAGE(radar, RADAR_STAGE_MULTIPROCESS, stageTicks);
+  }
+
+  if (radar->telemetry.enabled > 0) { // the binary telemetry replaces the CSV text
+    telemetryCycle(radar, res);
+  } else if (radar->accessPoints.serialCSVdataEnable > 0) {
+    serialPrintCSVdata(radar);
+  }
+
+  if (radar->accessPoints.warmStart.storeInterval > 0) { // periodic snapshot, for the next boot
+    radar->accessPoints.warmStart.cyclesSinceStore++;
+    if (radar->accessPoints.warmStart.cyclesSinceStore >= radar->accessPoints.warmStart.storeInterval) {
+      radar->accessPoints.warmStart.cyclesSinceStore = 0;
+      storeSnapshot(radar);
+    }
+  }
+  RADAR_PROFILE_STAGE(radar, RADAR_STAGE_OUTPUT, stageTicks);
+  RADAR_PROFILE_SPAN(radar, RADAR_STAGE_CYCLE, cycleTicks, stageTicks);
+
+
+  //res = multistatic_interference_radar_multiprocess(); // the returned value is a cumulative measure of the signal's variance. Data relative to each transmitter is saved within the relative structures and can be accessed globally.
+
+  return res;
+
+}
+
+
+int multistatic_interference_radar(radarContext * radar) { // request the RSSI level internally, then process the signal and return the detection level in dBm
+
+  checkTransmittersPool(radar);
+
+
+
+
+  // the scan scheduler decides between a full channel scan and a targeted one (only if enabled, otherwise we always do a full channel scan)
+
+  const radarScanBackend * backend = activeScanBackend(radar);
+  if (backend == NULL) {
+    RADAR_LOG(radar, 1, RADAR_EVENT_NO_SCAN_BACKEND, 0);
+    return RADAR_UNINITIALIZED;
+  }
+
+  RADAR_TRACE_BEGIN(radar, callTicks);
+  radar->accessPoints.discoveredNetworks = runScanCycle(radar, backend); // one pass over the scan results into the snapshot, from now on nothing reads them again
+
+  int res = processScanCycle(radar);
+  RADAR_TRACE_END(radar, RADAR_TRACE_RADAR, res, callTicks);
+  return res;
+
+}
+
+
+int multistatic_interference_radar_pipelined(radarContext * radar) { // non blocking: returns RADAR_RESULTS_PENDING while the next cycle is being acquired, otherwise the detection level of the cycle just completed
+
+  checkTransmittersPool(radar);
+
+  const radarScanBackend * backend = activeScanBackend(radar);
+  if (backend == NULL) {
+    RADAR_LOG(radar, 1, RADAR_EVENT_NO_SCAN_BACKEND, 1);
+    return RADAR_UNINITIALIZED;
+  }
+
+  scanPipeline * pipe = &radar->accessPoints.pipeline;
+  unsigned long acquisitionStartMs = 0;
+
+  if ((backend->startScanAsync == NULL) || (backend->scanStatus == NULL)) { // no asynchronous scans: nothing to overlap, a plain blocking cycle
+    acquisitionStartMs = backend->millis(backend->backendData);
+    pipe->latestLevel = multistatic_interference_radar(radar);
+  } else {
+
+    if (stepAsyncScanCycle(radar, backend) == 0) {
+      return RADAR_RESULTS_PENDING;
+    }
+
+    // the acquired snapshot becomes the current one, the one just processed is free to be filled again
+    acquisitionStartMs = pipe->request.startMs;
+    radar->accessPoints.scanResults = &radar->accessPoints.scanBuffers[pipe->fillBuffer];
+    pipe->fillBuffer = 1 - pipe->fillBuffer;
+    radar->accessPoints.discoveredNetworks = radar->accessPoints.scanResults->entriesNumber;
+
+    stepAsyncScanCycle(radar, backend); // the radio starts on the next cycle right away, planned on the slots as they are now (the channels of the slots loaded below are added to it afterwards)
+
+    pipe->latestLevel = processScanCycle(radar);
+
+    if (pipe->cycleRunning == 1) { // a transmitter loaded just now on a channel the running cycle does not scan would be missed, then dropped, over and over
+      topUpScanRequest(radar, &pipe->request);
+    }
+  }
+
+  pipe->publishedCycles++;
+  pipe->latestAcquisitionStartMs = acquisitionStartMs;
+  pipe->latestPublishMs = backend->millis(backend->backendData);
+
+  return pipe->latestLevel;
+}
+
+
+
+
+
+// streaming ingest
+
+// single-producer / single-consumer rings (stream ring, threaded mode queues): head and tail only grow (wrapping at 2^32), the slot is the counter masked by the ring size.
+// the producer publishes an item with a release store of head, the consumer frees it with a release store of tail. size MUST be a power of two.
+
+template <typename T>
+int spscPush(std::atomic<uint32_t> * head, std::atomic<uint32_t> * tail, T * items, uint32_t size, const T * item) { // producer only, returns 1 if queued, 0 if the ring is full
+  uint32_t localHead = head->load(std::memory_order_relaxed);
+  uint32_t localTail = tail->load(std::memory_order_acquire);
+  if (localHead - localTail >= size) {
+    return 0;
+  }
+  items[localHead & (size - 1)] = *item;
+  head->store(localHead + 1, std::memory_order_release);
+  return 1;
+}
+
+
+template <typename T>
+int spscPop(std::atomic<uint32_t> * head, std::atomic<uint32_t> * tail, T * items, uint32_t size, T * item) { // consumer only, returns 1 if an item has been dequeued, 0 if the ring is empty
+  uint32_t localTail = tail->load(std::memory_order_relaxed);
+  uint32_t localHead = head->load(std::memory_order_acquire);
+  if (localHead == localTail) {
+    return 0;
+  }
+  *item = items[localTail & (size - 1)];
+  tail->store(localTail + 1, std::memory_order_release);
+  return 1;
+}
+
+
+int streamRingPush(radarStream * stream, const streamSample * sample) {
+  return spscPush(&stream->head, &stream->tail, stream->samples, STREAM_RING_SIZE, sample);
+}
+
+
+int streamRingPop(radarStream * stream, streamSample * sample) {
+  return spscPop(&stream->head, &stream->tail, stream->samples, STREAM_RING_SIZE, sample);
+}
+
+
+void publishTrackedKeys(radarContext * radar) { // consumer only: the valid slots BSSIDs, rewritten under the sequence lock when they differ from the published ones
+  radarStream * stream = &radar->accessPoints.stream;
+  uint64_t keys[MAX_ALLOWED_TRANSMITTERS_NUMBER];
+  int keysNumber = 0;
+  for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    if ((radar->accessPoints.APslotStatus[slotIndex] == AP_SLOT_STATUS_VALID) && (radar->accessPoints.BSSIDkeys[slotIndex] != 0)) {
+      keys[keysNumber] = radar->accessPoints.BSSIDkeys[slotIndex];
+      keysNumber++;
+    }
+  }
+
+  int changed = (keysNumber != stream->trackedKeysNumber.load(std::memory_order_relaxed)) ? 1 : 0; // the consumer is the only writer, it can read its own keys without the lock
+  for (int keyIndex = 0; (keyIndex < keysNumber) && (changed == 0); keyIndex++) {
+    uint64_t published = ((uint64_t) stream->trackedKeysHigh[keyIndex].load(std::memory_order_relaxed) << 32) | stream->trackedKeysLow[keyIndex].load(std::memory_order_relaxed);
+    changed = (published != keys[keyIndex]) ? 1 : 0;
+  }
+  if (changed == 0) {
+    return;
+  }
+
+  uint32_t sequence = stream->trackedKeysSequence.load(std::memory_order_relaxed);
+  stream->trackedKeysSequence.store(sequence + 1, std::memory_order_relaxed); // odd: rewrite in progress
+  std::atomic_thread_fence(std::memory_order_release); // the odd sequence is visible before any of the keys below
+  for (int keyIndex = 0; keyIndex < keysNumber; keyIndex++) {
+    stream->trackedKeysHigh[keyIndex].store((uint32_t) (keys[keyIndex] >> 32), std::memory_order_relaxed);
+    stream->trackedKeysLow[keyIndex].store((uint32_t) keys[keyIndex], std::memory_order_relaxed);
+  }
+  stream->trackedKeysNumber.store(keysNumber, std::memory_order_relaxed);
+  stream->trackedKeysSequence.store(sequence + 2, std::memory_order_release); // even again: published
+}
+
+
+int streamKeyTracked(radarStream * stream, uint64_t key) { // producer only: 1 when key is published, reads under the sequence lock
+  uint32_t keyHigh = (uint32_t) (key >> 32);
+  uint32_t keyLow = (uint32_t) key;
+  for (int attempt = 0; attempt < STREAM_TRACKED_KEYS_READ_RETRIES; attempt++) {
+    uint32_t sequence = stream->trackedKeysSequence.load(std::memory_order_acquire);
+    if ((sequence & 1) != 0) { // a rewrite is in progress
+      continue;
+    }
+    int tracked = 0;
+    int keysNumber = stream->trackedKeysNumber.load(std::memory_order_relaxed);
+    for (int keyIndex = 0; keyIndex < keysNumber; keyIndex++) { // a handful of keys, a linear pass is the cheapest here
+      if ((stream->trackedKeysLow[keyIndex].load(std::memory_order_relaxed) == keyLow) && (stream->trackedKeysHigh[keyIndex].load(std::memory_order_relaxed) == keyHigh)) {
+        tracked = 1;
+        break;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire); // the keys above are read before the sequence is checked again
+    if (stream->trackedKeysSequence.load(std::memory_order_relaxed) == sequence) {
+      return tracked;
+    }
+  }
+  return 1; // never got a consistent read: let the frame through, stream_process() discards it if the transmitter is not tracked
+}
+
+
+int multistatic_interference_radar_stream_ingest_frame(radarContext * radar, const uint8_t * frame, int frameLength, int rssi, uint32_t timestampMs) { // producer side, touches nothing but the ring, the tracked keys and the producer statistics
+  radarStream * stream = &radar->accessPoints.stream;
+
+  if ((stream->enabled == 0) || (frame == NULL) || (frameLength < 24)) { // 24 bytes: management frame header
+    return 0;
+  }
+  stream->framesSeen.fetch_add(1, std::memory_order_relaxed);
+
+  // frame control: type 0 (management), subtype 8 (beacon) or 5 (probe response, same transmitter, same information)
+  int frameType = (frame[0] >> 2) & 0x03;
+  int frameSubtype = (frame[0] >> 4) & 0x0F;
+  if ((frameType != 0) || ((frameSubtype != 8) && (frameSubtype != 5))) {
+    return 0;
+  }
+
+  uint64_t key = packBSSID(&frame[16]); // address 3 is the BSSID
+  if (streamKeyTracked(stream, key) == 0) {
+    return 0;
+  }
+
+  streamSample sample;
+  sample.BSSIDkey = key;
+  sample.RSSI = (int8_t) rssi;
+  sample.timestampMs = timestampMs;
+  if (streamRingPush(stream, &sample) == 0) {
+    stream->ringOverflows.fetch_add(1, std::memory_order_relaxed);
+    return -1;
+  }
+  stream->framesAccepted.fetch_add(1, std::memory_order_relaxed);
+  return 1;
+}
+
+
+int multistatic_interference_radar_stream_process(radarContext * radar) { // consumer side, returns the number of processed samples
+
+  checkTransmittersPool(radar);
+
+  radarStream * stream = &radar->accessPoints.stream;
+  streamSample sample;
+  int processed = 0;
+  int discarded = 0;
+
+  if (radar->accessPoints.slotsIndexDirty == 1) {
+    rebuildSlotsIndex(radar);
+  }
+
+  while (streamRingPop(stream, &sample) == 1) {
+    stream->latestTimestampMs = sample.timestampMs;
+    int slotIndex = bssidIndexFind(&radar->accessPoints.slotsIndex, sample.BSSIDkey);
+    if ((slotIndex < 0) || (radar->accessPoints.APslotStatus[slotIndex] != AP_SLOT_STATUS_VALID) || (radar->accessPoints.batchProcessing >= 1)) { // the slot has changed since the record was queued
+      discarded++;
+      continue;
+    }
+    radar->accessPoints.latestVariances[slotIndex] = multistatic_interference_radar_process(radar, sample.RSSI, & radar->accessPoints.transmittersData[slotIndex]);
+    updateSlotAlarm(radar, slotIndex);
+    if (radar->telemetry.enabled > 0) {
+      telemetrySample(radar, slotIndex, sample.timestampMs);
+    }
+    processed++;
+  }
+
+  stream->samplesProcessed = stream->samplesProcessed + processed;
+  stream->samplesDiscarded = stream->samplesDiscarded + discarded;
+
+  publishTrackedKeys(radar); // rewrites the producer filter only if the valid slots have changed
+
+  RADAR_LOG(radar, 4, RADAR_EVENT_STREAM_PROCESSED, processed, discarded, stream->ringOverflows.load(std::memory_order_relaxed));
+
+  return processed;
+}
+
+
+#if defined(ARDUINO)
+
+radarContext * promiscuousRadar = NULL; // there is one radio: the radar fed by the promiscuous callback, set by multistatic_interference_radar_enable_stream()
+
+void radarPromiscuousCallback(void * buffer, wifi_promiscuous_pkt_type_t packetType) { // runs in the WiFi task: the streaming ingest producer
+  radarContext * radar = promiscuousRadar;
+  if ((packetType != WIFI_PKT_MGMT) || (radar == NULL)) {
+    return;
+  }
+  const wifi_promiscuous_pkt_t * packet = (const wifi_promiscuous_pkt_t *) buffer;
+  multistatic_interference_radar_stream_ingest_frame(radar, packet->payload, packet->rx_ctrl.sig_len, packet->rx_ctrl.rssi, (uint32_t) millis());
+}
+
+#endif
+
+
+
+
+
+// threaded mode
+
+int indexQueuePush(radarIndexQueue * queue, int item) {
+  return spscPush(&queue->head, &queue->tail, queue->items, RADAR_TASK_QUEUE_SIZE, &item);
+}
+
+
+int indexQueuePop(radarIndexQueue * queue, int * item) {
+  return spscPop(&queue->head, &queue->tail, queue->items, RADAR_TASK_QUEUE_SIZE, item);
+}
+
+
+void radarTaskSleep(int sleepMs) { // lets the other tasks run
+#if defined(ARDUINO)
+  vTaskDelay((pdMS_TO_TICKS(sleepMs) > 0) ? pdMS_TO_TICKS(sleepMs) : 1);
+#else
+  std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+#endif
+}
+
+
+void radarTaskIdle() { // nothing to do: the shortest wait the platform offers without spinning (one tick on the ESP32)
+#if defined(ARDUINO)
+  vTaskDelay(1);
+#else
+  std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+}
+
+
+void acquisitionTaskLoop(radarContext * radar) { // owns the scan backend and the buffer it is filling, nothing else
+  radarTasks * tasks = &radar->accessPoints.tasks;
+  const radarScanBackend * backend = activeScanBackend(radar);
+  int buffer = 0;
+
+  while (tasks->stopRequest.load(std::memory_order_acquire) == 0) {
+    if (indexQueuePop(&tasks->freeBuffers, &buffer) == 0) {
+      radarTaskIdle(); // processing is behind, both buffers are in its hands
+      continue;
+    }
+    tasks->scanStartUs[buffer] = micros();
+    runScanRequest(radar, backend, &tasks->requests[buffer], &radar->accessPoints.scanBuffers[buffer]);
+    tasks->acquiredUs[buffer] = micros();
+    indexQueuePush(&tasks->filledBuffers, buffer); // never full: there are fewer buffers than queue entries
+    tasks->acquiredCycles.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+
+void dspTaskLoop(radarContext * radar) { // owns the slots, the filters, the scheduler and the stream consumer
+  radarTasks * tasks = &radar->accessPoints.tasks;
+  int buffer = 0;
+
+  while (tasks->stopRequest.load(std::memory_order_acquire) == 0) {
+
+    int worked = 0;
+    if (radar->accessPoints.stream.enabled == 1) {
+      worked = multistatic_interference_radar_stream_process(radar);
+    }
+
+    if (indexQueuePop(&tasks->filledBuffers, &buffer) == 1) {
+      radarResult result;
+
+      radar->accessPoints.scanResults = &radar->accessPoints.scanBuffers[buffer];
+      accountScanRequest(radar, &tasks->requests[buffer], radar->accessPoints.scanResults);
+      radar->accessPoints.discoveredNetworks = radar->accessPoints.scanResults->entriesNumber;
+      result.level = processScanCycle(radar);
+
+      result.cycle = tasks->processedCycles.fetch_add(1, std::memory_order_relaxed);
+      result.discoveredNetworks = radar->accessPoints.discoveredNetworks;
+      result.scanStartUs = tasks->scanStartUs[buffer];
+      result.acquiredUs = tasks->acquiredUs[buffer];
+      result.publishedUs = micros();
+      if (spscPush(&tasks->resultsHead, &tasks->resultsTail, tasks->results, RADAR_RESULTS_QUEUE_SIZE, &result) == 0) {
+        tasks->resultsDropped.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      // the buffer goes back with the plan for its next cycle, made on the slots as they are now
+      buildScanRequest(radar, &tasks->requests[buffer]);
+      indexQueuePush(&tasks->freeBuffers, buffer);
+      worked = 1;
+    }
+
+    if (worked == 0) {
+      radarTaskIdle();
+    }
+  }
+}
+
+
+#if defined(ARDUINO)
+
+void acquisitionTask(void * parameters) { // the parameter is the radar context
+  radarContext * radar = (radarContext *) parameters;
+  acquisitionTaskLoop(radar);
+  radar->accessPoints.tasks.tasksAlive.fetch_sub(1, std::memory_order_release);
+  vTaskDelete(NULL);
+}
+
+void dspTask(void * parameters) {
+  radarContext * radar = (radarContext *) parameters;
+  dspTaskLoop(radar);
+  radar->accessPoints.tasks.tasksAlive.fetch_sub(1, std::memory_order_release);
+  vTaskDelete(NULL);
+}
+
+#endif
+
+
+int multistatic_interference_radar_start_tasks(radarContext * radar) {
+
+  radarTasks * tasks = &radar->accessPoints.tasks;
+
+  if (tasks->running.load() == 1) {
+    return 0;
+  }
+
+  checkTransmittersPool(radar);
+  if (activeScanBackend(radar) == NULL) {
+    if (RADAR_LOG_ENABLED(radar, 1)) {
+      Serial.println("multistatic_interference_radar_start_tasks(): no scan backend available: set one via multistatic_interference_radar_set_scan_backend()");
+    }
+    return RADAR_UNINITIALIZED;
+  }
+
+  // both buffers start in the acquisition hands, the second one with the same plan as the first one
+  tasks->freeBuffers.head.store(0);
+  tasks->freeBuffers.tail.store(0);
+  tasks->filledBuffers.head.store(0);
+  tasks->filledBuffers.tail.store(0);
+  for (int buffer = 0; buffer < 2; buffer++) {
+    buildScanRequest(radar, &tasks->requests[buffer]);
+    indexQueuePush(&tasks->freeBuffers, buffer);
+  }
+  radar->accessPoints.pipeline.cycleRunning = 0; // the pipelined mode is superseded
+  radar->accessPoints.pipeline.scanInFlight = 0;
+  tasks->stopRequest.store(0);
+  tasks->tasksAlive.store(0); // counts the tasks actually created, each one decrements it when it exits
+  tasks->running.store(1);
+
+#if defined(ARDUINO)
+  if (xTaskCreatePinnedToCore(acquisitionTask, "radarAcquisition", RADAR_TASK_STACK_SIZE, radar, RADAR_TASK_PRIORITY, NULL, RADAR_ACQUISITION_CORE) != pdPASS) {
+    tasks->running.store(0);
+    return -1;
+  }
+  tasks->tasksAlive.fetch_add(1, std::memory_order_release);
+  if (xTaskCreatePinnedToCore(dspTask, "radarDSP", RADAR_TASK_STACK_SIZE, radar, RADAR_TASK_PRIORITY, NULL, RADAR_DSP_CORE) != pdPASS) {
+    multistatic_interference_radar_stop_tasks(radar); // waits for the acquisition task only, the one counted in tasksAlive
+    return -1;
+  }
+  tasks->tasksAlive.fetch_add(1, std::memory_order_release);
+#else
+  radar->acquisitionThread = std::thread(acquisitionTaskLoop, radar);
+  tasks->tasksAlive.fetch_add(1, std::memory_order_release);
+  radar->dspThread = std::thread(dspTaskLoop, radar);
+  tasks->tasksAlive.fetch_add(1, std::memory_order_release);
+#endif
+
+  if (RADAR_LOG_ENABLED(radar, 3)) {
+    Serial.println("multistatic_interference_radar_start_tasks(): acquisition and signal processing tasks started");
+  }
+  return 1;
+}
+
+
+int multistatic_interference_radar_stop_tasks(radarContext * radar) {
+
+  radarTasks * tasks = &radar->accessPoints.tasks;
+
+  if (tasks->running.load() == 0) {
+    return 0;
+  }
+
+  tasks->stopRequest.store(1, std::memory_order_release);
+#if defined(ARDUINO)
+  while (tasks->tasksAlive.load(std::memory_order_acquire) > 0) { // each task finishes its current cycle first
+    radarTaskSleep(10);
+  }
+#else
+  if (radar->acquisitionThread.joinable()) {
+    radar->acquisitionThread.join();
+  }
+  if (radar->dspThread.joinable()) {
+    radar->dspThread.join();
+  }
+  tasks->tasksAlive.store(0);
+#endif
+  tasks->running.store(0);
+
+  if (RADAR_LOG_ENABLED(radar, 3)) {
+    Serial.print("multistatic_interference_radar_stop_tasks(): tasks stopped, processed cycles: ");
+    Serial.println(tasks->processedCycles.load());
+  }
+  return (int) tasks->processedCycles.load();
+}
+
+
+int multistatic_interference_radar_poll_result(radarContext * radar, radarResult * result) {
+  radarTasks * tasks = &radar->accessPoints.tasks;
+  return spscPop(&tasks->resultsHead, &tasks->resultsTail, tasks->results, RADAR_RESULTS_QUEUE_SIZE, result);
+}
+
+
+
+int multistatic_interference_radar_set_log_mode(radarContext * radar, int logMode) {
+  if ((logMode < RADAR_LOG_MODE_SERIAL) || (logMode > RADAR_LOG_MODE_RING_BINARY)) {
+    logMode = RADAR_LOG_MODE_SERIAL;
+  }
+  radar->debugLog.mode = logMode; // switching back to the serial mode leaves the queued events in the ring, drain it first if they matter
+  return radar->debugLog.mode;
+}
+
+
+int multistatic_interference_radar_log_read(radarContext * radar, radarLogRecord * records, int maxRecords) {
+  int recordsNumber = 0;
+  while ((recordsNumber < maxRecords) && (logPop(&radar->debugLog, &records[recordsNumber]) == 1)) {
+    recordsNumber++;
+  }
+  return recordsNumber;
+}
+
+
+int multistatic_interference_radar_log_drain(radarContext * radar) {
+  radarLog * debugLog = &radar->debugLog;
+  radarLogRecord record;
+  int drained = 0;
+
+  uint32_t dropped = debugLog->dropped.load(std::memory_order_relaxed);
+  if (dropped != debugLog->droppedReported) { // the gap goes into the output where it happened, more or less
+    record.timestampUs = (uint32_t) micros();
+    record.eventId = RADAR_EVENT_LOG_DROPPED;
+    record.argsNumber = 1;
+    record.args[0] = (int32_t) (dropped - debugLog->droppedReported);
+    debugLog->droppedReported = dropped;
+    printLogRecord(radar, &record, 1);
+    drained++;
+  }
+  while (logPop(debugLog, &record) == 1) {
+    printLogRecord(radar, &record, 1);
+    drained++;
+  }
+  return drained;
+}
+
+
+void logDrainTaskLoop(radarContext * radar) {
+  radarLog * debugLog = &radar->debugLog;
+  while (debugLog->taskStopRequest.load(std::memory_order_acquire) == 0) {
+    multistatic_interference_radar_log_drain(radar);
+    radarTaskSleep(debugLog->taskPeriodMs);
+  }
+  multistatic_interference_radar_log_drain(radar); // what was logged while stopping
+}
+
+
+#if defined(ARDUINO)
+
+void logDrainTask(void * parameters) { // the parameter is the radar context
+  radarContext * radar = (radarContext *) parameters;
+  logDrainTaskLoop(radar);
+  radar->debugLog.taskRunning.store(0, std::memory_order_release);
+  vTaskDelete(NULL);
+}
+
+#endif
+
+
+int multistatic_interference_radar_start_log_task(radarContext * radar, int periodMs) {
+  radarLog * debugLog = &radar->debugLog;
+  if (debugLog->taskRunning.load() == 1) {
+    return 0;
+  }
+  debugLog->taskPeriodMs = (periodMs > 0) ? periodMs : RADAR_LOG_DRAIN_PERIOD_MS;
+  debugLog->taskStopRequest.store(0);
+  debugLog->taskRunning.store(1);
+#if defined(ARDUINO)
+  if (xTaskCreatePinnedToCore(logDrainTask, "radarLogDrain", RADAR_TASK_STACK_SIZE, radar, RADAR_LOG_TASK_PRIORITY, NULL, RADAR_LOG_TASK_CORE) != pdPASS) {
+    debugLog->taskRunning.store(0);
+    return -1;
+  }
+#else
+  radar->logDrainThread = std::thread(logDrainTaskLoop, radar);
+#endif
+  return 1;
+}
+
+
+int multistatic_interference_radar_stop_log_task(radarContext * radar) {
+  radarLog * debugLog = &radar->debugLog;
+  if (debugLog->taskRunning.load() == 0) {
+    return 0;
+  }
+  debugLog->taskStopRequest.store(1, std::memory_order_release);
+#if defined(ARDUINO)
+  while (debugLog->taskRunning.load(std::memory_order_acquire) == 1) { // the task drains what is left first
+    radarTaskSleep(10);
+  }
+#else
+  if (radar->logDrainThread.joinable()) {
+    radar->logDrainThread.join();
+  }
+  debugLog->taskRunning.store(0);
+#endif
+  return 1;
+}
+
+
+
+
+
+int multistatic_interference_radar_enable_telemetry(radarContext * radar, int telemetryEnable) {
+  if ((telemetryEnable <= 0) && (radar->telemetry.enabled > 0)) {
+    telemetryFlush(radar); // the records still in the chunk
+  }
+  radar->telemetry.enabled = (telemetryEnable > 0) ? 1 : 0;
+  return radar->telemetry.enabled;
+}
+
+
+int multistatic_interference_radar_set_telemetry_sink(radarContext * radar, radarTelemetrySink sink, void * sinkData) {
+  telemetryFlush(radar);
+  radar->telemetry.sink = sink;
+  radar->telemetry.sinkData = sinkData;
+  return 1;
+}
+
+
+int multistatic_interference_radar_telemetry_flush(radarContext * radar) {
+  return telemetryFlush(radar);
+}
+
+const char * multistatic_interference_radar_stage_name(int stage) {
+  static const char * const stageNames[RADAR_TRACE_IDS_NUMBER] = { "scan", "check_invalid_tx", "check_dead_tx", "check_invalid_rssi", "sort", "load", "multiprocess", "output", "cycle",
+                                                                    "process", "process_batch", "radar" };
+  return ((stage >= 0) && (stage < RADAR_TRACE_IDS_NUMBER)) ? stageNames[stage] : "unknown";
+}
 
-    // assign new slots if possible
 
-    res = loadScanResults();
-    if (debugRadarMsg >= 3) {
-      Serial.print("multistatic_interference_radar(): loadScanResults() response: ");
-      Serial.println(res);
+float profilePercentileUs(const radarStageStats * stats, float fraction, float ticksPerUs) { // upper bound of the bucket holding the percentile, clamped to the maximum
+  uint32_t rank = (uint32_t) (fraction * stats->count + 0.999f);
+  uint32_t seen = 0;
+  for (int bucket = 0; bucket < RADAR_PROFILE_BUCKETS; bucket++) {
+    seen = seen + stats->histogram[bucket];
+    if ((seen >= rank) && (seen > 0)) {
+      uint64_t upperTicks = (bucket < RADAR_PROFILE_BUCKETS - 1) ? (((uint64_t) 2 << bucket) - 1) : (uint64_t) stats->maxTicks;
+      return ((upperTicks < (uint64_t) stats->maxTicks) ? upperTicks : (uint64_t) stats->maxTicks) / ticksPerUs;
     }
-    
-    
+  }
+  return 0;
+}
 
-    // finalizing
-    accessPoints.initComplete = 1;
-  } // end filling empty slots
 
-  
+float profileTicksPerUs() { // the rate of radarTicks()
+#if defined(ARDUINO)
+  return (float) ESP.getCpuFreqMHz();
+#else
+  return radarHostTicksPerUs();
+#endif
+}
 
-  
-  if ((debugRadarMsg >= 3) && (res > 0)) {
-    Serial.print("multistatic_interference_radar(): transmitters gone out of range or dead: ");
-    Serial.println(res);
+
+radarProfileReport multistatic_interference_radar_get_profile(radarContext * radar) {
+  radarProfileReport report;
+#if RADAR_PROFILING
+  const radarProfile * profile = &radar->profile;
+  report.ticksPerUs = profileTicksPerUs();
+  for (int stage = 0; stage < RADAR_STAGES_NUMBER; stage++) {
+    const radarStageStats * stats = &profile->stages[stage];
+    radarStageReport * stageReport = &report.stages[stage];
+    stageReport->count = stats->count;
+    memcpy(stageReport->histogram, stats->histogram, sizeof(stageReport->histogram));
+    if (stats->count == 0) {
+      continue;
+    }
+    stageReport->meanUs = (float) ((double) stats->totalTicks / stats->count / report.ticksPerUs);
+    stageReport->minUs = stats->minTicks / report.ticksPerUs;
+    stageReport->maxUs = stats->maxTicks / report.ticksPerUs;
+    stageReport->p50Us = profilePercentileUs(stats, 0.50f, report.ticksPerUs);
+    stageReport->p90Us = profilePercentileUs(stats, 0.90f, report.ticksPerUs);
+    stageReport->p99Us = profilePercentileUs(stats, 0.99f, report.ticksPerUs);
   }
+  report.cycles = profile->cycles;
+  report.inoperableCycles = profile->inoperableCycles;
+  report.rankings = profile->rankings;
+  report.slotAssignments = profile->slotAssignments;
+  report.slotReleases = profile->slotReleases;
+  report.shadowPromotions = profile->shadowPromotions;
+  report.filterResets = profile->filterResets;
+#else
+  (void) radar;
+#endif
+  return report;
+}
 
-  if (accessPoints.initComplete >= 1) { // process the data
-    
-    res = multistatic_interference_radar_multiprocess(); // the returned value is a cumulative measure of the signal's variance. Data relative to each transmitter is saved within the relative structures and can be accessed globally.
 
-  }
+int multistatic_interference_radar_reset_profile(radarContext * radar) {
+  radar->profile = radarProfile();
+  return 1;
+}
+
 
-  if (accessPoints.serialCSVdataEnable > 0) {
-    serialPrintCSVdata();
+int multistatic_interference_radar_enable_tracing(radarContext * radar, int enable) {
+#if RADAR_TRACING
+  if ((enable >= 1) && (radar->trace.events == NULL)) { // first enable: the ring, for the lifetime of the context
+    radar->trace.events = (radarTraceEvent *) malloc(RADAR_TRACE_EVENTS * sizeof(radarTraceEvent));
+    if (radar->trace.events == NULL) {
+      if (RADAR_LOG_ENABLED(radar, 1)) {
+        Serial.println("multistatic_interference_radar_enable_tracing(): cannot allocate the trace ring, tracing stays disabled");
+      }
+      radar->trace.enabled = 0;
+      return 0;
+    }
+    radar->trace.capacity = RADAR_TRACE_EVENTS;
+    radar->trace.head.store(0);
   }
+  radar->trace.enabled = (enable >= 1) ? 1 : 0;
+#else
+  (void) enable;
+  radar->trace.enabled = 0; // no probes to record anything
+#endif
+  return radar->trace.enabled;
+}
 
 
-  //res = multistatic_interference_radar_multiprocess(); // the returned value is a cumulative measure of the signal's variance. Data relative to each transmitter is saved within the relative structures and can be accessed globally.
+radarTraceStruct::~radarTraceStruct() {
+  free(events);
+}
 
-  return res;
 
+int multistatic_interference_radar_reset_trace(radarContext * radar) {
+  radar->trace.head.store(0);
+  return 1;
 }
 
 
+void putLittleEndian32(uint8_t * bytes, uint32_t value) {
+  for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+    bytes[byteIndex] = (uint8_t) (value >> (8 * byteIndex));
+  }
+}
 
 
+int multistatic_interference_radar_trace_dump(radarContext * radar) {
+  uint32_t head = radar->trace.head.load(std::memory_order_acquire);
+  uint32_t eventsNumber = (head < radar->trace.capacity) ? head : radar->trace.capacity;
+  uint8_t block[RADAR_TRACE_HEADER_LEN + 16 * RADAR_TRACE_EVENT_LEN]; // written 16 events at a time: small enough for a task stack
+  block[0] = RADAR_TRACE_SYNC0;
+  block[1] = RADAR_TRACE_SYNC1;
+  block[2] = RADAR_TRACE_VERSION;
+  block[3] = 0;
+  putLittleEndian32(&block[4], (uint32_t) (profileTicksPerUs() * 1000.0f + 0.5f));
+  putLittleEndian32(&block[8], eventsNumber);
+  putLittleEndian32(&block[12], head - eventsNumber);
+  uint32_t crc = radarCRC32(&block[2], RADAR_TRACE_HEADER_LEN - 2);
+  int blockLength = RADAR_TRACE_HEADER_LEN;
+  int length = 0;
+  for (uint32_t position = head - eventsNumber; position != head; position++) {
+    const radarTraceEvent * event = &radar->trace.events[position & (radar->trace.capacity - 1)];
+    uint8_t * bytes = &block[blockLength];
+    putLittleEndian32(&bytes[0], (uint32_t) event->startTicks);
+    putLittleEndian32(&bytes[4], event->durationTicks);
+    bytes[8] = (uint8_t) event->arg;
+    bytes[9] = (uint8_t) ((uint16_t) event->arg >> 8);
+    bytes[10] = event->id;
+    bytes[11] = 0;
+    crc = radarCRC32(bytes, RADAR_TRACE_EVENT_LEN, crc);
+    blockLength = blockLength + RADAR_TRACE_EVENT_LEN;
+    if (blockLength + RADAR_TRACE_EVENT_LEN > (int) sizeof(block)) {
+      Serial.write(block, blockLength);
+      length = length + blockLength;
+      blockLength = 0;
+    }
+  }
+  putLittleEndian32(&block[blockLength], crc);
+  blockLength = blockLength + 4;
+  Serial.write(block, blockLength);
+  return length + blockLength;
+}
 
-int multistatic_interference_radar_debug_via_serial(int debugLevel) {
 
- int debugSave = debugRadarMsg;
- debugRadarMsg = debugLevel;
- if (debugRadarMsg >= 1) {
+#if !defined(ARDUINO)
+int multistatic_interference_radar_trace_write_json(radarContext * radar, const char * fileName) {
+  FILE * jsonFile = fopen(fileName, "w");
+  if (jsonFile == NULL) {
+    return -1;
+  }
+  int written = 0;
+  uint32_t head = radar->trace.head.load(std::memory_order_acquire);
+  uint32_t eventsNumber = (head < radar->trace.capacity) ? head : radar->trace.capacity;
+  double ticksPerUs = profileTicksPerUs();
+  // the scans on their own track: in the threaded mode they overlap the processing of the previous cycle
+  fprintf(jsonFile, "{\"traceEvents\":[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"acquisition\"}},\n"
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"processing\"}}");
+  radarProfileTicks originTicks = 0;
+  for (uint32_t position = head - eventsNumber; position != head; position++) { // the earliest start is the time origin
+    const radarTraceEvent * event = &radar->trace.events[position & (radar->trace.capacity - 1)];
+    originTicks = ((position == head - eventsNumber) || (event->startTicks < originTicks)) ? event->startTicks : originTicks;
+  }
+  for (uint32_t position = head - eventsNumber; position != head; position++) {
+    const radarTraceEvent * event = &radar->trace.events[position & (radar->trace.capacity - 1)];
+    fprintf(jsonFile, ",\n{\"name\":\"%s\",\"cat\":\"radar\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"arg\":%d}}",
+            multistatic_interference_radar_stage_name(event->id), (event->id == RADAR_STAGE_SCAN) ? 1 : 2, (double) (event->startTicks - originTicks) / ticksPerUs,
+            event->durationTicks / ticksPerUs, event->arg);
+    written++;
+  }
+  fprintf(jsonFile, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"ticks_per_us\":%.3f,\"overwritten_spans\":%u}}\n", ticksPerUs, head - eventsNumber);
+  if (fclose(jsonFile) != 0) {
+    return -1;
+  }
+  return written;
+}
+#endif
+
+int multistatic_interference_radar_debug_via_serial(radarContext * radar, int debugLevel) {
+
+ int debugSave = radar->debugRadarMsg;
+ radar->debugRadarMsg = debugLevel;
+ if (RADAR_LOG_ENABLED(radar, 1)) {
   Serial.print("multistatic_interference_radar_debug_via_serial(): debugging functions (if the current wifi mode allows it):");
-  Serial.println(multistatic_interference_radar());
+  Serial.println(multistatic_interference_radar(radar));
   
   /*
   int modeRes = (int) WiFi.getMode();
@@ -1131,13 +3749,15 @@ int multistatic_interference_radar_debug_via_serial(int debugLevel) {
   
  }
 
- debugRadarMsg = debugSave; // restore the normal debug level
+ radar->debugRadarMsg = debugSave; // restore the normal debug level
+ return debugLevel;
   
 }
 
 
-int multistatic_interference_radar_set_debug_level(int debugLevel) {
-  debugRadarMsg = debugLevel;
+int multistatic_interference_radar_set_debug_level(radarContext * radar, int debugLevel) {
+  radar->debugRadarMsg = debugLevel;
+  return radar->debugRadarMsg;
 }
 
 
@@ -1145,58 +3765,188 @@ int multistatic_interference_radar_set_debug_level(int debugLevel) {
 
 
 
-int multistatic_interference_radar_set_txN_limit(int txNlimit) { // forcefully reduces the number of processed transmitters; CAVEAT: do not exceed MAX_ALLOWED_TRANSMITTERS_NUMBER
+int multistatic_interference_radar_set_txN_limit(radarContext * radar, int txNlimit) { // grows or shrinks the number of processed transmitters within the pool, no reflash needed
   
-  if (debugRadarMsg >= 1) {
+  checkTransmittersPool(radar);
+
+  if (RADAR_LOG_ENABLED(radar, 1)) {
     Serial.print("multistatic_interference_radar_set_txN_limit(): requesto set accessPoints.transmittersListLen to: ");
     Serial.println(txNlimit);
   }
   
-  if (txNlimit > MAX_ALLOWED_TRANSMITTERS_NUMBER) { // safety check, otherwise the array amd struct boundaries may be exceed. 
-    txNlimit = MAX_ALLOWED_TRANSMITTERS_NUMBER;
+  if (txNlimit > radar->accessPoints.transmittersPoolSize) { // safety check, otherwise the pool boundaries may be exceed. 
+    txNlimit = radar->accessPoints.transmittersPoolSize;
+  }
+  if (txNlimit < 1) {
+    txNlimit = 1;
+  }
+
+  // shrinking: the slots leaving the active set are emptied, so that a later growth restarts them clean
+  for (int slotIndex = txNlimit; slotIndex < radar->accessPoints.transmittersListLen; slotIndex++) {
+    freeTransmitterSlot(radar, slotIndex);
+  }
+  // growing: the new slots are free, the next cycle will fill them from the scan results
+  if (txNlimit > radar->accessPoints.transmittersListLen) {
+    radar->accessPoints.initComplete = 0;
+    radar->accessPoints.scanPlan.fullSweepRequested = 1;
   }
-  accessPoints.transmittersListLen = txNlimit;
-  if (debugRadarMsg >= 1) {
+
+  radar->accessPoints.transmittersListLen = txNlimit;
+  radar->accessPoints.slotsIndexDirty = 1; // the slots index only covers the active transmitters
+  if (RADAR_LOG_ENABLED(radar, 1)) {
     Serial.print("multistatic_interference_radar_set_txN_limit(): set accessPoints.transmittersListLen to: ");
-    Serial.println(accessPoints.transmittersListLen);
+    Serial.println(radar->accessPoints.transmittersListLen);
   }
   return txNlimit;
 
 }
 
 
-int multistatic_interference_radar_enable_second_order_variance_filtering(int FIRfilter) { // [ 0 = disabled, >=1 = enabled (1 recommended) ] enhances the second order derivative for very slow drifting variances, nullifies long-term variance offsets in crowded environments. As a wanted side-effect, when a transmitter accidentally becomes to weak to measure reliably and data stops being gathered, the terminal variance offset is gracefully compensated by the finite impulse response filter. 
+int multistatic_interference_radar_enable_second_order_variance_filtering(radarContext * radar, int FIRfilter) { // [ 0 = disabled, >=1 = enabled (1 recommended) ] enhances the second order derivative for very slow drifting variances, nullifies long-term variance offsets in crowded environments. As a wanted side-effect, when a transmitter accidentally becomes to weak to measure reliably and data stops being gathered, the terminal variance offset is gracefully compensated by the finite impulse response filter. 
   if (FIRfilter <0) {
     FIRfilter = 0;
   }
-  accessPoints.secondOrderFilter = FIRfilter;
+  radar->accessPoints.secondOrderFilter = FIRfilter;
   return FIRfilter;
 }
 
 
-int multistatic_interference_radar_enable_aggressive_cleaning_low_RSSI(int cleanerEnable) {
-  accessPoints.RSSIcleanerEnable = cleanerEnable;
-  return accessPoints.RSSIcleanerEnable;
+int multistatic_interference_radar_enable_aggressive_cleaning_low_RSSI(radarContext * radar, int cleanerEnable) {
+  radar->accessPoints.RSSIcleanerEnable = cleanerEnable;
+  return radar->accessPoints.RSSIcleanerEnable;
 }
 
 
-int multistatic_interference_radar_enable_serial_CSV_graph_data(int serialCSVen = 0) {
+int multistatic_interference_radar_enable_serial_CSV_graph_data(radarContext * radar, int serialCSVen) {
 
-  accessPoints.serialCSVdataEnable = serialCSVen;
-  debugRadarMsg = 0;
-  return accessPoints.serialCSVdataEnable;
+  radar->accessPoints.serialCSVdataEnable = serialCSVen;
+  radar->debugRadarMsg = 0;
+  return radar->accessPoints.serialCSVdataEnable;
   
 }
 
 
 
-int multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient(int attnCoeff) {
-  accessPoints.secondOrderAttenutationCoefficient = attnCoeff;
+int multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient(radarContext * radar, int attnCoeff) {
+  if (attnCoeff < 2) { // the filter divides by it, 0 would crash and 1 would cancel the variance out
+    attnCoeff = 2;
+  }
+  radar->accessPoints.secondOrderAttenutationCoefficient = attnCoeff;
   return attnCoeff;
 }
 
 
-int multistatic_interference_radar_set_minimum_RSSI(int rssiMin) {
+int multistatic_interference_radar_set_scan_backend(radarContext * radar, const radarScanBackend * backend) {
+  radar->accessPoints.scanBackend = backend;
+  radar->accessPoints.scanPlan.fullSweepRequested = 1; // a different radio, a different world
+  radar->accessPoints.pipeline.cycleRunning = 0; // a background acquisition on the previous backend is dropped
+  radar->accessPoints.pipeline.scanInFlight = 0;
+  return (activeScanBackend(radar) != NULL) ? 1 : 0;
+}
+
+
+int multistatic_interference_radar_enable_targeted_scan(radarContext * radar, int targetedEnable) {
+  if (targetedEnable < 0) {
+    targetedEnable = 0;
+  }
+  radar->accessPoints.scanPlan.targetedScan = targetedEnable;
+  if (RADAR_LOG_ENABLED(radar, 1)) {
+    Serial.print("multistatic_interference_radar_enable_targeted_scan(): set accessPoints.scanPlan.targetedScan to: ");
+    Serial.println(radar->accessPoints.scanPlan.targetedScan);
+  }
+  return radar->accessPoints.scanPlan.targetedScan;
+}
+
+
+int multistatic_interference_radar_set_full_sweep_interval(radarContext * radar, int sweepInterval) {
+  if (sweepInterval < 1) {
+    sweepInterval = 1; // every cycle is a full sweep
+  }
+  radar->accessPoints.scanPlan.fullSweepInterval = sweepInterval;
+  return sweepInterval;
+}
+
+
+int multistatic_interference_radar_enable_batch_processing(radarContext * radar, int batchEnable) {
+  if (batchEnable < 0) {
+    batchEnable = 0;
+  }
+  checkTransmittersPool(radar);
+  if (batchEnable != radar->accessPoints.batchProcessing) { // the two engines do not share their variance data: restart the links on the engine we are switching to
+    for (int slotIndex = 0; slotIndex < radar->accessPoints.transmittersPoolSize; slotIndex++) {
+      radar->accessPoints.transmittersData[slotIndex].resetRequest = 1;
+    }
+  }
+  radar->accessPoints.batchProcessing = batchEnable;
+  if (RADAR_LOG_ENABLED(radar, 1)) {
+    Serial.print("multistatic_interference_radar_enable_batch_processing(): set accessPoints.batchProcessing to: ");
+    Serial.println(radar->accessPoints.batchProcessing);
+  }
+  return radar->accessPoints.batchProcessing;
+}
+
+
+int multistatic_interference_radar_enable_bootstrap(radarContext * radar, int bootstrapEnable) { // takes effect on the links still booting, the valid ones are not affected
+  if (bootstrapEnable < 0) {
+    bootstrapEnable = 0;
+  }
+  radar->accessPoints.bootstrapMode = bootstrapEnable;
+  if (RADAR_LOG_ENABLED(radar, 1)) {
+    Serial.print("multistatic_interference_radar_enable_bootstrap(): set accessPoints.bootstrapMode to: ");
+    Serial.println(radar->accessPoints.bootstrapMode);
+  }
+  return radar->accessPoints.bootstrapMode;
+}
+
+
+int multistatic_interference_radar_set_shadow_trackers(radarContext * radar, int shadowsNumber) { // fewer shadows: the ones leaving are dropped; more: the next cycle fills them from the ranking
+  if (shadowsNumber < 0) {
+    shadowsNumber = 0;
+  }
+  if (shadowsNumber > SHADOW_TRACKERS_MAX) {
+    shadowsNumber = SHADOW_TRACKERS_MAX;
+  }
+  for (int shadowIndex = shadowsNumber; shadowIndex < SHADOW_TRACKERS_MAX; shadowIndex++) {
+    freeShadow(radar, shadowIndex);
+  }
+  radar->accessPoints.shadows.shadowsNumber = shadowsNumber;
+  radar->accessPoints.shadows.cyclesSinceRefill = SHADOW_REFILL_INTERVAL;
+  if (RADAR_LOG_ENABLED(radar, 1)) {
+    Serial.print("multistatic_interference_radar_set_shadow_trackers(): set accessPoints.shadows.shadowsNumber to: ");
+    Serial.println(radar->accessPoints.shadows.shadowsNumber);
+  }
+  return radar->accessPoints.shadows.shadowsNumber;
+}
+
+
+int multistatic_interference_radar_enable_stream(radarContext * radar, int streamEnable) {
+  checkTransmittersPool(radar);
+  radar->accessPoints.stream.enabled = (streamEnable >= 1) ? 1 : 0;
+  publishTrackedKeys(radar);
+#if defined(ARDUINO)
+  if (radar->accessPoints.stream.enabled == 1) {
+    wifi_promiscuous_filter_t filter;
+    filter.filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT; // beacons only, the callback sees no data traffic
+    esp_wifi_set_promiscuous_filter(&filter);
+    promiscuousRadar = radar; // the latest radar enabling the stream gets the frames
+    esp_wifi_set_promiscuous_rx_cb(radarPromiscuousCallback);
+    if ((esp_wifi_set_promiscuous(true) != ESP_OK) && (RADAR_LOG_ENABLED(radar, 1))) {
+      Serial.println("multistatic_interference_radar_enable_stream(): could not enable the promiscuous mode, the transmitters will only be sampled by the scans");
+    }
+  } else if (promiscuousRadar == radar) {
+    esp_wifi_set_promiscuous(false);
+    promiscuousRadar = NULL;
+  }
+#endif
+  if (RADAR_LOG_ENABLED(radar, 3)) {
+    Serial.print("multistatic_interference_radar_enable_stream(): streaming ingest: ");
+    Serial.println(radar->accessPoints.stream.enabled);
+  }
+  return radar->accessPoints.stream.enabled;
+}
+
+
+int multistatic_interference_radar_set_minimum_RSSI(radarContext * radar, int rssiMin) {
 
   if ((rssiMin > 0) || (rssiMin < ABSOLUTE_RSSI_LIMIT)) {
     rssiMin == ABSOLUTE_RSSI_LIMIT; // which results in disabling the minimum RSSI check
@@ -1204,19 +3954,20 @@ int multistatic_interference_radar_set_minimum_RSSI(int rssiMin) {
 
   
 
-  for (int RSSIslotIndex = 0; RSSIslotIndex < accessPoints.transmittersListLen; RSSIslotIndex++) {
-    if (debugRadarMsg >= 2) {
+  checkTransmittersPool(radar); // the settings are applied to the whole pool, so that transmitters activated later inherit them
+  for (int RSSIslotIndex = 0; RSSIslotIndex < radar->accessPoints.transmittersPoolSize; RSSIslotIndex++) {
+    if ((RADAR_LOG_ENABLED(radar, 2)) && (RSSIslotIndex < radar->accessPoints.transmittersListLen)) {
       Serial.print("multistatic_interference_radar_set_minimum_RSSI(): current accessPoints.transmittersData[N].minimum_RSSI: ");
-      Serial.print(accessPoints.transmittersData[RSSIslotIndex].minimum_RSSI);
+      Serial.print(radar->accessPoints.transmittersData[RSSIslotIndex].minimum_RSSI);
       Serial.print(" for slot ");
       Serial.print(RSSIslotIndex);
       Serial.print("/");
-      Serial.println(accessPoints.transmittersListLen);
+      Serial.println(radar->accessPoints.transmittersPoolSize);
     }
-    accessPoints.transmittersData[RSSIslotIndex].minimum_RSSI = rssiMin;
-    if (debugRadarMsg >= 1) {
+    radar->accessPoints.transmittersData[RSSIslotIndex].minimum_RSSI = rssiMin;
+    if ((RADAR_LOG_ENABLED(radar, 1)) && (RSSIslotIndex < radar->accessPoints.transmittersListLen)) {
       Serial.print("multistatic_interference_radar_set_minimum_RSSI(): set accessPoints.transmittersData[N].minimum_RSSI to: ");
-      Serial.println(accessPoints.transmittersData[RSSIslotIndex].minimum_RSSI);
+      Serial.println(radar->accessPoints.transmittersData[RSSIslotIndex].minimum_RSSI);
     }
   }
   
@@ -1225,19 +3976,20 @@ int multistatic_interference_radar_set_minimum_RSSI(int rssiMin) {
 
 
 // current status: IMPLEMENTED
-int multistatic_interference_radar_enable_alarm(int enableThreshold) {
+int multistatic_interference_radar_enable_alarm(radarContext * radar, int enableThreshold) {
   if (enableThreshold < 0) {
     enableThreshold = 0; // which results in disabling the alarm
   }
 
   
 
-  for (int enableslotIndex = 0; enableslotIndex < accessPoints.transmittersListLen; enableslotIndex++) {
+  checkTransmittersPool(radar); // the settings are applied to the whole pool, so that transmitters activated later inherit them
+  for (int enableslotIndex = 0; enableslotIndex < radar->accessPoints.transmittersPoolSize; enableslotIndex++) {
     
-    accessPoints.transmittersData[enableslotIndex].enableThreshold = enableThreshold;
-    if (debugRadarMsg >= 1) {
+    radar->accessPoints.transmittersData[enableslotIndex].enableThreshold = (enableThreshold >= 1) ? 1 : 0; // a one bit flag
+    if ((RADAR_LOG_ENABLED(radar, 1)) && (enableslotIndex < radar->accessPoints.transmittersListLen)) {
       Serial.print("multistatic_interference_radar_enable_alarm(): set accessPoints.transmittersData[N].enableThreshold to: ");
-      Serial.println(accessPoints.transmittersData[enableslotIndex].enableThreshold);
+      Serial.println(radar->accessPoints.transmittersData[enableslotIndex].enableThreshold);
     }
   }
   
@@ -1247,23 +3999,337 @@ int multistatic_interference_radar_enable_alarm(int enableThreshold) {
 
 
 // current status: IMPLEMENTED
-int multistatic_interference_radar_set_alarm_threshold(int alarmThreshold) {
+int multistatic_interference_radar_set_alarm_threshold(radarContext * radar, int alarmThreshold) {
     if (alarmThreshold < 0) {
     alarmThreshold = 0; // which results in always enabling the alarm
   }
 
   
 
-  for (int alarmslotIndex = 0; alarmslotIndex < accessPoints.transmittersListLen; alarmslotIndex++) {
+  checkTransmittersPool(radar); // the settings are applied to the whole pool, so that transmitters activated later inherit them
+  for (int alarmslotIndex = 0; alarmslotIndex < radar->accessPoints.transmittersPoolSize; alarmslotIndex++) {
     
-    accessPoints.transmittersData[alarmslotIndex].varianceThreshold = alarmThreshold;
-    if (debugRadarMsg >= 1) {
+    radar->accessPoints.transmittersData[alarmslotIndex].varianceThreshold = alarmThreshold;
+    if ((RADAR_LOG_ENABLED(radar, 1)) && (alarmslotIndex < radar->accessPoints.transmittersListLen)) {
       Serial.print("multistatic_interference_radar_set_alarm_threshold(): set accessPoints.transmittersData[N].varianceThreshold to: ");
-      Serial.println(accessPoints.transmittersData[alarmslotIndex].varianceThreshold);
+      Serial.println(radar->accessPoints.transmittersData[alarmslotIndex].varianceThreshold);
     }
   }
   
   return alarmThreshold;
 }
 
+
+int multistatic_interference_radar_save_state(radarContext * radar, uint8_t * buffer, int bufferLength) {
+  if (radar->accessPoints.tasks.running.load() == 1) {
+    return RADAR_SNAPSHOT_BUSY; // the tasks own the state, they store it themselves (see multistatic_interference_radar_set_snapshot_interval())
+  }
+  return saveState(radar, buffer, bufferLength);
+}
+
+
+int multistatic_interference_radar_restore_state(radarContext * radar, const uint8_t * buffer, int bufferLength) {
+  if (radar->accessPoints.tasks.running.load() == 1) {
+    return RADAR_SNAPSHOT_BUSY;
+  }
+  return restoreState(radar, buffer, bufferLength);
+}
+
+
+int multistatic_interference_radar_store_snapshot(radarContext * radar) {
+  if (radar->accessPoints.tasks.running.load() == 1) {
+    return RADAR_SNAPSHOT_BUSY;
+  }
+  return storeSnapshot(radar);
+}
+
+
+int multistatic_interference_radar_load_snapshot(radarContext * radar) {
+
+  if (radar->accessPoints.tasks.running.load() == 1) {
+    return RADAR_SNAPSHOT_BUSY;
+  }
+
+  int length = 0;
+  uint8_t * buffer = NULL;
+
+#if defined(ARDUINO)
+
+  Preferences preferences;
+  if (preferences.begin(SNAPSHOT_NVS_NAMESPACE, true) == false) { // read only: fails when nothing has ever been stored
+    return RADAR_SNAPSHOT_NOT_FOUND;
+  }
+  length = (int) preferences.getBytesLength(radar->accessPoints.warmStart.name);
+  if ((length > 0) && (length <= RADAR_SNAPSHOT_MAX_LEN(MAX_ALLOWED_TRANSMITTERS_NUMBER))) {
+    buffer = (uint8_t *) malloc(length);
+    if ((buffer != NULL) && (preferences.getBytes(radar->accessPoints.warmStart.name, buffer, length) != (size_t) length)) {
+      free(buffer);
+      buffer = NULL;
+    }
+  }
+  preferences.end();
+
+#else
+
+  char path[SNAPSHOT_NAME_LEN + 16] = {0};
+  snprintf(path, sizeof(path), "%s.snapshot", radar->accessPoints.warmStart.name);
+  FILE * snapshotFile = fopen(path, "rb");
+  if (snapshotFile == NULL) {
+    return RADAR_SNAPSHOT_NOT_FOUND;
+  }
+  if (fseek(snapshotFile, 0, SEEK_END) == 0) {
+    length = (int) ftell(snapshotFile);
+  }
+  if ((length > 0) && (length <= RADAR_SNAPSHOT_MAX_LEN(MAX_ALLOWED_TRANSMITTERS_NUMBER)) && (fseek(snapshotFile, 0, SEEK_SET) == 0)) {
+    buffer = (uint8_t *) malloc(length);
+    if ((buffer != NULL) && ((int) fread(buffer, 1, length, snapshotFile) != length)) {
+      free(buffer);
+      buffer = NULL;
+    }
+  }
+  fclose(snapshotFile);
+
+#endif
+
+  if (length <= 0) {
+    return RADAR_SNAPSHOT_NOT_FOUND;
+  }
+  if (buffer == NULL) {
+    return RADAR_SNAPSHOT_INVALID; // too big to be one of ours, or unreadable
+  }
+  int res = restoreState(radar, buffer, length);
+  free(buffer);
+  return res;
+}
+
+
+int multistatic_interference_radar_set_snapshot_name(radarContext * radar, const char * snapshotName) {
+  if ((snapshotName == NULL) || (snapshotName[0] == 0) || (strlen(snapshotName) >= SNAPSHOT_NAME_LEN)) {
+    return 0;
+  }
+  strncpy(radar->accessPoints.warmStart.name, snapshotName, SNAPSHOT_NAME_LEN);
+  return 1;
+}
+
+
+int multistatic_interference_radar_set_snapshot_interval(radarContext * radar, int storeInterval) {
+  if (storeInterval < 0) {
+    storeInterval = 0;
+  }
+  radar->accessPoints.warmStart.storeInterval = storeInterval;
+  radar->accessPoints.warmStart.cyclesSinceStore = 0;
+  return storeInterval;
+}
+
 //
+
+
+
+
+
+// the same functions on the default radar context, for the single radar applications (every sketch written before the radar contexts existed)
+
+int multistatic_interference_radar_init(int poolSize) {
+  return multistatic_interference_radar_init(&defaultRadarContext, poolSize);
+}
+
+int multistatic_interference_radar_process(int sample, transmitterData *transmitterX) {
+  return multistatic_interference_radar_process(&defaultRadarContext, sample, transmitterX);
+}
+
+int multistatic_interference_radar_multiprocess() {
+  return multistatic_interference_radar_multiprocess(&defaultRadarContext);
+}
+
+int multistatic_interference_radar() {
+  return multistatic_interference_radar(&defaultRadarContext);
+}
+
+int multistatic_interference_radar_pipelined() {
+  return multistatic_interference_radar_pipelined(&defaultRadarContext);
+}
+
+int multistatic_interference_radar_stream_ingest_frame(const uint8_t * frame, int frameLength, int rssi, uint32_t timestampMs) {
+  return multistatic_interference_radar_stream_ingest_frame(&defaultRadarContext, frame, frameLength, rssi, timestampMs);
+}
+
+int multistatic_interference_radar_stream_process() {
+  return multistatic_interference_radar_stream_process(&defaultRadarContext);
+}
+
+int multistatic_interference_radar_start_tasks() {
+  return multistatic_interference_radar_start_tasks(&defaultRadarContext);
+}
+
+int multistatic_interference_radar_stop_tasks() {
+  return multistatic_interference_radar_stop_tasks(&defaultRadarContext);
+}
+
+int multistatic_interference_radar_poll_result(radarResult * result) {
+  return multistatic_interference_radar_poll_result(&defaultRadarContext, result);
+}
+
+
+int multistatic_interference_radar_set_log_mode(int logMode) {
+  return multistatic_interference_radar_set_log_mode(&defaultRadarContext, logMode);
+}
+
+
+int multistatic_interference_radar_log_drain() {
+  return multistatic_interference_radar_log_drain(&defaultRadarContext);
+}
+
+
+int multistatic_interference_radar_log_read(radarLogRecord * records, int maxRecords) {
+  return multistatic_interference_radar_log_read(&defaultRadarContext, records, maxRecords);
+}
+
+
+int multistatic_interference_radar_start_log_task(int periodMs) {
+  return multistatic_interference_radar_start_log_task(&defaultRadarContext, periodMs);
+}
+
+
+int multistatic_interference_radar_stop_log_task() {
+  return multistatic_interference_radar_stop_log_task(&defaultRadarContext);
+}
+
+
+int multistatic_interference_radar_enable_telemetry(int telemetryEnable = 0) {
+  return multistatic_interference_radar_enable_telemetry(&defaultRadarContext, telemetryEnable);
+}
+
+
+int multistatic_interference_radar_set_telemetry_sink(radarTelemetrySink sink, void * sinkData) {
+  return multistatic_interference_radar_set_telemetry_sink(&defaultRadarContext, sink, sinkData);
+}
+
+
+int multistatic_interference_radar_telemetry_flush() {
+  return multistatic_interference_radar_telemetry_flush(&defaultRadarContext);
+}
+
+
+radarProfileReport multistatic_interference_radar_get_profile() {
+  return multistatic_interference_radar_get_profile(&defaultRadarContext);
+}
+
+
+int multistatic_interference_radar_reset_profile() {
+  return multistatic_interference_radar_reset_profile(&defaultRadarContext);
+}
+
+
+int multistatic_interference_radar_enable_tracing(int enable) {
+  return multistatic_interference_radar_enable_tracing(&defaultRadarContext, enable);
+}
+
+
+int multistatic_interference_radar_reset_trace() {
+  return multistatic_interference_radar_reset_trace(&defaultRadarContext);
+}
+
+
+int multistatic_interference_radar_trace_dump() {
+  return multistatic_interference_radar_trace_dump(&defaultRadarContext);
+}
+
+
+#if !defined(ARDUINO)
+int multistatic_interference_radar_trace_write_json(const char * fileName) {
+  return multistatic_interference_radar_trace_write_json(&defaultRadarContext, fileName);
+}
+#endif
+
+
+int multistatic_interference_radar_debug_via_serial(int debugLevel) {
+  return multistatic_interference_radar_debug_via_serial(&defaultRadarContext, debugLevel);
+}
+
+int multistatic_interference_radar_set_debug_level(int debugLevel) {
+  return multistatic_interference_radar_set_debug_level(&defaultRadarContext, debugLevel);
+}
+
+int multistatic_interference_radar_set_txN_limit(int txNlimit) {
+  return multistatic_interference_radar_set_txN_limit(&defaultRadarContext, txNlimit);
+}
+
+int multistatic_interference_radar_enable_second_order_variance_filtering(int FIRfilter) {
+  return multistatic_interference_radar_enable_second_order_variance_filtering(&defaultRadarContext, FIRfilter);
+}
+
+int multistatic_interference_radar_enable_aggressive_cleaning_low_RSSI(int cleanerEnable) {
+  return multistatic_interference_radar_enable_aggressive_cleaning_low_RSSI(&defaultRadarContext, cleanerEnable);
+}
+
+int multistatic_interference_radar_enable_serial_CSV_graph_data(int serialCSVen = 0) {
+  return multistatic_interference_radar_enable_serial_CSV_graph_data(&defaultRadarContext, serialCSVen);
+}
+
+int multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient(int attnCoeff) {
+  return multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient(&defaultRadarContext, attnCoeff);
+}
+
+int multistatic_interference_radar_set_scan_backend(const radarScanBackend * backend) {
+  return multistatic_interference_radar_set_scan_backend(&defaultRadarContext, backend);
+}
+
+int multistatic_interference_radar_enable_targeted_scan(int targetedEnable) {
+  return multistatic_interference_radar_enable_targeted_scan(&defaultRadarContext, targetedEnable);
+}
+
+int multistatic_interference_radar_set_full_sweep_interval(int sweepInterval) {
+  return multistatic_interference_radar_set_full_sweep_interval(&defaultRadarContext, sweepInterval);
+}
+
+int multistatic_interference_radar_enable_batch_processing(int batchEnable) {
+  return multistatic_interference_radar_enable_batch_processing(&defaultRadarContext, batchEnable);
+}
+
+int multistatic_interference_radar_enable_bootstrap(int bootstrapEnable) {
+  return multistatic_interference_radar_enable_bootstrap(&defaultRadarContext, bootstrapEnable);
+}
+
+int multistatic_interference_radar_set_shadow_trackers(int shadowsNumber) {
+  return multistatic_interference_radar_set_shadow_trackers(&defaultRadarContext, shadowsNumber);
+}
+
+int multistatic_interference_radar_enable_stream(int streamEnable) {
+  return multistatic_interference_radar_enable_stream(&defaultRadarContext, streamEnable);
+}
+
+int multistatic_interference_radar_set_minimum_RSSI(int rssiMin) {
+  return multistatic_interference_radar_set_minimum_RSSI(&defaultRadarContext, rssiMin);
+}
+
+int multistatic_interference_radar_enable_alarm(int enableThreshold) {
+  return multistatic_interference_radar_enable_alarm(&defaultRadarContext, enableThreshold);
+}
+
+int multistatic_interference_radar_set_alarm_threshold(int alarmThreshold) {
+  return multistatic_interference_radar_set_alarm_threshold(&defaultRadarContext, alarmThreshold);
+}
+
+int multistatic_interference_radar_save_state(uint8_t * buffer, int bufferLength) {
+  return multistatic_interference_radar_save_state(&defaultRadarContext, buffer, bufferLength);
+}
+
+int multistatic_interference_radar_restore_state(const uint8_t * buffer, int bufferLength) {
+  return multistatic_interference_radar_restore_state(&defaultRadarContext, buffer, bufferLength);
+}
+
+int multistatic_interference_radar_store_snapshot() {
+  return multistatic_interference_radar_store_snapshot(&defaultRadarContext);
+}
+
+int multistatic_interference_radar_load_snapshot() {
+  return multistatic_interference_radar_load_snapshot(&defaultRadarContext);
+}
+
+int multistatic_interference_radar_set_snapshot_name(const char * snapshotName) {
+  return multistatic_interference_radar_set_snapshot_name(&defaultRadarContext, snapshotName);
+}
+
+int multistatic_interference_radar_set_snapshot_interval(int storeInterval) {
+  return multistatic_interference_radar_set_snapshot_interval(&defaultRadarContext, storeInterval);
+}
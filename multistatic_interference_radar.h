@@ -19,11 +19,19 @@
 
 
 
+#ifndef MULTISTATIC_INTERFERENCE_RADAR_H
+#define MULTISTATIC_INTERFERENCE_RADAR_H
+
 // standard includes
 #include <stdint.h>
+#include <stddef.h>
+#include <atomic> // lock-free ring of the streaming ingest
+#if !defined(ARDUINO)
+#include <thread> // threaded mode tasks of the host builds, owned by the radar context
+#endif
 
 
-//// there are no initialization functions, the structures and arrays are already declared, initialized and accessible 
+//// there is no mandatory initialization function, the structures and arrays are already declared, initialized and accessible (the transmitters pool is bound on first use)
 
 
 
@@ -60,6 +68,22 @@
 
 #define ENABLE_RSSI_CLEANER 0 // aggressively remove transmitters with subpar signals
 
+#define ENABLE_BOOTSTRAP 0 // [ 0 = disabled (default), >=1 = enabled ] freshly loaded transmitters produce estimates from their first BOOTSTRAP_MIN_SAMPLES samples on, instead of waiting for a full sample buffer
+
+#define BOOTSTRAP_MIN_SAMPLES 4 // bootstrap mode: samples a link needs before its first estimate (at least 2: a single sample has no variance)
+
+#define ENABLE_TARGETED_SCAN 0 // [ 0 = disabled (default), >=1 = enabled ] scan only the channels of the tracked transmitters, with short dwell times, and do a full discovery sweep only now and then (see the scan scheduler section)
+
+#define SCAN_FULL_SWEEP_INTERVAL 16 // with targeted scans enabled: cycles between two full discovery sweeps (a sweep is also done whenever a transmitter is lost)
+
+#define SCAN_FULL_DWELL_MS 300 // per channel dwell time of the full discovery sweep, in milliseconds
+
+#define SCAN_TARGETED_DWELL_MS 60 // per channel dwell time of the targeted scans, in milliseconds
+
+#define SCAN_TARGETED_MISS_LIMIT 3 // consecutive targeted scans a tracked transmitter may go unheard before its slot is freed: a short dwell easily misses a beacon (a full sweep not hearing it frees the slot right away)
+
+#define WIFI_CHANNELS_NUMBER 14 // channels 1 to 14
+
 
 
 // ERROR LEVELS 
@@ -69,6 +93,11 @@
 #define RADAR_INOPERABLE -6
 #define RADAR_UNINITIALIZED -5
 #define RADAR_BOOTING -4  // from -1 to -4 anything is RADAR_BOOTING
+#define RADAR_RESULTS_PENDING -9 // pipelined mode only: the next scan cycle is still being acquired, there are no new results yet (not an error)
+#define RADAR_SNAPSHOT_INVALID -10 // warm start: not a snapshot, unknown version, truncated or corrupted
+#define RADAR_SNAPSHOT_NOT_FOUND -11 // warm start: nothing stored under the snapshot name
+#define RADAR_SNAPSHOT_STORAGE_FAILED -12 // warm start: buffer too small, NVS or file write failure
+#define RADAR_SNAPSHOT_BUSY -13 // warm start: the threaded mode owns the radar state, stop the tasks first
 
 
 // STRUCTS
@@ -82,99 +111,185 @@
 
 
 
+// compact layout: the samples are clamped to [ABSOLUTE_RSSI_LIMIT, 0] when they enter the filter, every field is then sized to the range it can actually reach:
+// - RSSI values fit an int8_t: the sample ring is 1 byte per entry,
+// - a squared deviation from the mean is at most 128 * 128 = 16384 (below 21846 with the bootstrap correction): the variance ring is 2 bytes per entry,
+// - the running sums and the integrals are at most 32 samples or 16 variance entries: 16 and 32 bit.
+// every field read or written by a sample is in the first 52 bytes, the rings follow, then the state only the cycle touches: a sample touches 2 or 3 cache lines of the packed pool, the all-int layout touched 4 to 7 (see extras/host/layout_report.cpp).
+// the flags are plain bytes rather than bitfields: C++11 does not allow default member initializers on bitfields, and a byte store costs nothing.
+
 typedef struct  transmitterDataStruct {
 
-int sampleBuffer[MAX_SAMPLEBUFFERSIZE_MULTI] = {0};
+// per sample state
 
-int sampleBufferSize = MAX_SAMPLEBUFFERSIZE_MULTI;  // DO NOT EXCEED THIS VALUE
+int32_t variance = RADAR_BOOTING; // this value is calculated from the current sample and the mobile average //// PLEASE NOTE: the init value is -1, meaning the variance is invalid, it will stay invalid until it can be effectively calculated // DO NOT CHANGE THE -1 INITIALIZATION VALUE
 
-int sampleBufferIndex = 0;
+int32_t varianceIntegral = 0; // running sum of the latest varianceIntegratorLimit entries of the varianceBuffer
 
-int sampleBufferValid = 0;
+int32_t varianceBufferSum = 0; // sum of the whole varianceBuffer, used by the FIR/IIR second order filter
 
-int latestReceivedSample = ABSOLUTE_RSSI_LIMIT;
+int32_t varianceAR = 0;  // autoregressive version 
 
-int mobileAverageBufferSize = MAX_AVERAGEBUFFERSIZE_MULTI;  // DO NOT EXCEED THIS VALUE
+// running sums: the windows are slid by adding the newest value and subtracting the evicted one, so the per-sample cost does not depend on the window lengths
+int16_t mobileAverageSum = 0; // sum of the latest mobileAverageFilterSize samples, at most MAX_SAMPLEBUFFERSIZE_MULTI * ABSOLUTE_RSSI_LIMIT
 
-int mobileAverageBuffer[MAX_AVERAGEBUFFERSIZE_MULTI] = {0};
+int16_t mobileAverage = 0;
 
-int mobileAverageTemp = 0;
+uint16_t varianceSample = 0; // deviation of the current sample from the average
 
-int mobileAverageFilterSize = MAX_SAMPLEBUFFERSIZE_MULTI; // you cannot calculate a mobile average past the maximum numer of samples in your sample buffer... that would exceed the array size and cause a crash  // DO NOT EXCEED THIS VALUE
+uint16_t FIRvarianceAvg = 0;
 
-int mobileAverage = 0;
+uint8_t sampleBufferSize = MAX_SAMPLEBUFFERSIZE_MULTI;  // DO NOT EXCEED THIS VALUE
 
-int mobileAverageBufferIndex = 0;
+uint8_t sampleBufferIndex = 0;
 
-int mobileAverageBufferValid = 0;
+uint8_t mobileAverageFilterSize = MAX_SAMPLEBUFFERSIZE_MULTI; // you cannot calculate a mobile average past the maximum numer of samples in your sample buffer... that would exceed the array size and cause a crash  // DO NOT EXCEED THIS VALUE
 
-int varianceBufferSize = MAX_VARIANCEBUFFERSIZE_MULTI;  // DO NOT EXCEED THIS VALUE
+uint8_t mobileAverageSumSize = 0; // the mobileAverageFilterSize value mobileAverageSum was built with, if they differ the sums are rebuilt from the buffers. DO NOT TOUCH
 
-int varianceBuffer[MAX_VARIANCEBUFFERSIZE_MULTI] = {0}; // holds the variance values
+uint8_t sampleBufferSumSize = 0; // the sampleBufferSize value the sums were built with, same as above. DO NOT TOUCH
 
-//// PLEASE NOTE: the init value is -1, meaning the variance is invalid, it will stay invalid until it can be effectively calculated
-// DO NOT CHANGE THE -1 INITIALIZATION VALUE
-int variance = RADAR_BOOTING; // this value is calculated from the current sample and the average calculated from the mobileAverageBuffer values
+uint8_t varianceBufferSize = MAX_VARIANCEBUFFERSIZE_MULTI;  // DO NOT EXCEED THIS VALUE
 
-int variancePrev = 0;
+uint8_t varianceBufferIndex = 0;
 
-int varianceSample = 0; // deviation of the current sample from the average
+uint8_t varianceIntegratorLimit = VARIANCE_INTEGRATOR_LIMIT;  // DO NOT EXCEED varianceBufferSize (it is clamped to varianceBufferSize anyways)
 
-int varianceBufferIndex = 0;
+uint8_t varianceIntegralSize = 0; // the varianceIntegratorLimit value varianceIntegral was built with, if they differ the sums are rebuilt from the buffers. DO NOT TOUCH
 
-int varianceBufferValid = 0;
+uint8_t varianceBufferSumSize = 0; // the varianceBufferSize value varianceBufferSum and varianceIntegral were built with, same as above. DO NOT TOUCH
 
-int varianceIntegral = 0;
+// the flags share one byte. Bitfields cannot have default member initializers before C++20: they are zeroed by the constructor below
 
-int varianceIntegratorLimitMax = MAX_SAMPLEBUFFERSIZE_MULTI;  // DO NOT EXCEED THIS VALUE
+uint8_t sampleBufferValid : 1;
 
-int varianceIntegratorLimit = VARIANCE_INTEGRATOR_LIMIT;  // DO NOT EXCEED varianceIntegratorLimitMax 
+uint8_t varianceBufferValid : 1;
 
-int varianceAR = 0;  // autoregressive version 
+uint8_t resetRequest : 1; // when 1, the pointers are reset to zero and this variable is toggled back to zero. 
 
+uint8_t initComplete : 1; // 0 = buffers never initialized, 1 = buffers initialized with live data  // substantially unused at the moment.
 
-int bufferIndex = 0; // index used for all buffers. // currently unused lol
+uint8_t enableThreshold : 1; // 0 = disable threshold; 1 = enable...
 
+bool enableAutoRegressive : 1; // true to enable
 
-int enableThreshold = 0; // 0 = disable threshold; 1 = enable...
+int16_t latestReceivedSample = ABSOLUTE_RSSI_LIMIT;
 
-int varianceThreshold = VARIANCE_THRESHOLD; // in dBm
+int16_t minimum_RSSI = MINIMUM_RSSI; // the define is -80dBm, a reasonable value is -75 or -80 dBm
 
-int FIRvarianceAvg = 0;
+int16_t currentRSSI = MINIMUM_RSSI;
 
-int detectionLevel = 0; // holds the detected level integrated from the varianceBuffer
+int32_t varianceThreshold = VARIANCE_THRESHOLD; // in dBm
 
-bool enableAutoRegressive = false; // true to enable
+int32_t detectionLevel = 0; // holds the detected level integrated from the varianceBuffer
 
-int minimum_RSSI = MINIMUM_RSSI; // the define is -128dBm, but you should set it to a more reasonable -75 or -80 dBm
+// the windows
 
-int currentRSSI = MINIMUM_RSSI;
+int8_t sampleBuffer[MAX_SAMPLEBUFFERSIZE_MULTI] = {0};
 
-int initComplete = 0; // 0 = buffers never initialized, 1 = buffers initialized with live data  // substantially unused at the moment.
+uint16_t varianceBuffer[MAX_VARIANCEBUFFERSIZE_MULTI] = {0}; // holds the variance values
 
-int resetRequest = 0; // when 1, the pointers are reset to zero and this variable is toggled back to zero. 
+// cycle state, never touched by the samples
 
-int alarmStatus = 0; // 0 = no alarm; >1 triggered (above the varianceThreshold value)
+int32_t alarmStatus = 0; // 0 = no alarm; >1 triggered (above the varianceThreshold value)
+
+transmitterDataStruct() : sampleBufferValid(0), varianceBufferValid(0), resetRequest(0), initComplete(0), enableThreshold(0), enableAutoRegressive(false) {}
 
 } transmitterData;
 
+#define TRANSMITTER_DATA_BUDGET 120 // bytes per link, under two cache lines: 118 of fields, rounded to the int32_t alignment (the all-int layout took 404)
+
+static_assert(sizeof(transmitterData) <= TRANSMITTER_DATA_BUDGET, "transmitterData: over its size budget");
+static_assert((ABSOLUTE_RSSI_LIMIT >= -128) && (MAX_SAMPLEBUFFERSIZE_MULTI <= 255) && (MAX_VARIANCEBUFFERSIZE_MULTI <= 255), "transmitterData: the samples must fit an int8_t and the window sizes an uint8_t");
+static_assert(MAX_SAMPLEBUFFERSIZE_MULTI * ABSOLUTE_RSSI_LIMIT >= -32768, "transmitterData: the mobile average sum must fit an int16_t");
+
+
+// by default we use 4 transmitters in the multistatic system. Basically: the strongest and nearest, one per non-overlapping channel plus one spare.
+// the transmitters data live in a pool carved once from a fixed arena (see multistatic_interference_radar_init()), the number of active transmitters can be changed runtime 
+// via multistatic_interference_radar_set_txN_limit() up to the pool size, no library changes or reflash needed. 
+
+
+#define TRANSMITTERS_POOL_SIZE ABSOLUTE_MAX_SCAN_RESULTS  // arena capacity, in transmitters; there is no point in having more transmitters than scan results
+
+#define MAX_ALLOWED_TRANSMITTERS_NUMBER TRANSMITTERS_POOL_SIZE  // upper bound for every per transmitter array
+
+#define DEFAULT_TRANSMITTERS_NUMBER 4  // active transmitters at boot
+
+
+
+
+// structure-of-arrays version of the transmitters data, used by the batch kernel multistatic_interference_radar_process_batch()
+// all the links are slid in lockstep (one sample per link per call), therefore the window positions are shared and each ring row holds one window position for every link:
+// a single loop can then update all of the links at once, and the compiler is free to vectorize it. 
+// the window sizes are shared by all the links, the thresholds and the minimum RSSI are per link. 
+
+#define ENABLE_BATCH_PROCESSING 0 // [ 0 = disabled (default), >=1 = enabled ] process all the transmitters in one call of the structure-of-arrays batch kernel
+
+typedef struct  transmittersBatchDataStruct {
+
+int linksNumber = 0; // how many links are processed, DO NOT EXCEED MAX_ALLOWED_TRANSMITTERS_NUMBER
+
+int sampleBufferSize = MAX_SAMPLEBUFFERSIZE_MULTI;  // DO NOT EXCEED THIS VALUE
+
+int mobileAverageFilterSize = MAX_SAMPLEBUFFERSIZE_MULTI; // DO NOT EXCEED sampleBufferSize
+
+int varianceBufferSize = MAX_VARIANCEBUFFERSIZE_MULTI;  // DO NOT EXCEED THIS VALUE
+
+int varianceIntegratorLimit = VARIANCE_INTEGRATOR_LIMIT;  // DO NOT EXCEED varianceBufferSize
+
+int secondOrderFilter = ENABLE_FIR_IIR_SECOND_ORDER; 
+
+int secondOrderAttenutationCoefficient = 16; // don't set it to 0 or 1, it needs to be at least 2 or above.
+
+int bootstrapMode = ENABLE_BOOTSTRAP; // shared by all the links, see multistatic_interference_radar_enable_bootstrap()
+
+int sampleBufferIndex = 0; // shared write position of the sample ring
+
+int varianceBufferIndex = 0; // shared write position of the variance ring
+
+int windowsSize = 0; // the mobileAverageFilterSize value the running sums were built with, if they differ all of the links are reset. DO NOT TOUCH
+
+int integratorSize = 0; // the varianceIntegratorLimit value the running sums were built with, if they differ all of the links are reset. DO NOT TOUCH
+
+int8_t sampleRing[MAX_SAMPLEBUFFERSIZE_MULTI][MAX_ALLOWED_TRANSMITTERS_NUMBER] = {{0}}; // [window position][link], samples clamped like the scalar version
+
+uint16_t varianceRing[MAX_VARIANCEBUFFERSIZE_MULTI][MAX_ALLOWED_TRANSMITTERS_NUMBER] = {{0}}; // [window position][link]
+
+// hot per link state, the same ranges as transmitterData
+
+uint8_t samplesCount[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // samples received since the last reset, saturates at sampleBufferSize, the link is valid when the sample window is full
+
+int16_t mobileAverageSum[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+int32_t varianceBufferSum[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+int32_t varianceIntegral[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+int32_t varianceAR[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
 
-// we'll allow UP TO 4 transmitters in the multistatic system. Basically: the strongest and nearest, one per non-overlapping channel plus one spare.
+int16_t mobileAverage[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
 
+int8_t currentRSSI[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
 
-#define MAX_ALLOWED_TRANSMITTERS_NUMBER 4  // YOU MUST CHANGE THIS IF YOU NEED MORE TRANSMITTERS
+int8_t latestReceivedSample[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
 
-static transmitterData transmitterA; //  I'm not gonna use an init function. These structs are small enough to let me keep the matters simple...
-static transmitterData transmitterB; //  
-static transmitterData transmitterC; //  
-static transmitterData transmitterD; //  
+int32_t variance[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // same meaning as transmitterData.variance, -1 while the link is booting
 
+uint16_t varianceSample[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // latest deviation of the link, same as transmitterData.varianceSample
 
-// YOU MUST UNCOMMENT THIS IF YOU NEED MORE TRANSMITTERS
-//transmitterData transmitterE; //  uncomment these to add more points, if you're adventurous. You'll have to modify the library code as well, or this will not work
-//transmitterData transmitterF; //  
-//transmitterData transmitterG; //  
-//transmitterData transmitterH; //  
+// per link configuration
+
+uint8_t resetRequest[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // when 1, the link is cleaned and this variable is toggled back to zero. 
+
+uint8_t enableThreshold[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+uint8_t enableAutoRegressive[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // 1 = the output of the link is the autoregressive smoother, like transmitterData.enableAutoRegressive
+
+int16_t minimum_RSSI[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+int32_t varianceThreshold[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+} transmittersBatchData;
 
 
 
@@ -190,108 +305,1319 @@ static transmitterData transmitterD; //
 
 
 
-typedef struct  multistaticDataStruct {
+// per cycle scan snapshot: the scan results are copied once into this fixed capacity table (and the driver scan memory is freed right after), 
+// every later stage of the cycle reads only from here: no repeated WiFi accessor calls and no String allocations in the steady state.
+// the SSIDs are interned: networks broadcasting the same SSID from several BSSIDs share one copy.
 
-transmitterData transmittersData[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {transmitterA, transmitterB, transmitterC, transmitterD};  // of course there are 4 transmitters as default value. // YOU MUST CHANGE THIS IF YOU NEED MORE TRANSMITTERS
+#define SSID_STORAGE_LEN 34 // the maximum allowed SSID length is 32 characters + NULL terminator, 34 for extreme safety (same as multistaticData.SSIDs)
 
-int transmittersListLen = MAX_ALLOWED_TRANSMITTERS_NUMBER; // see above, update it if you plan to use more than 4 transmitters)
+typedef struct  scanSnapshotEntryStruct {
 
-uint8_t BSSIDs[MAX_ALLOWED_TRANSMITTERS_NUMBER][6] = {{0}}; //holds the BSSID list, in 6 bytes format
+uint64_t BSSIDkey = 0; // packed BSSID
 
-uint8_t netItemNumbers[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {}; //holds the netItem numbers for the current cycle // all of these are updated during the current cycle
+uint8_t BSSID[6] = {0};
 
-// uint8_t BSSIDs[MAX_ALLOWED_TRANSMITTERS_NUMBER][6] = {{0}}; // placeholder, remove this line when cleaning
+int8_t RSSI = ABSOLUTE_RSSI_LIMIT; // in dBm
 
-uint8_t APslotStatus[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // 0 Valid; 1 free; init 2; invalid 3; // this will be updated runtime by the library, DO NOT TOUCH
+uint8_t channel = 0;
 
-char SSIDs[MAX_ALLOWED_TRANSMITTERS_NUMBER][34] = {{0}}; // the maximum allowed SSID length is 32 characters, (or 31 + NULL terminator), for extreme safety we will use 34 and accomodate 32 max (hardwired)
+uint8_t SSIDindex = 0; // index into scanSnapshot.SSIDs
 
-int currentTransmitterIndex = 0; // which of the MAX_ALLOWED_TRANSMITTERS_NUMBER we are currently processing. This will allow the code to runtime-pinpoint the relevant data in each array
+} scanSnapshotEntry;
 
-int activeTransmittersNumber = 0; // updated per each roundrobin cycle from APslotStatus[], each valid slot increases this variable by one.
+typedef struct  scanSnapshotStruct {
 
-int discoveredNetworks = 0; // this is only used to parse the wifi scan results
+int entriesNumber = 0; // valid entries, the netItem numbers used everywhere else are indexes into entries[]
 
-int absoluteRSSIlimit = ABSOLUTE_RSSI_LIMIT; // in dBm
+int fullSweep = 1; // 1 = the entries come from a full discovery sweep, 0 = from a targeted scan of a few channels
 
-int initComplete = 0; // 0 = reinitialize the transmitters ranks, 1 = process the existing ranks
+scanSnapshotEntry entries[ABSOLUTE_MAX_SCAN_RESULTS];
 
-int scanIndexByPower[ABSOLUTE_MAX_SCAN_RESULTS] = {0}; // ABSOLUTE_MAX_SCAN_RESULTS bytes array used to sort the scan results by RSSI,  will only be used when and if we need to fill in empty transmitter slots in the data stucture. 
+int SSIDsNumber = 0; // interned SSIDs
 
-int scanIndexByPowerFirstFreeSpot = 0;
+uint32_t SSIDhashes[ABSOLUTE_MAX_SCAN_RESULTS] = {0};
 
-int latestVariances[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {{0}}; // here you'll find the latest processing results, in the form of variance values, accordingto the transmitter index. 
+char SSIDs[ABSOLUTE_MAX_SCAN_RESULTS][SSID_STORAGE_LEN] = {{0}};
 
-int secondOrderFilter = ENABLE_FIR_IIR_SECOND_ORDER; // default enabled (1), reset to 0 to disable  // useful to stabilize the variance output in crowded environments with a lot of weak signals
+} scanSnapshot;
 
-int secondOrderAttenutationCoefficient = 16; // don't set it to 0 or 1, it needs to be at least 2 or above. If <= 1 very bad things might happen.
 
-int RSSIcleanerEnable = ENABLE_RSSI_CLEANER; // aggressively remove transmitters with subpar signals
 
-int serialCSVdataEnable = ENABLE_SERIAL_CSV_DATA; // output only data in CSV format, good for plotting the variance data
 
-} multistaticData;
+// scan backend: every radio access of the library goes through these hooks. The default backend (NULL) is the ESP32 WiFi class, 
+// on other platforms, or to replay recorded / simulated environments, provide your own via multistatic_interference_radar_set_scan_backend()
+// the asynchronous hooks are optional, they are only used by multistatic_interference_radar_pipelined()
+// every hook receives the backendData of the backend as first parameter, so that one set of hooks can serve many independent radios (or simulations)
 
+#define RADAR_SCAN_RUNNING -1 // scanStatus(): the asynchronous scan is still running (same value as WIFI_SCAN_RUNNING)
+#define RADAR_SCAN_FAILED -2 // scanStatus() and startScanAsync(): no scan running or the scan failed (same value as WIFI_SCAN_FAILED)
 
-static multistaticData accessPoints;
+typedef struct  radarScanBackendStruct {
 
+int (*startScan)(void * backendData, int channel, int dwellMs); // blocking scan, channel 0 means all channels; returns the number of results (< 0 on failure)
 
+int (*readResult)(void * backendData, int index, scanSnapshotEntry * entry, char * SSID); // fills BSSID, RSSI and channel of the entry plus the SSID (SSID_STORAGE_LEN bytes) of the index-th result of the latest scan, returns 0 on success
 
+void (*releaseResults)(void * backendData); // frees the scan results memory, called once all of them have been read
 
+unsigned long (*millis)(void * backendData); // time base, in milliseconds
 
+int (*startScanAsync)(void * backendData, int channel, int dwellMs); // starts a scan and returns right away, 0 if started, RADAR_SCAN_FAILED otherwise. NULL = not supported, the pipelined mode then falls back to blocking scans
 
+int (*scanStatus)(void * backendData); // RADAR_SCAN_RUNNING while the asynchronous scan runs, then the number of results (readResult() and releaseResults() work as after startScan()), RADAR_SCAN_FAILED on failure
 
+void * backendData; // handed back to every hook, NULL if the backend has no per instance state
 
-// main functions
-   
-//// no init and deinit functions for the data arrays
+} radarScanBackend;
 
 
-// NOTE: there is no reconfiguration function. The data structures are exposed already, you may directly change every parameter, taking care to NEVER exceed the array boundaries and the maximum defined limits.
 
-// current status: IMPLEMENTED // architecture-independent
- // receives the transmitter data structure (don't forget to check the default values in multistatic_interference_radar.h) and the related RSSI signal as parameters, 
- // returns the detection level in dBm^2 ( < 0 -> error (see ERROR LEVELS section), == 0 -> no detection, > 0 -> detection level in dBm^2)
-int multistatic_interference_radar_process(int sample, transmitterData *transmitterX);
+// scan scheduler: with targeted scans enabled, most cycles only scan the channels the tracked transmitters are on, with short dwell times;
+// a full discovery sweep is done every fullSweepInterval cycles, when a transmitter is lost, or when the transmitters number grows.
 
-// current status: IMPLEMENTED // ESP32 and Arduino architecture-dependent
-int multistatic_interference_radar(); // ESP32 specific version: does all the the scans, classification, and requests the RSSI level internally, then processes the signal and returns the detection level in dBm^2
+typedef struct  scanSchedulerStruct {
 
+int targetedScan = ENABLE_TARGETED_SCAN;
 
+int fullSweepInterval = SCAN_FULL_SWEEP_INTERVAL;
 
+int fullSweepDwellMs = SCAN_FULL_DWELL_MS;
 
-// SERVICE / CONFIG FUNCTIONS
+int targetedDwellMs = SCAN_TARGETED_DWELL_MS;
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_debug_via_serial(int);  // parameter is debug level, set it to at least >= 1; the highest the level, the more messages you enjoy
+int fullSweepRequested = 1; // set by the library whenever the slots need a discovery sweep, DO NOT TOUCH
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_set_debug_level(int);  // parameter is debug level, set it to at least >= 1; the highest the level, the more messages you enjoy
+int cyclesSinceFullSweep = 0;
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_set_txN_limit(int); // forcefully reduces the number of processed transmitters; CAVEAT: do not exceed MAX_ALLOWED_TRANSMITTERS_NUMBER
+int planFullSweep = 1; // the current cycle plan: 1 = full sweep, 0 = targeted
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_enable_second_order_variance_filtering(int); // [ 0 = disabled, >=1 = enabled (1 recommended) ] enhances the second order derivative for very slow drifting variances, nullifies long-term variance offsets in crowded environments. As a wanted side-effect, when a transmitter accidentally becomes to weak to measure reliably and data stops being gathered, the terminal variance offset is gracefully compensated by the finite impulse response filter. 
+int planChannelsNumber = 0; // targeted plan: how many channels
 
-// current status: // current status: IMPLEMENTED
-int multistatic_interference_radar_enable_aggressive_cleaning_low_RSSI(int); // 0 = disabled, 1 = enabled (0 recommended) aggressively clean the transmitters list in case of low signals. // I don't recommentd enabling it unless you debug your system
+uint8_t planChannels[WIFI_CHANNELS_NUMBER] = {0}; // targeted plan: which channels
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_enable_serial_CSV_graph_data(int); // [ 0 = disabled, >=1 = enabled (default is 0) ] completely disable the verbose output and only print the variance foreach transmitter in CSV format over the serial console, so that any program listening to the serial can graph the relevant data. 
+// statistics
 
+unsigned long lastCycleScanMs = 0; // radio time spent by the latest cycle
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient(int); // don't set it to 0 or 1, it needs to be at least 2 or above. If <= 1 very bad things might happen.
+unsigned long totalScanMs = 0;
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_set_minimum_RSSI(int);
+unsigned long fullSweeps = 0;
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_enable_alarm(int);
+unsigned long targetedCycles = 0;
 
+unsigned long channelScans = 0; // single channel scans done by the targeted cycles
 
-// current status: IMPLEMENTED
-int multistatic_interference_radar_set_alarm_threshold(int);
+} scanScheduler;
 
-//
+
+// one cycle worth of scans, as planned by the scheduler: what the acquisition executes, be it the blocking cycle, the pipelined one or the acquisition task
+
+typedef struct  scanRequestStruct {
+
+int fullSweep = 1; // 1 = full sweep, 0 = the channels below
+
+int channelsNumber = 0;
+
+uint8_t channels[WIFI_CHANNELS_NUMBER] = {0};
+
+int fullSweepDwellMs = SCAN_FULL_DWELL_MS;
+
+int targetedDwellMs = SCAN_TARGETED_DWELL_MS;
+
+// filled by the acquisition
+
+unsigned long startMs = 0; // backend time the first scan started
+
+unsigned long scanMs = 0; // radio time spent
+
+int channelScans = 0; // single channel scans done
+
+} scanRequest;
+
+
+
+
+// pipelined mode: the scan of cycle N+1 runs in the background (asynchronous backend hooks) while cycle N is processed. 
+// Two snapshots are used in turn: the background acquisition fills one, the housekeeping, ranking and DSP stages read the other; 
+// they swap when an acquisition completes, no copy involved.
+
+typedef struct  scanPipelineStruct {
+
+int cycleRunning = 0; // 1 while a cycle is being acquired in the background, DO NOT TOUCH
+
+int scanInFlight = 0; // 1 while a backend scan of that cycle is running, DO NOT TOUCH
+
+scanRequest request; // the cycle being acquired, DO NOT TOUCH
+
+int planIndex = 0; // next scan of the request to start, DO NOT TOUCH
+
+int fillBuffer = 1; // which of multistaticData.scanBuffers the background acquisition fills, the other one is multistaticData.scanResults, DO NOT TOUCH
+
+// published results, updated each time a cycle completes
+
+int latestLevel = RADAR_BOOTING; // same value multistatic_interference_radar() would have returned for that cycle
+
+unsigned long publishedCycles = 0;
+
+unsigned long latestPublishMs = 0; // backend time of the latest publication
+
+unsigned long latestAcquisitionStartMs = 0; // backend time the published snapshot started to be acquired: latestPublishMs - latestAcquisitionStartMs is the age of the results when published
+
+} scanPipeline;
+
+
+
+
+// streaming ingest: instead of one RSSI sample per scan, every beacon received from a tracked transmitter becomes a sample (about 10 per second per access point).
+// The producer (the ESP32 promiscuous receive callback, or a pcap replay on the host) filters the frames against the tracked BSSIDs and pushes 
+// (BSSID, RSSI, timestamp) records into a lock-free single-producer / single-consumer ring; multistatic_interference_radar_stream_process(), called from the loop, 
+// drains the ring into multistatic_interference_radar_process(), per transmitter. The scans are still needed to discover and rank the transmitters.
+// please note: in promiscuous mode the radio only hears the channel it is tuned to, the transmitters on the other channels keep getting their samples from the scans.
+
+#define STREAM_RING_SIZE 256 // records, MUST be a power of two; at 10 beacons per second per transmitter, 4 transmitters fill it in about 6 seconds
+
+typedef struct  streamSampleStruct {
+
+uint64_t BSSIDkey = 0; // packed BSSID
+
+uint32_t timestampMs = 0; // producer time of reception
+
+int8_t RSSI = ABSOLUTE_RSSI_LIMIT; // in dBm
+
+} streamSample;
+
+typedef struct  radarStreamStruct {
+
+int enabled = 0; // set via multistatic_interference_radar_enable_stream()
+
+// the ring, the producer only writes head, the consumer only writes tail
+
+std::atomic<uint32_t> head {0};
+
+std::atomic<uint32_t> tail {0};
+
+streamSample samples[STREAM_RING_SIZE];
+
+// tracked BSSIDs filter, published by the consumer only when the valid slots change, guarded by a sequence lock: trackedKeysSequence is odd while the keys are rewritten, 
+// the producer retries a read that overlapped a rewrite. The keys are split in 32 bit atomic halves, lock-free on the ESP32, the sequence makes the pairs consistent.
+// A producer that keeps overlapping a rewrite (e.g. the consumer was preempted in the middle of it) lets the frame through: the consumer checks every record against the slots anyway.
+
+#define STREAM_TRACKED_KEYS_READ_RETRIES 4 // producer attempts before letting a frame through unchecked
+
+std::atomic<uint32_t> trackedKeysSequence {0};
+
+std::atomic<uint32_t> trackedKeysHigh[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {}; // bits 32..47 of the packed BSSIDs
+
+std::atomic<uint32_t> trackedKeysLow[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {}; // bits 0..31 of the packed BSSIDs
+
+std::atomic<int> trackedKeysNumber {0};
+
+// statistics, written by the producer
+
+std::atomic<uint32_t> framesSeen {0}; // frames handed to the ingest
+
+std::atomic<uint32_t> framesAccepted {0}; // beacons from tracked transmitters pushed into the ring
+
+std::atomic<uint32_t> ringOverflows {0}; // accepted beacons lost because the ring was full: call multistatic_interference_radar_stream_process() more often
+
+// statistics, written by the consumer
+
+uint32_t samplesProcessed = 0;
+
+uint32_t samplesDiscarded = 0; // records whose transmitter is no longer tracked
+
+uint32_t latestTimestampMs = 0; // timestamp of the latest processed record
+
+} radarStream;
+
+
+
+
+// threaded mode: one task acquires (scans, while the beacon capture keeps feeding the stream ring) and one task processes, each owning its own state:
+// - the acquisition task only uses the scan backend and the snapshot buffer it holds,
+// - the signal processing task owns everything else (slots, filters, scheduler, stream consumer).
+// They exchange the two scan snapshot buffers through a pair of bounded lock-free queues: a filled buffer goes to processing, 
+// a processed buffer comes back carrying the scan request for the next cycle. The detection results reach the application through a third queue.
+// on the ESP32 they are FreeRTOS tasks pinned to separate cores, on the host they are std::threads.
+
+#define RADAR_TASK_QUEUE_SIZE 4 // buffer indexes queues, MUST be a power of two and at least 2 (the snapshot buffers)
+
+#define RADAR_RESULTS_QUEUE_SIZE 16 // results queue, MUST be a power of two; when the application falls behind, the newest results are dropped
+
+#define RADAR_ACQUISITION_CORE 0 // the ESP32 WiFi stack runs on core 0 as well
+
+#define RADAR_DSP_CORE 1 // same core as the Arduino loop()
+
+#define RADAR_TASK_STACK_SIZE 8192 // bytes
+
+#define RADAR_TASK_PRIORITY 1
+
+typedef struct  radarResultStruct {
+
+int level = RADAR_BOOTING; // same value multistatic_interference_radar() would have returned for the cycle
+
+uint32_t cycle = 0; // sequence number
+
+int discoveredNetworks = 0;
+
+unsigned long scanStartUs = 0; // micros() when the acquisition of the cycle started
+
+unsigned long acquiredUs = 0; // micros() when the filled snapshot was queued for processing
+
+unsigned long publishedUs = 0; // micros() when this result was queued for the application: publishedUs - acquiredUs is the queueing plus processing latency
+
+} radarResult;
+
+typedef struct  radarIndexQueueStruct {
+
+std::atomic<uint32_t> head {0};
+
+std::atomic<uint32_t> tail {0};
+
+int items[RADAR_TASK_QUEUE_SIZE] = {0};
+
+} radarIndexQueue;
+
+typedef struct  radarTasksStruct {
+
+std::atomic<int> running {0}; // 1 between multistatic_interference_radar_start_tasks() and multistatic_interference_radar_stop_tasks()
+
+std::atomic<int> stopRequest {0};
+
+std::atomic<int> tasksAlive {0}; // how many of the successfully created tasks have not exited yet
+
+radarIndexQueue freeBuffers; // processing -> acquisition
+
+radarIndexQueue filledBuffers; // acquisition -> processing
+
+scanRequest requests[2]; // one per snapshot buffer, owned by whoever holds the buffer
+
+unsigned long scanStartUs[2] = {0}; // one per snapshot buffer, micros() when its acquisition started
+
+unsigned long acquiredUs[2] = {0}; // one per snapshot buffer, micros() when it was queued for processing
+
+// results, processing -> application
+
+std::atomic<uint32_t> resultsHead {0};
+
+std::atomic<uint32_t> resultsTail {0};
+
+radarResult results[RADAR_RESULTS_QUEUE_SIZE];
+
+std::atomic<uint32_t> resultsDropped {0};
+
+// statistics
+
+std::atomic<uint32_t> acquiredCycles {0};
+
+std::atomic<uint32_t> processedCycles {0};
+
+} radarTasks;
+
+
+
+
+// BSSID lookups: the 6 bytes BSSIDs are packed into 48 bit integer keys (0 means no BSSID), and indexed by a small open addressing hash table, 
+// so that matching a slot or a scan result is a single probe (plus a few on collisions) instead of a byte by byte scan of every entry. 
+
+#define BSSID_INDEX_SIZE 128 // table entries, MUST be a power of two and at least twice the number of indexed items (ABSOLUTE_MAX_SCAN_RESULTS)
+
+typedef struct  bssidIndexStruct {
+
+uint64_t keys[BSSID_INDEX_SIZE] = {0}; // packed BSSIDs, 0 = empty entry
+
+int16_t values[BSSID_INDEX_SIZE] = {0}; // what the key points to (slot index or netItem)
+
+} bssidIndex;
+
+static_assert((BSSID_INDEX_SIZE > 1) && ((BSSID_INDEX_SIZE & (BSSID_INDEX_SIZE - 1)) == 0), "BSSID index: BSSID_INDEX_SIZE must be a power of two");
+static_assert(BSSID_INDEX_SIZE >= 2 * ABSOLUTE_MAX_SCAN_RESULTS, "BSSID index: BSSID_INDEX_SIZE must be at least twice ABSOLUTE_MAX_SCAN_RESULTS");
+
+
+
+
+// warm start: the slot table and the filter windows of the tracked transmitters are saved into a compact versioned binary snapshot (NVS on the ESP32, a file on the host), 
+// so that after a reboot or a brown-out the radar restores them and produces valid output from the first cycles, instead of refilling the windows from scratch. 
+// The first scan after a restore validates the snapshot: restored transmitters that are gone, or whose RSSI moved by more than rssiTolerance, are dropped and replaced as usual; 
+// if most of them fail, the whole snapshot is considered stale and the radar starts cold. 
+// the format, little endian, only the valid slots are saved:
+//   header (RADAR_SNAPSHOT_HEADER_LEN bytes): magic "MIRS" (4) version (1) flags (1, bit 0: saved from the batch kernel) links number (2) total length (4)
+//   per link: slot (1) channel (1) BSSID (6) SSID length (1) SSID (SSID length) samples number (1) variances number (1) mobile average (1, dBm) current RSSI (1, dBm) 
+//             variance (4) varianceAR (4) samples (1 byte each, dBm, oldest first) variance window (2 bytes each, oldest first, clamped to MAX_VARIANCE_MULTI)
+//   CRC32 of everything above (4)
+// the windows are saved in chronological order: a snapshot taken with the batch kernel restores into the scalar filters and vice versa.
+
+#define RADAR_SNAPSHOT_VERSION 1
+
+#define RADAR_SNAPSHOT_HEADER_LEN 12
+
+#define RADAR_SNAPSHOT_LINK_MAX_LEN (21 + 32 + MAX_SAMPLEBUFFERSIZE_MULTI + 2 * MAX_VARIANCEBUFFERSIZE_MULTI) // bytes, one link with a 32 characters SSID and full windows
+
+#define RADAR_SNAPSHOT_MAX_LEN(linksNumber) (RADAR_SNAPSHOT_HEADER_LEN + (linksNumber) * RADAR_SNAPSHOT_LINK_MAX_LEN + 4) // buffer size that always fits a snapshot of linksNumber links
+
+#define SNAPSHOT_RSSI_TOLERANCE 10 // dB, a restored transmitter heard further than this from its saved mobile average is dropped by the validation
+
+#define SNAPSHOT_NAME_LEN 16 // NVS keys are 15 characters at most
+
+#define SNAPSHOT_NVS_NAMESPACE "mi_radar" // ESP32 only
+
+typedef struct  radarWarmStartStruct {
+
+char name[SNAPSHOT_NAME_LEN] = "radar"; // NVS key on the ESP32 (namespace SNAPSHOT_NVS_NAMESPACE), file name plus ".snapshot" on the host, see multistatic_interference_radar_set_snapshot_name()
+
+int storeInterval = 0; // cycles between two automatic multistatic_interference_radar_store_snapshot() calls, 0 = disabled (the application stores when it likes)
+
+int cyclesSinceStore = 0;
+
+int rssiTolerance = SNAPSHOT_RSSI_TOLERANCE;
+
+int validationPending = 0; // 1 from the restore to the first processed scan, DO NOT TOUCH
+
+uint8_t restoredSlots[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // 1 for the slots waiting for the validation, DO NOT TOUCH
+
+int referenceRSSI[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // what the validation expects to hear from each restored slot, DO NOT TOUCH
+
+// statistics
+
+int restoredLinks = 0; // by the latest restore
+
+int confirmedLinks = 0; // by the latest validation
+
+int droppedLinks = 0; // by the latest validation
+
+unsigned long storedSnapshots = 0;
+
+} radarWarmStart;
+
+
+
+
+// hot standby: besides the tracked transmitters, the next strongest ones in the ranking (the runner-ups) can be followed by shadow trackers. A shadow runs the same 
+// running sums filter as a slot, one update per cycle whatever the window sizes, but it is neither reported nor does it raise alarms. When a tracked transmitter is lost 
+// (checkDeadTransmitters(), checkInvalidRSSI()) the free slot is taken over by the warmest shadow still heard, filter state included, instead of loading the next strongest 
+// transmitter cold and waiting for its windows to fill. With targeted scans on, the channels of the shadows are scanned as well.
+
+#define SHADOW_TRACKERS_MAX 8 // upper bound of the shadow trackers number
+
+#define SHADOW_TRACKERS_NUMBER 0 // shadow trackers at boot, 0 = disabled (default)
+
+#define SHADOW_MAX_MISSES 3 // consecutive scans a shadow may be missing from before it is dropped (single missed beacons are common)
+
+#define SHADOW_REFILL_INTERVAL 4 // cycles between two attempts to fill the free shadows, when the ranking has not been rebuilt anyway
+
+typedef struct  radarShadowsStruct {
+
+int shadowsNumber = SHADOW_TRACKERS_NUMBER; // see multistatic_interference_radar_set_shadow_trackers()
+
+uint64_t BSSIDkeys[SHADOW_TRACKERS_MAX] = {0}; // packed BSSIDs of the followed transmitters, 0 = free shadow
+
+uint8_t channels[SHADOW_TRACKERS_MAX] = {0}; // the channel each shadow was last seen on, used by the scan scheduler
+
+uint8_t misses[SHADOW_TRACKERS_MAX] = {0}; // consecutive scans without the shadow
+
+transmitterData filters[SHADOW_TRACKERS_MAX]; // DO NOT TOUCH
+
+int cyclesSinceRefill = 0;
+
+// statistics
+
+unsigned long promotedWarm = 0; // shadows promoted with a valid output
+
+unsigned long promotedBooting = 0; // shadows promoted while still booting, ahead of a cold load anyway
+
+unsigned long coldLoads = 0; // slots loaded by loadScanResults() the usual way
+
+unsigned long droppedShadows = 0; // shadows missing for more than SHADOW_MAX_MISSES scans
+
+} radarShadows;
+
+
+
+
+typedef struct  multistaticDataStruct {
+
+transmitterData *transmittersData = NULL;  // the transmitters pool, bound to the library arena by multistatic_interference_radar_init() (called automatically on first use) 
+
+int transmittersPoolSize = 0; // how many transmitters the pool holds, set by multistatic_interference_radar_init(), DO NOT TOUCH
+
+int transmittersListLen = DEFAULT_TRANSMITTERS_NUMBER; // active transmitters, change it runtime via multistatic_interference_radar_set_txN_limit(), never above transmittersPoolSize
+
+// per slot state read every cycle, kept together at the top
+
+int latestVariances[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {{0}}; // here you'll find the latest processing results, in the form of variance values, accordingto the transmitter index. 
+
+uint64_t BSSIDkeys[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // the BSSIDs below, packed into 48 bit keys, always kept in sync with them. DO NOT TOUCH
+
+uint8_t netItemNumbers[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {}; //holds the netItem numbers for the current cycle // all of these are updated during the current cycle
+
+uint8_t channels[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // the channel each transmitter was last seen on, used by the scan scheduler
+
+uint8_t missedScans[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // consecutive targeted scans that did not hear the transmitter (see SCAN_TARGETED_MISS_LIMIT), meanwhile its samples are ABSOLUTE_RSSI_LIMIT
+
+uint8_t APslotStatus[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // 0 Valid; 1 free; init 2; invalid 3; // this will be updated runtime by the library, DO NOT TOUCH
+
+int currentTransmitterIndex = 0; // which of the MAX_ALLOWED_TRANSMITTERS_NUMBER we are currently processing. This will allow the code to runtime-pinpoint the relevant data in each array
+
+int activeTransmittersNumber = 0; // updated per each roundrobin cycle from APslotStatus[], each valid slot increases this variable by one.
+
+int discoveredNetworks = 0; // this is only used to parse the wifi scan results
+
+int absoluteRSSIlimit = ABSOLUTE_RSSI_LIMIT; // in dBm
+
+int initComplete = 0; // 0 = reinitialize the transmitters ranks, 1 = process the existing ranks
+
+int scanIndexByPower[ABSOLUTE_MAX_SCAN_RESULTS] = {0}; // ABSOLUTE_MAX_SCAN_RESULTS bytes array used to sort the scan results by RSSI,  will only be used when and if we need to fill in empty transmitter slots in the data stucture. 
+
+int scanIndexByPowerFirstFreeSpot = 0; // how many results have been ranked into scanIndexByPower (the top transmittersListLen plus shadowsNumber at most)
+
+scanSnapshot scanBuffers[2]; // the scan snapshots, a single one is used unless the pipelined mode is running
+
+scanSnapshot * scanResults = scanBuffers; // the current cycle scan results, see appendScanResults(). Points into scanBuffers: never copy a multistaticData structure around
+
+bssidIndex scanResultsIndex; // packed BSSID -> netItem, rebuilt once per scan
+
+bssidIndex slotsIndex; // packed BSSID -> slot index, rebuilt when the slots change
+
+int slotsIndexDirty = 1; // 1 when the slots have changed since the last slotsIndex rebuild
+
+int secondOrderFilter = ENABLE_FIR_IIR_SECOND_ORDER; // default enabled (1), reset to 0 to disable  // useful to stabilize the variance output in crowded environments with a lot of weak signals
+
+int secondOrderAttenutationCoefficient = 16; // don't set it to 0 or 1, it needs to be at least 2 or above. If <= 1 very bad things might happen.
+
+int RSSIcleanerEnable = ENABLE_RSSI_CLEANER; // aggressively remove transmitters with subpar signals
+
+int bootstrapMode = ENABLE_BOOTSTRAP; // booting transmitters produce estimates over the samples they have, see multistatic_interference_radar_enable_bootstrap()
+
+int serialCSVdataEnable = ENABLE_SERIAL_CSV_DATA; // output only data in CSV format, good for plotting the variance data
+
+int batchProcessing = ENABLE_BATCH_PROCESSING; // process all the transmitters with the structure-of-arrays batch kernel instead of one multistatic_interference_radar_process() call per transmitter
+
+transmittersBatchData batchData; // structure-of-arrays state used when batchProcessing is enabled
+
+scanScheduler scanPlan; // decides which channels each cycle scans
+
+const radarScanBackend * scanBackend = NULL; // NULL = the ESP32 WiFi class (on the host a backend must be set)
+
+scanPipeline pipeline; // state of multistatic_interference_radar_pipelined()
+
+radarStream stream; // streaming ingest state, see multistatic_interference_radar_stream_process()
+
+radarTasks tasks; // threaded mode state, see multistatic_interference_radar_start_tasks()
+
+radarWarmStart warmStart; // snapshot and restore state, see multistatic_interference_radar_store_snapshot()
+
+radarShadows shadows; // hot standby state, see multistatic_interference_radar_set_shadow_trackers()
+
+// cold per slot metadata, only touched when a slot changes hands or for the reports: kept apart from the state of the cycle
+
+uint8_t BSSIDs[MAX_ALLOWED_TRANSMITTERS_NUMBER][6] = {{0}}; //holds the BSSID list, in 6 bytes format
+
+char SSIDs[MAX_ALLOWED_TRANSMITTERS_NUMBER][34] = {{0}}; // the maximum allowed SSID length is 32 characters, (or 31 + NULL terminator), for extreme safety we will use 34 and accomodate 32 max (hardwired)
+
+} multistaticData;
+
+
+
+// logging: every diagnostic message has a level, the debugRadarMsg value it needs to be printed.
+// - compile time floor: the messages above RADAR_LOG_MAX_LEVEL generate no code at all, their level test is a constant the compiler removes together with the message,
+//   e.g. build with -DRADAR_LOG_MAX_LEVEL=0 and the library has no diagnostics code left. Within the floor, debugRadarMsg still selects at runtime what is printed.
+// - the messages of the cycle, of the housekeeping and of the filters are events: an id, a timestamp and a few integers, formatted only when they are printed.
+//   In RADAR_LOG_MODE_SERIAL (default) they are printed right away, the caller waits for the UART as it always did. In the ring modes they are only copied 
+//   into a lock-free ring (any task may log, nobody ever waits: a full ring drops the record and counts it), and multistatic_interference_radar_log_drain(), 
+//   or the drain task, prints them later as text lines or as binary frames (decoded on the host by extras/host/log_decode.cpp).
+
+#ifndef RADAR_LOG_MAX_LEVEL
+#define RADAR_LOG_MAX_LEVEL 17 // highest debug level compiled in, 17 keeps every message of the library
+#endif
+
+#define RADAR_LOG_ENABLED(radar, level) (((level) <= RADAR_LOG_MAX_LEVEL) && ((radar)->debugRadarMsg >= (level))) // the level MUST be a constant
+
+#define RADAR_LOG_MODE_SERIAL 0 // the events are printed when they happen (default)
+
+#define RADAR_LOG_MODE_RING_TEXT 1 // the events go to the ring, the drain prints them as text lines with their timestamps
+
+#define RADAR_LOG_MODE_RING_BINARY 2 // the events go to the ring, the drain writes them as binary frames
+
+#define RADAR_LOG_RING_SIZE 256 // records, MUST be a power of two; 8 KB
+
+#define RADAR_LOG_MAX_ARGS 6
+
+#define RADAR_LOG_DRAIN_PERIOD_MS 50 // default period of the drain task
+
+#define RADAR_LOG_TASK_CORE 0 // the drain task shares the core of the WiFi stack and of the acquisition, never the one of the filters
+
+#define RADAR_LOG_TASK_PRIORITY 1
+
+// binary frame, little endian: 0xA5 0x5A, event id (2 bytes), level (1), args number (1), timestamp in us (4), the args (4 bytes each), 
+// checksum (1, the sum of the bytes between the sync bytes and the checksum)
+
+#define RADAR_LOG_FRAME_SYNC0 0xA5
+
+#define RADAR_LOG_FRAME_SYNC1 0x5A
+
+#define RADAR_LOG_FRAME_HEADER_LEN 10
+
+#define RADAR_LOG_FRAME_MAX_LEN (RADAR_LOG_FRAME_HEADER_LEN + 4 * RADAR_LOG_MAX_ARGS + 1)
+
+// event ids: they are part of the binary format, never renumber them, add new ones at the end (the texts are in the event table of multistatic_interference_radar.cpp)
+
+#define RADAR_EVENT_LOG_DROPPED 0 // records dropped because the ring was full
+#define RADAR_EVENT_PROCESS_UNINITIALIZED 1
+#define RADAR_EVENT_PROCESS_WEAK_RSSI 2
+#define RADAR_EVENT_PROCESS_SAMPLE 3
+#define RADAR_EVENT_PROCESS_DETECTION 4
+#define RADAR_EVENT_PROCESS_UNDER_THRESHOLD 5
+#define RADAR_EVENT_SCAN_TOO_MANY_RESULTS 6
+#define RADAR_EVENT_RSSI_CHECK_ITEM 7
+#define RADAR_EVENT_RSSI_TOO_LOW 8
+#define RADAR_EVENT_SLOT_ALREADY_FREE 9
+#define RADAR_EVENT_SLOT_LOOKUP 10
+#define RADAR_EVENT_SLOT_NOT_HEARD 11
+#define RADAR_EVENT_SLOT_HEARD 12
+#define RADAR_EVENT_RANKED_RESULT 13
+#define RADAR_EVENT_SLOT_VARIANCE 14
+#define RADAR_EVENT_SCAN_REQUEST 15
+#define RADAR_EVENT_SHADOW_PROMOTED 16
+#define RADAR_EVENT_RADAR_INOPERABLE 17
+#define RADAR_EVENT_INVALID_TX_CLEANED 18
+#define RADAR_EVENT_DEAD_TX_CLEANED 19
+#define RADAR_EVENT_LOW_SIGNAL_LOST 20
+#define RADAR_EVENT_SHADOWS_PROMOTED 21
+#define RADAR_EVENT_SLOTS_LOADED 22
+#define RADAR_EVENT_TX_GONE 23
+#define RADAR_EVENT_NO_SCAN_BACKEND 24
+#define RADAR_EVENT_STREAM_PROCESSED 25
+
+#define RADAR_EVENTS_NUMBER 26
+
+typedef struct  radarLogRecordStruct {
+
+uint32_t timestampUs = 0; // micros() when the event happened
+
+uint16_t eventId = 0;
+
+uint8_t level = 0;
+
+uint8_t argsNumber = 0;
+
+int32_t args[RADAR_LOG_MAX_ARGS] = {0};
+
+} radarLogRecord;
+
+typedef struct  radarLogCellStruct {
+
+std::atomic<uint32_t> sequence {0}; // position - index: lap * RADAR_LOG_RING_SIZE when free for that lap, + 1 once the record of that lap is written
+
+radarLogRecord record;
+
+} radarLogCell;
+
+typedef struct  radarLogStruct {
+
+int mode = RADAR_LOG_MODE_SERIAL; // see multistatic_interference_radar_set_log_mode()
+
+// the ring: many producers claim positions on head, the single consumer (the drain) owns tail
+
+std::atomic<uint32_t> head {0};
+
+uint32_t tail = 0;
+
+radarLogCell cells[RADAR_LOG_RING_SIZE];
+
+std::atomic<uint32_t> dropped {0}; // records lost to a full ring: drain more often, or log less
+
+uint32_t droppedReported = 0; // consumer only
+
+// drain task
+
+std::atomic<int> taskRunning {0};
+
+std::atomic<int> taskStopRequest {0};
+
+int taskPeriodMs = RADAR_LOG_DRAIN_PERIOD_MS;
+
+} radarLog;
+
+
+
+
+// binary telemetry: the per cycle data of every link (RSSI, mobile average, variance, alarm), and with the beacon stream on every streamed sample, 
+// in a compact framed binary format instead of the CSV text of multistatic_interference_radar_enable_serial_CSV_graph_data() (the two are exclusive, telemetry wins).
+// The records are appended to a chunk buffer, the whole chunk is handed to the sink (Serial.write() by default: one call, one UART / DMA transfer) when the next 
+// record does not fit, when TELEMETRY_FLUSH_INTERVAL_MS have passed since its first record, or on multistatic_interference_radar_telemetry_flush(). 
+// Nothing is ever dropped by the encoder: the sink may block, it is called from the cycle. Decoded on the host by extras/host/telemetry_decoder.h.
+//
+// chunk, little endian: 0xA5 0xC3, version (1), reserved (1), sequence (4, +1 per chunk), payload length (2), records number (2), payload, CRC-32 (4, IEEE, of 
+// everything between the sync bytes and the CRC). Every chunk decodes on its own: the delta state and the link table restart with it, so a lost or corrupted chunk 
+// only loses its own records, and the sequence numbers tell how many were lost.
+// payload records, the integers are LEB128 varints (zigzag for the signed ones), the deltas are taken against the previous value of the same field within the chunk (0 at its start):
+//   TELEMETRY_RECORD_LINK:   type, slot, BSSID (6 raw bytes), channel          when a slot gets a new transmitter, and for every valid slot at the start of a chunk
+//   TELEMETRY_RECORD_CYCLE:  type, timestamp ms (signed delta), detection level (signed), links number, valid bitmap and alarm bitmap ((links number + 7) / 8 bytes each), 
+//                            then for each valid link: RSSI, mobile average and variance (signed deltas of that slot)
+//   TELEMETRY_RECORD_SAMPLE: type, slot * 2 + alarm, timestamp ms (signed delta), RSSI, mobile average and variance (signed deltas of that slot)
+
+#define TELEMETRY_SYNC0 0xA5
+
+#define TELEMETRY_SYNC1 0xC3
+
+#define TELEMETRY_VERSION 1
+
+#define TELEMETRY_CHUNK_HEADER_LEN 12
+
+#define TELEMETRY_CHUNK_SIZE 2048 // bytes, header and CRC included: the largest write handed to the sink, MUST be a multiple of 4 (a cycle of 4 links takes about 25 bytes, a streamed sample 5 to 10)
+
+#define TELEMETRY_CHUNK_PAYLOAD_MAX (TELEMETRY_CHUNK_SIZE - TELEMETRY_CHUNK_HEADER_LEN - 4)
+
+#define TELEMETRY_FLUSH_INTERVAL_MS 1000 // default upper bound of the time a record waits in the chunk
+
+#define TELEMETRY_RECORD_LINK 1
+#define TELEMETRY_RECORD_CYCLE 2
+#define TELEMETRY_RECORD_SAMPLE 3
+
+#define TELEMETRY_LINK_RECORD_LEN 9 // slot and channel always fit one varint byte
+
+#define TELEMETRY_CYCLE_RECORD_MAX_LEN(links) (12 + 2 * (((links) + 7) / 8) + (links) * 15) // 5 bytes varints at worst
+
+#define TELEMETRY_SAMPLE_RECORD_MAX_LEN 23
+
+static_assert(MAX_ALLOWED_TRANSMITTERS_NUMBER <= 127, "telemetry: the slot indexes must fit one varint byte");
+static_assert(TELEMETRY_CYCLE_RECORD_MAX_LEN(MAX_ALLOWED_TRANSMITTERS_NUMBER) + MAX_ALLOWED_TRANSMITTERS_NUMBER * TELEMETRY_LINK_RECORD_LEN <= TELEMETRY_CHUNK_PAYLOAD_MAX, "telemetry: a chunk must hold a cycle of the full pool and its link table");
+static_assert(TELEMETRY_CHUNK_SIZE % 4 == 0, "telemetry: the chunk size must be a multiple of 4");
+
+typedef void (*radarTelemetrySink)(const uint8_t * chunk, int length, void * sinkData); // receives each complete chunk, the buffer is reused after the call
+
+typedef struct  radarTelemetryStruct {
+
+int enabled = 0; // set via multistatic_interference_radar_enable_telemetry()
+
+radarTelemetrySink sink = NULL; // NULL = Serial.write()
+
+void * sinkData = NULL; // passed back to the sink
+
+unsigned long flushIntervalMs = TELEMETRY_FLUSH_INTERVAL_MS;
+
+// the chunk being filled
+
+alignas(4) uint8_t chunk[TELEMETRY_CHUNK_SIZE] = {0};
+
+int payloadLength = 0;
+
+int recordsNumber = 0;
+
+uint32_t sequence = 0; // of the next chunk
+
+uint32_t chunkStartMs = 0; // timestamp of the first record of the chunk
+
+// delta state, restarted with every chunk
+
+int32_t previousTimestampMs = 0;
+
+int32_t previousRSSI[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+int32_t previousAverage[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+int32_t previousVariance[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0};
+
+uint64_t linkKeys[MAX_ALLOWED_TRANSMITTERS_NUMBER] = {0}; // the BSSIDs sent in this chunk, 0 = none yet
+
+// statistics
+
+uint32_t chunksSent = 0;
+
+uint32_t bytesSent = 0;
+
+uint32_t recordsSent = 0;
+
+} radarTelemetry;
+
+
+
+
+// profiling: where the time of a cycle goes. Each stage of a cycle is timed with the cheapest clock there is (the CCOUNT cycle counter on the ESP32, 
+// the TSC on x86 hosts, steady_clock elsewhere) into a log2 histogram, and the slot churn is counted. multistatic_interference_radar_get_profile() returns it all.
+// The churn counters count every cycle, the stages are timed one cycle every RADAR_PROFILE_SAMPLE_INTERVAL: the clock reads are the bulk of what the probes cost,
+// and a sample of the cycles gives the same means and percentiles (see extras/host/profile_report.cpp for the cost against the processing time);
+// build with -DRADAR_PROFILING=0 and they are compiled out (the report is then empty).
+// The scan stage is timed by whoever scans (in the threaded mode, the acquisition task), everything else by the signal processing side.
+// Asynchronous scans (pipelined mode) run in the background and are not timed.
+
+#ifndef RADAR_PROFILING
+#define RADAR_PROFILING 1 // 0 removes the stage timers and the counters
+#endif
+
+#ifndef RADAR_PROFILE_SAMPLE_INTERVAL
+#define RADAR_PROFILE_SAMPLE_INTERVAL 64 // one timed cycle (and one timed scan) every that many, MUST be a power of two, 1 times them all: 64 keeps the probes under 1% of the processing time
+#endif
+
+static_assert((RADAR_PROFILE_SAMPLE_INTERVAL & (RADAR_PROFILE_SAMPLE_INTERVAL - 1)) == 0, "profiling: RADAR_PROFILE_SAMPLE_INTERVAL must be a power of two");
+
+#define RADAR_STAGE_SCAN 0 // blocking scans, runScanRequest()
+#define RADAR_STAGE_CHECK_INVALID_TX 1
+#define RADAR_STAGE_CHECK_DEAD_TX 2
+#define RADAR_STAGE_CHECK_INVALID_RSSI 3 // only with the RSSI cleaner enabled
+#define RADAR_STAGE_SORT 4 // only on the cycles with free slots
+#define RADAR_STAGE_LOAD 5 // same
+#define RADAR_STAGE_MULTIPROCESS 6
+#define RADAR_STAGE_OUTPUT 7 // CSV or telemetry, periodic snapshot
+#define RADAR_STAGE_CYCLE 8 // the whole processing after the scan, the untimed housekeeping between the stages included
+
+#define RADAR_STAGES_NUMBER 9
+
+#define RADAR_PROFILE_BUCKETS 32 // bucket b counts the durations of 2^b to 2^(b+1) - 1 ticks (bucket 0 also counts 0), the last one everything longer
+
+#if defined(ARDUINO)
+typedef uint32_t radarProfileTicks; // CCOUNT: wraps after 17 s at 240 MHz, far longer than any stage
+#else
+typedef uint64_t radarProfileTicks;
+#endif
+
+typedef struct  radarStageStatsStruct {
+
+uint32_t count = 0;
+
+uint32_t histogram[RADAR_PROFILE_BUCKETS] = {0};
+
+uint64_t totalTicks = 0;
+
+radarProfileTicks minTicks = 0;
+
+radarProfileTicks maxTicks = 0;
+
+} radarStageStats;
+
+typedef struct  radarProfileStruct {
+
+radarStageStats stages[RADAR_STAGES_NUMBER];
+
+// churn and resets, since the last multistatic_interference_radar_reset_profile()
+
+uint32_t cycles = 0; // processed scans
+
+uint32_t inoperableCycles = 0; // scans without results
+
+uint32_t rankings = 0; // cycles that ranked the scan results to fill free slots
+
+uint32_t slotAssignments = 0; // a transmitter taking a slot (restored ones included)
+
+uint32_t slotReleases = 0; // a transmitter leaving its slot
+
+uint32_t shadowPromotions = 0; // of those assignments, warm ones
+
+uint32_t filterResets = 0; // filter windows restarted, shadow trackers included
+
+// sampling state
+
+uint32_t scans = 0; // blocking scans, the scan stage has its own sampling: in the threaded mode it runs in the acquisition task
+
+uint8_t timedCycle = 0; // 1 while the processing stages of the current cycle are timed
+
+uint8_t timedScan = 0; // same for the current scan
+
+} radarProfile;
+
+typedef struct  radarStageReportStruct { // the times are in microseconds
+
+uint32_t count = 0;
+
+float meanUs = 0;
+
+float minUs = 0;
+
+float maxUs = 0;
+
+float p50Us = 0; // the percentiles come from the histogram: upper bound of their bucket (clamped to the maximum), at most twice the true value
+
+float p90Us = 0;
+
+float p99Us = 0;
+
+uint32_t histogram[RADAR_PROFILE_BUCKETS] = {0}; // as recorded, in ticks
+
+} radarStageReport;
+
+typedef struct  radarProfileReportStruct {
+
+int compiledIn = RADAR_PROFILING; // 0: the probes are not in the build, everything below is 0
+
+float ticksPerUs = 0; // histogram scale
+
+uint32_t sampleInterval = RADAR_PROFILE_SAMPLE_INTERVAL; // the stage counts below are the timed cycles, about cycles / sampleInterval
+
+radarStageReport stages[RADAR_STAGES_NUMBER];
+
+uint32_t cycles = 0;
+
+uint32_t inoperableCycles = 0;
+
+uint32_t rankings = 0;
+
+uint32_t slotAssignments = 0;
+
+uint32_t slotReleases = 0;
+
+uint32_t shadowPromotions = 0;
+
+uint32_t filterResets = 0;
+
+} radarProfileReport;
+
+
+
+// tracing: the timeline behind the profile, to find the one slow cycle (a scan that overran, a re-rank storm after churn) the averages hide.
+// Once enabled (multistatic_interference_radar_enable_tracing()), every stage of the profile above, every multistatic_interference_radar() call and every per link
+// multistatic_interference_radar_process() call (with batch processing, one span for the whole batch) is recorded as a complete span, start and duration in profiling
+// ticks, into a ring of RADAR_TRACE_EVENTS events: the oldest are overwritten, so the ring always holds the latest cycles.
+// The ring is allocated by the first enable (about 6 KB on the ESP32 with the default size) and kept with the context, so that it can still be dumped after disabling:
+// a context that never traces carries a pointer, and its layout does not depend on RADAR_TRACING or RADAR_TRACE_EVENTS (only the library translation unit reads them).
+// Host builds write it as Chrome trace-event JSON (multistatic_interference_radar_trace_write_json(), open it in ui.perfetto.dev or chrome://tracing);
+// the ESP32 dumps it over Serial as one binary frame (multistatic_interference_radar_trace_dump()) that extras/host/trace_export.cpp turns into the same JSON.
+// Disabled, a traced call costs one flag test; build with -DRADAR_TRACING=0 to remove the probes (enabling then fails).
+
+#ifndef RADAR_TRACING
+#define RADAR_TRACING 1 // 0 removes the probes
+#endif
+
+#ifndef RADAR_TRACE_EVENTS
+#define RADAR_TRACE_EVENTS 512 // ring size, MUST be a power of two: about 30 cycles of 8 links. 12 bytes each on the ESP32, 24 on 64 bit hosts
+#endif
+
+static_assert((RADAR_TRACE_EVENTS & (RADAR_TRACE_EVENTS - 1)) == 0, "tracing: RADAR_TRACE_EVENTS must be a power of two");
+
+// span ids: the stage ids of the profile (RADAR_STAGE_SCAN ... RADAR_STAGE_CYCLE), then
+
+#define RADAR_TRACE_PROCESS RADAR_STAGES_NUMBER // one multistatic_interference_radar_process() call, arg: the slot (-1 for shadow trackers and foreign transmitters data)
+#define RADAR_TRACE_PROCESS_BATCH (RADAR_STAGES_NUMBER + 1) // the batch kernel, arg: the links number
+#define RADAR_TRACE_RADAR (RADAR_STAGES_NUMBER + 2) // one multistatic_interference_radar() call, scan included, arg: the returned level (clamped to 16 bits)
+
+#define RADAR_TRACE_IDS_NUMBER (RADAR_STAGES_NUMBER + 3)
+
+// binary dump, little endian: 0xA5 0x7E, version (1), 0 (1), ticks per ms (4), events number (4), overwritten events (4), then the events oldest first,
+// 12 bytes each: start ticks (low 32 bits, 4), duration ticks (4), arg (2, signed), span id (1), 0 (1); then the CRC-32 (IEEE) of everything after the sync bytes (4).
+// The decoder unwraps the start ticks, so two consecutive events must be less than 2^31 ticks apart (9 s at 240 MHz)
+
+#define RADAR_TRACE_SYNC0 0xA5
+
+#define RADAR_TRACE_SYNC1 0x7E
+
+#define RADAR_TRACE_VERSION 1
+
+#define RADAR_TRACE_HEADER_LEN 16
+
+#define RADAR_TRACE_EVENT_LEN 12
+
+typedef struct  radarTraceEventStruct {
+
+radarProfileTicks startTicks = 0;
+
+uint32_t durationTicks = 0;
+
+int16_t arg = 0; // see the span ids
+
+uint8_t id = 0;
+
+} radarTraceEvent;
+
+typedef struct  radarTraceStruct {
+
+int enabled = 0;
+
+std::atomic<uint32_t> head {0}; // events recorded since the last reset: the scan spans come from the acquisition task in the threaded mode, so positions are claimed atomically
+
+uint32_t capacity = 0; // events in the ring, a power of two, 0 until the first enable
+
+radarTraceEvent * events = NULL; // the ring, allocated by the first multistatic_interference_radar_enable_tracing(1)
+
+~radarTraceStruct(); // frees the ring
+
+} radarTrace;
+
+
+
+
+// radar context: everything one radar is made of, settings and state. Radars on different contexts share nothing (but the ESP32 radio),
+// so that many of them can run in parallel threads, e.g. host replays of many nodes. Every public function has a version taking the context as first parameter,
+// the versions without it work on defaultRadarContext. A context is big (mostly the transmitters arena): allocate it statically or on the heap, not on a task stack.
+
+typedef struct  radarContextStruct {
+
+multistaticData accessPoints;
+
+int debugRadarMsg = 3; // serial messages verbosity of this radar
+
+radarLog debugLog; // where the messages go, see the logging section above
+
+radarTelemetry telemetry; // binary telemetry state, see the telemetry section above
+
+radarProfile profile; // stage timers and churn counters, see the profiling section above
+
+radarTrace trace; // span ring, see the tracing section above
+
+transmitterData transmittersArena[TRANSMITTERS_POOL_SIZE]; // the one and only allocation for the transmitters data, carved into the pool by multistatic_interference_radar_init()
+
+#if !defined(ARDUINO)
+std::thread acquisitionThread; // threaded mode, host builds (on the ESP32 the tasks are FreeRTOS tasks receiving the context as parameter)
+
+std::thread dspThread;
+
+std::thread logDrainThread; // drain task, host builds
+#endif
+
+} radarContext;
+
+
+extern radarContext defaultRadarContext; // defined in multistatic_interference_radar.cpp, the radar of the functions without a context parameter
+
+extern multistaticData & accessPoints; // defaultRadarContext.accessPoints, one instance shared by every file including this header
+
+
+
+
+
+
+
+
+// main functions
+   
+//// the init function is optional: the transmitters pool is bound to the arena on first use with the full TRANSMITTERS_POOL_SIZE capacity
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_init(int); // binds the transmitters pool to the arena and cleans it, the parameter is the pool size (1 to TRANSMITTERS_POOL_SIZE), returns the pool size
+
+
+// NOTE: there is no reconfiguration function. The data structures are exposed already, you may directly change every parameter, taking care to NEVER exceed the array boundaries and the maximum defined limits.
+
+// current status: IMPLEMENTED // architecture-independent
+ // receives the transmitter data structure (don't forget to check the default values in multistatic_interference_radar.h) and the related RSSI signal as parameters, 
+ // returns the detection level in dBm^2 ( < 0 -> error (see ERROR LEVELS section), == 0 -> no detection, > 0 -> detection level in dBm^2)
+int multistatic_interference_radar_process(int sample, transmitterData *transmitterX);
+
+// current status: IMPLEMENTED // architecture-independent
+ // batch version of the above: receives one RSSI sample per link in samples[] and updates every link of the structure-of-arrays batch data in one go. 
+ // writes each link's detection level to results[] (same meaning as the multistatic_interference_radar_process() return value), returns the number of processed links.
+int multistatic_interference_radar_process_batch(const int *samples, int *results, transmittersBatchData *batch);
+
+// current status: IMPLEMENTED // ESP32 and Arduino architecture-dependent
+int multistatic_interference_radar(); // ESP32 specific version: does all the the scans, classification, and requests the RSSI level internally, then processes the signal and returns the detection level in dBm^2
+
+// current status: IMPLEMENTED // ESP32 and Arduino architecture-dependent
+ // non blocking version of the above, call it as often as you like from the loop: it keeps the next scan running in the background while the previous one is processed.
+ // returns RADAR_RESULTS_PENDING until a new cycle is complete, then the same value as multistatic_interference_radar() (also published in accessPoints.pipeline). 
+ // don't mix it with multistatic_interference_radar() calls while running: both drive the radio. Backends without asynchronous hooks get blocking scans instead.
+int multistatic_interference_radar_pipelined();
+
+// current status: IMPLEMENTED // architecture-independent
+ // producer side of the streaming ingest, safe to call from another task / thread than the rest of the library (one producer only): 
+ // receives a raw 802.11 frame (from the frame control field on), the RSSI it was received with and a timestamp in ms.
+ // returns 1 if the frame is a beacon from a tracked transmitter and has been queued, 0 if filtered out, -1 if the ring was full
+int multistatic_interference_radar_stream_ingest_frame(const uint8_t * frame, int frameLength, int rssi, uint32_t timestampMs);
+
+// current status: IMPLEMENTED // architecture-independent
+ // consumer side: publishes the tracked BSSIDs to the producer and drains the queued beacons into the transmitters filters. Call it from the loop, between the scans. 
+ // returns the number of processed samples. The samples go through multistatic_interference_radar_process(): with batch processing enabled they are discarded.
+int multistatic_interference_radar_stream_process();
+
+// current status: IMPLEMENTED // ESP32 (FreeRTOS) and host (std::thread)
+ // threaded mode: starts the acquisition task and the signal processing task, returns 1 on success, 0 if already running, < 0 on failure.
+ // while they run, the library state belongs to them: only call multistatic_interference_radar_poll_result(), the stream ingest and multistatic_interference_radar_stop_tasks()
+int multistatic_interference_radar_start_tasks();
+
+// current status: IMPLEMENTED // ESP32 (FreeRTOS) and host (std::thread)
+int multistatic_interference_radar_stop_tasks(); // waits for both tasks to finish their current cycle and exit, returns the number of processed cycles
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_poll_result(radarResult *); // threaded mode: returns 1 and the oldest unread result, 0 if there is none
+
+// current status: IMPLEMENTED // architecture-independent
+ // [ RADAR_LOG_MODE_SERIAL (default), RADAR_LOG_MODE_RING_TEXT, RADAR_LOG_MODE_RING_BINARY ] where the diagnostic events go, see the logging section. 
+ // with a ring mode, drain it from the loop or start the drain task, or the records are dropped once it is full. Returns the applied mode.
+int multistatic_interference_radar_set_log_mode(int);
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_log_drain(); // prints the queued events to Serial (text or binary frames, after the mode), returns how many. One consumer at a time: not while the drain task runs
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_log_read(radarLogRecord * records, int maxRecords); // for application sinks (SD card, network): dequeues up to maxRecords events, returns how many. Same single consumer rule
+
+// current status: IMPLEMENTED // ESP32 (FreeRTOS) and host (std::thread)
+int multistatic_interference_radar_start_log_task(int periodMs); // drains the ring every periodMs in the background (<= 0: RADAR_LOG_DRAIN_PERIOD_MS), returns 1 on success, 0 if already running, < 0 on failure
+
+// current status: IMPLEMENTED // ESP32 (FreeRTOS) and host (std::thread)
+int multistatic_interference_radar_stop_log_task(); // drains what is left and stops the task, returns 1 if it was running
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_log_format(const radarLogRecord *, char * text, int textLength); // the message of an event, without timestamp and line end; returns its length
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_log_encode(const radarLogRecord *, uint8_t * frame); // the binary frame of an event, frame holds at least RADAR_LOG_FRAME_MAX_LEN bytes; returns its length
+
+
+// current status: IMPLEMENTED // architecture-independent
+ // [ 0 = disabled (default), >=1 = enabled ] binary telemetry of every cycle (and of every streamed sample) instead of the CSV output, see the telemetry section. 
+ // disabling it flushes the records still in the chunk. Returns the applied setting
+int multistatic_interference_radar_enable_telemetry(int);
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_set_telemetry_sink(radarTelemetrySink sink, void * sinkData); // where the chunks go, NULL = Serial.write(); the pending records go to the previous sink first. Returns 1
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_telemetry_flush(); // hands the chunk being filled to the sink now, returns its length in bytes (0 if empty). Same task as the cycle, like every telemetry call
+
+
+// current status: IMPLEMENTED // architecture-independent
+radarProfileReport multistatic_interference_radar_get_profile(); // the stage times and the counters so far, see the profiling section. About 1.5 KB: mind small task stacks
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_reset_profile(); // clears the stage times and the counters, returns 1
+
+// current status: IMPLEMENTED // architecture-independent
+const char * multistatic_interference_radar_stage_name(int); // "scan", "check_invalid_tx", ... or "unknown"; also names the trace span ids ("process", "process_batch", "radar")
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_enable_tracing(int); // [ 0 = disabled (default), >=1 = enabled ] records the spans of every cycle into the trace ring, see the tracing section. Returns the applied setting: 0 if the ring cannot be allocated, or with RADAR_TRACING 0
+
+// current status: IMPLEMENTED // architecture-independent
+int multistatic_interference_radar_reset_trace(); // empties the trace ring, returns 1
+
+// current status: IMPLEMENTED // architecture-independent
+ // writes the trace ring to Serial as one binary frame (see the tracing section), returns its length in bytes. Call it between two cycles (or with the tasks stopped): 
+ // a span recorded while the frame is written may come out torn
+int multistatic_interference_radar_trace_dump();
+
+#if !defined(ARDUINO)
+// current status: IMPLEMENTED // host only
+int multistatic_interference_radar_trace_write_json(const char * fileName); // the trace ring as Chrome trace-event JSON, returns the number of spans written, -1 if the file cannot be written
+#endif
+
+
+// current status: IMPLEMENTED // architecture-independent
+ // warm start: writes the snapshot of the valid slots and of their filter windows into buffer (RADAR_SNAPSHOT_MAX_LEN(transmitters number) bytes always suffice),
+ // returns the snapshot length, RADAR_SNAPSHOT_STORAGE_FAILED if the buffer is too small
+int multistatic_interference_radar_save_state(uint8_t * buffer, int bufferLength);
+
+// current status: IMPLEMENTED // architecture-independent
+ // restores a snapshot made by multistatic_interference_radar_save_state(): the slots outside of the snapshot are freed, the restored ones are validated by the next scan.
+ // call it after the settings (transmitters number, batch processing, window sizes), returns the number of restored links or an error (RADAR_SNAPSHOT_INVALID, RADAR_SNAPSHOT_BUSY)
+int multistatic_interference_radar_restore_state(const uint8_t * buffer, int bufferLength);
+
+// current status: IMPLEMENTED // ESP32 (NVS) and host (file)
+int multistatic_interference_radar_store_snapshot(); // saves the state and writes it under the snapshot name, returns the snapshot length or RADAR_SNAPSHOT_STORAGE_FAILED
+
+// current status: IMPLEMENTED // ESP32 (NVS) and host (file)
+int multistatic_interference_radar_load_snapshot(); // reads the snapshot stored under the snapshot name and restores it, returns the number of restored links or an error (RADAR_SNAPSHOT_NOT_FOUND and the above)
+
+
+
+// SERVICE / CONFIG FUNCTIONS
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_debug_via_serial(int);  // parameter is debug level, set it to at least >= 1; the highest the level, the more messages you enjoy
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_debug_level(int);  // parameter is debug level, set it to at least >= 1; the highest the level, the more messages you enjoy
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_txN_limit(int); // grows or shrinks the number of processed transmitters, from 1 up to the pool size (values outside are clamped), returns the applied limit
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_second_order_variance_filtering(int); // [ 0 = disabled, >=1 = enabled (1 recommended) ] enhances the second order derivative for very slow drifting variances, nullifies long-term variance offsets in crowded environments. As a wanted side-effect, when a transmitter accidentally becomes to weak to measure reliably and data stops being gathered, the terminal variance offset is gracefully compensated by the finite impulse response filter. 
+
+// current status: // current status: IMPLEMENTED
+int multistatic_interference_radar_enable_aggressive_cleaning_low_RSSI(int); // 0 = disabled, 1 = enabled (0 recommended) aggressively clean the transmitters list in case of low signals. // I don't recommentd enabling it unless you debug your system
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_serial_CSV_graph_data(int); // [ 0 = disabled, >=1 = enabled (default is 0) ] completely disable the verbose output and only print the variance foreach transmitter in CSV format over the serial console, so that any program listening to the serial can graph the relevant data. 
+
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient(int); // don't set it to 0 or 1, it needs to be at least 2 or above. If <= 1 very bad things might happen. (values below 2 are clamped to 2), returns the applied coefficient
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_scan_backend(const radarScanBackend *); // replaces the radio access hooks, NULL restores the default ESP32 backend. The backend struct must stay valid while in use.
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_targeted_scan(int); // [ 0 = disabled (default), >=1 = enabled ] scan only the channels of the tracked transmitters most of the time, several times faster per sample
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_full_sweep_interval(int); // with targeted scans enabled, how many cycles between two full discovery sweeps (at least 1)
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_batch_processing(int); // [ 0 = disabled (default), >=1 = enabled ] process all the transmitters at once with the structure-of-arrays batch kernel. Switching it resets the variance data.
+
+// current status: IMPLEMENTED // ESP32 and Arduino architecture-dependent
+int multistatic_interference_radar_enable_stream(int); // [ 0 = disabled (default), >=1 = enabled ] beacon streaming ingest: on the ESP32 it installs the promiscuous receive callback, on the host the frames are fed by the application; returns the applied setting
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_minimum_RSSI(int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_alarm(int);
+
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_alarm_threshold(int);
+
+// current status: IMPLEMENTED
+ // [ 0 = disabled (default), >=1 = enabled ] bootstrap mode: a freshly loaded (or replaced) transmitter produces estimates from BOOTSTRAP_MIN_SAMPLES samples on, instead of after a full sample buffer.
+ // until the buffer is full, the mean and the variance are taken over the samples received so far (growing windows) and corrected for the bias of the short windows, 
+ // then the usual filters take over seamlessly. The early estimates are noisier: with few transmitters, a threshold alarm may fire now and then on a replacement.
+int multistatic_interference_radar_enable_bootstrap(int);
+
+// current status: IMPLEMENTED
+ // [ 0 = disabled (default), 1 to SHADOW_TRACKERS_MAX ] hot standby: how many runner-up transmitters are followed by shadow trackers, see the hot standby section. 
+ // returns the applied number.
+int multistatic_interference_radar_set_shadow_trackers(int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_snapshot_name(const char *); // NVS key (ESP32) or file name without the ".snapshot" extension (host), up to SNAPSHOT_NAME_LEN - 1 characters, returns 1 if applied
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_snapshot_interval(int); // store a snapshot every that many processed cycles, 0 = never (default); mind the flash wear on the ESP32, minutes apart are plenty
+
+
+
+// reentrant versions: the same functions, same parameters and return values, on an explicit radar context (see radarContext above)
+// calls on different contexts can run in parallel, calls on the same context can not (except stream_ingest_frame() with its single consumer, as above)
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_init(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_process(radarContext *, int sample, transmitterData *transmitterX); // the context provides the second order filter settings
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_pipelined(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_stream_ingest_frame(radarContext *, const uint8_t * frame, int frameLength, int rssi, uint32_t timestampMs);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_stream_process(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_start_tasks(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_stop_tasks(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_poll_result(radarContext *, radarResult *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_log_mode(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_log_drain(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_log_read(radarContext *, radarLogRecord * records, int maxRecords);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_start_log_task(radarContext *, int periodMs); // one drain task per context
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_stop_log_task(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_telemetry(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_telemetry_sink(radarContext *, radarTelemetrySink sink, void * sinkData);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_telemetry_flush(radarContext *);
+
+// current status: IMPLEMENTED
+radarProfileReport multistatic_interference_radar_get_profile(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_reset_profile(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_tracing(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_reset_trace(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_trace_dump(radarContext *);
+
+#if !defined(ARDUINO)
+// current status: IMPLEMENTED
+int multistatic_interference_radar_trace_write_json(radarContext *, const char * fileName);
+#endif
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_save_state(radarContext *, uint8_t * buffer, int bufferLength);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_restore_state(radarContext *, const uint8_t * buffer, int bufferLength);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_store_snapshot(radarContext *); // on the ESP32, give each context its own snapshot name
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_load_snapshot(radarContext *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_debug_via_serial(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_debug_level(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_txN_limit(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_second_order_variance_filtering(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_aggressive_cleaning_low_RSSI(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_serial_CSV_graph_data(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_Second_Order_Attenutation_Coefficient(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_scan_backend(radarContext *, const radarScanBackend *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_targeted_scan(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_full_sweep_interval(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_batch_processing(radarContext *, int);
+
+// current status: IMPLEMENTED // ESP32 and Arduino architecture-dependent
+int multistatic_interference_radar_enable_stream(radarContext *, int); // on the ESP32 there is one radio: the promiscuous frames go to the latest context enabling the stream
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_minimum_RSSI(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_alarm(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_alarm_threshold(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_enable_bootstrap(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_shadow_trackers(radarContext *, int);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_snapshot_name(radarContext *, const char *);
+
+// current status: IMPLEMENTED
+int multistatic_interference_radar_set_snapshot_interval(radarContext *, int);
+
+//
+
+#endif
@@ -8,10 +8,21 @@
 
 int enableCSVgraphOutput = 1; // 0 disable, 1 enable // if enabled, you may use Tools-> Serial Plotter to plot the variance output for each transmitter. 
 
+int enableBinaryTelemetry = 0; // 0 disable, 1 enable // if enabled, the serial output is binary telemetry instead (every link, every cycle, losslessly): capture it and convert it with extras/host/telemetry_decode
+
 int scanInterval = 1000; // in milliseconds
 
+int enableWarmStart = 0; // 0 disable, 1 enable // if enabled, the radar state is restored from NVS at boot and saved again every snapshotInterval scan cycles
+
+int snapshotInterval = 300; // in scan cycles: a cycle is scanInterval plus a full channel sweep of about 4 seconds, so 300 cycles are about 25 minutes. NVS flash has limited write cycles, don't go much lower
+
+int enableBootstrap = 0; // 0 disable, 1 enable // if enabled, transmitters replaced along the way produce data after a few scans, instead of 32
+
+int shadowTrackers = 0; // 0 disable, 1 or more enable // follow that many of the next strongest transmitters in the background, so that a lost transmitter is replaced by an already warm one
+
 // PLEASE NOTE: by default configuration, it takes 32 iterations to collect enough data to produce a meaningful output. PLEASE BE PATIENT AND WAIT about 2 minutes for that. 
 // While initializing, the output is tipically < 0 and meaningless. 
+// With enableWarmStart this only happens on the very first boot: the radar state is saved in NVS about every 25 minutes (see snapshotInterval) and restored at boot, so after a reboot the output is valid right away.
 
 // My suggestion is to use Tools->Serial plotter to see the actual graph, also don't forget you can change most runtime parameters for this library by sending simple serial commands 
 // (see the manageSerialCommands() function down below)
@@ -89,7 +100,28 @@ void setup()
       multistatic_interference_radar_enable_serial_CSV_graph_data(enableCSVgraphOutput); // output CSV data only
     }
 
+    if (enableBinaryTelemetry > 0) {
+      multistatic_interference_radar_enable_telemetry(enableBinaryTelemetry); // takes over from the CSV output
+    }
+
     multistatic_interference_radar_enable_second_order_variance_filtering(enableSecondOrderFilter);
+
+    if (enableBootstrap > 0) {
+      multistatic_interference_radar_enable_bootstrap(enableBootstrap);
+    }
+
+    if (shadowTrackers > 0) {
+      multistatic_interference_radar_set_shadow_trackers(shadowTrackers);
+    }
+
+
+    //// warm start: restore the transmitters and their filter data saved before the reboot (call it after the other settings), then keep saving them.
+    //// if the room has changed in the meantime, the first scan notices it and the radar starts from scratch as usual.
+
+    if (enableWarmStart > 0) {
+      multistatic_interference_radar_load_snapshot();
+      multistatic_interference_radar_set_snapshot_interval(snapshotInterval);
+    }
     
     
     //// trying to reduce overall power usage
@@ -173,6 +205,25 @@ void manageSerialCommands() { // receives simple commands via serial port in the
       if (serCom == 'i') { // set the scan interval in milliseconds
         scanInterval = serParVal;
       }
+      if (serCom == 'b') {
+        multistatic_interference_radar_enable_bootstrap(serParVal);
+      }
+      if (serCom == 'h') { // hot standby shadow trackers
+        multistatic_interference_radar_set_shadow_trackers(serParVal);
+      }
+      if (serCom == 'y') { // binary telemetry on / off
+        enableBinaryTelemetry = multistatic_interference_radar_enable_telemetry(serParVal);
+      }
+      if (serCom == 'x') { // tracing: x1 starts recording the cycle timeline (the first one allocates the ring), x2 dumps it (binary, convert the capture with extras/host/trace_export), x0 stops
+        if (serParVal == 2) {
+          multistatic_interference_radar_trace_dump();
+        } else {
+          multistatic_interference_radar_enable_tracing(serParVal);
+        }
+      }
+      if (serCom == 'w') { // save the radar state now, e.g. right before a planned reboot
+        multistatic_interference_radar_store_snapshot();
+      }
     }
 
 }
@@ -186,7 +237,7 @@ void loop()
     
     wifiRadarLevel = multistatic_interference_radar();  // if the connection fails, the radar will automatically try to switch to different operating modes by using ESP32 specific calls. 
     
-    if (enableCSVgraphOutput == 0) {
+    if ((enableCSVgraphOutput == 0) && (enableBinaryTelemetry == 0)) {
       Serial.print("wifiRadarLevel: ");
       Serial.println(wifiRadarLevel);
     }
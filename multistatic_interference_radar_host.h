@@ -0,0 +1,98 @@
+// Host (Linux) replacements for the few Arduino facilities used by the multistatic interference radar library.
+
+// This file is only included by multistatic_interference_radar.cpp when ARDUINO is not defined, it lets the unmodified library code run on a workstation:
+// the diagnostic messages go to stdout, millis() and micros() follow the monotonic clock.
+// The WiFi class is not replaced: on the host a scan backend must be provided via multistatic_interference_radar_set_scan_backend() (see extras/host for a mock one).
+
+#ifndef MULTISTATIC_INTERFERENCE_RADAR_HOST_H
+#define MULTISTATIC_INTERFERENCE_RADAR_HOST_H
+
+#if !defined(ARDUINO)
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define DEC 10
+#define HEX 16
+
+
+class radarHostSerial { // the subset of the Arduino Print interface used by the library
+
+public:
+
+  void print(const char * text) { fputs(text, stdout); }
+  void print(char character) { fputc(character, stdout); }
+  void print(int value, int base = DEC) { printf((base == HEX) ? "%X" : "%d", value); }
+  void print(unsigned int value, int base = DEC) { printf((base == HEX) ? "%X" : "%u", value); }
+  void print(long value, int base = DEC) { printf((base == HEX) ? "%lX" : "%ld", value); }
+  void print(unsigned long value, int base = DEC) { printf((base == HEX) ? "%lX" : "%lu", value); }
+  void print(long long value, int base = DEC) { printf((base == HEX) ? "%llX" : "%lld", value); }
+  void print(unsigned long long value, int base = DEC) { printf((base == HEX) ? "%llX" : "%llu", value); }
+  void print(double value, int digits = 2) { printf("%.*f", digits, value); }
+
+  void println() { fputc('\n', stdout); }
+  template <typename T> void println(T value) { print(value); println(); }
+  template <typename T> void println(T value, int format) { print(value, format); println(); }
+
+  size_t write(uint8_t byte) { return fwrite(&byte, 1, 1, stdout); }
+  size_t write(const uint8_t * buffer, size_t size) { return fwrite(buffer, 1, size, stdout); }
+
+  void flush() { fflush(stdout); }
+
+};
+
+static radarHostSerial Serial; // stateless, one per translation unit is harmless
+
+
+static inline std::chrono::steady_clock::time_point radarHostClockStart() {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return start;
+}
+
+static inline unsigned long millis() {
+  return (unsigned long) std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - radarHostClockStart()).count();
+}
+
+static inline unsigned long micros() {
+  return (unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - radarHostClockStart()).count();
+}
+
+
+static inline uint64_t radarHostTicks() { // profiling clock: the TSC on x86, a few cycles to read, nanoseconds elsewhere
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline float radarHostCalibrateTicks() { // the TSC rate against the monotonic clock, takes about 20 ms
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  uint64_t startTicks = __rdtsc();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  uint64_t ticks = __rdtsc() - startTicks;
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  return (float) (ticks / us);
+}
+#endif
+
+static inline float radarHostTicksPerUs() { // measured once, the first time; a static initializer, so concurrent first calls wait for the one calibration
+#if defined(__x86_64__) || defined(__i386__)
+  static const float ticksPerUs = radarHostCalibrateTicks();
+  return ticksPerUs;
+#else
+  return 1000.0f;
+#endif
+}
+
+#endif
+
+#endif
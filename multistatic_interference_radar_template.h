@@ -0,0 +1,213 @@
+// Compile-time specialised version of the multistatic interference radar core.
+
+// The window sizes and the enabled filter stages become template parameters instead of global #defines and runtime flags:
+// - power-of-two windows get mask based indexing and shift based divisions,
+// - disabled stages (FIR/IIR second order filter, autoregressive smoother, alarm threshold) are compiled away entirely, no branches are left in the hot path,
+// - since every instance carries its own sizes, one binary can hold several differently sized radar instances.
+
+// the processing is the same as multistatic_interference_radar_process() (running sums, see multistatic_interference_radar.cpp), the function is an overload of the same name:
+//
+//   transmitterDataT<64, 64, 32, 4, true, 16, true, true> link; // 64 samples window, 32 variance buffer, integrator over 4 entries, second order filter with 1/16 attenuation, AR smoother and alarm threshold
+//   int level = multistatic_interference_radar_process(rssi, &link);
+//
+// like the core function, this file does NOT require any hardware specific library.
+// please note: the configuration fields of the multistaticData structure (secondOrderFilter, secondOrderAttenutationCoefficient) have no effect here, the template parameters replace them.
+
+#ifndef MULTISTATIC_INTERFERENCE_RADAR_TEMPLATE_H
+#define MULTISTATIC_INTERFERENCE_RADAR_TEMPLATE_H
+
+#include "multistatic_interference_radar.h"
+
+#include <stdlib.h> // abs()
+
+
+
+// compile-time helpers
+
+constexpr bool radarIsPowerOfTwo(int value) {
+  return (value > 0) && ((value & (value - 1)) == 0);
+}
+
+constexpr int radarLog2(int value) {
+  return (value <= 1) ? 0 : 1 + radarLog2(value >> 1);
+}
+
+
+template <int N>
+struct radarWindow {
+
+  static_assert(N > 0, "radarWindow: window sizes must be positive");
+
+  // index - offset, wrapped inside the window, with 0 <= index < N and 0 <= offset <= N
+  static inline int back(int index, int offset) {
+    return radarIsPowerOfTwo(N) ? ((index - offset) & (N - 1)) : (((index - offset) < 0) ? (index - offset + N) : (index - offset));
+  }
+
+  // index + 1, wrapped inside the window
+  static inline int next(int index) {
+    return radarIsPowerOfTwo(N) ? ((index + 1) & (N - 1)) : (((index + 1) >= N) ? 0 : (index + 1));
+  }
+
+  // value / N, truncating towards zero exactly like the '/' operator does (the sums of RSSI samples are negative, a plain shift would round them down)
+  static inline int divide(int value) {
+    return radarIsPowerOfTwo(N) ? ((value + ((value < 0) ? (N - 1) : 0)) >> radarLog2(N)) : (value / N);
+  }
+};
+
+
+
+template <int SampleBufferSize = MAX_SAMPLEBUFFERSIZE_MULTI,
+          int MobileAverageFilterSize = SampleBufferSize,
+          int VarianceBufferSize = MAX_VARIANCEBUFFERSIZE_MULTI,
+          int VarianceIntegratorLimit = VARIANCE_INTEGRATOR_LIMIT,
+          bool SecondOrderFilter = (ENABLE_FIR_IIR_SECOND_ORDER >= 1),
+          int SecondOrderAttenuationCoefficient = 16,
+          bool AutoRegressive = false,
+          bool Threshold = false>
+struct transmitterDataT {
+
+  static_assert(MobileAverageFilterSize <= SampleBufferSize, "transmitterDataT: the mobile average cannot exceed the sample buffer");
+  static_assert(VarianceIntegratorLimit <= VarianceBufferSize, "transmitterDataT: the variance integrator cannot exceed the variance buffer");
+  static_assert(MobileAverageFilterSize > 0 && VarianceIntegratorLimit > 0, "transmitterDataT: empty windows");
+  static_assert((!SecondOrderFilter) || (SecondOrderAttenuationCoefficient >= 2), "transmitterDataT: the second order attenuation coefficient needs to be at least 2");
+  static_assert((SampleBufferSize <= 255) && (VarianceBufferSize <= 255), "transmitterDataT: the window sizes must fit an uint8_t, like transmitterData");
+  static_assert(SampleBufferSize * ABSOLUTE_RSSI_LIMIT >= -32768, "transmitterDataT: the mobile average sum must fit an int16_t, like transmitterData");
+
+  // same compact layout as transmitterData: the samples are clamped to [ABSOLUTE_RSSI_LIMIT, 0] and kept in 8 bits, the deviations in 16 bits, the fields a sample touches come first
+
+  int32_t variance = RADAR_BOOTING;
+
+  int32_t varianceIntegral = 0; // running sum of the latest VarianceIntegratorLimit entries of the varianceBuffer
+
+  int32_t varianceBufferSum = 0; // running sum of the whole varianceBuffer, only maintained when SecondOrderFilter is enabled
+
+  int32_t varianceAR = 0; // only maintained when AutoRegressive is enabled
+
+  int16_t mobileAverageSum = 0; // running sum of the latest MobileAverageFilterSize samples
+
+  int16_t mobileAverage = 0;
+
+  uint16_t varianceSample = 0;
+
+  uint16_t FIRvarianceAvg = 0;
+
+  uint8_t sampleBufferIndex = 0;
+
+  uint8_t varianceBufferIndex = 0;
+
+  uint8_t sampleBufferValid = 0;
+
+  uint8_t varianceBufferValid = 0;
+
+  uint8_t resetRequest = 0; // when 1, the buffers are cleaned and this variable is toggled back to zero.
+
+  int16_t latestReceivedSample = ABSOLUTE_RSSI_LIMIT;
+
+  int16_t minimum_RSSI = MINIMUM_RSSI;
+
+  int16_t currentRSSI = MINIMUM_RSSI;
+
+  int32_t varianceThreshold = VARIANCE_THRESHOLD; // only used when Threshold is enabled
+
+  int32_t detectionLevel = 0;
+
+  int8_t sampleBuffer[SampleBufferSize] = {0};
+
+  uint16_t varianceBuffer[VarianceBufferSize] = {0};
+
+};
+
+typedef transmitterDataT<> transmitterDataDefaultT; // same sizes and stages as the #define defaults
+
+
+
+template <int SampleBufferSize, int MobileAverageFilterSize, int VarianceBufferSize, int VarianceIntegratorLimit, bool SecondOrderFilter, int SecondOrderAttenuationCoefficient, bool AutoRegressive, bool Threshold>
+int multistatic_interference_radar_process(int sample, transmitterDataT<SampleBufferSize, MobileAverageFilterSize, VarianceBufferSize, VarianceIntegratorLimit, SecondOrderFilter, SecondOrderAttenuationCoefficient, AutoRegressive, Threshold> *transmitterX) { // same return values as the runtime version
+
+  typedef radarWindow<SampleBufferSize> sampleWindow;
+  typedef radarWindow<MobileAverageFilterSize> filterWindow;
+  typedef radarWindow<VarianceBufferSize> varianceWindow;
+  typedef radarWindow<SecondOrderAttenuationCoefficient> attenuation;
+
+  if (transmitterX->resetRequest == 1) {
+    transmitterX->resetRequest = 0;
+    for (int sampleIndex = 0; sampleIndex < SampleBufferSize; sampleIndex++) {
+      transmitterX->sampleBuffer[sampleIndex] = 0;
+    }
+    for (int varianceIndex = 0; varianceIndex < VarianceBufferSize; varianceIndex++) {
+      transmitterX->varianceBuffer[varianceIndex] = 0;
+    }
+    transmitterX->sampleBufferIndex = 0;
+    transmitterX->sampleBufferValid = 0;
+    transmitterX->mobileAverageSum = 0;
+    transmitterX->varianceBufferIndex = 0;
+    transmitterX->varianceBufferValid = 0;
+    transmitterX->varianceBufferSum = 0;
+    transmitterX->varianceIntegral = 0;
+    transmitterX->varianceAR = 0;
+    transmitterX->variance = -1;
+  }
+
+  // the compact layout holds the samples in 8 bits and sizes the sums on that range: nothing a radio reports is outside of it
+  if (sample < ABSOLUTE_RSSI_LIMIT) {
+    sample = ABSOLUTE_RSSI_LIMIT;
+  }
+  if (sample > 0) {
+    sample = 0;
+  }
+
+  transmitterX->latestReceivedSample = sample;
+
+  // minimum RSSI test, weak samples are replaced by the mobile average (or by the latest acceptable sample while booting)
+  if (sample >= transmitterX->minimum_RSSI) {
+    transmitterX->currentRSSI = sample;
+  } else {
+    sample = (transmitterX->sampleBufferValid == 1) ? transmitterX->mobileAverage : transmitterX->currentRSSI;
+  }
+
+  // sliding the mobile average window
+  transmitterX->mobileAverageSum = transmitterX->mobileAverageSum + sample - transmitterX->sampleBuffer[sampleWindow::back(transmitterX->sampleBufferIndex, MobileAverageFilterSize)];
+  transmitterX->sampleBuffer[transmitterX->sampleBufferIndex] = sample;
+  transmitterX->sampleBufferIndex = sampleWindow::next(transmitterX->sampleBufferIndex);
+  if (transmitterX->sampleBufferIndex == 0) {
+    transmitterX->sampleBufferValid = 1;
+  }
+
+  if (transmitterX->sampleBufferValid == 0) {
+    return transmitterX->variance; // still booting
+  }
+
+  transmitterX->mobileAverage = filterWindow::divide(transmitterX->mobileAverageSum);
+  transmitterX->varianceSample = (sample - transmitterX->mobileAverage) * (sample - transmitterX->mobileAverage);
+
+  if (SecondOrderFilter) { // compiled away when disabled
+    transmitterX->FIRvarianceAvg = attenuation::divide(varianceWindow::divide(transmitterX->varianceBufferSum));
+    transmitterX->varianceSample = abs(transmitterX->varianceSample - transmitterX->FIRvarianceAvg);
+    transmitterX->varianceBufferSum = transmitterX->varianceBufferSum + transmitterX->varianceSample - transmitterX->varianceBuffer[transmitterX->varianceBufferIndex];
+  }
+
+  // mobile integrator over the latest VarianceIntegratorLimit entries
+  transmitterX->varianceIntegral = transmitterX->varianceIntegral + transmitterX->varianceSample - transmitterX->varianceBuffer[varianceWindow::back(transmitterX->varianceBufferIndex, VarianceIntegratorLimit)];
+  transmitterX->varianceBuffer[transmitterX->varianceBufferIndex] = transmitterX->varianceSample;
+  transmitterX->varianceBufferIndex = varianceWindow::next(transmitterX->varianceBufferIndex);
+  if (transmitterX->varianceBufferIndex == 0) {
+    transmitterX->varianceBufferValid = 1;
+  }
+
+  if (AutoRegressive) { // compiled away when disabled
+    transmitterX->varianceAR = (transmitterX->varianceIntegral + transmitterX->varianceAR) / 2;
+    transmitterX->variance = transmitterX->varianceAR;
+  } else {
+    transmitterX->variance = transmitterX->varianceIntegral;
+  }
+
+  if (Threshold) { // compiled away when disabled
+    transmitterX->detectionLevel = (transmitterX->variance >= transmitterX->varianceThreshold) ? transmitterX->variance : 0;
+    return transmitterX->detectionLevel;
+  }
+
+  return transmitterX->variance;
+}
+
+
+#endif